@@ -0,0 +1,390 @@
+#include "le_core.h"
+#include "le_renderer/le_renderer_types.h"
+#include "le_backend_vk/le_command_stream_t.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/*
+
+Micro-benchmark for command stream encoding and decoding.
+
+We record the command sequence of a typical mesh draw loop into a
+`le_command_stream_t`, and then walk the stream with
+`le_command_stream_t::reader_t`, the same way in which the backend does
+in `backend_process_frame` - minus the Vulkan calls.
+
+This needs no Vulkan device, and no renderer; it only includes the
+headers which are shared between renderer and backend.
+
+Encoding rules mirror `le_command_buffer_encoder.cpp`:
+
+* `full`    - every draw is recorded as CommandDrawIndexed, and buffer
+              bindings are recorded for every draw.
+* `compact` - draws are recorded as CommandDrawIndexedCompact, and buffer
+              bindings which would not change state are skipped.
+
+*/
+
+using Clock = std::chrono::steady_clock;
+
+enum class encoding_t : uint32_t {
+	eFull = 0,
+	eCompact,
+};
+
+static char const* encoding_name( encoding_t encoding ) {
+	return encoding == encoding_t::eCompact ? "compact" : "full";
+}
+
+struct benchmark_settings_t {
+	uint32_t draws      = 10000; // number of draws per stream
+	uint32_t meshes     = 100;   // number of distinct meshes - draws are sorted by mesh, so buffers change every draws/meshes draws
+	uint32_t iterations = 200;   // number of times to encode, then decode a stream
+	bool     run_full    = true;
+	bool     run_compact = true;
+};
+
+// Encoder state - mirrors what le_command_buffer_encoder_o keeps for elision.
+struct encoder_t {
+	le_command_stream_t*                stream                  = nullptr;
+	le::CommandBindIndexBuffer const*   last_index_buffer_cmd   = nullptr; // non-owning
+	le::CommandBindVertexBuffers const* last_vertex_buffers_cmd = nullptr; // non-owning
+};
+
+// Decoder state - roughly what backend_process_frame tracks while decoding a pass.
+struct decoder_state_t {
+	le_buf_resource_handle index_buffer        = nullptr;
+	uint64_t               index_buffer_offset = 0;
+	le_buf_resource_handle vertex_buffers[ 4 ] = {};
+	uint64_t               vertex_offsets[ 4 ] = {};
+	uint8_t                push_constants[ 128 ];
+	uint64_t               checksum = 0; // accumulates draw parameters, so that decoding cannot be optimised away
+};
+
+struct mesh_t {
+	le_buf_resource_handle vertex_buffers[ 2 ];
+	uint64_t               vertex_offsets[ 2 ];
+	le_buf_resource_handle index_buffer;
+	uint32_t               index_count;
+};
+
+// ----------------------------------------------------------------------
+
+static void encode_bind_vertex_buffers( encoder_t& self, encoding_t encoding, uint32_t firstBinding, uint32_t bindingCount, le_buf_resource_handle const* pBuffers, uint64_t const* pOffsets ) {
+
+	size_t data_buffers_size = sizeof( le_buf_resource_handle ) * bindingCount;
+	size_t data_offsets_size = sizeof( uint64_t ) * bindingCount;
+
+	if ( auto prev = self.last_vertex_buffers_cmd;
+	     encoding == encoding_t::eCompact &&
+	     prev &&
+	     prev->info.firstBinding == firstBinding &&
+	     prev->info.bindingCount == bindingCount ) {
+
+		auto prevBuffers = ( le_buf_resource_handle const* )( prev + 1 );
+		auto prevOffsets = ( uint64_t const* )( prevBuffers + bindingCount );
+
+		if ( 0 == memcmp( prevBuffers, pBuffers, data_buffers_size ) &&
+		     0 == memcmp( prevOffsets, pOffsets, data_offsets_size ) ) {
+			return;
+		}
+	}
+
+	auto cmd = self.stream->emplace_cmd<le::CommandBindVertexBuffers>( data_buffers_size + data_offsets_size );
+
+	self.last_vertex_buffers_cmd = cmd;
+
+	le_buf_resource_handle* dataBuffers = ( le_buf_resource_handle* )( cmd + 1 );
+	uint64_t*               dataOffsets = ( uint64_t* )( dataBuffers + bindingCount );
+
+	cmd->info = { firstBinding, bindingCount };
+	cmd->header.info.size += uint32_t( data_buffers_size + data_offsets_size );
+
+	memcpy( dataBuffers, pBuffers, data_buffers_size );
+	memcpy( dataOffsets, pOffsets, data_offsets_size );
+}
+
+// ----------------------------------------------------------------------
+
+static void encode_bind_index_buffer( encoder_t& self, encoding_t encoding, le_buf_resource_handle buffer, uint64_t offset ) {
+
+	if ( auto prev = self.last_index_buffer_cmd;
+	     encoding == encoding_t::eCompact &&
+	     prev &&
+	     prev->info.buffer == buffer &&
+	     prev->info.offset == offset &&
+	     prev->info.indexType == le::IndexType::eUint32 ) {
+		return;
+	}
+
+	auto cmd  = self.stream->emplace_cmd<le::CommandBindIndexBuffer>();
+	cmd->info = { buffer, offset, le::IndexType::eUint32, 0 };
+
+	self.last_index_buffer_cmd = cmd;
+}
+
+// ----------------------------------------------------------------------
+
+static void encode_set_push_constant_data( encoder_t& self, void const* src_data, uint64_t num_bytes ) {
+
+	auto cmd = self.stream->emplace_cmd<le::CommandSetPushConstantData>( num_bytes );
+
+	cmd->info = { num_bytes };
+	cmd->header.info.size += uint32_t( num_bytes );
+
+	memcpy( cmd + 1, src_data, num_bytes );
+}
+
+// ----------------------------------------------------------------------
+
+static void encode_draw_indexed( encoder_t& self, encoding_t encoding, uint32_t indexCount, uint32_t firstIndex ) {
+
+	if ( encoding == encoding_t::eCompact ) {
+		auto cmd  = self.stream->emplace_cmd<le::CommandDrawIndexedCompact>();
+		cmd->info = { indexCount, firstIndex };
+		return;
+	}
+
+	auto cmd  = self.stream->emplace_cmd<le::CommandDrawIndexed>();
+	cmd->info = { indexCount, 1, firstIndex, 0, 0, 0 };
+}
+
+// ----------------------------------------------------------------------
+// Records a draw loop over all meshes - one push constant update, and one
+// draw per object; vertex and index buffers change whenever the mesh changes.
+static void encode_stream( le_command_stream_t* stream, encoding_t encoding, std::vector<mesh_t> const& meshes, uint32_t draws ) {
+
+	stream->reset();
+
+	encoder_t encoder{ stream };
+
+	uint32_t draws_per_mesh = std::max<uint32_t>( 1, draws / uint32_t( meshes.size() ) );
+
+	for ( uint32_t i = 0; i != draws; i++ ) {
+		mesh_t const& mesh = meshes[ std::min<size_t>( i / draws_per_mesh, meshes.size() - 1 ) ];
+
+		float mvp[ 16 ] = {};
+		mvp[ 0 ] = mvp[ 5 ] = mvp[ 10 ] = mvp[ 15 ] = 1.f;
+		mvp[ 12 ]                                   = float( i );
+
+		encode_bind_vertex_buffers( encoder, encoding, 0, 2, mesh.vertex_buffers, mesh.vertex_offsets );
+		encode_bind_index_buffer( encoder, encoding, mesh.index_buffer, 0 );
+		encode_set_push_constant_data( encoder, mvp, sizeof( mvp ) );
+		encode_draw_indexed( encoder, encoding, mesh.index_count, 0 );
+	}
+}
+
+// ----------------------------------------------------------------------
+// Walks the stream in the same way as backend_process_frame does.
+static void decode_stream( le_command_stream_t const* stream, decoder_state_t& state ) {
+
+	le_command_stream_t::reader_t reader( stream );
+
+	for ( size_t commandIndex = 0; commandIndex != stream->cmd_count; commandIndex++ ) {
+
+		void* dataIt = reader.get();
+		auto  header = static_cast<le::CommandHeader*>( dataIt );
+
+		switch ( header->info.type ) {
+		case le::CommandType::eBindVertexBuffers: {
+			auto* le_cmd      = static_cast<le::CommandBindVertexBuffers*>( dataIt );
+			auto  pBuffers    = ( le_buf_resource_handle const* )( le_cmd + 1 );
+			auto  pOffsets    = ( uint64_t const* )( pBuffers + le_cmd->info.bindingCount );
+			uint32_t last_idx = std::min<uint32_t>( le_cmd->info.firstBinding + le_cmd->info.bindingCount, 4 );
+			for ( uint32_t b = le_cmd->info.firstBinding, j = 0; b < last_idx; b++, j++ ) {
+				state.vertex_buffers[ b ] = pBuffers[ j ];
+				state.vertex_offsets[ b ] = pOffsets[ j ];
+			}
+		} break;
+		case le::CommandType::eBindIndexBuffer: {
+			auto* le_cmd              = static_cast<le::CommandBindIndexBuffer*>( dataIt );
+			state.index_buffer        = le_cmd->info.buffer;
+			state.index_buffer_offset = le_cmd->info.offset;
+		} break;
+		case le::CommandType::eSetPushConstantData: {
+			auto* le_cmd = static_cast<le::CommandSetPushConstantData*>( dataIt );
+			memcpy( state.push_constants, le_cmd + 1, std::min<uint64_t>( le_cmd->info.num_bytes, sizeof( state.push_constants ) ) );
+		} break;
+		case le::CommandType::eDrawIndexed: {
+			auto* le_cmd = static_cast<le::CommandDrawIndexed*>( dataIt );
+			state.checksum += le_cmd->info.indexCount + le_cmd->info.instanceCount + le_cmd->info.firstIndex +
+			                  uint64_t( le_cmd->info.vertexOffset ) + le_cmd->info.firstInstance +
+			                  uint64_t( state.index_buffer ) + uint64_t( state.vertex_buffers[ 0 ] ) + state.push_constants[ 48 ];
+		} break;
+		case le::CommandType::eDrawIndexedCompact: {
+			auto* le_cmd = static_cast<le::CommandDrawIndexedCompact*>( dataIt );
+			state.checksum += le_cmd->info.indexCount + 1 + le_cmd->info.firstIndex +
+			                  uint64_t( state.index_buffer ) + uint64_t( state.vertex_buffers[ 0 ] ) + state.push_constants[ 48 ];
+		} break;
+		default:
+			break;
+		}
+
+		reader.advance( header->info.size );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+template <typename T>
+static T median_of( std::vector<T>& values ) {
+	if ( values.empty() ) {
+		return T{};
+	}
+	auto mid = values.begin() + values.size() / 2;
+	std::nth_element( values.begin(), mid, values.end() );
+	return *mid;
+}
+
+// ----------------------------------------------------------------------
+// Encodes, then decodes the same stream `iterations` times, and writes one line
+// of JSON with median timings. The stream is re-used between iterations, just
+// as the backend re-uses command streams between frames.
+static uint64_t run_benchmark( benchmark_settings_t const& settings, encoding_t encoding, std::vector<mesh_t> const& meshes ) {
+
+	le_command_stream_t stream;
+	decoder_state_t     state{};
+
+	std::vector<uint64_t> encode_ns;
+	std::vector<uint64_t> decode_ns;
+	encode_ns.reserve( settings.iterations );
+	decode_ns.reserve( settings.iterations );
+
+	// One untimed iteration, so that the stream reaches its steady-state capacity.
+	encode_stream( &stream, encoding, meshes, settings.draws );
+	decode_stream( &stream, state );
+
+	for ( uint32_t i = 0; i != settings.iterations; i++ ) {
+		auto t0 = Clock::now();
+		encode_stream( &stream, encoding, meshes, settings.draws );
+		auto t1 = Clock::now();
+		decode_stream( &stream, state );
+		auto t2 = Clock::now();
+
+		encode_ns.push_back( uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>( t1 - t0 ).count() ) );
+		decode_ns.push_back( uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>( t2 - t1 ).count() ) );
+	}
+
+	uint64_t median_encode_ns = std::max<uint64_t>( 1, median_of( encode_ns ) );
+	uint64_t median_decode_ns = std::max<uint64_t>( 1, median_of( decode_ns ) );
+
+	// bytes per nanosecond equals gigabytes per second - we print megabytes per second.
+	double encode_mb_s = double( stream.size ) * 1000. / double( median_encode_ns );
+	double decode_mb_s = double( stream.size ) * 1000. / double( median_decode_ns );
+
+	printf( "{\"encoding\":\"%s\",\"draws\":%u,\"meshes\":%u,\"iterations\":%u,", encoding_name( encoding ), settings.draws, uint32_t( meshes.size() ), settings.iterations );
+	printf( "\"commands\":%zu,\"bytes\":%zu,\"segments\":%zu,", stream.cmd_count, stream.size, stream.segments.size() );
+	printf( "\"median_ns\":{\"encode\":%llu,\"decode\":%llu},", ( unsigned long long )median_encode_ns, ( unsigned long long )median_decode_ns );
+	printf( "\"mb_per_s\":{\"encode\":%.1f,\"decode\":%.1f},", encode_mb_s, decode_mb_s );
+	printf( "\"draws_per_us\":{\"encode\":%.1f,\"decode\":%.1f}}\n",
+	        double( settings.draws ) * 1000. / double( median_encode_ns ),
+	        double( settings.draws ) * 1000. / double( median_decode_ns ) );
+
+	return state.checksum;
+}
+
+// ----------------------------------------------------------------------
+
+static void print_usage() {
+	fprintf( stderr,
+	         "Usage: command_stream_benchmark [options]\n"
+	         "  --draws=<n>       number of draws per stream (default: 10000)\n"
+	         "  --meshes=<n>      number of distinct meshes (default: 100)\n"
+	         "  --iterations=<n>  number of timed iterations (default: 200)\n"
+	         "  --encoding=<name> one of: full, compact, both (default: both)\n" );
+}
+
+// ----------------------------------------------------------------------
+// Returns pointer to value if `arg` has the form `--<name>=<value>`, nullptr otherwise.
+static char const* arg_get_value( char const* arg, char const* name ) {
+	size_t name_len = strlen( name );
+	if ( strncmp( arg, "--", 2 ) == 0 &&
+	     strncmp( arg + 2, name, name_len ) == 0 &&
+	     arg[ 2 + name_len ] == '=' ) {
+		return arg + 2 + name_len + 1;
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------
+
+static bool parse_args( benchmark_settings_t& settings, int argc, char const* argv[] ) {
+
+	for ( int i = 1; i < argc; i++ ) {
+		char const* arg = argv[ i ];
+		char const* value;
+
+		if ( ( value = arg_get_value( arg, "draws" ) ) ) {
+			settings.draws = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "meshes" ) ) ) {
+			settings.meshes = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "iterations" ) ) ) {
+			settings.iterations = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "encoding" ) ) ) {
+			settings.run_full    = ( 0 == strcmp( value, "full" ) || 0 == strcmp( value, "both" ) );
+			settings.run_compact = ( 0 == strcmp( value, "compact" ) || 0 == strcmp( value, "both" ) );
+			if ( !settings.run_full && !settings.run_compact ) {
+				fprintf( stderr, "Unknown encoding: '%s'\n", value );
+				return false;
+			}
+		} else {
+			fprintf( stderr, "Unknown argument: '%s'\n", arg );
+			return false;
+		}
+	}
+
+	if ( settings.draws == 0 || settings.meshes == 0 || settings.iterations == 0 ) {
+		fprintf( stderr, "--draws, --meshes, and --iterations must be greater than 0\n" );
+		return false;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	benchmark_settings_t settings{};
+
+	if ( !parse_args( settings, argc, argv ) ) {
+		print_usage();
+		return 1;
+	}
+
+	// Buffer handles are opaque, and never dereferenced by the command stream -
+	// we use addresses of these placeholder objects as distinct handles.
+	std::vector<le_buf_resource_handle_t> buffer_objects( size_t( settings.meshes ) * 3 );
+	std::vector<mesh_t>                   meshes( settings.meshes );
+
+	for ( uint32_t i = 0; i != settings.meshes; i++ ) {
+		meshes[ i ] = {
+		    .vertex_buffers = { &buffer_objects[ i * 3 + 0 ], &buffer_objects[ i * 3 + 1 ] },
+		    .vertex_offsets = { 0, 0 },
+		    .index_buffer   = &buffer_objects[ i * 3 + 2 ],
+		    .index_count    = 36 + i,
+		};
+	}
+
+	uint64_t checksum_full    = 0;
+	uint64_t checksum_compact = 0;
+
+	if ( settings.run_full ) {
+		checksum_full = run_benchmark( settings, encoding_t::eFull, meshes );
+	}
+	if ( settings.run_compact ) {
+		checksum_compact = run_benchmark( settings, encoding_t::eCompact, meshes );
+	}
+
+	// Both encodings must decode to the same draws - if not, the compact encoding is broken.
+	if ( settings.run_full && settings.run_compact && checksum_full != checksum_compact ) {
+		fprintf( stderr, "Error: full and compact encoding decode to different draws\n" );
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include "renderer_benchmark_app/renderer_benchmark_app.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/*
+
+main.cpp works as a stub, just as it does for the examples - with one
+addition: it replaces global operator new and delete, so that we can
+count heap allocations made while the benchmark runs.
+
+Note that we only count allocations which go through C++ operator new;
+direct calls to malloc (by Vulkan drivers, for example) are not counted.
+
+*/
+
+static std::atomic<uint64_t> g_allocation_count{ 0 };
+
+static uint64_t get_allocation_count() {
+	return g_allocation_count.load( std::memory_order_relaxed );
+}
+
+// ----------------------------------------------------------------------
+
+void* operator new( std::size_t count ) {
+	g_allocation_count.fetch_add( 1, std::memory_order_relaxed );
+	if ( void* p = malloc( count ? count : 1 ) ) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[]( std::size_t count ) {
+	return operator new( count );
+}
+
+void* operator new( std::size_t count, std::nothrow_t const& ) noexcept {
+	g_allocation_count.fetch_add( 1, std::memory_order_relaxed );
+	return malloc( count ? count : 1 );
+}
+
+void* operator new[]( std::size_t count, std::nothrow_t const& tag ) noexcept {
+	return operator new( count, tag );
+}
+
+void operator delete( void* ptr ) noexcept {
+	free( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept {
+	free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t ) noexcept {
+	free( ptr );
+}
+
+void operator delete[]( void* ptr, std::size_t ) noexcept {
+	free( ptr );
+}
+
+// ----------------------------------------------------------------------
+
+int main( int argc, char const* argv[] ) {
+
+	RendererBenchmarkApp::initialize();
+
+	int exit_code = 0;
+
+	{
+		// We instantiate RendererBenchmarkApp in its own scope - so that
+		// it will be destroyed before RendererBenchmarkApp::terminate
+		// is called.
+
+		RendererBenchmarkApp RendererBenchmarkApp{ argc, argv, get_allocation_count };
+
+		for ( ;; ) {
+
+#ifdef PLUGINS_DYNAMIC
+			le_core_poll_for_module_reloads();
+#endif
+			auto result = RendererBenchmarkApp.update();
+
+			if ( !result ) {
+				break;
+			}
+		}
+
+		exit_code = RendererBenchmarkApp.getExitCode();
+	}
+
+	// Must only be called once last RendererBenchmarkApp is destroyed
+	RendererBenchmarkApp::terminate();
+
+	return exit_code;
+}
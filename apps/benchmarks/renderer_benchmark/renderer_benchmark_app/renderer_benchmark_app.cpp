@@ -0,0 +1,1014 @@
+#include "renderer_benchmark_app.h"
+
+#include "le_renderer.hpp"
+#include "le_backend_vk.h" // for le_pass_timing_t, le_barrier_stats_t
+#include "le_pipeline_builder.h"
+#include "le_camera.h"
+#include "le_stage.h"
+#include "le_gltf.h"
+#include "le_log.h"
+#include "le_tracy.h"
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE // vulkan clip space is from 0 to 1
+#define GLM_FORCE_RIGHT_HANDED      // glTF uses right handed coordinate system, and we're following its lead.
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+
+Headless renderer benchmark.
+
+Renders one of a set of scripted scenes into an image swapchain, for a
+fixed number of frames, and writes per-frame measurements as JSON lines:
+cpu time spent on each renderer update stage, heap allocations per
+update, pipeline barrier counts, and gpu time per renderpass.
+
+Each scene stresses one part of the renderer:
+
+    passes   - a chain of offscreen passes, each sampling the previous one
+    draws    - many small draws into a single pass
+    textures - many small textures, each sampled by its own draw
+    compute  - many dispatches over a storage buffer
+    gltf     - a glTF scene, rendered via le_stage (requires --gltf=<path>)
+
+See README.md for command line options, and for how to run on lavapipe.
+
+*/
+
+static constexpr char const* LOGGER_LABEL = "renderer_benchmark";
+
+enum class Scene : uint32_t {
+	ePasses = 0,
+	eDraws,
+	eTextures,
+	eCompute,
+	eGltf,
+};
+
+struct scene_info_t {
+	char const* name;
+	Scene       scene;
+	uint32_t    default_count; // default value for --count, meaning depends on scene
+};
+
+static constexpr scene_info_t SCENES[] = {
+    { "passes", Scene::ePasses, 32 },      // number of offscreen passes
+    { "draws", Scene::eDraws, 10000 },     // number of draws
+    { "textures", Scene::eTextures, 256 }, // number of textures
+    { "compute", Scene::eCompute, 256 },   // number of dispatches
+    { "gltf", Scene::eGltf, 1 },           // unused
+};
+
+static constexpr uint32_t   TEXTURE_SIZE       = 64;                          // width and height of textures for the textures scene
+static constexpr uint32_t   COMPUTE_NUM_VALUES = 64 * 1024;                   // number of vec4 elements in storage buffer for compute scene
+static constexpr uint32_t   MAX_DRAIN_FRAMES   = 16;                          // max number of extra frames to render while waiting for the last measurements
+static constexpr le::Format OFFSCREEN_FORMAT   = le::Format::eR8G8B8A8Unorm; // format for intermediary images of the passes scene
+
+struct benchmark_settings_t {
+	scene_info_t const* scene           = &SCENES[ 1 ];
+	uint32_t            count           = 0; // 0 means: use scene default
+	uint32_t            frames          = 300;
+	uint32_t            warmup          = 30;
+	uint32_t            width           = 1280;
+	uint32_t            height          = 720;
+	std::string         gltf_path       = "";
+	std::string         pipe_cmd        = ""; // if set, write images to pipe instead of discarding them
+	std::string         ring_path       = ""; // if set, write images to memory-mapped ring instead of discarding them
+	std::string         out_path        = ""; // if empty, write measurements to stdout
+	int64_t             max_allocations = -1; // if not negative, benchmark fails if any measured frame allocates more often than this
+};
+
+// Per-frame measurements which we keep around so that we can summarise them once the benchmark completes.
+struct frame_measurement_t {
+	le_renderer_frame_timings_t cpu;
+	uint64_t                    allocations;
+	uint64_t                    gpu_ns; // sum over gpu timings of all passes
+};
+
+// Parameters for the execute callback of a pass in the passes scene.
+struct chain_pass_params_t {
+	struct renderer_benchmark_app_o* app;
+	uint32_t                         index;
+};
+
+struct renderer_benchmark_app_o {
+	benchmark_settings_t settings;
+	bool                 is_valid     = false; // set once setup succeeded
+	bool                 check_failed = false; // set if measurements failed a check, such as --max-allocations
+
+	renderer_benchmark_app_api::pfn_get_allocation_count get_allocation_count = nullptr;
+
+	le::Renderer renderer;
+	FILE*        out = stdout;
+
+	uint64_t frame_counter     = 0; // number of frames recorded so far, equals the renderer's frame number of the next frame
+	uint64_t next_report_frame = 0; // frame number of the next frame for which we must collect measurements
+
+	std::vector<uint64_t>            allocations_per_frame; // indexed by frame number
+	std::vector<frame_measurement_t> measurements;          // one per reported frame
+	std::vector<le_pass_timing_t>    pass_timings;          // scratch space for collecting pass timings
+
+	le_img_resource_handle swapchain_image = nullptr;
+
+	// passes scene
+	std::vector<le_img_resource_handle> chain_images;
+	std::vector<le_texture_handle>      chain_textures;
+	std::vector<chain_pass_params_t>    chain_pass_params;
+
+	// textures scene
+	std::vector<le_img_resource_handle> images;
+	std::vector<le_texture_handle>      textures;
+	bool                                texturesUploaded = false;
+
+	// compute scene
+	le_buf_resource_handle compute_buffer           = nullptr;
+	bool                   computeBufferInitialised = false;
+
+	// gltf scene
+	LeCamera                    camera;
+	std::unique_ptr<LeStage>    stage;
+	le_stage_api::draw_params_t draw_params{};
+	le_img_resource_handle      depth_image = nullptr;
+};
+
+// We use this local typedef so spare us lots of typing
+typedef renderer_benchmark_app_o app_o;
+
+// Data as it is laid out in the push constant block of quad.vert
+struct QuadParams {
+	float rect[ 4 ]; // x, y, width, height in normalised device coordinates
+	float color[ 4 ];
+};
+
+// ----------------------------------------------------------------------
+
+static void app_initialize() {
+	LE_TRACY_ENABLE_LOG( -1 );
+};
+
+// ----------------------------------------------------------------------
+
+static void app_terminate() {
+};
+
+// ----------------------------------------------------------------------
+
+static void app_print_usage() {
+	printf( "Usage: renderer_benchmark [options]\n"
+	        "\n"
+	        "  --scene=<name>      one of: passes, draws, textures, compute, gltf (default: draws)\n"
+	        "  --count=<n>         scene size: number of passes, draws, textures, or dispatches\n"
+	        "  --frames=<n>        number of frames to measure (default: 300)\n"
+	        "  --warmup=<n>        number of frames to render before measuring (default: 30)\n"
+	        "  --width=<n>         swapchain width (default: 1280)\n"
+	        "  --height=<n>        swapchain height (default: 720)\n"
+	        "  --gltf=<path>       glTF file to render for scene gltf\n"
+	        "  --pipe-cmd=<cmd>    write rendered images to pipe, instead of discarding them\n"
+	        "  --ring-path=<path>  write rendered images to memory-mapped ring, instead of discarding them\n"
+	        "  --out=<path>        write measurements to file instead of stdout\n"
+	        "  --max-allocations=<n>  fail if any measured frame makes more than n heap allocations\n" );
+}
+
+// ----------------------------------------------------------------------
+// Returns pointer to value if `arg` has the form `--<name>=<value>`, nullptr otherwise.
+static char const* arg_get_value( char const* arg, char const* name ) {
+	size_t name_len = strlen( name );
+	if ( strncmp( arg, "--", 2 ) == 0 &&
+	     strncmp( arg + 2, name, name_len ) == 0 &&
+	     arg[ 2 + name_len ] == '=' ) {
+		return arg + 2 + name_len + 1;
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------
+
+static bool app_parse_args( benchmark_settings_t& settings, int argc, char const* argv[] ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	for ( int i = 1; i < argc; i++ ) {
+		char const* arg = argv[ i ];
+		char const* value;
+
+		if ( ( value = arg_get_value( arg, "scene" ) ) ) {
+			settings.scene = nullptr;
+			for ( auto const& s : SCENES ) {
+				if ( strcmp( s.name, value ) == 0 ) {
+					settings.scene = &s;
+				}
+			}
+			if ( settings.scene == nullptr ) {
+				logger.error( "Unknown scene: '%s'", value );
+				return false;
+			}
+		} else if ( ( value = arg_get_value( arg, "count" ) ) ) {
+			settings.count = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "frames" ) ) ) {
+			settings.frames = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "warmup" ) ) ) {
+			settings.warmup = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "width" ) ) ) {
+			settings.width = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "height" ) ) ) {
+			settings.height = uint32_t( strtoul( value, nullptr, 10 ) );
+		} else if ( ( value = arg_get_value( arg, "gltf" ) ) ) {
+			settings.gltf_path = value;
+		} else if ( ( value = arg_get_value( arg, "pipe-cmd" ) ) ) {
+			settings.pipe_cmd = value;
+		} else if ( ( value = arg_get_value( arg, "ring-path" ) ) ) {
+			settings.ring_path = value;
+		} else if ( ( value = arg_get_value( arg, "out" ) ) ) {
+			settings.out_path = value;
+		} else if ( ( value = arg_get_value( arg, "max-allocations" ) ) ) {
+			settings.max_allocations = int64_t( strtoull( value, nullptr, 10 ) );
+		} else {
+			logger.error( "Unknown argument: '%s'", arg );
+			return false;
+		}
+	}
+
+	if ( settings.count == 0 ) {
+		settings.count = settings.scene->default_count;
+	}
+
+	if ( settings.scene->scene == Scene::eGltf && settings.gltf_path.empty() ) {
+		logger.error( "Scene 'gltf' requires a path to a glTF file: --gltf=<path>" );
+		return false;
+	}
+
+	if ( settings.frames == 0 || settings.width == 0 || settings.height == 0 ) {
+		logger.error( "Number of frames, width, and height must not be zero." );
+		return false;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+static bool app_setup_scene( app_o* self ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	uint32_t const count = self->settings.count;
+	char           name[ 64 ];
+
+	switch ( self->settings.scene->scene ) {
+	case Scene::ePasses:
+		self->chain_images.reserve( count );
+		self->chain_textures.reserve( count );
+		self->chain_pass_params.reserve( count + 1 );
+		for ( uint32_t i = 0; i != count; i++ ) {
+			snprintf( name, sizeof( name ), "bench_chain_img_%u", i );
+			self->chain_images.push_back( le::Renderer::produceImageHandle( name ) );
+			snprintf( name, sizeof( name ), "bench_chain_tex_%u", i );
+			self->chain_textures.push_back( le::Renderer::produceTextureHandle( name ) );
+		}
+		// One more set of params than there are images - for the final pass into the swapchain image.
+		for ( uint32_t i = 0; i != count + 1; i++ ) {
+			self->chain_pass_params.push_back( { self, i } );
+		}
+		break;
+	case Scene::eTextures:
+		self->images.reserve( count );
+		self->textures.reserve( count );
+		for ( uint32_t i = 0; i != count; i++ ) {
+			snprintf( name, sizeof( name ), "bench_img_%u", i );
+			self->images.push_back( le::Renderer::produceImageHandle( name ) );
+			snprintf( name, sizeof( name ), "bench_tex_%u", i );
+			self->textures.push_back( le::Renderer::produceTextureHandle( name ) );
+		}
+		break;
+	case Scene::eCompute:
+		self->compute_buffer = le::Renderer::produceBufferHandle( "bench_compute_data" );
+		break;
+	case Scene::eGltf: {
+		self->stage       = std::make_unique<LeStage>( self->renderer );
+		self->depth_image = le::Renderer::produceImageHandle( "bench_depth" );
+
+		LeGltf gltf( self->settings.gltf_path.c_str() );
+
+		if ( !gltf.import( *self->stage ) ) {
+			logger.error( "Could not import glTF file: '%s'", self->settings.gltf_path.c_str() );
+			return false;
+		}
+
+		le_stage::le_stage_i.setup_pipelines( *self->stage );
+
+		self->camera.setViewport( { 0, 0, float( self->settings.width ), float( self->settings.height ), 0.f, 1.f } );
+		self->camera.setFovRadians( glm::radians( 60.f ) ); // glm::radians converts degrees to radians
+		glm::mat4 camMatrix = glm::lookAt( glm::vec3{ 0, 0, self->camera.getUnitDistance() }, glm::vec3{ 0 }, glm::vec3{ 0, 1, 0 } );
+		self->camera.setViewMatrix( ( float* )( &camMatrix ) );
+
+		self->draw_params = { *self->stage, self->camera };
+	} break;
+	case Scene::eDraws:
+		break;
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+static app_o* app_create( int argc, char const* argv[], renderer_benchmark_app_api::pfn_get_allocation_count get_allocation_count ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	auto app = new ( app_o );
+
+	app->get_allocation_count = get_allocation_count;
+
+	if ( !app_parse_args( app->settings, argc, argv ) ) {
+		app_print_usage();
+		return app;
+	}
+
+	// Validation layers would dominate any measurements.
+	LE_SETTING( const bool, LE_SETTING_SHOULD_USE_VALIDATION_LAYERS, false );
+
+	if ( !app->settings.out_path.empty() ) {
+		app->out = fopen( app->settings.out_path.c_str(), "w" );
+		if ( app->out == nullptr ) {
+			logger.error( "Could not open output file: '%s'", app->settings.out_path.c_str() );
+			app->out = stdout;
+			return app;
+		}
+	}
+
+	// We render into an image swapchain, so that we don't need a window. Unless
+	// asked to write images somewhere, images get read back, but then discarded.
+
+	le::RendererInfoBuilder renderer_info;
+
+	auto& img_swapchain_info =
+	    renderer_info
+	        .addSwapchain()
+	        .setWidthHint( app->settings.width )
+	        .setHeightHint( app->settings.height )
+	        .asImgSwapchain();
+
+	if ( !app->settings.ring_path.empty() ) {
+		img_swapchain_info.setRingPath( app->settings.ring_path.c_str() );
+	} else if ( !app->settings.pipe_cmd.empty() ) {
+		img_swapchain_info.setPipeCmd( app->settings.pipe_cmd.c_str() );
+	} else {
+		img_swapchain_info.setNullOutput();
+	}
+
+	img_swapchain_info.end().end();
+
+	app->renderer.setup( renderer_info.build() );
+
+	app->swapchain_image = app->renderer.getSwapchainResource();
+
+	if ( !app_setup_scene( app ) ) {
+		return app;
+	}
+
+	uint64_t const total_frames = uint64_t( app->settings.warmup ) + app->settings.frames;
+
+	app->allocations_per_frame.resize( total_frames, 0 );
+	app->measurements.reserve( app->settings.frames );
+
+	app->is_valid = true;
+
+	return app;
+}
+
+// ----------------------------------------------------------------------
+// Pipeline for quads drawn via quad.vert, with either a flat color, or a texture.
+static le_gpso_handle get_quad_pipeline( le_pipeline_manager_o* pipeline_manager, bool textured ) {
+
+	static auto pipelineQuadColor =
+	    LeGraphicsPipelineBuilder( pipeline_manager )
+	        .addShaderStage(
+	            LeShaderModuleBuilder( pipeline_manager )
+	                .setShaderStage( le::ShaderStage::eVertex )
+	                .setSourceFilePath( "./local_resources/shaders/quad.vert" )
+	                .build() )
+	        .addShaderStage(
+	            LeShaderModuleBuilder( pipeline_manager )
+	                .setShaderStage( le::ShaderStage::eFragment )
+	                .setSourceFilePath( "./local_resources/shaders/color.frag" )
+	                .build() )
+	        .build();
+
+	static auto pipelineQuadTextured =
+	    LeGraphicsPipelineBuilder( pipeline_manager )
+	        .addShaderStage(
+	            LeShaderModuleBuilder( pipeline_manager )
+	                .setShaderStage( le::ShaderStage::eVertex )
+	                .setSourceFilePath( "./local_resources/shaders/quad.vert" )
+	                .build() )
+	        .addShaderStage(
+	            LeShaderModuleBuilder( pipeline_manager )
+	                .setShaderStage( le::ShaderStage::eFragment )
+	                .setSourceFilePath( "./local_resources/shaders/textured.frag" )
+	                .build() )
+	        .build();
+
+	return textured ? pipelineQuadTextured : pipelineQuadColor;
+}
+
+// ----------------------------------------------------------------------
+// Places quad `index` out of `count` quads on a regular grid covering the render area.
+static void quad_params_for_index( QuadParams& params, uint32_t index, uint32_t count ) {
+	uint32_t cols = 1;
+	while ( cols * cols < count ) {
+		cols++;
+	}
+	float const cell = 2.f / float( cols );
+	params.rect[ 0 ] = -1.f + cell * float( index % cols );
+	params.rect[ 1 ] = -1.f + cell * float( index / cols );
+	params.rect[ 2 ] = cell * 0.9f;
+	params.rect[ 3 ] = cell * 0.9f;
+
+	params.color[ 0 ] = float( index % 7 ) / 6.f;
+	params.color[ 1 ] = float( index % 11 ) / 10.f;
+	params.color[ 2 ] = float( index % 13 ) / 12.f;
+	params.color[ 3 ] = 1.f;
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_chain_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto params = static_cast<chain_pass_params_t*>( user_data );
+	auto app    = params->app;
+
+	le::GraphicsEncoder encoder{ encoder_ };
+
+	if ( params->index == 0 ) {
+		// First pass in the chain has nothing to sample - fill it with a quad.
+		QuadParams quad{ { -1.f, -1.f, 2.f, 2.f }, { 1.f, 0.5f, 0.25f, 1.f } };
+		encoder
+		    .bindGraphicsPipeline( get_quad_pipeline( encoder.getPipelineManager(), false ) )
+		    .setPushConstantData( &quad, sizeof( QuadParams ) )
+		    .draw( 6 );
+		return;
+	}
+
+	// ----------| invariant: there is a previous pass, sample its image.
+
+	static auto pipelineBlit =
+	    LeGraphicsPipelineBuilder( encoder.getPipelineManager() )
+	        .addShaderStage(
+	            LeShaderModuleBuilder( encoder.getPipelineManager() )
+	                .setShaderStage( le::ShaderStage::eVertex )
+	                .setSourceFilePath( "./local_resources/shaders/fullscreen.vert" )
+	                .build() )
+	        .addShaderStage(
+	            LeShaderModuleBuilder( encoder.getPipelineManager() )
+	                .setShaderStage( le::ShaderStage::eFragment )
+	                .setSourceFilePath( "./local_resources/shaders/blit.frag" )
+	                .build() )
+	        .build();
+
+	float tint[ 4 ] = { 0.99f, 0.99f, 0.99f, 1.f };
+
+	encoder
+	    .bindGraphicsPipeline( pipelineBlit )
+	    .setArgumentTexture( LE_ARGUMENT_NAME( "src_tex_unit_0" ), app->chain_textures[ params->index - 1 ] )
+	    .setArgumentData( LE_ARGUMENT_NAME( "Params" ), tint, sizeof( tint ) )
+	    .draw( 3 );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_record_passes_scene( app_o* self, le::RenderGraph& graph ) {
+
+	uint32_t const count = self->settings.count;
+	char           pass_name[ 64 ];
+
+	le_resource_info_t const offscreen_info =
+	    le::ImageInfoBuilder()
+	        .setFormat( OFFSCREEN_FORMAT )
+	        .setExtent( self->settings.width, self->settings.height )
+	        .addUsageFlags( le::ImageUsageFlags( le::ImageUsageFlagBits::eColorAttachment | le::ImageUsageFlagBits::eSampled ) )
+	        .build();
+
+	for ( uint32_t i = 0; i != count + 1; i++ ) {
+
+		bool const is_last = ( i == count );
+
+		// Pass names must be unique, as a pass is identified by the hash of its name.
+		snprintf( pass_name, sizeof( pass_name ), "chain_%u", i );
+
+		le::RenderPass pass( pass_name );
+
+		pass
+		    .addColorAttachment( is_last ? self->swapchain_image : self->chain_images[ i ] )
+		    .setExecuteCallback( &self->chain_pass_params[ i ], pass_chain_exec );
+
+		if ( i > 0 ) {
+			pass.sampleTexture( self->chain_textures[ i - 1 ], self->chain_images[ i - 1 ] );
+		}
+
+		graph.addRenderPass( pass );
+
+		if ( !is_last ) {
+			graph.declareResource( self->chain_images[ i ], offscreen_info );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_draws_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::GraphicsEncoder encoder{ encoder_ };
+
+	uint32_t const count = app->settings.count;
+
+	encoder.bindGraphicsPipeline( get_quad_pipeline( encoder.getPipelineManager(), false ) );
+
+	QuadParams quad;
+
+	for ( uint32_t i = 0; i != count; i++ ) {
+		quad_params_for_index( quad, i, count );
+		encoder
+		    .setPushConstantData( &quad, sizeof( QuadParams ) )
+		    .draw( 6 );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void app_record_draws_scene( app_o* self, le::RenderGraph& graph ) {
+
+	auto passDraws =
+	    le::RenderPass( "draws" )
+	        .addColorAttachment( self->swapchain_image )
+	        .setExecuteCallback( self, pass_draws_exec );
+
+	graph.addRenderPass( passDraws );
+}
+
+// ----------------------------------------------------------------------
+
+static bool pass_upload_textures_setup( le_renderpass_o* pRp, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::RenderPass rp( pRp );
+
+	for ( auto const& img : app->images ) {
+		rp.useImageResource( img, le::AccessFlagBits2::eTransferWrite );
+	}
+
+	// Textures only need to be uploaded once.
+	if ( app->texturesUploaded ) {
+		return false;
+	} else {
+		app->texturesUploaded = true;
+		return true;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_upload_textures_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::TransferEncoder encoder{ encoder_ };
+
+	std::vector<uint32_t> pixels( TEXTURE_SIZE * TEXTURE_SIZE );
+
+	le_write_to_image_settings_t const write_info =
+	    le::WriteToImageSettingsBuilder()
+	        .setImageW( TEXTURE_SIZE )
+	        .setImageH( TEXTURE_SIZE )
+	        .build();
+
+	for ( uint32_t i = 0; i != app->images.size(); i++ ) {
+
+		// Checkerboard pattern, with a different color for each texture.
+		uint32_t const color = 0xff000000 | ( ( i * 2654435761u ) & 0x00ffffff );
+
+		for ( uint32_t y = 0; y != TEXTURE_SIZE; y++ ) {
+			for ( uint32_t x = 0; x != TEXTURE_SIZE; x++ ) {
+				pixels[ y * TEXTURE_SIZE + x ] = ( ( x / 8 + y / 8 ) & 1 ) ? color : 0xffffffff;
+			}
+		}
+
+		encoder.writeToImage( app->images[ i ], write_info, pixels.data(), pixels.size() * sizeof( uint32_t ) );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_textures_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::GraphicsEncoder encoder{ encoder_ };
+
+	uint32_t const count = uint32_t( app->textures.size() );
+
+	encoder.bindGraphicsPipeline( get_quad_pipeline( encoder.getPipelineManager(), true ) );
+
+	QuadParams quad;
+
+	for ( uint32_t i = 0; i != count; i++ ) {
+		quad_params_for_index( quad, i, count );
+		encoder
+		    .setArgumentTexture( LE_ARGUMENT_NAME( "tex_unit_0" ), app->textures[ i ] )
+		    .setPushConstantData( &quad, sizeof( QuadParams ) )
+		    .draw( 6 );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void app_record_textures_scene( app_o* self, le::RenderGraph& graph ) {
+
+	le_resource_info_t const texture_info =
+	    le::ImageInfoBuilder()
+	        .setFormat( le::Format::eR8G8B8A8Unorm )
+	        .setExtent( TEXTURE_SIZE, TEXTURE_SIZE )
+	        .addUsageFlags( le::ImageUsageFlags( le::ImageUsageFlagBits::eSampled | le::ImageUsageFlagBits::eTransferDst ) )
+	        .build();
+
+	auto passUpload =
+	    le::RenderPass( "upload_textures", le::QueueFlagBits::eTransfer )
+	        .setSetupCallback( self, pass_upload_textures_setup )
+	        .setExecuteCallback( self, pass_upload_textures_exec );
+
+	auto passDraw =
+	    le::RenderPass( "textures" )
+	        .addColorAttachment( self->swapchain_image )
+	        .setExecuteCallback( self, pass_textures_exec );
+
+	for ( size_t i = 0; i != self->images.size(); i++ ) {
+		passDraw.sampleTexture( self->textures[ i ], self->images[ i ] );
+		graph.declareResource( self->images[ i ], texture_info );
+	}
+
+	graph
+	    .addRenderPass( passUpload )
+	    .addRenderPass( passDraw );
+}
+
+// ----------------------------------------------------------------------
+
+static bool pass_init_compute_setup( le_renderpass_o* pRp, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::RenderPass( pRp ).useBufferResource( app->compute_buffer, le::AccessFlagBits2::eTransferWrite );
+
+	// Buffer only needs to be initialised once.
+	if ( app->computeBufferInitialised ) {
+		return false;
+	} else {
+		app->computeBufferInitialised = true;
+		return true;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_init_compute_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::TransferEncoder encoder{ encoder_ };
+
+	std::vector<float> values( size_t( COMPUTE_NUM_VALUES ) * 4 );
+
+	for ( size_t i = 0; i != values.size(); i++ ) {
+		values[ i ] = float( i % 1024 ) / 1024.f;
+	}
+
+	encoder.writeToBuffer( app->compute_buffer, 0, values.data(), values.size() * sizeof( float ) );
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_compute_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto app = static_cast<app_o*>( user_data );
+
+	le::ComputeEncoder encoder{ encoder_ };
+
+	static auto psoCompute =
+	    LeComputePipelineBuilder( encoder.getPipelineManager() )
+	        .setShaderStage(
+	            LeShaderModuleBuilder( encoder.getPipelineManager() )
+	                .setShaderStage( le::ShaderStage::eCompute )
+	                .setSourceFilePath( "./local_resources/shaders/compute.glsl" )
+	                .build() )
+	        .build();
+
+	struct Uniforms {
+		uint32_t num_values;
+		uint32_t iteration;
+	};
+
+	uint32_t const count = app->settings.count;
+
+	encoder.bindComputePipeline( psoCompute );
+
+	for ( uint32_t i = 0; i != count; i++ ) {
+
+		Uniforms uniforms{ COMPUTE_NUM_VALUES, i };
+
+		encoder
+		    .bindArgumentBuffer( LE_ARGUMENT_NAME( "DataBuf" ), app->compute_buffer )
+		    .setArgumentData( LE_ARGUMENT_NAME( "Uniforms" ), &uniforms, sizeof( Uniforms ) )
+		    .dispatch( ( COMPUTE_NUM_VALUES + 63 ) / 64, 1, 1 );
+
+		// Each dispatch reads what the previous dispatch wrote - buffers are not
+		// synchronised automatically within a pass, so we must issue a barrier.
+		encoder.bufferMemoryBarrier(
+		    le::PipelineStageFlags2( le::PipelineStageFlagBits2::eComputeShader ),
+		    le::PipelineStageFlags2( le::PipelineStageFlagBits2::eComputeShader ),
+		    le::AccessFlagBits2::eShaderStorageRead | le::AccessFlagBits2::eShaderStorageWrite,
+		    app->compute_buffer );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_compute_present_exec( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	le::GraphicsEncoder encoder{ encoder_ };
+
+	QuadParams quad{ { -0.5f, -0.5f, 1.f, 1.f }, { 0.25f, 0.5f, 1.f, 1.f } };
+
+	encoder
+	    .bindGraphicsPipeline( get_quad_pipeline( encoder.getPipelineManager(), false ) )
+	    .setPushConstantData( &quad, sizeof( QuadParams ) )
+	    .draw( 6 );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_record_compute_scene( app_o* self, le::RenderGraph& graph ) {
+
+	auto passInit =
+	    le::RenderPass( "init_compute", le::QueueFlagBits::eTransfer )
+	        .setSetupCallback( self, pass_init_compute_setup )
+	        .setExecuteCallback( self, pass_init_compute_exec );
+
+	auto passCompute =
+	    le::RenderPass( "compute", le::QueueFlagBits::eCompute )
+	        .useBufferResource( self->compute_buffer, le::AccessFlagBits2::eShaderStorageRead, le::AccessFlagBits2::eShaderStorageWrite )
+	        .setExecuteCallback( self, pass_compute_exec );
+
+	// Compute passes only get executed if they contribute to the swapchain image -
+	// this pass connects the compute pass to the swapchain image.
+	auto passPresent =
+	    le::RenderPass( "compute_present" )
+	        .addColorAttachment( self->swapchain_image )
+	        .useBufferResource( self->compute_buffer, le::AccessFlagBits2::eShaderStorageRead )
+	        .setExecuteCallback( self, pass_compute_present_exec );
+
+	graph
+	    .addRenderPass( passInit )
+	    .addRenderPass( passCompute )
+	    .addRenderPass( passPresent )
+	    .declareResource(
+	        self->compute_buffer,
+	        le::BufferInfoBuilder()
+	            .setSize( uint64_t( COMPUTE_NUM_VALUES ) * 4 * sizeof( float ) )
+	            .addUsageFlags( le::BufferUsageFlagBits::eStorageBuffer | le::BufferUsageFlagBits::eTransferDst )
+	            .build() );
+}
+
+// ----------------------------------------------------------------------
+
+static void app_record_gltf_scene( app_o* self, le::RenderGraph& graph ) {
+
+	self->stage->update();
+
+	le_stage::le_stage_i.update_rendermodule( *self->stage, graph );
+	le_stage::le_stage_i.draw_into_module( &self->draw_params, graph, self->swapchain_image, self->depth_image );
+
+	graph.declareResource( self->depth_image, le::ImageInfoBuilder().addUsageFlags( le::ImageUsageFlags( le::ImageUsageFlagBits::eDepthStencilAttachment ) ).build() );
+}
+
+// ----------------------------------------------------------------------
+// Writes `str` as a JSON string, including quotes.
+static void json_write_string( FILE* out, char const* str ) {
+	fputc( '"', out );
+	for ( char const* c = str; *c; c++ ) {
+		if ( *c == '"' || *c == '\\' ) {
+			fputc( '\\', out );
+			fputc( *c, out );
+		} else if ( uint8_t( *c ) < 0x20 ) {
+			fprintf( out, "\\u%04x", uint32_t( uint8_t( *c ) ) );
+		} else {
+			fputc( *c, out );
+		}
+	}
+	fputc( '"', out );
+}
+
+// ----------------------------------------------------------------------
+// Writes measurements for one frame as a single line of JSON.
+static void app_report_frame( app_o* self, uint64_t frame_number, le_renderer_frame_timings_t const& cpu ) {
+
+	le_barrier_stats_t barrier_stats{};
+	self->renderer.getBarrierStats( frame_number, &barrier_stats );
+
+	uint32_t num_timings = 0;
+	self->renderer.getPassTimings( frame_number, nullptr, &num_timings );
+	self->pass_timings.resize( num_timings );
+	if ( num_timings && !self->renderer.getPassTimings( frame_number, self->pass_timings.data(), &num_timings ) ) {
+		num_timings = 0;
+	}
+
+	frame_measurement_t measurement{};
+	measurement.cpu         = cpu;
+	measurement.allocations = self->allocations_per_frame[ frame_number ];
+
+	FILE* out = self->out;
+
+	fprintf( out, "{\"scene\":\"%s\",\"count\":%u,\"frame\":%llu,", self->settings.scene->name, self->settings.count, ( unsigned long long )frame_number );
+	fprintf( out, "\"cpu_ns\":{\"record\":%llu,\"acquire\":%llu,\"process\":%llu,\"dispatch\":%llu,\"fence_wait\":%llu,\"clear\":%llu},",
+	         ( unsigned long long )cpu.record_ns, ( unsigned long long )cpu.acquire_ns, ( unsigned long long )cpu.process_ns,
+	         ( unsigned long long )cpu.dispatch_ns, ( unsigned long long )cpu.fence_wait_ns, ( unsigned long long )cpu.clear_ns );
+	fprintf( out, "\"allocations\":%llu,", ( unsigned long long )measurement.allocations );
+	fprintf( out, "\"barriers\":{\"emitted\":%u,\"elided\":%u,\"batches\":%u},",
+	         barrier_stats.barriers_emitted, barrier_stats.barriers_elided, barrier_stats.barrier_batches );
+	fprintf( out, "\"gpu_ns\":[" );
+	for ( uint32_t i = 0; i != num_timings; i++ ) {
+		fprintf( out, i ? ",{\"pass\":" : "{\"pass\":" );
+		json_write_string( out, self->pass_timings[ i ].debug_name );
+		fprintf( out, ",\"ns\":%llu}", ( unsigned long long )self->pass_timings[ i ].gpu_duration_ns );
+		measurement.gpu_ns += self->pass_timings[ i ].gpu_duration_ns;
+	}
+	fprintf( out, "]}\n" );
+
+	self->measurements.push_back( measurement );
+}
+
+// ----------------------------------------------------------------------
+// Collects measurements for all frames which have completed since the last call.
+static void app_collect_measurements( app_o* self ) {
+
+	uint64_t const total_frames = self->allocations_per_frame.size();
+
+	le_renderer_frame_timings_t cpu;
+
+	while ( self->next_report_frame < std::min( self->frame_counter, total_frames ) &&
+	        self->renderer.getFrameTimings( self->next_report_frame, &cpu ) ) {
+		if ( self->next_report_frame >= self->settings.warmup ) {
+			app_report_frame( self, self->next_report_frame, cpu );
+		}
+		self->next_report_frame++;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+template <typename T>
+static T median_of( std::vector<T>& values ) {
+	if ( values.empty() ) {
+		return T{};
+	}
+	auto mid = values.begin() + values.size() / 2;
+	std::nth_element( values.begin(), mid, values.end() );
+	return *mid;
+}
+
+// ----------------------------------------------------------------------
+// Writes a single line of JSON with medians over all measured frames.
+static void app_report_summary( app_o* self ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	size_t const n = self->measurements.size();
+
+	std::vector<uint64_t> record( n ), acquire( n ), process( n ), dispatch( n ), cpu_total( n ), allocations( n ), gpu( n );
+
+	uint64_t max_allocations = 0;
+
+	for ( size_t i = 0; i != n; i++ ) {
+		auto const& m    = self->measurements[ i ];
+		record[ i ]      = m.cpu.record_ns;
+		acquire[ i ]     = m.cpu.acquire_ns;
+		process[ i ]     = m.cpu.process_ns;
+		dispatch[ i ]    = m.cpu.dispatch_ns;
+		cpu_total[ i ]   = m.cpu.record_ns + m.cpu.acquire_ns + m.cpu.process_ns + m.cpu.dispatch_ns + m.cpu.clear_ns;
+		allocations[ i ] = m.allocations;
+		gpu[ i ]         = m.gpu_ns;
+		max_allocations  = std::max( max_allocations, m.allocations );
+	}
+
+	if ( self->settings.max_allocations >= 0 && max_allocations > uint64_t( self->settings.max_allocations ) ) {
+		logger.error( "Allocation check failed: a measured frame made %llu heap allocations, limit is %lld.",
+		              ( unsigned long long )max_allocations, ( long long )self->settings.max_allocations );
+		self->check_failed = true;
+	}
+
+	fprintf( self->out, "{\"scene\":\"%s\",\"count\":%u,\"summary\":{\"frames\":%llu,", self->settings.scene->name, self->settings.count, ( unsigned long long )n );
+	fprintf( self->out, "\"median_cpu_ns\":{\"record\":%llu,\"acquire\":%llu,\"process\":%llu,\"dispatch\":%llu,\"total\":%llu},",
+	         ( unsigned long long )median_of( record ), ( unsigned long long )median_of( acquire ), ( unsigned long long )median_of( process ),
+	         ( unsigned long long )median_of( dispatch ), ( unsigned long long )median_of( cpu_total ) );
+	fprintf( self->out, "\"median_allocations\":%llu,\"max_allocations\":%llu,\"median_gpu_ns\":%llu}}\n",
+	         ( unsigned long long )median_of( allocations ), ( unsigned long long )max_allocations, ( unsigned long long )median_of( gpu ) );
+
+	fflush( self->out );
+}
+
+// ----------------------------------------------------------------------
+
+static bool app_update( app_o* self ) {
+	ZoneScoped;
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	if ( !self->is_valid ) {
+		return false;
+	}
+
+	// ----------| invariant: benchmark was set up successfully
+
+	uint64_t const total_frames = self->allocations_per_frame.size();
+
+	if ( self->next_report_frame >= total_frames ) {
+		app_report_summary( self );
+		return false;
+	}
+
+	if ( self->frame_counter >= total_frames + MAX_DRAIN_FRAMES ) {
+		logger.warn( "Measurements missing for frames from frame %llu onwards.", ( unsigned long long )self->next_report_frame );
+		app_report_summary( self );
+		return false;
+	}
+
+	// ----------| invariant: there are frames left to render, or to collect measurements for.
+	//
+	// Once all measured frames have been recorded, we keep rendering for as long
+	// as it takes for the last measured frames to complete.
+
+	uint64_t const allocations_before = self->get_allocation_count ? self->get_allocation_count() : 0;
+
+	{
+		le::RenderGraph renderGraph{};
+
+		switch ( self->settings.scene->scene ) {
+		case Scene::ePasses:
+			app_record_passes_scene( self, renderGraph );
+			break;
+		case Scene::eDraws:
+			app_record_draws_scene( self, renderGraph );
+			break;
+		case Scene::eTextures:
+			app_record_textures_scene( self, renderGraph );
+			break;
+		case Scene::eCompute:
+			app_record_compute_scene( self, renderGraph );
+			break;
+		case Scene::eGltf:
+			app_record_gltf_scene( self, renderGraph );
+			break;
+		}
+
+		self->renderer.update( renderGraph );
+	}
+
+	if ( self->frame_counter < total_frames && self->get_allocation_count ) {
+		// Note that this counts all allocations during this update: we record this frame,
+		// but we also process, dispatch, and clear earlier frames.
+		self->allocations_per_frame[ self->frame_counter ] = self->get_allocation_count() - allocations_before;
+	}
+
+	self->frame_counter++;
+
+	app_collect_measurements( self );
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Returns non-zero if the benchmark could not be set up, or if measurements failed a check.
+static int app_get_exit_code( app_o* self ) {
+	return ( !self->is_valid || self->check_failed ) ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------
+
+static void app_destroy( app_o* self ) {
+	if ( self->out && self->out != stdout ) {
+		fclose( self->out );
+	}
+	delete ( self );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( renderer_benchmark_app, api ) {
+	auto  renderer_benchmark_app_api_i = static_cast<renderer_benchmark_app_api*>( api );
+	auto& renderer_benchmark_app_i     = renderer_benchmark_app_api_i->renderer_benchmark_app_i;
+
+	renderer_benchmark_app_i.initialize = app_initialize;
+	renderer_benchmark_app_i.terminate  = app_terminate;
+
+	renderer_benchmark_app_i.create  = app_create;
+	renderer_benchmark_app_i.destroy = app_destroy;
+	renderer_benchmark_app_i.update  = app_update;
+
+	renderer_benchmark_app_i.get_exit_code = app_get_exit_code;
+}
@@ -0,0 +1,69 @@
+#ifndef GUARD_renderer_benchmark_app_H
+#define GUARD_renderer_benchmark_app_H
+#endif
+
+#include "le_core.h"
+
+// depends on le_backend_vk. le_backend_vk must be loaded before this class is used.
+
+struct renderer_benchmark_app_o;
+
+// clang-format off
+struct renderer_benchmark_app_api {
+
+	typedef uint64_t ( *pfn_get_allocation_count )(); // total number of heap allocations since program start
+
+	struct renderer_benchmark_app_interface_t {
+		renderer_benchmark_app_o * ( *create   )( int argc, char const* argv[], pfn_get_allocation_count get_allocation_count );
+		void         ( *destroy                  )( renderer_benchmark_app_o *self );
+		bool         ( *update                   )( renderer_benchmark_app_o *self );
+		int          ( *get_exit_code            )( renderer_benchmark_app_o *self ); // non-zero if setup failed, or if a check such as --max-allocations failed
+		void         ( *initialize               )(); // static methods
+		void         ( *terminate                )(); // static methods
+	};
+
+	renderer_benchmark_app_interface_t renderer_benchmark_app_i;
+};
+// clang-format on
+
+LE_MODULE( renderer_benchmark_app );
+LE_MODULE_LOAD_DEFAULT( renderer_benchmark_app );
+
+#ifdef __cplusplus
+
+namespace renderer_benchmark_app {
+static const auto& api                      = renderer_benchmark_app_api_i;
+static const auto& renderer_benchmark_app_i = api -> renderer_benchmark_app_i;
+} // namespace renderer_benchmark_app
+
+class RendererBenchmarkApp : NoCopy, NoMove {
+
+	renderer_benchmark_app_o* self;
+
+  public:
+	RendererBenchmarkApp( int argc, char const* argv[], renderer_benchmark_app_api::pfn_get_allocation_count get_allocation_count )
+	    : self( renderer_benchmark_app::renderer_benchmark_app_i.create( argc, argv, get_allocation_count ) ) {
+	}
+
+	bool update() {
+		return renderer_benchmark_app::renderer_benchmark_app_i.update( self );
+	}
+
+	int getExitCode() {
+		return renderer_benchmark_app::renderer_benchmark_app_i.get_exit_code( self );
+	}
+
+	~RendererBenchmarkApp() {
+		renderer_benchmark_app::renderer_benchmark_app_i.destroy( self );
+	}
+
+	static void initialize() {
+		renderer_benchmark_app::renderer_benchmark_app_i.initialize();
+	}
+
+	static void terminate() {
+		renderer_benchmark_app::renderer_benchmark_app_i.terminate();
+	}
+};
+
+#endif
@@ -0,0 +1,15 @@
+#version 450 core
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+// vertex shader inputs
+layout (location = 0) in vec2 inTexCoord;
+layout (location = 1) in vec4 inColor;
+
+// outputs
+layout (location = 0) out vec4 outFragColor;
+
+void main(){
+	outFragColor = inColor;
+}
@@ -0,0 +1,35 @@
+#version 450
+
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+// Binding 0 : storage buffer which each dispatch reads, and writes back to
+layout(std430, set = 0, binding = 0) buffer DataBuf 
+{
+   vec4 values[ ];
+};
+
+// arguments
+layout (set = 0, binding = 1) uniform Uniforms 
+{
+	uint num_values;
+	uint iteration;
+};
+
+void main(){
+
+	uint index = gl_GlobalInvocationID.x; 
+
+	if ( index >= num_values ) {
+		return;
+	}
+
+	// Some arithmetic, so that dispatches are not entirely bandwidth-bound.
+
+	vec4 v = values[ index ];
+
+	for ( int i = 0; i != 16; i++ ) {
+		v = fract( v * 1.0001f + vec4( float( iteration ) * 0.001f ) );
+	}
+
+	values[ index ] = v;
+}
@@ -0,0 +1,25 @@
+#version 450 core
+
+// This shader built after a technique introduced in:
+// http://www.saschawillems.de/?page_id=2122
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+// inputs // Note: no inputs!
+
+// outputs 
+layout (location = 0) out vec2 outTexCoord;
+
+// Override the built-in fixed function outputs
+// to have more control over the SPIR-V code created.
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+void main() 
+{
+	outTexCoord = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+	gl_Position = vec4(outTexCoord * 2.0f + -1.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,35 @@
+#version 450 core
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+// Draws an axis-aligned quad from six vertices - no vertex buffers needed.
+// Quad rectangle and color are given via push constants.
+
+// arguments (via push constants)
+layout (push_constant) uniform Params {
+	vec4 rect;  // x, y, width, height in normalised device coordinates
+	vec4 color;
+};
+
+// outputs
+layout (location = 0) out vec2 outTexCoord;
+layout (location = 1) out vec4 outColor;
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+const vec2 corners[6] = vec2[](
+	vec2(0, 0), vec2(1, 0), vec2(0, 1),
+	vec2(0, 1), vec2(1, 0), vec2(1, 1)
+);
+
+void main() 
+{
+	vec2 corner = corners[gl_VertexIndex % 6];
+	outTexCoord = corner;
+	outColor    = color;
+	gl_Position = vec4(rect.xy + corner * rect.zw, 0.0f, 1.0f);
+}
@@ -0,0 +1,18 @@
+#version 450 core
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+// vertex shader inputs
+layout (location = 0) in vec2 inTexCoord;
+layout (location = 1) in vec4 inColor;
+
+// uniforms
+layout (set = 0, binding = 0) uniform sampler2D tex_unit_0;
+
+// outputs
+layout (location = 0) out vec4 outFragColor;
+
+void main(){
+	outFragColor = texture(tex_unit_0, inTexCoord.xy) * inColor;
+}
@@ -55,6 +55,7 @@ struct le_descriptor_set_layout_t {
 	std::vector<le_shader_binding_info> binding_info;                  // binding info for this set
 	VkDescriptorSetLayout               vk_descriptor_set_layout;      // vk object
 	VkDescriptorUpdateTemplate          vk_descriptor_update_template; // template used to update such a descriptorset based on descriptor data laid out in flat DescriptorData elements
+	bool                                is_bindless = false;           // if true, set is the backend-owned bindless set: binding_info is empty, and there is no update template
 };
 // ----------------------------------------------------------------------
 // Everything a possible vulkan descriptor binding might contain.
@@ -156,6 +157,7 @@ struct BackendQueueInfo {
 	VkSemaphore  semaphore;            // owning, Per-queue timeline semaphore
 	uint64_t     semaphore_wait_value; // Highest value which this semaphore is going to signal - others may wait on this, defaults to 0
 	uint32_t     queue_family_index;   // queue family index for this queue - all queues with the same family index have the same capabilities, multiple queues may share the same family index (when they belong to the same family)
+	uint32_t     timestamp_valid_bits; // number of meaningful bits in timestamps written on this queue, 0 if this queue does not support timestamps
 	uint64_t     semaphore_get_next_signal_value() {
 		    return ++semaphore_wait_value;
 	};
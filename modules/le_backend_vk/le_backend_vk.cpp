@@ -2,6 +2,7 @@
 #include "le_backend_vk.h"
 #include "le_log.h"
 #include "private/le_backend_vk/le_command_stream_t.h"
+#include "private/le_backend_vk/le_flat_map.h"
 #include "util/vk_mem_alloc/vk_mem_alloc.h" // for allocation
 #include "le_backend_types_internal.h"      // includes vulkan.hpp
 #include "le_swapchain_vk.h"
@@ -74,9 +75,10 @@ static constexpr auto LOGGER_LABEL     = "le_backend_vk";
 
 LE_WRAP_ENUM_IN_STRUCT( VkFormat, VkFormatEnum ); // define wrapper struct `VkFormatEnum`
 
-constexpr size_t LE_FRAME_DATA_POOL_BLOCK_SIZE  = 1u << 24; // 16.77 MB
-constexpr size_t LE_FRAME_DATA_POOL_BLOCK_COUNT = 1;
-constexpr size_t LE_LINEAR_ALLOCATOR_SIZE       = 1u << 24;
+constexpr size_t   LE_FRAME_DATA_POOL_BLOCK_SIZE  = 1u << 24; // 16.77 MB
+constexpr size_t   LE_FRAME_DATA_POOL_BLOCK_COUNT = 1;
+constexpr size_t   LE_LINEAR_ALLOCATOR_SIZE       = 1u << 24;
+constexpr uint32_t LE_MAX_TIMESTAMP_QUERY_PASSES  = 256; // maximum number of passes per frame for which we record gpu timestamps
 
 static constexpr VkImageSubresourceRange LE_IMAGE_SUBRESOURCE_RANGE_ALL_MIPLEVELS{
     .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
@@ -490,6 +492,7 @@ class swapchain_data_t {
 		swapchain_surface        = rhs.swapchain_surface; // this should also increase the use count...
 		height                   = rhs.height;
 		width                    = rhs.width;
+		image_count              = rhs.image_count;
 		swapchain_image          = rhs.swapchain_image;
 		return *this;
 	};
@@ -498,8 +501,29 @@ class swapchain_data_t {
 		*this = rhs;
 	};
 
-	swapchain_data_t( swapchain_data_t&& ) noexcept            = default; // move constructor
-	swapchain_data_t& operator=( swapchain_data_t&& ) noexcept = default; // move assignment
+	// Moving transfers ownership of the swapchain reference - the moved-from
+	// object must not release it again.
+	swapchain_data_t( swapchain_data_t&& rhs ) noexcept {
+		*this = std::move( rhs );
+	};
+
+	swapchain_data_t& operator=( swapchain_data_t&& rhs ) noexcept {
+		if ( this != &rhs ) {
+			if ( swapchain ) {
+				le_swapchain_vk::swapchain_ref_i.dec_ref( swapchain );
+			}
+			swapchain     = rhs.swapchain;
+			rhs.swapchain = nullptr;
+
+			swapchain_surface_format = rhs.swapchain_surface_format;
+			swapchain_surface        = std::move( rhs.swapchain_surface );
+			height                   = rhs.height;
+			width                    = rhs.width;
+			image_count              = rhs.image_count;
+			swapchain_image          = rhs.swapchain_image;
+		}
+		return *this;
+	};
 
 	~swapchain_data_t() {
 		if ( swapchain ) {
@@ -517,6 +541,37 @@ struct swapchain_state_t {
 	swapchain_data_t                    swapchain_data;
 };
 
+// Frame-local tables are flat maps, so that they keep their storage when they get
+// cleared - in steady state, rebuilding these tables every frame doesn't allocate.
+using resource_info_map_t = le::FlatMap<le_resource_handle, le_resource_info_t>;
+
+// Queue family ownership transfer for a resource, see backend_submit_queue_transfer_ops.
+struct ownership_transfer_t {
+	le_resource_handle    resource;
+	uint32_t              src_queue_family_index;
+	uint32_t              dst_queue_family_index;
+	std::vector<uint32_t> dst_queue_index;
+};
+
+// Release, or acquire barriers for queue family ownership transfers, grouped by
+// queue family (release), or by queue (acquire).
+struct ownership_barriers_t {
+	le::FlatMap<le_resource_handle, VkImageMemoryBarrier2>  img_barriers;       // we use a map here because there an only be one barrier per-resource
+	le::FlatMap<le_resource_handle, VkBufferMemoryBarrier2> buf_barriers;       // --"--
+	std::vector<uint32_t>                                   src_family_indices; // unique; which release queues this queue must wait for - only used for acquire barriers
+};
+
+// Found via ADL by le::FlatMap - recycled values keep the capacity of their members.
+inline void flat_map_recycle_value( ownership_transfer_t& v ) {
+	v.dst_queue_index.clear();
+}
+
+inline void flat_map_recycle_value( ownership_barriers_t& v ) {
+	v.img_barriers.clear();
+	v.buf_barriers.clear();
+	v.src_family_indices.clear();
+}
+
 // Herein goes all data which is associated with the current frame.
 // Backend keeps track of multiple frames, exactly one per renderer::FrameData frame.
 //
@@ -543,9 +598,11 @@ struct BackendFrameData {
 		std::string           debug_root_passes_names; // name of root passes
 	};                                                 //
 	std::vector<PerQueueSubmissionData> queue_submission_data;
-	std::vector<CommandPool*>           available_command_pools; // Owning. reset on frame recycle, delete all objects on BackendFrameData::destroy
+	std::vector<PerQueueSubmissionData> spare_queue_submission_data; // elements parked by frame_resize_queue_submission_data, so that they keep their capacity
+	std::vector<CommandPool*>           available_command_pools;     // Owning. reset on frame recycle, delete all objects on BackendFrameData::destroy
 
-	std::unordered_map<uint64_t, swapchain_state_t> frame_owned_swapchain_state; // per-swapchain state for this frame
+	le::FlatMap<uint64_t, swapchain_state_t> frame_owned_swapchain_state;      // per-swapchain state for this frame
+	le::FlatMap<uint64_t, swapchain_state_t> scratch_previous_swapchain_state; // scratch: swapchain state from previous use of this frame, used in acquire_swapchain_resources
 
 	struct Texture {
 		VkSampler   sampler;
@@ -554,13 +611,15 @@ struct BackendFrameData {
 
 	using texture_map_t = std::unordered_map<le_texture_handle, Texture>;
 
-	std::unordered_map<le_img_resource_handle, VkImageView> imageViews; // non-owning, references to frame-local textures, cleared on frame fence.
+	le::FlatMap<le_img_resource_handle, VkImageView> imageViews; // non-owning, references to frame-local textures, cleared on frame fence.
 
 	// With `syncChainTable` and image_attachment_info_o.syncState, we should
 	// be able to create renderpasses. Each resource has a sync chain, and each attachment_info
 	// has a struct which holds indices into the sync chain telling us where to look
 	// up the sync state for a resource at different stages of renderpass construction.
-	using sync_chain_table_t = std::unordered_map<le_resource_handle, std::vector<ResourceState>>;
+	//
+	// Note that sync chain vectors keep their capacity when the table gets cleared.
+	using sync_chain_table_t = le::FlatMap<le_resource_handle, std::vector<ResourceState>>;
 	sync_chain_table_t syncChainTable;
 
 	static_assert( sizeof( VkBuffer ) == sizeof( VkImageView ) && sizeof( VkBuffer ) == sizeof( VkImage ), "size of AbstractPhysicalResource components must be identical" );
@@ -568,7 +627,7 @@ struct BackendFrameData {
 	// Map from renderer resource id to physical resources - only contains resources this frame uses.
 	// Q: Does this table actually own the resources?
 	// A: It must not: as it is used to map external resources as well.
-	std::unordered_map<le_resource_handle, AbstractPhysicalResource> physicalResources;
+	le::FlatMap<le_resource_handle, AbstractPhysicalResource> physicalResources;
 
 	/// \brief vk resources retained and destroyed with BackendFrameData.
 	/// These resources (such as samplers, imageviews, framebuffers) are transient,
@@ -578,7 +637,10 @@ struct BackendFrameData {
 	/// \brief if user provides explicit resource info, we collect this here, so that we can make sure
 	/// that any inferred resourceInfo is compatible with what the user selected.
 	/// there is no guarantee that declared resources are unique, which means we must consolidate.
-	std::unordered_map<le_resource_handle, le_resource_info_t> declared_resources; // | pre-declared resources (explicitly declared via rendergraph)
+	resource_info_map_t declared_resources; // | pre-declared resources (explicitly declared via rendergraph)
+	resource_info_map_t active_resources;   // | scratch: consolidated resource infos for all resources used in this frame, rebuilt on allocate_resources
+
+	le::FlatMap<le_resource_handle, VkQueueFlags> resource_queue_flags; // scratch: accumulated queue flags per resource, used in process_frame
 
 	std::vector<BackendRenderPass>   passes;
 	std::vector<le::RootPassesField> queue_submission_keys; // One key per isolated queue invocation,
@@ -592,6 +654,12 @@ struct BackendFrameData {
 
 	std::vector<VkDescriptorPool> descriptorPools; // one descriptor pool per pass
 
+	VkDescriptorPool                    bindlessDescriptorPool = nullptr; // owning: pool for bindlessDescriptorSet, nullptr if bindless descriptors are disabled
+	VkDescriptorSet                     bindlessDescriptorSet  = nullptr; // bindless set for this frame, updated at the start of process_frame
+	std::vector<VkWriteDescriptorSet>   scratch_bindless_writes;          // scratch: descriptor writes for bindless set, used in process_frame
+	std::vector<VkDescriptorImageInfo>  scratch_bindless_image_infos;     // scratch: image infos referenced by scratch_bindless_writes
+	std::vector<VkDescriptorBufferInfo> scratch_bindless_buffer_infos;    // scratch: buffer infos referenced by scratch_bindless_writes
+
 	typedef std::unordered_map<le_resource_handle, AllocatedResourceVk> ResourceMap_T;
 
 	ResourceMap_T availableResources; // resources this frame may use - each entry represents an association between a le_resource_handle and a vk resource
@@ -617,6 +685,30 @@ struct BackendFrameData {
 
 	std::vector<le_command_stream_t*> command_streams; // owning; these must be destroyed when frame gets destroyed.
 
+	VkQueryPool                   timestampQueryPool = nullptr; // owning: two timestamp queries per pass (begin, end), indexed by pass index
+	std::vector<le_pass_timing_t> passTimings;                  // gpu timings per pass, harvested on frame clear. protected by le_backend_o::pass_timings_mutex
+	le_barrier_stats_t            barrierStats{};               // barrier counts, updated at the end of process_frame. protected by le_backend_o::pass_timings_mutex
+
+	std::array<uint32_t, LE_MAX_TIMESTAMP_QUERY_PASSES> passTimestampValidBits{}; // per pass: timestampValidBits of the queue which wrote the pass's timestamps
+
+	std::vector<VkImageMemoryBarrier2>  scratch_image_barriers;   // scratch: image barriers which are batched into a single dependency, used in process_frame
+	std::vector<VkBufferMemoryBarrier2> scratch_buffer_barriers;  // scratch: buffer barriers which are batched into a single dependency, used in process_frame
+	std::vector<VkMemoryBarrier2>       scratch_memory_barriers;  // scratch: global memory barriers which are batched into a single dependency, used in process_frame
+	std::vector<le_img_resource_handle> scratch_swapchain_images; // scratch: images of swapchains owned by this frame, used in process_frame
+
+	// scratch: used in dispatch_frame, and submit_queue_transfer_ops
+	std::vector<VkSemaphoreSubmitInfo>                    scratch_present_complete_waits;
+	std::vector<VkSemaphoreSubmitInfo>                    scratch_render_complete_signals;
+	std::vector<VkSemaphoreSubmitInfo>                    scratch_cross_queue_waits;
+	std::vector<VkSemaphoreSubmitInfo>                    scratch_submission_waits;
+	std::vector<VkCommandBufferSubmitInfo>                scratch_command_buffer_submit_infos;
+	std::vector<VkImageMemoryBarrier2>                    scratch_transfer_image_barriers;
+	std::vector<VkBufferMemoryBarrier2>                   scratch_transfer_buffer_barriers;
+	le::FlatMap<le_resource_handle, ownership_transfer_t> scratch_ownership_transfers;
+	le::FlatMap<uint32_t, ownership_barriers_t>           scratch_release_barriers;          // by queue family index
+	le::FlatMap<uint32_t, ownership_barriers_t>           scratch_acquire_barriers;          // by queue index
+	le::FlatMap<uint32_t, std::vector<uint32_t>>          scratch_per_queue_wait_for_queues; // by queue index: unique indices of queues to wait for
+
 	bool must_create_queues_dot_graph = false;
 };
 
@@ -658,6 +750,9 @@ struct le_backend_o {
 
 	std::unordered_map<le_resource_handle, uint64_t> resource_queue_family_ownership[ 2 ]; // per-resource queue family ownership - we use this to detect queue family ownership change for resources
 
+	float      timestamp_period_ns = 0; // nanoseconds per timestamp tick, 0 if device does not support timestamps on graphics and compute queues
+	std::mutex pass_timings_mutex;      // protects BackendFrameData::passTimings, and BackendFrameData::barrierStats, which may be read from any thread
+
   private:
 	// Vulkan resources which are available to all frames.
 	// Generally, a resource needs to stay alive until the last frame that uses it has crossed its fence.
@@ -683,6 +778,8 @@ struct ArgumentState {
 	std::array<uint32_t, 256>                  dynamicOffsets     = {}; // offset for each dynamic element in current pipeline
 	uint32_t                                   setCount           = 0;  // current count of bound descriptorSets (max: 8)
 	std::array<std::vector<DescriptorData>, 8> setData;                 // data per-set
+	uint32_t                                   bindlessSetMask    = 0;       // bit per set: set is the bindless set, which needs no updates
+	VkDescriptorSet                            bindlessSet        = nullptr; // bindless descriptor set for current frame, nullptr if bindless descriptors are disabled
 
 	std::array<VkDescriptorUpdateTemplate, 8> updateTemplates; // update templates for currently bound descriptor sets
 	std::array<VkDescriptorSetLayout, 8>      layouts;         // layouts for currently bound descriptor sets
@@ -747,6 +844,7 @@ static VkBufferUsageFlags defaults_get_buffer_usage_scratch() {
 	    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
 	    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
 	    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+	    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | // so that draw parameters may be sourced from scratch memory
 	    VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
 	// Enable shader_device_address for scratch buffer, if raytracing feature is requested
@@ -798,7 +896,15 @@ static void backend_destroy( le_backend_o* self ) {
 
 		vkDestroyFence( device, frameData.frameFence, nullptr );
 
-		frameData.frame_owned_swapchain_state.clear();
+		if ( frameData.timestampQueryPool ) {
+			vkDestroyQueryPool( device, frameData.timestampQueryPool, nullptr );
+			frameData.timestampQueryPool = nullptr;
+		}
+
+		// Flat maps keep values alive when cleared - we must drop them, so that
+		// swapchain semaphores and swapchain references are released here.
+		frameData.frame_owned_swapchain_state      = {};
+		frameData.scratch_previous_swapchain_state = {};
 
 		{
 			for ( auto& cp : frameData.available_command_pools ) {
@@ -813,6 +919,10 @@ static void backend_destroy( le_backend_o* self ) {
 			vkDestroyDescriptorPool( device, d, nullptr );
 		}
 
+		if ( frameData.bindlessDescriptorPool ) {
+			vkDestroyDescriptorPool( device, frameData.bindlessDescriptorPool, nullptr );
+		}
+
 		{
 			// Destroy linear allocators, and the buffers allocated for them.
 			assert( frameData.allocatorBuffers.size() == frameData.allocators.size() &&
@@ -1085,6 +1195,15 @@ static bool backend_get_swapchain_extent( le_backend_o* self, le_swapchain_handl
 	}
 }
 // ----------------------------------------------------------------------
+// Returns the number of images owned by the swapchain, 0 if the swapchain is unknown.
+static uint32_t backend_get_swapchain_image_count( le_backend_o* self, le_swapchain_handle swapchain_handle ) {
+	auto it = self->swapchains.find( reinterpret_cast<uint64_t>( swapchain_handle ) );
+	if ( it != self->swapchains.end() ) {
+		return it->second.image_count;
+	}
+	return 0;
+}
+// ----------------------------------------------------------------------
 
 bool backend_get_swapchains_infos( le_backend_o* self, uint32_t frame_index, uint32_t* count, uint32_t* p_width, uint32_t* p_height, le_img_resource_handle* p_handle ) {
 
@@ -1279,6 +1398,12 @@ static void backend_initialise( le_backend_o* self ) {
 
 		vk_device_i.get_queues_info( *self->device, &num_queues, queues.data(), queues_family_index.data(), queues_flags.data() );
 
+		// We need queue family properties to find out how many bits of a timestamp are valid on each queue.
+		uint32_t num_queue_families = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties( self->device->getVkPhysicalDevice(), &num_queue_families, nullptr );
+		std::vector<VkQueueFamilyProperties> queue_family_properties( num_queue_families );
+		vkGetPhysicalDeviceQueueFamilyProperties( self->device->getVkPhysicalDevice(), &num_queue_families, queue_family_properties.data() );
+
 		VkSemaphoreTypeCreateInfo type_info = {
 		    .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
 		    .pNext         = nullptr, // optional
@@ -1298,6 +1423,7 @@ static void backend_initialise( le_backend_o* self ) {
 			    .semaphore            = nullptr,
 			    .semaphore_wait_value = 0,
 			    .queue_family_index   = queues_family_index[ i ],
+			    .timestamp_valid_bits = queue_family_properties[ queues_family_index[ i ] ].timestampValidBits,
 			};
 
 			{
@@ -1397,6 +1523,16 @@ static void backend_setup( le_backend_o* self ) {
 
 	uint32_t memIndexScratchBufferGraphics = getMemoryIndexForGraphicsScratchBuffer( self->mAllocator, self->queueFamilyIndexGraphics ); // used for transient command buffer allocations
 
+	{
+		// We only record timestamps if all graphics and compute queues support them.
+		auto const& limits = vk_device_i.get_vk_physical_device_properties( *self->device )->limits;
+		if ( limits.timestampComputeAndGraphics ) {
+			self->timestamp_period_ns = limits.timestampPeriod;
+		} else {
+			logger.warn( "Device does not support timestamps on graphics and compute queues - pass timings will not be available." );
+		}
+	}
+
 	assert( vkDevice ); // device must come from somewhere! It must have been introduced to backend before, or backend must create device used by everyone else...
 
 	for ( size_t i = 0; i != settings->data_frames_count; ++i ) {
@@ -1416,6 +1552,20 @@ static void backend_setup( le_backend_o* self ) {
 			vkCreateFence( vkDevice, &create_info, nullptr, &frameData.frameFence ); // frence starts out as sigmalled
 		}
 
+		if ( self->timestamp_period_ns > 0 ) {
+			VkQueryPoolCreateInfo create_info = {
+			    .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			    .pNext              = nullptr, // optional
+			    .flags              = 0,       // optional
+			    .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+			    .queryCount         = LE_MAX_TIMESTAMP_QUERY_PASSES * 2, // one query for begin, one for end of each pass
+			    .pipelineStatistics = 0,
+			};
+			vkCreateQueryPool( vkDevice, &create_info, nullptr, &frameData.timestampQueryPool );
+			// Queries must be reset before first use.
+			vkResetQueryPool( vkDevice, frameData.timestampQueryPool, 0, create_info.queryCount );
+		}
+
 		{
 			// -- set up an allocation pool for each frame
 			// so that each frame can create sub-allocators
@@ -2023,6 +2173,58 @@ static bool backend_poll_frame_fence( le_backend_o* self, size_t frameIndex ) {
 	}
 }
 
+// ----------------------------------------------------------------------
+// Read back timestamps written while processing this frame, and store
+// per-pass timings with the frame so that they may be queried until
+// the frame gets cleared again.
+// Must only be called once the frame fence has been crossed.
+static void backend_frame_harvest_pass_timings( le_backend_o* self, BackendFrameData& frame, VkDevice device ) {
+	ZoneScoped;
+
+	uint32_t num_passes = std::min<uint32_t>( uint32_t( frame.passes.size() ), LE_MAX_TIMESTAMP_QUERY_PASSES );
+
+	// Each query returns a pair of values: the timestamp, and its availability.
+	// Queries which were never written (e.g. because the frame was never processed)
+	// will not be available, we must ignore these.
+	std::array<uint64_t, LE_MAX_TIMESTAMP_QUERY_PASSES * 4> results;
+
+	{
+		auto lock = std::scoped_lock( self->pass_timings_mutex );
+
+		frame.passTimings.clear();
+
+		if ( num_passes != 0 ) {
+
+			VkResult result = vkGetQueryPoolResults( device, frame.timestampQueryPool, 0, num_passes * 2,
+			                                         sizeof( results ), results.data(), sizeof( uint64_t ) * 2,
+			                                         VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT );
+
+			if ( result == VK_SUCCESS || result == VK_NOT_READY ) {
+				for ( uint32_t i = 0; i != num_passes; i++ ) {
+					uint64_t const* query = results.data() + i * 4; // [begin, begin_available, end, end_available]
+					if ( query[ 1 ] == 0 || query[ 3 ] == 0 ) {
+						continue;
+					}
+					// Only the lower timestampValidBits bits of a timestamp are meaningful, the
+					// upper bits are undefined. We mask both timestamps, and the difference, so
+					// that the duration is also correct if the counter wrapped in between.
+					uint32_t const valid_bits = frame.passTimestampValidBits[ i ];
+					uint64_t const mask       = valid_bits >= 64 ? ~uint64_t( 0 ) : ( uint64_t( 1 ) << valid_bits ) - 1;
+					uint64_t const ticks      = ( ( query[ 2 ] & mask ) - ( query[ 0 ] & mask ) ) & mask;
+
+					le_pass_timing_t timing{};
+					snprintf( timing.debug_name, sizeof( timing.debug_name ), "%s", frame.passes[ i ].debugName );
+					timing.gpu_duration_ns = uint64_t( double( ticks ) * self->timestamp_period_ns );
+					frame.passTimings.push_back( timing );
+				}
+			}
+		}
+	}
+
+	// Reset queries so that they may be written again when this frame gets processed next.
+	vkResetQueryPool( device, frame.timestampQueryPool, 0, LE_MAX_TIMESTAMP_QUERY_PASSES * 2 );
+}
+
 // ----------------------------------------------------------------------
 /// \brief: Frees all frame local resources
 /// \preliminary: frame fence must have been crossed.
@@ -2108,11 +2310,24 @@ static bool backend_clear_frame( le_backend_o* self, size_t frameIndex ) {
 		// Note that we don't clear `cp->buffers` - no need to do this as buffers
 		// get resized and overwritten whenever a pool gets re-used.
 	}
-	frame.queue_submission_data.clear();
+
+	// Note that we don't remove elements from `queue_submission_data` - we only
+	// reset them, so that their vectors and strings keep their capacity.
+	// `process_frame` resizes `queue_submission_data` to the number of submissions,
+	// via frame_resize_queue_submission_data, which parks elements instead of destroying them.
+	for ( auto& qs : frame.queue_submission_data ) {
+		qs.pass_indices.clear();
+		qs.debug_root_passes_names.clear();
+		qs.command_pool = nullptr;
+	}
 
 	frame.physicalResources.clear();
 	frame.syncChainTable.clear();
 
+	if ( frame.timestampQueryPool ) {
+		backend_frame_harvest_pass_timings( self, frame, device );
+	}
+
 	for ( auto& f : frame.passes ) {
 		if ( f.encoder ) {
 			using namespace le_renderer;
@@ -2147,7 +2362,7 @@ static constexpr auto ANY_WRITE_VK_ACCESS_2_FLAGS =
 // ----------------------------------------------------------------------
 // Executes on the DISPATCH FRAME
 //
-static void backend_create_renderpasses( BackendFrameData& frame, VkDevice& device ) {
+static void backend_create_renderpasses( BackendFrameData& frame, VkDevice& device, le_pipeline_manager_o* pipeline_manager ) {
 	ZoneScoped;
 	static auto logger = LeLog( LOGGER_LABEL );
 
@@ -2478,6 +2693,10 @@ static void backend_create_renderpasses( BackendFrameData& frame, VkDevice& devi
 
 			vkCreateRenderPass2( device, &renderpassCreateInfo, nullptr, &pass.renderPass );
 
+			// Tell pipeline manager about this renderpass, so that it may compile
+			// pipelines for compatible renderpasses in the background.
+			le_backend_vk::le_pipeline_manager_i.introduce_renderpass_signature( pipeline_manager, pass.renderpassHash, &renderpassCreateInfo, pass.numColorAttachments, pass.sampleCount );
+
 			delete dsAttachmentReference; // noo-op if nullptr; we clean up here in case we allocated a
 			                              // depth stencil attachment reference above.
 			                              // Once createRenderPass has consumed the data, we can safely delete.
@@ -2716,6 +2935,146 @@ static void backend_create_descriptor_pools( BackendFrameData& frame, VkDevice&
 	}
 }
 
+// ----------------------------------------------------------------------
+// Creates the bindless descriptor set for a frame, if bindless descriptors
+// are enabled, and the frame does not have a bindless set yet.
+//
+// Each frame has its own bindless set, so that a frame may update its set
+// while sets for other frames may still be in use by the GPU. Indices into
+// the set are the same for all frames.
+static void backend_create_bindless_descriptor_set( BackendFrameData& frame, VkDevice& device, le_pipeline_manager_o* pipeline_manager ) {
+
+	if ( frame.bindlessDescriptorSet ) {
+		return;
+	}
+
+	VkDescriptorSetLayout layout = le_backend_vk::le_pipeline_manager_i.get_bindless_descriptor_set_layout( pipeline_manager );
+
+	if ( layout == nullptr ) {
+		return;
+	}
+
+	// ----------| invariant: bindless descriptors are enabled
+
+	uint32_t num_textures = 0;
+	uint32_t num_buffers  = 0;
+	le_backend_vk::settings_i.get_bindless_descriptor_counts( &num_textures, &num_buffers );
+
+	VkDescriptorPoolSize pool_sizes[ 2 ] = {
+	    { .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = std::max( num_textures, 1u ) },
+	    { .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = std::max( num_buffers, 1u ) },
+	};
+
+	VkDescriptorPoolCreateInfo pool_create_info{
+	    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+	    .pNext         = nullptr, // optional
+	    .flags         = 0,       // optional
+	    .maxSets       = 1,
+	    .poolSizeCount = 2,
+	    .pPoolSizes    = pool_sizes,
+	};
+
+	auto result = vkCreateDescriptorPool( device, &pool_create_info, nullptr, &frame.bindlessDescriptorPool );
+	assert( result == VK_SUCCESS && "failed to create bindless descriptor pool" );
+
+	VkDescriptorSetAllocateInfo allocate_info{
+	    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+	    .pNext              = nullptr, // optional
+	    .descriptorPool     = frame.bindlessDescriptorPool,
+	    .descriptorSetCount = 1,
+	    .pSetLayouts        = &layout,
+	};
+
+	result = vkAllocateDescriptorSets( device, &allocate_info, &frame.bindlessDescriptorSet );
+	assert( result == VK_SUCCESS && "failed to allocate bindless descriptor set" );
+}
+
+// ----------------------------------------------------------------------
+// Writes descriptors for all textures and buffers which this frame uses, and which
+// have a bindless index, into the frame's bindless set - this happens once per frame,
+// before any command buffers get recorded.
+//
+// Only textures which were declared via a renderpass (`sample_texture`), and allocated
+// buffers which are used by this frame have valid descriptors - shaders must
+// not access any other elements, as the set is partially bound, and elements from
+// earlier frames refer to transient objects which are gone.
+static void backend_frame_update_bindless_descriptors( BackendFrameData& frame, VkDevice device, le_pipeline_manager_o* pipeline_manager ) {
+
+	if ( frame.bindlessDescriptorSet == nullptr ) {
+		return;
+	}
+
+	ZoneScoped;
+	using namespace le_backend_vk;
+
+	frame.scratch_bindless_writes.clear();
+	frame.scratch_bindless_image_infos.clear();
+	frame.scratch_bindless_buffer_infos.clear();
+
+	auto add_write = [ &frame ]( uint32_t binding, uint32_t array_element, VkDescriptorType type ) {
+		frame.scratch_bindless_writes.push_back( {
+		    .sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		    .pNext            = nullptr, // optional
+		    .dstSet           = frame.bindlessDescriptorSet,
+		    .dstBinding       = binding,
+		    .dstArrayElement  = array_element,
+		    .descriptorCount  = 1,
+		    .descriptorType   = type,
+		    .pImageInfo       = nullptr, // patched once all infos have been collected
+		    .pBufferInfo      = nullptr, // patched once all infos have been collected
+		    .pTexelBufferView = nullptr,
+		} );
+	};
+
+	for ( auto const& textures : frame.textures_per_pass ) {
+		for ( auto const& [ texture_handle, texture ] : textures ) {
+			uint32_t index = le_pipeline_manager_i.find_bindless_texture_index( pipeline_manager, texture_handle );
+			if ( index == LE_BINDLESS_INDEX_INVALID ) {
+				continue;
+			}
+			frame.scratch_bindless_image_infos.push_back( {
+			    .sampler     = texture.sampler,
+			    .imageView   = texture.imageView,
+			    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			} );
+			add_write( 0, index, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER );
+		}
+	}
+
+	for ( auto const& [ resource, allocated_resource ] : frame.availableResources ) {
+		if ( resource->data->type != LeResourceType::eBuffer ) {
+			continue;
+		}
+		uint32_t index = le_pipeline_manager_i.find_bindless_buffer_index( pipeline_manager, static_cast<le_buf_resource_handle>( resource ) );
+		if ( index == LE_BINDLESS_INDEX_INVALID ) {
+			continue;
+		}
+		frame.scratch_bindless_buffer_infos.push_back( {
+		    .buffer = allocated_resource.as.buffer,
+		    .offset = 0,
+		    .range  = VK_WHOLE_SIZE,
+		} );
+		add_write( 1, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER );
+	}
+
+	// ----------| invariant: info vectors won't grow anymore - pointers into them are stable
+
+	auto image_info  = frame.scratch_bindless_image_infos.data();
+	auto buffer_info = frame.scratch_bindless_buffer_infos.data();
+
+	for ( auto& w : frame.scratch_bindless_writes ) {
+		if ( w.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ) {
+			w.pImageInfo = image_info++;
+		} else {
+			w.pBufferInfo = buffer_info++;
+		}
+	}
+
+	if ( !frame.scratch_bindless_writes.empty() ) {
+		vkUpdateDescriptorSets( device, uint32_t( frame.scratch_bindless_writes.size() ), frame.scratch_bindless_writes.data(), 0, nullptr );
+	}
+}
+
 // ----------------------------------------------------------------------
 // Returns a VkFormat which will match a given set of LeImageUsageFlags.
 // If a matching format cannot be inferred, this method
@@ -3284,10 +3643,10 @@ static inline void consolidate_resource_info_into( le_resource_info_t& lhs, le_r
 //
 // should return a map of all resources used in all passes, with consolidated infos per-resource.
 static void collect_resource_infos_per_resource(
-    le_renderpass_o const* const*                                     passes,
-    size_t                                                            numRenderPasses,
-    std::unordered_map<le_resource_handle, le_resource_info_t> const& frame_declared_resources, // | pre-declared resources (declared via module)
-    std::unordered_map<le_resource_handle, le_resource_info_t>&       active_resources ) {
+    le_renderpass_o const* const* passes,
+    size_t                        numRenderPasses,
+    resource_info_map_t const&    frame_declared_resources, // | pre-declared resources (declared via module)
+    resource_info_map_t&          active_resources ) {
 	ZoneScoped;
 
 	using namespace le_renderer;
@@ -3409,7 +3768,7 @@ static void collect_resource_infos_per_resource(
 // ----------------------------------------------------------------------
 
 static void insert_msaa_versions(
-    std::unordered_map<le_resource_handle, le_resource_info_t>& active_resources ) {
+    resource_info_map_t& active_resources ) {
 	ZoneScoped;
 	// For each image resource which is specified with versions of additional sample counts
 	// we create additional resource_ids (by patching in the sample count), and add matching
@@ -3674,7 +4033,8 @@ static void backend_allocate_resources( le_backend_o* self, BackendFrameData& fr
 	// before we make sure to we find a valid image format which matches all uses...
 	//
 
-	std::unordered_map<le_resource_handle, le_resource_info_t> active_resources;
+	auto& active_resources = frame.active_resources;
+	active_resources.clear();
 
 	collect_resource_infos_per_resource(
 	    passes, numRenderPasses,
@@ -4194,13 +4554,13 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 
 		frame.syncChainTable.clear();
 		for ( auto const& res : frame.availableResources ) {
-			frame.syncChainTable.insert( { res.first, { res.second.state } } );
+			frame.syncChainTable[ res.first ].push_back( res.second.state );
 		}
 
 		// -- build sync chain for each resource, create explicit sync barrier requests for resources
 		// which cannot be implicitly synced.
-		std::vector<le_img_resource_handle> tmp_swapchain_resources{};
-		tmp_swapchain_resources.reserve( frame.frame_owned_swapchain_state.size() );
+		auto& tmp_swapchain_resources = frame.scratch_swapchain_images;
+		tmp_swapchain_resources.clear();
 
 		for ( auto& [ key, swp ] : frame.frame_owned_swapchain_state ) {
 			tmp_swapchain_resources.push_back( swp.swapchain_data.swapchain_image );
@@ -4258,11 +4618,14 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 	frame_allocate_transient_resources( frame, device, passes, numRenderPasses );
 
 	// create renderpasses - use sync chain to apply implicit syncing for image attachment resources
-	backend_create_renderpasses( frame, device );
+	backend_create_renderpasses( frame, device, self->pipelineCache );
 
 	// -- make sure that there is a descriptorpool for every renderpass
 	backend_create_descriptor_pools( frame, device, numRenderPasses );
 
+	// -- make sure that there is a bindless descriptor set, if bindless descriptors are enabled
+	backend_create_bindless_descriptor_set( frame, device, self->pipelineCache );
+
 	// patch and retain physical resources in bulk here, so that
 	// each pass may be processed independently
 
@@ -4271,6 +4634,40 @@ static bool backend_acquire_physical_resources( le_backend_o*             self,
 	return true;
 };
 
+// ----------------------------------------------------------------------
+// Removes resources from the backend, and places them into the frame's recycling bin,
+// so that they get freed once this frame comes round again - at which point no frame
+// in flight may still use them. Resources which are used by this frame are kept.
+// Must be called after backend_acquire_physical_resources for the same frame.
+static void backend_release_physical_resources( le_backend_o* self, size_t frameIndex, le_resource_handle const* resources, size_t resources_count ) {
+	ZoneScoped;
+
+	auto& frame = self->mFrames[ frameIndex ];
+
+	auto [ backend_resources, lock ] = self->get_allocated_resources();
+
+	for ( size_t i = 0; i != resources_count; i++ ) {
+
+		if ( frame.availableResources.find( resources[ i ] ) != frame.availableResources.end() ) {
+			// Resource is used by this frame - we must not release it.
+			continue;
+		}
+
+		auto it = backend_resources.find( resources[ i ] );
+
+		if ( it == backend_resources.end() ) {
+			continue;
+		}
+
+		if ( LE_PRINT_DEBUG_MESSAGES || true ) {
+			printResourceInfo( it->first, it->second.info, "RELEASE" );
+		}
+
+		frame.binnedResources.try_emplace( it->first, it->second );
+		backend_resources.erase( it );
+	}
+}
+
 // ----------------------------------------------------------------------
 static le_allocator_o** backend_get_transient_allocators( le_backend_o* self, size_t frameIndex ) {
 	return self->mFrames[ frameIndex ].allocators.data();
@@ -4397,6 +4794,15 @@ static bool updateArguments( const VkDevice&                    device,
 	// -- write data from descriptorSetData into freshly allocated DescriptorSets
 	for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
 
+		if ( argumentState.bindlessSetMask & ( 1u << setId ) ) {
+			// The bindless set is owned by the frame, and has already been updated.
+			descriptorSets[ setId ]           = argumentState.bindlessSet;
+			previousSetData[ setId ].setLayout = argumentState.layouts[ setId ];
+			previousSetData[ setId ].setData.clear();
+			argumentsOk &= ( argumentState.bindlessSet != nullptr );
+			continue;
+		}
+
 		// If argumentState contains invalid information (for example if an uniform has not been set yet)
 		// this will lead to SEGFAULT. You must ensure that argumentState contains valid information.
 		//
@@ -4614,6 +5020,8 @@ static void debug_print_command( void*& cmd ) {
 			switch (cmd_header->info.type){
                 case (le::CommandType::eDrawIndexed): os << "eDrawIndexed"; break;
                 case (le::CommandType::eDraw): os << "eDraw"; break;
+                case (le::CommandType::eDrawIndexedCompact): os << "eDrawIndexedCompact"; break;
+                case (le::CommandType::eDrawCompact): os << "eDrawCompact"; break;
                 case (le::CommandType::eDispatch): os << "eDispatch"; break;
                 case (le::CommandType::eBufferMemoryBarrier): os << "eBufferMemoryBarrier"; break;
                 case (le::CommandType::eSetLineWidth): os << "eSetLineWidth"; break;
@@ -4633,6 +5041,9 @@ static void debug_print_command( void*& cmd ) {
                 case (le::CommandType::eBuildRtxBlas): os << "eBuildRtxBlas"; break;
                 case (le::CommandType::eWriteToImage): os << "eWriteToImage"; break;
                 case (le::CommandType::eDrawMeshTasks): os << "eDrawMeshTasks"; break;
+                case (le::CommandType::eDrawIndirect): os << "eDrawIndirect"; break;
+                case (le::CommandType::eDrawIndexedIndirect): os << "eDrawIndexedIndirect"; break;
+                case (le::CommandType::eDrawIndexedIndirectCount): os << "eDrawIndexedIndirectCount"; break;
                 case (le::CommandType::eTraceRays): os << "eTraceRays"; break;
                 case (le::CommandType::eSetArgumentTlas): os << "eSetArgumentTlas"; break;
 			}
@@ -4716,6 +5127,14 @@ static uint32_t backend_find_queue_family_index_from_requirements( le_backend_o*
 			VkQueueFlags available_flags = info->queue_flags;
 			VkQueueFlags requested_flags = flags;
 
+			if ( ( available_flags & VK_QUEUE_COMPUTE_BIT ) && !( available_flags & VK_QUEUE_GRAPHICS_BIT ) &&
+			     !( requested_flags & VK_QUEUE_COMPUTE_BIT ) ) {
+				// Dedicated (async) compute families are reserved for work which asks for compute -
+				// we don't want transfer-only work to end up there, just because the compute
+				// family happens to have fewer extra capabilities than the graphics family.
+				continue;
+			}
+
 			if ( ( available_flags & requested_flags ) == requested_flags ) {
 				// requested_flags are contained in available flags
 				VkQueueFlags leftover_flags = ( available_flags & ( ~requested_flags ) ); // flags which only appear in available_flags
@@ -4742,9 +5161,12 @@ static void backend_acquire_swapchain_resources( le_backend_o* self, size_t fram
 	using namespace le_swapchain_vk;
 	static auto logger = LeLog( LOGGER_LABEL );
 
-	decltype( frame.frame_owned_swapchain_state ) previous_swapchain_state;
+	// We swap into previous so that we can tell which swapchains this frame knew about.
+	// Both maps belong to the frame, so that neither needs to allocate in steady state.
+	auto& previous_swapchain_state = frame.scratch_previous_swapchain_state;
 
-	std::swap( frame.frame_owned_swapchain_state, previous_swapchain_state ); // we swap into previous so that anything left over in previous will be destroyed at end of scope.
+	std::swap( frame.frame_owned_swapchain_state, previous_swapchain_state );
+	frame.frame_owned_swapchain_state.clear();
 
 	for ( auto& [ key, backend_swapchain_data ] : self->swapchains ) {
 
@@ -4753,9 +5175,9 @@ static void backend_acquire_swapchain_resources( le_backend_o* self, size_t fram
 		// we can recycle the semaphores.
 
 		auto const& [ swapchain_state, was_inserted ] =
-		    ( previous_it != previous_swapchain_state.end() )                                          // if item existed in a previous version of this frame
-		        ? frame.frame_owned_swapchain_state.emplace( previous_it->first, previous_it->second ) // then copy previous swapchain info into the current frame
-		        : frame.frame_owned_swapchain_state.emplace( key, swapchain_state_t{} );               // otherwise generate new swapchain info
+		    ( previous_it != previous_swapchain_state.end() )                                                       // if item existed in a previous version of this frame
+		        ? frame.frame_owned_swapchain_state.emplace( previous_it->first, std::move( previous_it->second ) ) // then move previous swapchain info into the current frame
+		        : frame.frame_owned_swapchain_state.emplace( key, swapchain_state_t{} );                            // otherwise generate new swapchain info
 
 		swapchain_state_t& local_swapchain_state = swapchain_state->second;
 
@@ -4893,6 +5315,13 @@ static void backend_acquire_swapchain_resources( le_backend_o* self, size_t fram
 			}
 		}
 	}
+
+	// Anything left over in previous state belongs to swapchains which have since been
+	// removed - resetting it releases their semaphores, and their swapchain references.
+	for ( auto& [ key, state ] : previous_swapchain_state ) {
+		state = {};
+	}
+	previous_swapchain_state.clear();
 }
 
 // ----------------------------------------------------------------------
@@ -4910,6 +5339,110 @@ inline DescriptorData* find_descriptor_with_binding_number_and_array_idx(
 	return nullptr;
 }
 
+// ----------------------------------------------------------------------
+// Returns true if a resource which is in state `from` may be used in state `to`
+// without a barrier: the layout does not change, there is no write which must
+// be made available, and everything which `to` requires to be visible has already
+// been made visible to the same stages - a read-after-read needs no barrier.
+static inline bool resource_state_transition_is_noop( ResourceState const& from, ResourceState const& to ) {
+	return from.layout == to.layout &&
+	       ( from.visible_access & ANY_WRITE_VK_ACCESS_2_FLAGS ) == 0 &&
+	       ( to.visible_access & ~from.visible_access ) == 0 &&
+	       ( to.stage & ~from.stage ) == 0;
+}
+
+// ----------------------------------------------------------------------
+// Adds a buffer memory barrier to the current batch of buffer barriers.
+// If the batch already holds a barrier for the same buffer range, the new
+// barrier is merged into the existing barrier: a barrier which covers the
+// union of both stage and access masks is at least as strong as both barriers.
+static void frame_add_buffer_barrier( BackendFrameData& frame, VkBufferMemoryBarrier2 const& barrier, le_barrier_stats_t& stats ) {
+	for ( auto& b : frame.scratch_buffer_barriers ) {
+		if ( b.buffer == barrier.buffer &&
+		     b.offset == barrier.offset &&
+		     b.size == barrier.size &&
+		     b.srcQueueFamilyIndex == barrier.srcQueueFamilyIndex &&
+		     b.dstQueueFamilyIndex == barrier.dstQueueFamilyIndex ) {
+			b.srcStageMask |= barrier.srcStageMask;
+			b.srcAccessMask |= barrier.srcAccessMask;
+			b.dstStageMask |= barrier.dstStageMask;
+			b.dstAccessMask |= barrier.dstAccessMask;
+			stats.barriers_elided++;
+			return;
+		}
+	}
+	frame.scratch_buffer_barriers.push_back( barrier );
+}
+
+// ----------------------------------------------------------------------
+// Returns true if the current batch holds an image barrier for `image`. Image barriers
+// for the same image may cover overlapping subresources, and layout transitions for
+// overlapping subresources must not be part of the same dependency - flush first.
+static bool frame_has_batched_image_barrier( BackendFrameData const& frame, VkImage image ) {
+	for ( auto const& b : frame.scratch_image_barriers ) {
+		if ( b.image == image ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------
+// Records all batched memory, image, and buffer barriers using a single call to
+// vkCmdPipelineBarrier2, then clears the batch.
+static void frame_flush_barriers( BackendFrameData& frame, VkCommandBuffer cmd, le_barrier_stats_t& stats ) {
+
+	if ( frame.scratch_image_barriers.empty() && frame.scratch_buffer_barriers.empty() && frame.scratch_memory_barriers.empty() ) {
+		return;
+	}
+
+	// ----------| invariant: there is at least one barrier to record
+
+	VkDependencyInfo dependency_info{
+	    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+	    .pNext                    = nullptr, // optional
+	    .dependencyFlags          = 0,       // optional
+	    .memoryBarrierCount       = uint32_t( frame.scratch_memory_barriers.size() ), // optional
+	    .pMemoryBarriers          = frame.scratch_memory_barriers.data(),
+	    .bufferMemoryBarrierCount = uint32_t( frame.scratch_buffer_barriers.size() ), // optional
+	    .pBufferMemoryBarriers    = frame.scratch_buffer_barriers.data(),
+	    .imageMemoryBarrierCount  = uint32_t( frame.scratch_image_barriers.size() ), // optional
+	    .pImageMemoryBarriers     = frame.scratch_image_barriers.data(),
+	};
+
+	vkCmdPipelineBarrier2( cmd, &dependency_info );
+
+	stats.barriers_emitted += dependency_info.memoryBarrierCount + dependency_info.bufferMemoryBarrierCount + dependency_info.imageMemoryBarrierCount;
+	stats.barrier_batches++;
+
+	frame.scratch_memory_barriers.clear();
+	frame.scratch_image_barriers.clear();
+	frame.scratch_buffer_barriers.clear();
+}
+
+// ----------------------------------------------------------------------
+// Resizes `queue_submission_data` without destroying elements: elements which are
+// no longer needed get parked in `spare_queue_submission_data`, and are taken from
+// there when needed again, so that their vectors and strings keep their capacity.
+static void frame_resize_queue_submission_data( BackendFrameData& frame, size_t count ) {
+	auto& data  = frame.queue_submission_data;
+	auto& spare = frame.spare_queue_submission_data;
+
+	while ( data.size() > count ) {
+		spare.emplace_back( std::move( data.back() ) );
+		data.pop_back();
+	}
+
+	while ( data.size() < count ) {
+		if ( spare.empty() ) {
+			data.emplace_back();
+		} else {
+			data.emplace_back( std::move( spare.back() ) );
+			spare.pop_back();
+		}
+	}
+}
+
 // ----------------------------------------------------------------------
 // Decode commandStream for each pass (may happen in parallel)
 // translate into vk specific commands.
@@ -4940,6 +5473,10 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 	bool needs_to_collect_root_pass_names = frame.must_create_queues_dot_graph; // only collect root pass names when these are needed, for example in order to create dot graphs or debug printouts
 
+	le_barrier_stats_t barrier_stats{}; // barrier counts for this frame, published once all command buffers have been recorded
+
+	backend_frame_update_bindless_descriptors( frame, device, self->pipelineCache );
+
 	{
 
 		// -- Collect command buffers for each queue submission by testing against queue submission key.
@@ -4947,12 +5484,22 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 		// -- And collect pass indices per queue submission
 
 		size_t num_invocation_keys = frame.queue_submission_keys.size();
+		size_t num_submissions     = 0;
+
+		// We recycle elements of `queue_submission_data` from earlier frames, so that
+		// vectors and strings held by each element keep their capacity.
+		frame_resize_queue_submission_data( frame, num_invocation_keys );
 
 		for ( size_t i = 0; i != num_invocation_keys; i++ ) {
 
 			auto const& key = frame.queue_submission_keys[ i ];
 
-			BackendFrameData::PerQueueSubmissionData submission_data{};
+			auto& submission_data       = frame.queue_submission_data[ num_submissions ];
+			submission_data.queue_idx   = 0;
+			submission_data.queue_flags = 0;
+			submission_data.pass_indices.clear();
+			submission_data.command_pool = nullptr;
+			submission_data.debug_root_passes_names.clear();
 
 			for ( size_t pi = 0; pi != frame.passes.size(); pi++ ) {
 
@@ -4976,10 +5523,12 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 			}
 
 			if ( !submission_data.pass_indices.empty() ) {
-				frame.queue_submission_data.push_back( submission_data );
+				num_submissions++;
 			}
 		}
 
+		frame_resize_queue_submission_data( frame, num_submissions );
+
 		assert( num_invocation_keys == frame.queue_submission_data.size() && "must have one submission data element per invocaton key" );
 
 		// -- Control that resources may only be used by the same queue family per-frame.
@@ -4995,7 +5544,8 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 			// for each resource, accumulate all queue type flags that it gets used with over all submissions
 
-			std::unordered_map<le_resource_handle, VkQueueFlags> resource_queue_flags;
+			auto& resource_queue_flags = frame.resource_queue_flags;
+			resource_queue_flags.clear();
 
 			for ( auto const& qs : frame.queue_submission_data ) {
 				for ( auto const& pi : qs.pass_indices ) {
@@ -5026,7 +5576,7 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 			/// from this, we can then go through all queues of the queue family
 			/// and pick the queue with the least submissions.
 			///
-			std::vector<uint32_t> num_submissions_per_queue( num_invocation_keys, 0 );
+			std::vector<uint32_t> num_submissions_per_queue( self->queues.size(), 0 ); // indexed by queue index
 			for ( size_t i = 0; i != num_invocation_keys; i++ ) {
 
 				auto const& queues = self->queues;
@@ -5056,6 +5606,11 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 				assert( matching_queue != -1 && "must have found matching queue" );
 
+				assert( ( ( flags & VK_QUEUE_COMPUTE_BIT ) ||
+				          !( queues[ matching_queue ]->queue_flags & VK_QUEUE_COMPUTE_BIT ) ||
+				          ( queues[ matching_queue ]->queue_flags & VK_QUEUE_GRAPHICS_BIT ) ) &&
+				        "submissions which don't use compute must not be routed to a dedicated compute queue" );
+
 				num_submissions_per_queue[ matching_queue ]++;
 
 				frame.queue_submission_data[ i ].queue_idx = matching_queue;
@@ -5087,7 +5642,7 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 			logger.info( "Listing queue batches and their queue affinity:" );
 			int i = 0;
 			for ( auto const& qf : frame.queue_submission_data ) {
-				logger.info( "#%i, [%-50s]", i, to_string_vk_queue_flags( qf.queue_flags ).c_str() );
+				logger.info( "#%i, [%-50s] -> queue %d (family %d)", i, to_string_vk_queue_flags( qf.queue_flags ).c_str(), qf.queue_idx, self->queues[ qf.queue_idx ]->queue_family_index );
 				i++;
 			}
 			logger.info( "" );
@@ -5126,6 +5681,19 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 				vkBeginCommandBuffer( cmd, &info );
 			}
 
+			// Timestamps are only guaranteed for graphics and compute queues - we don't time
+			// passes which were submitted to transfer-only queues.
+			bool const should_write_timestamps =
+			    frame.timestampQueryPool &&
+			    passIndex < LE_MAX_TIMESTAMP_QUERY_PASSES &&
+			    ( self->queues[ submission.queue_idx ]->queue_flags & ( VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT ) ) &&
+			    self->queues[ submission.queue_idx ]->timestamp_valid_bits != 0;
+
+			if ( should_write_timestamps ) {
+				frame.passTimestampValidBits[ passIndex ] = self->queues[ submission.queue_idx ]->timestamp_valid_bits;
+				vkCmdWriteTimestamp2( cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.timestampQueryPool, passIndex * 2 );
+			}
+
 			if ( SHOULD_INSERT_DEBUG_LABELS ) {
 				VkDebugUtilsLabelEXT labelInfo{
 				    .sType      = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
@@ -5167,6 +5735,10 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 				// We must to this here, as the spec requires barriers to happen
 				// before renderpass begin.
 				//
+				// All barriers for a pass are batched, and recorded with a single
+				// call to vkCmdPipelineBarrier2 once all sync ops have been visited.
+				// Transitions which are proven to be no-ops are dropped.
+				//
 				for ( auto const& op : pass.explicit_sync_ops ) {
 					// fill in sync op
 
@@ -5181,7 +5753,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 					auto const& stateInitial = syncChain[ op.sync_chain_offset_initial ];
 					auto const& stateFinal   = syncChain[ op.sync_chain_offset_final ];
 
-					if ( stateInitial != stateFinal ) {
+					if ( resource_state_transition_is_noop( stateInitial, stateFinal ) ) {
+						barrier_stats.barriers_elided++;
+					} else {
 						// we must issue an image barrier
 
 						if ( LE_PRINT_DEBUG_MESSAGES ) {
@@ -5205,7 +5779,7 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 						auto dstImage = frame_data_get_image_from_le_resource_id( frame, static_cast<le_img_resource_handle>( op.resource ) );
 
-						VkImageMemoryBarrier2 imageLayoutTransfer{
+						frame.scratch_image_barriers.push_back( {
 						    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
 						    .pNext               = nullptr,
 						    .srcStageMask        = uint64_t( stateInitial.stage ) == 0 ? VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT : stateInitial.stage, // happens-before
@@ -5218,23 +5792,11 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 						    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 						    .image               = dstImage,
 						    .subresourceRange    = LE_IMAGE_SUBRESOURCE_RANGE_ALL_MIPLEVELS,
-						};
-
-						VkDependencyInfo dependencyInfo = {
-						    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-						    .pNext                    = nullptr, // optional
-						    .dependencyFlags          = 0,       // optional
-						    .memoryBarrierCount       = 0,       // optional
-						    .pMemoryBarriers          = 0,
-						    .bufferMemoryBarrierCount = 0, // optional
-						    .pBufferMemoryBarriers    = 0,
-						    .imageMemoryBarrierCount  = 1, // optional
-						    .pImageMemoryBarriers     = &imageLayoutTransfer,
-						};
-
-						vkCmdPipelineBarrier2( cmd, &dependencyInfo );
+						} );
 					}
 				} // end for all explicit sync ops.
+
+				frame_flush_barriers( frame, cmd, barrier_stats );
 			}
 
 			// Draw passes must begin by opening a Renderpass context.
@@ -5262,11 +5824,10 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 			// -- Translate intermediary command stream data to api-native instructions
 
-			void*    commandStream = nullptr;
-			size_t   dataSize      = 0;
-			size_t   numCommands   = 0;
-			size_t   commandIndex  = 0;
-			uint32_t subpassIndex  = 0;
+			le_command_stream_t const* commandStream = nullptr;
+			size_t                     numCommands   = 0;
+			size_t                     commandIndex  = 0;
+			uint32_t                   subpassIndex  = 0;
 
 			VkPipelineLayout currentPipelineLayout                          = nullptr;
 			VkDescriptorSet  descriptorSets[ LE_MAX_BOUND_DESCRIPTOR_SETS ] = {}; // currently bound descriptorSets (allocated from pool, therefore we must not worry about freeing, and may re-use freely)
@@ -5281,10 +5842,13 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 			ArgumentState                     argumentState{};  //
 			RtxState                          rtx_state{};      // used to keep track of shader binding tables bound with rtx pipelines.
 
+			argumentState.bindlessSet = frame.bindlessDescriptorSet;
+
 			static le_buf_resource_handle LE_RTX_SCRATCH_BUFFER_HANDLE = LE_BUF_RESOURCE( "le_rtx_scratch_buffer_handle" ); // opaque handle for rtx scratch buffer
 
 			if ( pass.encoder ) {
-				encoder_i.get_encoded_data( pass.encoder, &commandStream, &dataSize, &numCommands );
+				commandStream = encoder_i.get_command_stream( pass.encoder );
+				numCommands   = commandStream ? commandStream->cmd_count : 0;
 			} else {
 				// This is legit behaviour for draw passes which are used only to clear attachments,
 				// in which case they don't need to include any draw commands.
@@ -5296,18 +5860,27 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 				assert( pipelineManager );
 
 				std::vector<VkBuffer>         vertexInputBindings( maxVertexInputBindings, nullptr );
-				void*                         dataIt = commandStream;
+				le_command_stream_t::reader_t commandReader( commandStream );
 				le_pipeline_and_layout_info_t currentPipeline{};
+				bool                          isGraphicsPipelinePending = false; // true if the most recently bound graphics pipeline is still being compiled
 
 				while ( commandIndex != numCommands ) {
 
-					auto header = static_cast<le::CommandHeader*>( dataIt );
+					void* dataIt = commandReader.get();
+					auto  header = static_cast<le::CommandHeader*>( dataIt );
 
 					if ( /* DISABLES CODE */ ( false ) ) {
 						// Print the command stream to stdout.
 						debug_print_command( dataIt );
 					}
 
+					if ( header->info.type != le::CommandType::eBufferMemoryBarrier &&
+					     header->info.type != le::CommandType::eWriteToImage ) {
+						// Any batched barriers must be recorded before the command which depends on them.
+						// WriteToImage adds its own barriers to the batch, and records the batch itself.
+						frame_flush_barriers( frame, cmd, barrier_stats );
+					}
+
 					switch ( header->info.type ) {
 
 					case le::CommandType::eBindGraphicsPipeline: {
@@ -5320,6 +5893,15 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 							// -- potentially compile and create pipeline here, based on current pass and subpass
 							auto requestedPipeline = le_pipeline_manager_i.produce_graphics_pipeline( pipelineManager, le_cmd->info.gpsoHandle, pass, subpassIndex );
 
+							// If pipelines get compiled in the background, the requested pipeline may not be
+							// ready yet. We then skip any draws and argument updates until the next pipeline
+							// gets bound - the frame renders without these draws rather than stalling.
+							isGraphicsPipelinePending = ( requestedPipeline.pipeline == nullptr );
+
+							if ( isGraphicsPipelinePending ) {
+								break;
+							}
+
 							if ( /* DISABLES CODE */ ( false ) ) {
 
 								// Print pipeline debug info when a new pipeline gets bound.
@@ -5340,6 +5922,7 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 								// -- reset dynamic offset count
 								argumentState.dynamicOffsetCount = 0;
+								argumentState.bindlessSetMask    = 0;
 
 								// let's create descriptorData vector based on current bindings-
 								for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
@@ -5355,6 +5938,14 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 									argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
 
 									setData.clear();
+
+									if ( setLayoutInfo->is_bindless ) {
+										// The bindless set is updated once per frame, and
+										// needs no per-draw descriptor data.
+										argumentState.bindlessSetMask |= ( 1u << setId );
+										continue;
+									}
+
 									setData.reserve( setLayoutInfo->binding_info.size() );
 
 									for ( auto b : setLayoutInfo->binding_info ) {
@@ -5440,6 +6031,7 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 								// -- reset dynamic offset count
 								argumentState.dynamicOffsetCount = 0;
+								argumentState.bindlessSetMask    = 0;
 
 								// let's create descriptorData vector based on current bindings-
 								for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
@@ -5455,6 +6047,14 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 									argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
 
 									setData.clear();
+
+									if ( setLayoutInfo->is_bindless ) {
+										// The bindless set is updated once per frame, and
+										// needs no per-draw descriptor data.
+										argumentState.bindlessSetMask |= ( 1u << setId );
+										continue;
+									}
+
 									setData.reserve( setLayoutInfo->binding_info.size() );
 
 									for ( auto b : setLayoutInfo->binding_info ) {
@@ -5535,6 +6135,7 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 								// -- reset dynamic offset count
 								argumentState.dynamicOffsetCount = 0;
+								argumentState.bindlessSetMask    = 0;
 
 								// let's create descriptorData vector based on current bindings-
 								for ( size_t setId = 0; setId != argumentState.setCount; ++setId ) {
@@ -5550,6 +6151,14 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 									argumentState.updateTemplates[ setId ] = setLayoutInfo->vk_descriptor_update_template;
 
 									setData.clear();
+
+									if ( setLayoutInfo->is_bindless ) {
+										// The bindless set is updated once per frame, and
+										// needs no per-draw descriptor data.
+										argumentState.bindlessSetMask |= ( 1u << setId );
+										continue;
+									}
+
 									setData.reserve( setLayoutInfo->binding_info.size() );
 
 									for ( auto b : setLayoutInfo->binding_info ) {
@@ -5707,6 +6316,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 					} break;
 					case le::CommandType::eBufferMemoryBarrier: {
+						// Buffer barriers are not recorded immediately: consecutive buffer barriers
+						// are batched, and recorded together, just before the next command which is
+						// not a buffer barrier.
 						auto*                  le_cmd = static_cast<le::CommandBufferMemoryBarrier*>( dataIt );
 						VkBufferMemoryBarrier2 bufferMemoryBarrier{
 						    .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
@@ -5722,23 +6334,32 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 						    .size                = le_cmd->info.range,
 						};
 
-						VkDependencyInfo dependency_info{
-						    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-						    .pNext                    = nullptr, // optional
-						    .dependencyFlags          = 0,       // optional
-						    .memoryBarrierCount       = 0,       // optional
-						    .pMemoryBarriers          = 0,
-						    .bufferMemoryBarrierCount = 1, // optional
-						    .pBufferMemoryBarriers    = &bufferMemoryBarrier,
-						    .imageMemoryBarrierCount  = 0, // optional
-						    .pImageMemoryBarriers     = 0,
-						};
-
-						vkCmdPipelineBarrier2( cmd, &dependency_info );
+						frame_add_buffer_barrier( frame, bufferMemoryBarrier, barrier_stats );
 
 					} break;
-					case le::CommandType::eDraw: {
-						auto* le_cmd = static_cast<le::CommandDraw*>( dataIt );
+					case le::CommandType::eDraw:
+					case le::CommandType::eDrawCompact: {
+
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
+
+						uint32_t vertexCount   = 0;
+						uint32_t instanceCount = 1;
+						uint32_t firstVertex   = 0;
+						uint32_t firstInstance = 0;
+
+						if ( header->info.type == le::CommandType::eDrawCompact ) {
+							auto* le_cmd = static_cast<le::CommandDrawCompact*>( dataIt );
+							vertexCount  = le_cmd->info.vertexCount;
+							firstVertex  = le_cmd->info.firstVertex;
+						} else {
+							auto* le_cmd  = static_cast<le::CommandDraw*>( dataIt );
+							vertexCount   = le_cmd->info.vertexCount;
+							instanceCount = le_cmd->info.instanceCount;
+							firstVertex   = le_cmd->info.firstVertex;
+							firstInstance = le_cmd->info.firstInstance;
+						}
 
 						// -- update descriptorsets via template if tainted
 						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
@@ -5762,11 +6383,34 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 							    argumentState.dynamicOffsets.data() );
 						}
 
-						vkCmdDraw( cmd, le_cmd->info.vertexCount, le_cmd->info.instanceCount, le_cmd->info.firstVertex, le_cmd->info.firstInstance );
+						vkCmdDraw( cmd, vertexCount, instanceCount, firstVertex, firstInstance );
 					} break;
 
-					case le::CommandType::eDrawIndexed: {
-						auto* le_cmd = static_cast<le::CommandDrawIndexed*>( dataIt );
+					case le::CommandType::eDrawIndexed:
+					case le::CommandType::eDrawIndexedCompact: {
+
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
+
+						uint32_t indexCount    = 0;
+						uint32_t instanceCount = 1;
+						uint32_t firstIndex    = 0;
+						int32_t  vertexOffset  = 0;
+						uint32_t firstInstance = 0;
+
+						if ( header->info.type == le::CommandType::eDrawIndexedCompact ) {
+							auto* le_cmd = static_cast<le::CommandDrawIndexedCompact*>( dataIt );
+							indexCount   = le_cmd->info.indexCount;
+							firstIndex   = le_cmd->info.firstIndex;
+						} else {
+							auto* le_cmd  = static_cast<le::CommandDrawIndexed*>( dataIt );
+							indexCount    = le_cmd->info.indexCount;
+							instanceCount = le_cmd->info.instanceCount;
+							firstIndex    = le_cmd->info.firstIndex;
+							vertexOffset  = le_cmd->info.vertexOffset;
+							firstInstance = le_cmd->info.firstInstance;
+						}
 
 						// -- update descriptorsets via template if tainted
 						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
@@ -5790,16 +6434,13 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 							    argumentState.dynamicOffsets.data() );
 						}
 
-						vkCmdDrawIndexed(
-						    cmd,
-						    le_cmd->info.indexCount,
-						    le_cmd->info.instanceCount,
-						    le_cmd->info.firstIndex,
-						    le_cmd->info.vertexOffset,
-						    le_cmd->info.firstInstance );
+						vkCmdDrawIndexed( cmd, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance );
 					} break;
 
 					case le::CommandType::eDrawMeshTasks: {
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
 						auto* le_cmd = static_cast<le::CommandDrawMeshTasks*>( dataIt );
 
 						// -- update descriptorsets via template if tainted
@@ -5826,6 +6467,71 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 						vkCmdDrawMeshTasksNV( cmd, le_cmd->info.taskCount, le_cmd->info.firstTask );
 					} break;
 
+					case le::CommandType::eDrawIndirect:
+					case le::CommandType::eDrawIndexedIndirect:
+					case le::CommandType::eDrawIndexedIndirectCount: {
+
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
+
+						// -- update descriptorsets via template if tainted
+						bool argumentsOk = updateArguments( device, descriptorPool, argumentState, previousSetState, descriptorSets );
+
+						if ( false == argumentsOk ) {
+							break;
+						}
+
+						// --------| invariant: arguments were updated successfully
+
+						if ( argumentState.setCount > 0 ) {
+
+							vkCmdBindDescriptorSets(
+							    cmd,
+							    VK_PIPELINE_BIND_POINT_GRAPHICS,
+							    currentPipelineLayout,
+							    0,
+							    argumentState.setCount,
+							    descriptorSets,
+							    argumentState.dynamicOffsetCount,
+							    argumentState.dynamicOffsets.data() );
+						}
+
+						// Without the multiDrawIndirect feature, drawCount must be 0, or 1 - we split multi-draws into single draws.
+						static bool const has_multi_draw = []() {
+							bool multi_draw = false;
+							le_backend_vk::settings_i.get_indirect_draw_features( &multi_draw, nullptr );
+							return multi_draw;
+						}();
+
+						if ( header->info.type == le::CommandType::eDrawIndirect ) {
+							auto*    le_cmd = static_cast<le::CommandDrawIndirect*>( dataIt );
+							VkBuffer buffer = frame_data_get_buffer_from_le_resource_id( frame, le_cmd->info.buffer );
+							if ( has_multi_draw ) {
+								vkCmdDrawIndirect( cmd, buffer, le_cmd->info.offset, le_cmd->info.drawCount, le_cmd->info.stride );
+							} else {
+								for ( uint32_t d = 0; d != le_cmd->info.drawCount; d++ ) {
+									vkCmdDrawIndirect( cmd, buffer, le_cmd->info.offset + uint64_t( d ) * le_cmd->info.stride, 1, le_cmd->info.stride );
+								}
+							}
+						} else if ( header->info.type == le::CommandType::eDrawIndexedIndirect ) {
+							auto*    le_cmd = static_cast<le::CommandDrawIndexedIndirect*>( dataIt );
+							VkBuffer buffer = frame_data_get_buffer_from_le_resource_id( frame, le_cmd->info.buffer );
+							if ( has_multi_draw ) {
+								vkCmdDrawIndexedIndirect( cmd, buffer, le_cmd->info.offset, le_cmd->info.drawCount, le_cmd->info.stride );
+							} else {
+								for ( uint32_t d = 0; d != le_cmd->info.drawCount; d++ ) {
+									vkCmdDrawIndexedIndirect( cmd, buffer, le_cmd->info.offset + uint64_t( d ) * le_cmd->info.stride, 1, le_cmd->info.stride );
+								}
+							}
+						} else {
+							auto*    le_cmd       = static_cast<le::CommandDrawIndexedIndirectCount*>( dataIt );
+							VkBuffer buffer       = frame_data_get_buffer_from_le_resource_id( frame, le_cmd->info.buffer );
+							VkBuffer count_buffer = frame_data_get_buffer_from_le_resource_id( frame, le_cmd->info.count_buffer );
+							vkCmdDrawIndexedIndirectCount( cmd, buffer, le_cmd->info.offset, count_buffer, le_cmd->info.count_buffer_offset, le_cmd->info.maxDrawCount, le_cmd->info.stride );
+						}
+					} break;
+
 					case le::CommandType::eSetLineWidth: {
 						auto* le_cmd = static_cast<le::CommandSetLineWidth*>( dataIt );
 						vkCmdSetLineWidth( cmd, le_cmd->info.width );
@@ -5846,6 +6552,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 					} break;
 
 					case le::CommandType::eSetPushConstantData: {
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
 						if ( currentPipelineLayout ) {
 							auto*              le_cmd               = static_cast<le::CommandSetPushConstantData*>( dataIt );
 							VkShaderStageFlags active_shader_stages = VkShaderStageFlags( currentPipeline.layout_info.active_vk_shader_stages );
@@ -5855,6 +6564,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 					}
 
 					case le::CommandType::eBindArgumentBuffer: {
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
 						// we need to store the data for the dynamic binding which was set as an argument to the ubo
 						// this alters our internal state
 						auto* le_cmd = static_cast<le::CommandBindArgumentBuffer*>( dataIt );
@@ -5921,6 +6633,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 					} break;
 
 					case le::CommandType::eSetArgumentTexture: {
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
 						auto*    le_cmd           = static_cast<le::CommandSetArgumentTexture*>( dataIt );
 						uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
@@ -5982,6 +6697,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 					} break;
 
 					case le::CommandType::eSetArgumentImage: {
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
 						auto*    le_cmd           = static_cast<le::CommandSetArgumentImage*>( dataIt );
 						uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
@@ -6030,6 +6748,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 
 					} break;
 					case le::CommandType::eSetArgumentTlas: {
+						if ( isGraphicsPipelinePending ) {
+							break; // skip, as pipeline is not ready
+						}
 						auto*    le_cmd           = static_cast<le::CommandSetArgumentTlas*>( dataIt );
 						uint64_t argument_name_id = le_cmd->info.argument_name_id;
 
@@ -6186,32 +6907,29 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 							    .image               = dstImage,
 							    .subresourceRange    = rangeAllRemainingMiplevels,
 							};
-							VkDependencyInfo dependency_info{
-							    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-							    .pNext                    = nullptr,
-							    .dependencyFlags          = 0,
-							    .memoryBarrierCount       = 0,
-							    .pMemoryBarriers          = 0,
-							    .bufferMemoryBarrierCount = 1,
-							    .pBufferMemoryBarriers    = &bufferTransferBarrier,
-							    .imageMemoryBarrierCount  = 1,
-							    .pImageMemoryBarriers     = &imageLayoutToTransferDstOptimal,
-							};
 
-							vkCmdPipelineBarrier2( cmd, &dependency_info );
+							// The batch may still hold barriers from previous commands - typically the transition to
+							// shader read of a previous writeToImage - we record these together with our barriers.
+							if ( frame_has_batched_image_barrier( frame, dstImage ) ) {
+								frame_flush_barriers( frame, cmd, barrier_stats );
+							}
+
+							frame_add_buffer_barrier( frame, bufferTransferBarrier, barrier_stats );
+							frame.scratch_image_barriers.push_back( imageLayoutToTransferDstOptimal );
+							frame_flush_barriers( frame, cmd, barrier_stats );
 						}
 
 						{
-							// Copy data for first mip level from buffer to image.
+							// Copy data for target mip level from buffer to image.
 							//
-							// Then use the first mip level as a source for subsequent mip levels.
+							// Then use the target mip level as a source for subsequent mip levels.
 							// When copying from a lower mip level to a higher mip level, we must make
 							// sure to add barriers, as these blit operations are transfers.
 							//
 
 							VkImageSubresourceLayers imageSubresourceLayers{
 							    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-							    .mipLevel       = 0,
+							    .mipLevel       = le_cmd->info.dst_miplevel,
 							    .baseArrayLayer = le_cmd->info.dst_array_layer,
 							    .layerCount     = 1,
 							};
@@ -6264,19 +6982,8 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 								    .subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, base_miplevel, 1, 0, 1 },
 								};
 
-								VkDependencyInfo dependency_info{
-								    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-								    .pNext                    = nullptr,
-								    .dependencyFlags          = 0,
-								    .memoryBarrierCount       = 0,
-								    .pMemoryBarriers          = 0,
-								    .bufferMemoryBarrierCount = 0,
-								    .pBufferMemoryBarriers    = 0,
-								    .imageMemoryBarrierCount  = 1,
-								    .pImageMemoryBarriers     = &prepareBlit,
-								};
-
-								vkCmdPipelineBarrier2( cmd, &dependency_info );
+								frame.scratch_image_barriers.push_back( prepareBlit );
+								frame_flush_barriers( frame, cmd, barrier_stats );
 							}
 							// Now blit from the srcMipLevel to dstMipLevel
 
@@ -6334,19 +7041,8 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
                                         },
 									};
 
-									VkDependencyInfo dependency_info{
-									    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-									    .pNext                    = nullptr,
-									    .dependencyFlags          = 0,
-									    .memoryBarrierCount       = 0,
-									    .pMemoryBarriers          = 0,
-									    .bufferMemoryBarrierCount = 0,
-									    .pBufferMemoryBarriers    = 0,
-									    .imageMemoryBarrierCount  = 1,
-									    .pImageMemoryBarriers     = &finishBlit,
-									};
-
-									vkCmdPipelineBarrier2( cmd, &dependency_info );
+									frame.scratch_image_barriers.push_back( finishBlit );
+									frame_flush_barriers( frame, cmd, barrier_stats );
 								}
 
 								// Store this miplevel image's dimensions for next iteration
@@ -6400,19 +7096,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 								;
 							}
 
-							VkDependencyInfo dependency_info{
-							    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-							    .pNext                    = nullptr,
-							    .dependencyFlags          = 0,
-							    .memoryBarrierCount       = 0,
-							    .pMemoryBarriers          = 0,
-							    .bufferMemoryBarrierCount = 0,
-							    .pBufferMemoryBarriers    = 0,
-							    .imageMemoryBarrierCount  = 1,
-							    .pImageMemoryBarriers     = &imageLayoutToShaderReadOptimal,
-							};
-
-							vkCmdPipelineBarrier2( cmd, &dependency_info ); // images: prepare for shader read
+							// images: prepare for shader read - we don't record this barrier right away: it stays in the batch,
+							// so that it may be recorded together with the barriers of the next command.
+							frame.scratch_image_barriers.push_back( imageLayoutToShaderReadOptimal );
 						}
 
 						break;
@@ -6557,19 +7243,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 								    .dstStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // before the next acceleration build stage
 								    .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,          // memory which has been previously written (and made available) must be visible after the barrier
 								};
-								VkDependencyInfo dependency_info = {
-								    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-								    .pNext                    = nullptr, // optional
-								    .dependencyFlags          = 0,       // optional
-								    .memoryBarrierCount       = 1,       // optional
-								    .pMemoryBarriers          = &barrier,
-								    .bufferMemoryBarrierCount = 0, // optional
-								    .pBufferMemoryBarriers    = 0,
-								    .imageMemoryBarrierCount  = 0,
-								    .pImageMemoryBarriers     = 0,
-								};
 
-								vkCmdPipelineBarrier2( cmd, &dependency_info );
+								frame.scratch_memory_barriers.push_back( barrier );
+								frame_flush_barriers( frame, cmd, barrier_stats );
 							}
 
 						} // end for each blas element in array
@@ -6616,18 +7292,9 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 							    .dstStageMask  = VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // acceleration structure build must happen-after barrier
 							    .dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,         // and memory must have been made visible to acceleration structure write
 							};
-							VkDependencyInfo dependency_info = {
-							    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-							    .pNext                    = nullptr, // optional
-							    .dependencyFlags          = 0,       // optional
-							    .memoryBarrierCount       = 1,       // optional
-							    .pMemoryBarriers          = &barrier,
-							    .bufferMemoryBarrierCount = 0, // optional
-							    .pBufferMemoryBarriers    = 0,
-							    .imageMemoryBarrierCount  = 0, // optional
-							    .pImageMemoryBarriers     = 0,
-							};
-							vkCmdPipelineBarrier2( cmd, &dependency_info );
+
+							frame.scratch_memory_barriers.push_back( barrier );
+							frame_flush_barriers( frame, cmd, barrier_stats );
 						}
 
 						// instances information is encoded via buffer, but that buffer is also available as host memory,
@@ -6706,12 +7373,15 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 					}
 					} // end switch header.info.type
 
-					// Move iterator by size of current le_command so that it points
+					// Move reader by size of current le_command so that it points
 					// to the next command in the list.
-					dataIt = static_cast<char*>( dataIt ) + header->info.size;
+					commandReader.advance( header->info.size );
 
 					++commandIndex;
 				}
+
+				// Record any barriers which were batched at the very end of the command stream.
+				frame_flush_barriers( frame, cmd, barrier_stats );
 			}
 
 			// non-draw passes don't need renderpasses.
@@ -6723,9 +7393,23 @@ static void backend_process_frame( le_backend_o* self, size_t frameIndex ) {
 				vkCmdEndDebugUtilsLabelEXT( cmd );
 			}
 
+			if ( should_write_timestamps ) {
+				vkCmdWriteTimestamp2( cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, frame.timestampQueryPool, passIndex * 2 + 1 );
+			}
+
 			vkEndCommandBuffer( cmd );
 		}
 	}
+
+	{
+		auto lock          = std::scoped_lock( self->pass_timings_mutex );
+		frame.barrierStats = barrier_stats;
+	}
+
+	if ( LE_PRINT_DEBUG_MESSAGES ) {
+		logger.info( "Barriers emitted: %d, elided: %d, batches: %d",
+		             barrier_stats.barriers_emitted, barrier_stats.barriers_elided, barrier_stats.barrier_batches );
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -6769,6 +7453,47 @@ static le_pipeline_manager_o* backend_get_pipeline_cache( le_backend_o* self ) {
 	return self->pipelineCache;
 }
 
+// ----------------------------------------------------------------------
+// Copies gpu timings for all timed passes which were harvested when the frame
+// at `frameIndex` was last cleared. Timings remain available until the same
+// frame gets cleared again.
+static bool backend_get_pass_timings( le_backend_o* self, size_t frameIndex, le_pass_timing_t* timings, uint32_t* count ) {
+
+	assert( frameIndex < self->mFrames.size() );
+
+	auto        lock        = std::scoped_lock( self->pass_timings_mutex );
+	auto const& frame       = self->mFrames[ frameIndex ];
+	uint32_t    num_timings = uint32_t( frame.passTimings.size() );
+
+	if ( timings == nullptr ) {
+		*count = num_timings;
+		return true;
+	}
+
+	if ( *count < num_timings ) {
+		*count = num_timings;
+		return false;
+	}
+
+	// ---------| invariant: there is enough space in timings to hold all available timings
+
+	memcpy( timings, frame.passTimings.data(), sizeof( le_pass_timing_t ) * num_timings );
+	*count = num_timings;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Copies barrier counts which were gathered when the frame at `frameIndex`
+// was last processed.
+static void backend_get_barrier_stats( le_backend_o* self, size_t frameIndex, le_barrier_stats_t* stats ) {
+
+	assert( frameIndex < self->mFrames.size() );
+
+	auto lock = std::scoped_lock( self->pass_timings_mutex );
+	*stats    = self->mFrames[ frameIndex ].barrierStats;
+}
+
 // ----------------------------------------------------------------------
 // Return a pointer to a queue info structure holding the queue
 // which we use for default graphics operations. This is also
@@ -7039,7 +7764,7 @@ static void backend_emit_queue_sync_dot_file( le_backend_o const* backend, uint6
 
 // ----------------------------------------------------------------------
 // we wrap queue submissions so that we can log all parameters for a queue submission.
-static void backend_queue_submit( BackendQueueInfo* queue, uint32_t submission_count, VkSubmitInfo2 const* submitInfo, VkFence fence, bool should_generate_dot_files, std::string const& debug_info ) {
+static void backend_queue_submit( BackendQueueInfo* queue, uint32_t submission_count, VkSubmitInfo2 const* submitInfo, VkFence fence, bool should_generate_dot_files, char const* debug_info ) {
 
 	if ( should_generate_dot_files ) {
 
@@ -7101,15 +7826,10 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 	static auto logger = LeLog( LOGGER_LABEL );
 	auto&       frame  = self->mFrames[ frameIndex ];
 
-	struct ownership_transfer_t {
-		le_resource_handle    resource;
-		uint32_t              src_queue_family_index;
-		uint32_t              dst_queue_family_index;
-		std::vector<uint32_t> dst_queue_index;
-	};
+	auto& queue_ownership_transfers = frame.scratch_ownership_transfers; // note that the transfer must happen on both queues - first release, then acquire.
+	bool  must_wait_for_acquire     = false;                             /// signals whether multiple queues of the same family await a resoruce to become acquired
 
-	std::unordered_map<le_resource_handle, ownership_transfer_t> queue_ownership_transfers;     // note that the transfer must happen on both queues - first release, then acquire.
-	bool                                                         must_wait_for_acquire = false; /// signals whether multiple queues of the same family await a resoruce to become acquired
+	queue_ownership_transfers.clear();
 
 	// For all resources test if family ownership matches
 	// since we last used this resource - if not, change it, and note the change.
@@ -7270,15 +7990,11 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 		}
 	}
 
-	struct Barriers {
-		std::unordered_map<le_resource_handle, VkImageMemoryBarrier2>  img_barriers;       // we use a map here because there an only be one barrier per-resource
-		std::unordered_map<le_resource_handle, VkBufferMemoryBarrier2> buf_barriers;       // --"--
-		std::set<uint32_t>                                             src_family_indices; // which release queues this queue must wait for - only used for acquire barriers
-		std::set<uint32_t>                                             wait_queue_indices; // which acquire queues this queue must wait for - only used for acquire barriers
-	};
+	auto& release_barriers = frame.scratch_release_barriers; // map from queue family index to release barrier
+	auto& acquire_barriers = frame.scratch_acquire_barriers; // map from queue to acquire barrier
 
-	std::unordered_map<uint32_t, Barriers> release_barriers; // map from queue family index to release barrier
-	std::unordered_map<uint32_t, Barriers> acquire_barriers; // map from queue to acquire barrier
+	release_barriers.clear();
+	acquire_barriers.clear();
 
 	// Group all release barriers together by queue family,
 	// and group all acquire barriers together by queue
@@ -7334,21 +8050,26 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 			assert( false && "unexpected resource type" );
 		}
 		// store src family index with acquire barrier - so that these barriers know which timeline semaphores to wait for.
-		acquire_barriers[ transfer.dst_queue_index[ 0 ] ].src_family_indices.emplace( transfer.src_queue_family_index );
+		auto& src_family_indices = acquire_barriers[ transfer.dst_queue_index[ 0 ] ].src_family_indices;
+		if ( std::find( src_family_indices.begin(), src_family_indices.end(), transfer.src_queue_family_index ) == src_family_indices.end() ) {
+			src_family_indices.push_back( transfer.src_queue_family_index );
+		}
 	}
 
+	le_barrier_stats_t ownership_transfer_stats{}; // counts for release, and acquire barriers
+
 	// ----------------------------------------------------------------------
 	// Record and submit all release actions into command buffers which match queue family
 	//
 	for ( auto& rb : release_barriers ) {
 
-		std::vector<VkBufferMemoryBarrier2> buffer_barriers;
-		buffer_barriers.reserve( rb.second.buf_barriers.size() );
+		auto& buffer_barriers = frame.scratch_transfer_buffer_barriers;
+		buffer_barriers.clear();
 		for ( auto const& b : rb.second.buf_barriers ) {
 			buffer_barriers.push_back( b.second );
 		}
-		std::vector<VkImageMemoryBarrier2> image_barriers;
-		image_barriers.reserve( rb.second.img_barriers.size() );
+		auto& image_barriers = frame.scratch_transfer_image_barriers;
+		image_barriers.clear();
 		for ( auto const& b : rb.second.img_barriers ) {
 			image_barriers.push_back( b.second );
 		}
@@ -7375,6 +8096,9 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 		vkCmdPipelineBarrier2( cmd, &dependencyInfo );
 		vkEndCommandBuffer( cmd );
 
+		ownership_transfer_stats.barriers_emitted += dependencyInfo.bufferMemoryBarrierCount + dependencyInfo.imageMemoryBarrierCount;
+		ownership_transfer_stats.barrier_batches++;
+
 		auto& queue = self->queues[ queue_index ];
 
 		VkCommandBufferSubmitInfo cmdSubmitInfo{
@@ -7416,13 +8140,13 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 	// each acquire submission waits for any release actions that it depends on.
 
 	for ( auto& ab : acquire_barriers ) {
-		std::vector<VkBufferMemoryBarrier2> buffer_barriers;
-		buffer_barriers.reserve( ab.second.buf_barriers.size() );
+		auto& buffer_barriers = frame.scratch_transfer_buffer_barriers;
+		buffer_barriers.clear();
 		for ( auto const& b : ab.second.buf_barriers ) {
 			buffer_barriers.push_back( b.second );
 		}
-		std::vector<VkImageMemoryBarrier2> image_barriers;
-		image_barriers.reserve( ab.second.img_barriers.size() );
+		auto& image_barriers = frame.scratch_transfer_image_barriers;
+		image_barriers.clear();
 		for ( auto const& b : ab.second.img_barriers ) {
 			image_barriers.push_back( b.second );
 		}
@@ -7450,6 +8174,9 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 		vkCmdPipelineBarrier2( cmd, &dependencyInfo );
 		vkEndCommandBuffer( cmd );
 
+		ownership_transfer_stats.barriers_emitted += dependencyInfo.bufferMemoryBarrierCount + dependencyInfo.imageMemoryBarrierCount;
+		ownership_transfer_stats.barrier_batches++;
+
 		auto& queue = self->queues[ queue_index ];
 
 		VkCommandBufferSubmitInfo cmdSubmitInfo{
@@ -7460,7 +8187,8 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 		};
 
 		// We want to signal a timeline semaphore for each queue submission so that any batch submitted to a queue can be waited upon
-		std::vector<VkSemaphoreSubmitInfo> wait_semaphore_timeline_complete;
+		auto& wait_semaphore_timeline_complete = frame.scratch_submission_waits;
+		wait_semaphore_timeline_complete.clear();
 
 		for ( auto& wait : ab.second.src_family_indices ) {
 
@@ -7506,6 +8234,14 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 		}
 	}
 
+	{
+		// Release, and acquire barriers are recorded after process_frame has published its barrier
+		// counts for this frame - we add ours to these.
+		auto lock = std::scoped_lock( self->pass_timings_mutex );
+		frame.barrierStats.barriers_emitted += ownership_transfer_stats.barriers_emitted;
+		frame.barrierStats.barrier_batches += ownership_transfer_stats.barrier_batches;
+	}
+
 	// We increase the semaphore wait values for all queues that did have an acquire step,
 	// so that acquire operations don't wait for each other - we know that acquire steps
 	// don't depend on each other because all that acquires have to wait for is any release.
@@ -7528,7 +8264,8 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 	//
 	if ( must_wait_for_acquire ) {
 
-		std::unordered_map<uint32_t, std::set<uint32_t>> per_queue_wait_for_queues;
+		auto& per_queue_wait_for_queues = frame.scratch_per_queue_wait_for_queues;
+		per_queue_wait_for_queues.clear();
 
 		// First, we group wait operations by queue, so that we only need to issue one sync op per
 		// queue.
@@ -7540,17 +8277,21 @@ static void backend_submit_queue_transfer_ops( le_backend_o* self, size_t frameI
 				for ( uint32_t i = 1; i != transfer.dst_queue_index.size(); i++ ) {
 					// each of the dependent queues must wait for the primary queue
 					if ( wait_for_queue_idx != transfer.dst_queue_index[ i ] ) {
-						per_queue_wait_for_queues[ transfer.dst_queue_index[ i ] ].emplace( wait_for_queue_idx );
+						auto& waits_for_queues = per_queue_wait_for_queues[ transfer.dst_queue_index[ i ] ];
+						if ( std::find( waits_for_queues.begin(), waits_for_queues.end(), wait_for_queue_idx ) == waits_for_queues.end() ) {
+							waits_for_queues.push_back( wait_for_queue_idx );
+						}
 					}
 				}
 			}
 		}
 
 		for ( auto const& per_queue_wait : per_queue_wait_for_queues ) {
-			uint32_t                  queue_idx        = per_queue_wait.first;
-			std::set<uint32_t> const& waits_for_queues = per_queue_wait.second;
+			uint32_t                     queue_idx        = per_queue_wait.first;
+			std::vector<uint32_t> const& waits_for_queues = per_queue_wait.second;
 
-			std::vector<VkSemaphoreSubmitInfo> wait_semaphore_acquire_complete;
+			auto& wait_semaphore_acquire_complete = frame.scratch_submission_waits;
+			wait_semaphore_acquire_complete.clear();
 
 			for ( auto& wait_for_queue : waits_for_queues ) {
 
@@ -7600,11 +8341,11 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 		backend_submit_queue_transfer_ops( self, frameIndex, frame.must_create_queues_dot_graph );
 	}
 
-	std::vector<VkSemaphoreSubmitInfo> wait_present_complete_semaphore_submit_infos;
-	std::vector<VkSemaphoreSubmitInfo> render_complete_semaphore_submit_infos;
+	auto& wait_present_complete_semaphore_submit_infos = frame.scratch_present_complete_waits;
+	auto& render_complete_semaphore_submit_infos       = frame.scratch_render_complete_signals;
 
-	wait_present_complete_semaphore_submit_infos.reserve( frame.frame_owned_swapchain_state.size() );
-	render_complete_semaphore_submit_infos.reserve( frame.frame_owned_swapchain_state.size() );
+	wait_present_complete_semaphore_submit_infos.clear();
+	render_complete_semaphore_submit_infos.clear();
 
 	{
 		ZoneScopedN( "ApplyWaitSemaphores" );
@@ -7649,12 +8390,41 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 		backend_queue_submit( self->queues[ self->queue_default_graphics_idx ], 1, &submitInfo, nullptr, frame.must_create_queues_dot_graph, "wait_present_complete" );
 	}
 
+	// If there is more than one queue, submissions in this frame may run on different queues - for
+	// example, isolated compute-only subgraphs may run on an async compute queue, while the rest of
+	// the frame runs on the default graphics queue.
+	//
+	// Submissions within the same frame are independent of each other (they were split
+	// into separate submissions because their subgraphs are isolated), and may overlap.
+	//
+	// Submissions of this frame must not overlap with work from previous frames on other queues,
+	// however, as they may read what earlier frames wrote. We therefore make each submission wait
+	// for the timeline semaphores of all other queues, at the values these semaphores have been
+	// signalled up to before this frame's submissions.
+	auto& cross_queue_wait_semaphores = frame.scratch_cross_queue_waits;
+	cross_queue_wait_semaphores.clear();
+
+	if ( self->queues.size() > 1 ) {
+		for ( auto const& q : self->queues ) {
+			cross_queue_wait_semaphores.push_back( {
+			    .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			    .pNext       = nullptr,
+			    .semaphore   = q->semaphore,
+			    .value       = q->semaphore_wait_value, // highest value signalled by submissions before this frame
+			    .stageMask   = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			    .deviceIndex = 0,
+			} );
+		}
+	}
+
+	auto& submission_wait_semaphores  = frame.scratch_submission_waits;
+	auto& command_buffer_submit_infos = frame.scratch_command_buffer_submit_infos;
+
 	for ( auto const& current_submission : frame.queue_submission_data ) {
 
 		ZoneScopedN( "SubmitToQueue" );
-		// Prepare command buffers for submission
-		std::vector<VkCommandBufferSubmitInfo> command_buffer_submit_infos;
-		command_buffer_submit_infos.reserve( current_submission.command_pool->buffers.size() ); // one command buffer per pass
+		// Prepare command buffers for submission - one command buffer per pass
+		command_buffer_submit_infos.clear();
 
 		for ( auto const& c : current_submission.command_pool->buffers ) {
 			command_buffer_submit_infos.push_back(
@@ -7666,6 +8436,15 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 			    } );
 		}
 
+		// Wait for work from earlier frames on all other queues - there is no need to wait for
+		// earlier work on our own queue, as submission order takes care of this.
+		submission_wait_semaphores.clear();
+		for ( size_t i = 0; i != cross_queue_wait_semaphores.size(); i++ ) {
+			if ( i != current_submission.queue_idx && cross_queue_wait_semaphores[ i ].value != 0 ) {
+				submission_wait_semaphores.push_back( cross_queue_wait_semaphores[ i ] );
+			}
+		}
+
 		// We want to signal a timeline semaphore for each queue submission so that any batch submitted to a queue can be waited upon
 		VkSemaphoreSubmitInfo signal_semaphore_timeline_complete = {
 		    .sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
@@ -7680,8 +8459,8 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 		    .sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
 		    .pNext                    = nullptr,
 		    .flags                    = 0,
-		    .waitSemaphoreInfoCount   = 0,
-		    .pWaitSemaphoreInfos      = nullptr,
+		    .waitSemaphoreInfoCount   = uint32_t( submission_wait_semaphores.size() ),
+		    .pWaitSemaphoreInfos      = submission_wait_semaphores.data(),
 		    .commandBufferInfoCount   = uint32_t( command_buffer_submit_infos.size() ),
 		    .pCommandBufferInfos      = command_buffer_submit_infos.data(),
 		    .signalSemaphoreInfoCount = 1,
@@ -7690,7 +8469,12 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 
 		auto queue = self->queues[ current_submission.queue_idx ];
 
-		backend_queue_submit( queue, 1, &submitInfo, nullptr, frame.must_create_queues_dot_graph, " subgraph { " + current_submission.debug_root_passes_names + " }" );
+		if ( frame.must_create_queues_dot_graph ) {
+			std::string const label = " subgraph { " + current_submission.debug_root_passes_names + " }";
+			backend_queue_submit( queue, 1, &submitInfo, nullptr, true, label.c_str() );
+		} else {
+			backend_queue_submit( queue, 1, &submitInfo, nullptr, false, nullptr );
+		}
 	}
 
 	{
@@ -7711,7 +8495,9 @@ static bool backend_dispatch_frame( le_backend_o* self, size_t frameIndex ) {
 		/// If submitted on the same queue, Queue submission order means that batch 1 needs to complete before batch 2
 		/// -- see VkSpec 7.2 (Implicit Synchronization Guarantees)
 
-		std::vector<VkSemaphoreSubmitInfo> timeline_wait_semaphores;
+		// We may re-use cross queue wait semaphores, as all submissions have been issued.
+		auto& timeline_wait_semaphores = frame.scratch_cross_queue_waits;
+		timeline_wait_semaphores.clear();
 
 		for ( uint32_t i = 0; i != self->queues.size(); i++ ) {
 			timeline_wait_semaphores.push_back( {
@@ -7865,12 +8651,15 @@ LE_MODULE_REGISTER_IMPL( le_backend_vk, api_ ) {
 	vk_backend_i.destroy                         = backend_destroy;
 	vk_backend_i.setup                           = backend_setup;
 	vk_backend_i.get_data_frames_count           = backend_get_data_frames_count;
+	vk_backend_i.get_pass_timings                = backend_get_pass_timings;
+	vk_backend_i.get_barrier_stats               = backend_get_barrier_stats;
 	vk_backend_i.get_transient_allocators        = backend_get_transient_allocators;
 	vk_backend_i.get_staging_allocator           = backend_get_staging_allocator;
 	vk_backend_i.get_frame_command_streams       = backend_get_frame_command_streams;
 	vk_backend_i.poll_frame_fence                = backend_poll_frame_fence;
 	vk_backend_i.clear_frame                     = backend_clear_frame;
 	vk_backend_i.acquire_physical_resources      = backend_acquire_physical_resources;
+	vk_backend_i.release_physical_resources      = backend_release_physical_resources;
 	vk_backend_i.process_frame                   = backend_process_frame;
 	vk_backend_i.dispatch_frame                  = backend_dispatch_frame;
 	vk_backend_i.set_frame_queue_submission_keys = backend_set_frame_queue_submission_keys;
@@ -7886,6 +8675,7 @@ LE_MODULE_REGISTER_IMPL( le_backend_vk, api_ ) {
 	vk_backend_i.get_swapchain_resource_default = backend_get_swapchain_resource_default;
 	vk_backend_i.get_swapchains_infos           = backend_get_swapchains_infos;
 	vk_backend_i.get_swapchains                 = backend_get_swapchains;
+	vk_backend_i.get_swapchain_image_count      = backend_get_swapchain_image_count;
 	vk_backend_i.acquire_swapchain_resources    = backend_acquire_swapchain_resources;
 
 	vk_backend_i.create_rtx_blas_info = backend_create_rtx_blas_info;
@@ -7931,6 +8721,10 @@ LE_MODULE_REGISTER_IMPL( le_backend_vk, api_ ) {
 	backend_settings_i.set_concurrency_count                        = le_backend_vk_settings_set_concurrency_count;
 	backend_settings_i.get_requested_queue_capabilities             = le_backend_vk_settings_get_requested_queue_capabilities;
 	backend_settings_i.set_requested_queue_capabilities             = le_backend_vk_settings_set_requested_queue_capabilities;
+	backend_settings_i.set_bindless_descriptor_counts               = le_backend_vk_settings_set_bindless_descriptor_counts;
+	backend_settings_i.get_bindless_descriptor_counts               = le_backend_vk_settings_get_bindless_descriptor_counts;
+	backend_settings_i.set_indirect_draw_features                   = le_backend_vk_settings_set_indirect_draw_features;
+	backend_settings_i.get_indirect_draw_features                   = le_backend_vk_settings_get_indirect_draw_features;
 	backend_settings_i.set_data_frames_count                        = le_backend_vk_settings_set_data_frames_count;
 
 	void** p_settings_singleton_addr = le_core_produce_dictionary_entry( hash_64_fnv1a_const( "backend_api_settings_singleton" ) );
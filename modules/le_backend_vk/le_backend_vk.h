@@ -24,6 +24,18 @@ struct le_pipeline_manager_o;
 constexpr uint8_t LE_MAX_BOUND_DESCRIPTOR_SETS = 8;
 constexpr uint8_t LE_MAX_COLOR_ATTACHMENTS     = 16; // maximum number of color attachments to a renderpass
 
+// Bindless descriptors: shaders which declare arguments with the following names all share a single,
+// backend-owned descriptor set, which gets updated once per frame, and which shaders index by integer:
+//
+//     layout (set = N, binding = 0) uniform sampler2D le_bindless_textures[];
+//     layout (set = N, binding = 1) readonly buffer LeBindlessBuffer { ... } le_bindless_buffers[];
+//
+// Bindless descriptors must be enabled via settings before backend setup. Stable indices for textures
+// and buffers are handed out by the pipeline manager, and via command buffer encoders.
+constexpr uint32_t LE_BINDLESS_INDEX_INVALID          = uint32_t( ~0 );
+constexpr char     LE_BINDLESS_TEXTURES_ARGUMENT_NAME[] = "le_bindless_textures";
+constexpr char     LE_BINDLESS_BUFFERS_ARGUMENT_NAME[]  = "le_bindless_buffers";
+
 struct graphics_pipeline_state_o; // for le_pipeline_builder
 struct compute_pipeline_state_o;  // for le_pipeline_builder
 struct rtx_pipeline_state_o;      // for le_pipeline_builder
@@ -38,6 +50,7 @@ LE_OPAQUE_HANDLE( le_img_resource_handle );
 LE_OPAQUE_HANDLE( le_buf_resource_handle );
 LE_OPAQUE_HANDLE( le_tlas_resource_handle );
 LE_OPAQUE_HANDLE( le_blas_resource_handle );
+LE_OPAQUE_HANDLE( le_texture_handle ); // defined in renderer_types
 
 LE_OPAQUE_HANDLE( le_cpso_handle );
 LE_OPAQUE_HANDLE( le_cpso_handle );
@@ -63,6 +76,8 @@ struct VkMemoryRequirements;
 struct VkMemoryAllocateInfo;
 struct VkSpecializationMapEntry;
 struct VkPhysicalDeviceFeatures2;
+struct VkRenderPassCreateInfo2;
+struct VkDescriptorSetLayout_T;
 
 struct VkFormatEnum;
 struct BackendRenderPass;
@@ -78,6 +93,7 @@ typedef VkFlags  VkQueueFlags;
 
 namespace le {
 enum class ShaderStageFlagBits : uint32_t;
+enum class SampleCountFlagBits : uint32_t;
 struct BuildAccelerationStructureFlagsKHR;
 } // namespace le
 
@@ -102,6 +118,30 @@ struct le_pipeline_and_layout_info_t {
 	le_pipeline_layout_info layout_info;
 };
 
+// GPU execution time for a single renderpass, measured via timestamp queries.
+struct le_pass_timing_t {
+	char     debug_name[ 64 ]; // debug name of renderpass, truncated if longer
+	uint64_t gpu_duration_ns;  // time between begin and end of pass on the GPU, in nanoseconds
+};
+
+// Pipeline barrier counts for a single frame, gathered while the backend recorded the
+// frame's command buffers. Counts cover explicit resource sync barriers issued at the
+// beginning of passes, barriers encoded into command streams, barriers for image uploads,
+// and acceleration structure builds, and queue family ownership transfer barriers.
+struct le_barrier_stats_t {
+	uint32_t barriers_emitted; // number of image or buffer memory barriers recorded into command buffers
+	uint32_t barriers_elided;  // number of barriers which were dropped as no-ops, or merged into another barrier
+	uint32_t barrier_batches;  // number of vkCmdPipelineBarrier2 calls used to record emitted barriers
+};
+
+// Identifies a graphics pipeline: a graphics pipeline state object, used
+// with any renderpass compatible with `renderpass_hash`, at subpass `subpass`.
+struct le_graphics_pipeline_key_t {
+	le_gpso_handle gpso;            // graphics pipeline state object
+	uint64_t       renderpass_hash; // hash over everything that contributes to renderpass compatibility
+	uint32_t       subpass;         // subpass index
+};
+
 struct le_backend_vk_api {
 
 	struct backend_vk_settings_interface_t // global settings for backend - must be set before backend setup- after that, settings are read-only.
@@ -115,6 +155,17 @@ struct le_backend_vk_api {
 
 		void ( *get_requested_queue_capabilities )( VkQueueFlags* queues, uint32_t* num_queues );
 		bool ( *set_requested_queue_capabilities )( VkQueueFlags* queues, uint32_t num_queues );
+
+		// Enables bindless descriptors, with space for the given number of textures and storage buffers.
+		// Returns false if settings are already readonly. Counts may get clamped to device limits.
+		bool ( *set_bindless_descriptor_counts )( uint32_t max_textures, uint32_t max_storage_buffers );
+		void ( *get_bindless_descriptor_counts )( uint32_t* max_textures, uint32_t* max_storage_buffers ); // both zero if bindless descriptors are disabled
+
+		// Requests optional device features for indirect draws - device creation fails if the device does not support them.
+		// multi_draw: multiDrawIndirect, and drawIndirectFirstInstance - without it, indirect multi-draws are split into single draws.
+		// draw_count: drawIndirectCount - without it, drawIndexedIndirectCount is rejected. Returns false if settings are already readonly.
+		bool ( *set_indirect_draw_features )( bool multi_draw, bool draw_count );
+		void ( *get_indirect_draw_features )( bool* multi_draw, bool* draw_count ); // both false by default
 	};
 
 	// clang-format off
@@ -129,6 +180,7 @@ struct le_backend_vk_api {
 		bool                   ( *clear_frame                ) ( le_backend_o *self, size_t frameIndex );
 		void                   ( *process_frame              ) ( le_backend_o *self, size_t frameIndex );
 		bool                   ( *acquire_physical_resources ) ( le_backend_o *self, size_t frameIndex, le_renderpass_o **passes, size_t numRenderPasses, le_resource_handle const * declared_resources, le_resource_info_t const * declared_resources_infos, size_t const & declared_resources_count );
+		void                   ( *release_physical_resources ) ( le_backend_o *self, size_t frameIndex, le_resource_handle const * resources, size_t resources_count ); // call after acquire_physical_resources
 		void                   ( *set_frame_queue_submission_keys ) ( le_backend_o *self, size_t frameIndex, void const * p_affinity_masks, uint32_t num_affinity_masks, char const** root_names, uint32_t root_names_count); // void* p_affinity_masks must be cast to le::RootPassesField, we can't forward-declare a using declaration
 
 		bool                   ( *dispatch_frame             ) ( le_backend_o *self, size_t frameIndex );
@@ -149,6 +201,7 @@ struct le_backend_vk_api {
 		le_img_resource_handle ( * get_swapchain_resource_default ) ( le_backend_o* self);
 		bool                   ( * get_swapchain_extent     ) ( le_backend_o* self, le_swapchain_handle swapchain, uint32_t * p_width, uint32_t * p_height );
 		bool                   ( * get_swapchains           ) ( le_backend_o* self, size_t *num_swapchains , le_swapchain_handle* p_swapchain_handles);
+		uint32_t               ( * get_swapchain_image_count) ( le_backend_o* self, le_swapchain_handle swapchain ); // 0 if swapchain is unknown
 		
 		// declares all resources belonging to a swapchain and makes them available to the current frame.
 		void 					( *acquire_swapchain_resources)(le_backend_o* self, size_t frameIndex);
@@ -157,6 +210,13 @@ struct le_backend_vk_api {
 		// return number of in-flight backend data frames
 		size_t                 ( *get_data_frames_count   ) ( le_backend_o *self );
 
+		// Returns GPU timings per renderpass which were harvested when frame at `frameIndex` was last cleared.
+		// If `timings` is nullptr, or `*count` is too small, `*count` is set to the number of available timings.
+		bool                   ( *get_pass_timings        ) ( le_backend_o *self, size_t frameIndex, le_pass_timing_t* timings, uint32_t* count );
+
+		// Returns barrier counts which were gathered when frame at `frameIndex` was last processed.
+		void                   ( *get_barrier_stats       ) ( le_backend_o *self, size_t frameIndex, le_barrier_stats_t* stats );
+
 		// this is called from the rendergraph to patch renderpass sizes - it must only be called on the recording thread
 		bool                   ( *get_swapchains_infos        ) ( le_backend_o* self, uint32_t frame_index, uint32_t *count, uint32_t* p_width, uint32_t * p_height, le_img_resource_handle * p_handlle );
 
@@ -248,6 +308,27 @@ struct le_backend_vk_api {
 
 		struct VkPipelineLayout_T*               ( *get_pipeline_layout               ) ( le_pipeline_manager_o* self, uint64_t pipeline_layout_key);
 		const struct le_descriptor_set_layout_t* ( *get_descriptor_set_layout         ) ( le_pipeline_manager_o* self, uint64_t setlayout_key);
+
+		// Called by the backend for each renderpass it creates, so that graphics pipelines for compatible
+		// renderpasses may later be compiled in the background. Only the first renderpass per renderpass_hash is retained.
+		void                                     ( *introduce_renderpass_signature    ) ( le_pipeline_manager_o* self, uint64_t renderpass_hash, VkRenderPassCreateInfo2 const * create_info, uint16_t num_color_attachments, le::SampleCountFlagBits sample_count );
+
+		// Queues graphics pipelines for compilation in the background. Returns false if any key refers to a renderpass
+		// signature which has not been introduced yet - such keys are ignored.
+		bool                                     ( *prewarm_graphics_pipelines        ) ( le_pipeline_manager_o* self, le_graphics_pipeline_key_t const * keys, uint32_t num_keys );
+
+		// Returns keys for all graphics pipelines which have been created so far - store these to pre-warm pipelines.
+		// If `keys` is nullptr, or `*num_keys` is too small, `*num_keys` is set to the number of available keys.
+		bool                                     ( *get_graphics_pipeline_keys        ) ( le_pipeline_manager_o* self, le_graphics_pipeline_key_t* keys, uint32_t* num_keys );
+
+		// Bindless descriptors: indices are stable for the lifetime of the pipeline manager. Produce methods assign an index
+		// on first use; find methods only look up. All return LE_BINDLESS_INDEX_INVALID if bindless descriptors are disabled,
+		// if there is no index for the given handle, or if all available indices are in use.
+		uint32_t                                 ( *produce_bindless_texture_index    ) ( le_pipeline_manager_o* self, le_texture_handle texture );
+		uint32_t                                 ( *produce_bindless_buffer_index     ) ( le_pipeline_manager_o* self, le_buf_resource_handle buffer );
+		uint32_t                                 ( *find_bindless_texture_index       ) ( le_pipeline_manager_o* self, le_texture_handle texture );
+		uint32_t                                 ( *find_bindless_buffer_index        ) ( le_pipeline_manager_o* self, le_buf_resource_handle buffer );
+		struct VkDescriptorSetLayout_T*          ( *get_bindless_descriptor_set_layout) ( le_pipeline_manager_o* self ); // nullptr if bindless descriptors are disabled
 	};
 
 	struct allocator_linear_interface_t {
@@ -33,9 +33,13 @@ struct le_backend_vk_settings_o {
 	    //	    VK_QUEUE_COMPUTE_BIT,
 	}; // each entry stands for one queue and its capabilities
 
-	uint32_t         data_frames_count = 2; // mumber of backend data frames - must be at minimum 2
-	uint32_t         concurrency_count = 1; // number of potential worker threads
-	std::atomic_bool readonly          = false;
+	uint32_t         data_frames_count              = 2;     // mumber of backend data frames - must be at minimum 2
+	uint32_t         bindless_textures_count        = 0;     // number of texture descriptors in bindless descriptor set, 0 means bindless descriptors are disabled
+	uint32_t         bindless_storage_buffers_count = 0;     // number of storage buffer descriptors in bindless descriptor set
+	bool             indirect_multi_draw_enabled    = false; // multiDrawIndirect, and drawIndirectFirstInstance device features requested
+	bool             indirect_draw_count_enabled    = false; // drawIndirectCount device feature requested
+	uint32_t         concurrency_count              = 1;     // number of potential worker threads
+	std::atomic_bool readonly                       = false;
 };
 
 static bool le_backend_vk_settings_set_requested_queue_capabilities( VkQueueFlags* queues, uint32_t num_queues ) {
@@ -59,6 +63,79 @@ static void le_backend_vk_settings_get_requested_queue_capabilities( VkQueueFlag
 	}
 }
 
+
+// ----------------------------------------------------------------------
+
+static bool le_backend_vk_settings_set_bindless_descriptor_counts( uint32_t max_textures, uint32_t max_storage_buffers ) {
+	le_backend_vk_settings_o* self = le_backend_vk::api->backend_settings_singleton;
+	if ( self->readonly ) {
+		static auto logger = LeLog( "le_backend_vk_settings" );
+		logger.error( "Cannot enable bindless descriptors - settings are readonly" );
+		return false;
+	}
+	// ----------| invariant: settings is not readonly
+
+	self->bindless_textures_count        = max_textures;
+	self->bindless_storage_buffers_count = max_storage_buffers;
+
+	if ( max_textures || max_storage_buffers ) {
+		// Descriptor indexing features needed so that shaders may index into
+		// large, partially populated descriptor arrays.
+		auto& vk_12                                      = self->requested_device_features.vk_12;
+		vk_12.descriptorIndexing                         = VK_TRUE;
+		vk_12.runtimeDescriptorArray                     = VK_TRUE;
+		vk_12.descriptorBindingPartiallyBound            = VK_TRUE;
+		vk_12.shaderSampledImageArrayNonUniformIndexing  = VK_TRUE;
+		vk_12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+	}
+
+	return true;
+}
+
+static void le_backend_vk_settings_get_bindless_descriptor_counts( uint32_t* max_textures, uint32_t* max_storage_buffers ) {
+	le_backend_vk_settings_o* self = le_backend_vk::api->backend_settings_singleton;
+	if ( max_textures ) {
+		*max_textures = self->bindless_textures_count;
+	}
+	if ( max_storage_buffers ) {
+		*max_storage_buffers = self->bindless_storage_buffers_count;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static bool le_backend_vk_settings_set_indirect_draw_features( bool multi_draw, bool draw_count ) {
+	le_backend_vk_settings_o* self = le_backend_vk::api->backend_settings_singleton;
+	if ( self->readonly ) {
+		static auto logger = LeLog( "le_backend_vk_settings" );
+		logger.error( "Cannot set indirect draw features - settings are readonly" );
+		return false;
+	}
+	// ----------| invariant: settings is not readonly
+
+	self->indirect_multi_draw_enabled = multi_draw;
+	self->indirect_draw_count_enabled = draw_count;
+
+	// These features are optional - drawIndirectCount even with Vulkan 1.2 - and device
+	// creation fails if we request them from a device which does not support them.
+	auto& features                     = self->requested_device_features.features.features;
+	features.multiDrawIndirect         = multi_draw ? VK_TRUE : VK_FALSE;
+	features.drawIndirectFirstInstance = multi_draw ? VK_TRUE : VK_FALSE;
+
+	self->requested_device_features.vk_12.drawIndirectCount = draw_count ? VK_TRUE : VK_FALSE;
+
+	return true;
+}
+
+static void le_backend_vk_settings_get_indirect_draw_features( bool* multi_draw, bool* draw_count ) {
+	le_backend_vk_settings_o* self = le_backend_vk::api->backend_settings_singleton;
+	if ( multi_draw ) {
+		*multi_draw = self->indirect_multi_draw_enabled;
+	}
+	if ( draw_count ) {
+		*draw_count = self->indirect_draw_count_enabled;
+	}
+}
 // ----------------------------------------------------------------------
 
 static bool le_backend_vk_settings_add_required_instance_extension( le_backend_vk_settings_o* self, char const* ext ) {
@@ -124,8 +201,8 @@ static le_backend_vk_settings_o* le_backend_vk_settings_create() {
 	        .sampleRateShading                       = VK_TRUE, // so that we can use sampleShadingEnable
 	        .dualSrcBlend                            = 0,
 	        .logicOp                                 = 0,
-	        .multiDrawIndirect                       = 0,
-	        .drawIndirectFirstInstance               = 0,
+	        .multiDrawIndirect                       = 0, // opt-in via set_indirect_draw_features
+	        .drawIndirectFirstInstance               = 0, // opt-in via set_indirect_draw_features
 	        .depthClamp                              = 0,
 	        .depthBiasClamp                          = 0,
 	        .fillModeNonSolid                        = VK_TRUE,
@@ -202,6 +279,7 @@ static le_backend_vk_settings_o* le_backend_vk_settings_create() {
 	// Apply some customisations
 
 	self->requested_device_features.vk_13.synchronization2 = VK_TRUE; // use synchronisation2 by default
+	self->requested_device_features.vk_12.hostQueryReset   = VK_TRUE; // reset timestamp query pools from the cpu on frame clear
 
 #ifdef LE_FEATURE_VIDEO
 	le_backend_vk_settings_add_required_device_extension( self, VK_KHR_VIDEO_QUEUE_EXTENSION_NAME );
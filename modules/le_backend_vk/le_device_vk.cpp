@@ -286,6 +286,43 @@ static le_device_o* device_create( le_backend_vk_instance_o* backend_instance, c
 			requested_queues.push_back( default_queue_flags );
 		}
 	}
+
+	{
+		// If async compute is enabled, and the device has a dedicated compute queue family
+		// (a family with compute, but without graphics capabilities), we request an extra
+		// queue from this family. The backend will schedule isolated, compute-only
+		// subgraphs onto this queue, so that they may overlap with graphics work.
+		//
+		// We don't add an extra queue if one of the requested queues already asks
+		// for compute without graphics.
+
+		LE_SETTING( bool, LE_SETTING_BACKEND_USE_ASYNC_COMPUTE, false );
+
+		bool has_compute_only_request = false;
+		for ( auto const& flags : requested_queues ) {
+			if ( ( flags & VK_QUEUE_COMPUTE_BIT ) && !( flags & VK_QUEUE_GRAPHICS_BIT ) ) {
+				has_compute_only_request = true;
+				break;
+			}
+		}
+
+		if ( *LE_SETTING_BACKEND_USE_ASYNC_COMPUTE && !has_compute_only_request ) {
+			bool has_dedicated_compute_family = false;
+			for ( auto const& p : self->properties.queue_family_properties ) {
+				VkQueueFlags flags = p.queueFamilyProperties.queueFlags;
+				if ( ( flags & VK_QUEUE_COMPUTE_BIT ) && !( flags & VK_QUEUE_GRAPHICS_BIT ) ) {
+					has_dedicated_compute_family = true;
+					break;
+				}
+			}
+			if ( has_dedicated_compute_family ) {
+				le::Log( LOGGER_LABEL ).info( "Async compute enabled, requesting additional queue: { %s }", le_queue_flags_to_string( le::QueueFlagBits( VK_QUEUE_COMPUTE_BIT ) ).c_str() );
+				requested_queues.push_back( VK_QUEUE_COMPUTE_BIT );
+			} else {
+				le::Log( LOGGER_LABEL ).info( "Async compute requested, but device has no dedicated compute queue family. Compute work will run on the default queue." );
+			}
+		}
+	}
 	std::vector<QueueQueryResult> available_queues =
 	    findBestMatchForRequestedQueues( self->properties.queue_family_properties, requested_queues );
 
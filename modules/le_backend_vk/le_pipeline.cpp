@@ -10,9 +10,12 @@
 #include <fstream>    // for reading shader source files
 #include <cstring>    // for memcpy
 #include <mutex>
-#include <shared_mutex>
 #include <atomic>
 #include <algorithm>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <unordered_set>
 
 #include "le_core.h"
 #include "le_shader_compiler.h"
@@ -55,153 +58,185 @@ struct le_shader_module_o {
 	specialization_map_info_t                      specialization_map_info; ///< information concerning specialization constants for this shader stage
 };
 
-// A table from `handle` -> `object*`, protected by mutex.
+// A map from `handle` -> `object*`, optimised for lookups which vastly outnumber
+// insertions - such as pipelines, pipeline layouts and descriptor set layouts,
+// which get looked up for every pipeline bind, but get created only rarely.
 //
-// Access is internally synchronised.
+// Lookups are wait-free: they never take a lock, and never write to shared
+// memory, so that lookups from many threads don't contend for cache lines.
+// Insertions are serialised via a mutex.
 //
-// lookup time will deteriorate linearly with number of elements,
-// but cache locality is very good for lookups, so this should work
-// fairly well for small number of resources such as pipelines.
-template <typename T, typename U>
-class HashTable : NoCopy, NoMove {
+// Elements are stored in an open-addressing table with linear probing. A slot
+// is published by atomically storing its object pointer (with release semantics)
+// *after* its key has been written; a reader which observes a non-null object
+// pointer (with acquire semantics) is therefore guaranteed to see the key.
+// Slots are never modified once published, and elements are never removed,
+// except via `clear()`.
+//
+// When the table needs to grow, we build a new, larger table, and atomically
+// swap it in (RCU-style): readers which still hold the previous table keep
+// reading valid - if possibly slightly outdated - data. Since we can't know
+// when the last reader has left a previous table, previous tables are retired
+// and only freed on `clear()`. Tables double in size as they grow, so retired
+// tables never take up more memory than the current table.
+//
+// Access is internally synchronised, with the exception of `clear()`, which
+// must not be called while any other thread may access the map.
+template <typename K, typename T>
+class HashMap : NoCopy, NoMove {
 
-	std::shared_mutex mtx;
-	std::vector<T>    handles;
-	std::vector<U*>   objects; // owning, object is copied on add_entry
+	struct slot_t {
+		K               key;
+		std::atomic<T*> obj; // owning; nullptr means slot is empty
+	};
 
-  public:
-	// Insert a new obj into table, object is copied.
-	// return true if successful, false if entry aready existed.
-	// in case return value is false, object was not copied.
-	bool try_insert( T const& handle, U* obj ) {
-		mtx.lock();
-		size_t i = 0;
-		for ( auto const& h : handles ) {
-			if ( h == handle ) {
-				break;
-			}
-			i++;
-		}
-		if ( i != handles.size() ) {
-			// entry already existed - this is strange.
-			mtx.unlock();
-			return false;
-		}
-		// -------| invariant: i == handles.size()
-		handles.push_back( handle );
-		objects.emplace_back( new U( *obj ) ); // make a copy
-		mtx.unlock();
-		return true;
-	}
+	struct table_t {
+		size_t  capacity; // number of slots, always a power of two
+		slot_t* slots;
+	};
 
-	// Looks up table entry under `needle`,
-	// returns nullptr if not found.
-	U* const try_find( T const& needle ) {
-		mtx.lock_shared();
-		U* const* obj = objects.data();
-		for ( auto const& h : handles ) {
-			if ( h == needle ) {
-				mtx.unlock();
-				return *obj;
-			}
-			obj++;
-		}
-		// --------| Invariant: no handle matching needle found
-		mtx.unlock();
-		return nullptr;
-	}
+	static constexpr size_t   MIN_CAPACITY  = 16;
+	static constexpr uint64_t FIBONACCI_MUL = 0x9e3779b97f4a7c15ull; // 2^64 / golden ratio
 
-	typedef void ( *iterator_fun )( U* e, void* user_data );
+	std::atomic<table_t*> table = nullptr; // current table, readers always start here
+	std::mutex            mtx;             // serialises writers
+	size_t                count = 0;       // number of elements, protected by mtx
+	std::vector<table_t*> retired_tables;  // previous tables, which may still be in use by readers, protected by mtx
 
-	// do something on all objects
-	void iterator( iterator_fun fun, void* user_data ) {
-		mtx.lock();
-		for ( auto& e : objects ) {
-			fun( e, user_data );
-		}
-		mtx.unlock();
+	static inline size_t home_slot( K const& key, size_t capacity ) {
+		return size_t( ( uint64_t( std::hash<K>()( key ) ) * FIBONACCI_MUL ) >> 32 ) & ( capacity - 1 );
 	}
 
-	void clear() {
-		mtx.lock();
-		for ( auto& obj : objects ) {
-			delete obj;
+	static table_t* create_table( size_t capacity ) {
+		table_t* t  = new table_t();
+		t->capacity = capacity;
+		t->slots    = new slot_t[ capacity ]();
+		for ( size_t i = 0; i != capacity; i++ ) {
+			t->slots[ i ].obj.store( nullptr, std::memory_order_relaxed );
 		}
-		handles.clear();
-		objects.clear();
-		mtx.unlock();
+		return t;
 	}
 
-	~HashTable() {
-		clear();
+	static void destroy_table( table_t* t ) {
+		delete[] t->slots;
+		delete t;
 	}
-};
-
-//
-template <typename S, typename T>
-class HashMap : NoCopy, NoMove {
 
-	std::shared_mutex         mtx;
-	std::unordered_map<S, T*> store; // owning, object is copied on successful try_insert
+	// Writes `obj` into the first empty slot for `key` - caller must hold mtx,
+	// and must make sure that there is at least one empty slot.
+	static void table_publish( table_t* t, K const& key, T* obj ) {
+		size_t const mask = t->capacity - 1;
+		size_t       i    = home_slot( key, t->capacity );
+		while ( t->slots[ i ].obj.load( std::memory_order_relaxed ) != nullptr ) {
+			i = ( i + 1 ) & mask;
+		}
+		t->slots[ i ].key = key;
+		t->slots[ i ].obj.store( obj, std::memory_order_release ); // publish - key must be visible before obj
+	}
 
-  public:
-	T* try_find( S needle ) {
-		mtx.lock_shared();
-		auto e = store.find( needle );
-		if ( e == store.end() ) {
-			mtx.unlock();
+	static T* table_find( table_t const* t, K const& key ) {
+		if ( t == nullptr ) {
 			return nullptr;
-		} else {
-			auto ret = e->second;
-			mtx.unlock();
-			return ret;
 		}
+		size_t const mask = t->capacity - 1;
+		for ( size_t i = home_slot( key, t->capacity ), n = 0; n != t->capacity; i = ( i + 1 ) & mask, n++ ) {
+			T* obj = t->slots[ i ].obj.load( std::memory_order_acquire );
+			if ( obj == nullptr ) {
+				return nullptr; // an empty slot ends the probe sequence
+			}
+			if ( t->slots[ i ].key == key ) {
+				return obj;
+			}
+		}
+		return nullptr;
 	}
+
+  public:
+	T* try_find( K const& needle ) const {
+		return table_find( table.load( std::memory_order_acquire ), needle );
+	}
+
 	// returns true and stores copy of obj in internal hash - or
 	// returns false if element with key already existed.
-	bool try_insert( S handle, T* obj ) {
+	bool try_insert( K const& handle, T* obj ) {
 
-		mtx.lock();
+		auto lock = std::scoped_lock( mtx );
 
-		// we attempt an insertion - a nullptr will go in as a placeholder
-		// because we cannot tell at this point whether the insertion will
-		// be successful.
-		auto result = store.emplace( handle, nullptr );
+		table_t* t = table.load( std::memory_order_relaxed );
 
-		if ( result.second ) {
-			// Insertion was successful - replace the placeholder with a copy of the actual object.
-			result.first->second = new T( *obj );
+		if ( table_find( t, handle ) ) {
+			return false;
+		}
+
+		// ----------| invariant: no element with this key exists
+
+		if ( t == nullptr || ( count + 1 ) * 2 > t->capacity ) {
+			// Keep load factor at or below 0.5 - grow table by creating a larger copy,
+			// and swapping it in once it is complete.
+			table_t* grown = create_table( t ? t->capacity * 2 : MIN_CAPACITY );
+			if ( t ) {
+				for ( size_t i = 0; i != t->capacity; i++ ) {
+					T* e = t->slots[ i ].obj.load( std::memory_order_relaxed );
+					if ( e ) {
+						table_publish( grown, t->slots[ i ].key, e );
+					}
+				}
+				retired_tables.push_back( t );
+			}
+			table.store( grown, std::memory_order_release );
+			t = grown;
 		}
 
-		mtx.unlock();
+		table_publish( t, handle, new T( *obj ) ); // make a copy
+		count++;
 
-		return result.second;
+		return true;
 	}
 
 	typedef void ( *iterator_fun )( T* e, void* user_data );
 
 	// do something on all objects
 	void iterator( iterator_fun fun, void* user_data ) {
-		mtx.lock();
-		for ( auto& e : store ) {
-			fun( e.second, user_data );
+		auto     lock = std::scoped_lock( mtx );
+		table_t* t    = table.load( std::memory_order_relaxed );
+		if ( t == nullptr ) {
+			return;
+		}
+		for ( size_t i = 0; i != t->capacity; i++ ) {
+			T* e = t->slots[ i ].obj.load( std::memory_order_relaxed );
+			if ( e ) {
+				fun( e, user_data );
+			}
 		}
-		mtx.unlock();
 	}
 
+	// Must not be called while any other thread may access the map.
 	void clear() {
-		mtx.lock();
-		for ( auto& e : store ) {
-			delete ( e.second );
+		auto     lock = std::scoped_lock( mtx );
+		table_t* t    = table.exchange( nullptr );
+		if ( t ) {
+			for ( size_t i = 0; i != t->capacity; i++ ) {
+				delete t->slots[ i ].obj.load( std::memory_order_relaxed );
+			}
+			destroy_table( t );
 		}
-		store.clear();
-		mtx.unlock();
+		for ( auto& r : retired_tables ) {
+			destroy_table( r ); // objects in retired tables are owned by the current table
+		}
+		retired_tables.clear();
+		count = 0;
 	}
+
 	~HashMap() {
 		clear();
 	}
 };
 
+// A table from `handle` -> `object*`, for pipeline state objects and shader group
+// data. Uses the same implementation - and the same wait-free lookups - as HashMap.
+template <typename T, typename U>
+using HashTable = HashMap<T, U>;
+
 struct ProtectedModuleDependencies {
 	std::mutex                                                         mtx;
 	std::unordered_map<std::string, std::set<le_shader_module_handle>> moduleDependencies; // map 'canonical shader source file path, watch_id' -> [shader modules]
@@ -222,6 +257,33 @@ struct le_shader_manager_o {
 	le_file_watcher_o*    shaderFileWatcher = nullptr; // owning
 };
 
+// Everything we need to know about a renderpass to create graphics pipelines for it.
+struct le_renderpass_signature_t {
+	VkRenderPass            renderpass;            // owning: compatible with any renderpass which has the same renderpass hash
+	uint16_t                num_color_attachments; //
+	le::SampleCountFlagBits sample_count;          //
+};
+
+// Queue of graphics pipelines to compile in the background.
+//
+// We compile on a dedicated thread rather than via le_jobs: compiling a pipeline is a
+// long, blocking driver call, which would otherwise tie up a job worker that frame
+// processing may need. Note also that le_jobs is only initialised in multi-threaded builds.
+struct le_pipeline_compile_queue_t {
+	struct request_t {
+		le_graphics_pipeline_key_t key;
+		uint64_t                   pipeline_hash;
+	};
+
+	std::mutex                   mtx;
+	std::condition_variable      cv;                // signalled when a request gets added, or completed
+	std::deque<request_t>        requests;          // requests which are waiting to be compiled
+	std::unordered_set<uint64_t> pending;           // pipeline hashes for requests which are queued, or being compiled
+	uint32_t                     num_in_flight = 0; // number of requests currently being compiled
+	bool                         should_stop   = false;
+	std::thread                  worker; // started lazily, with the first request
+};
+
 // NOTE: It might make sense to have one pipeline manager per worker thread, and
 //       to consolidate after the frame has been processed.
 struct le_pipeline_manager_o {
@@ -244,8 +306,27 @@ struct le_pipeline_manager_o {
 
 	HashMap<uint64_t, le_descriptor_set_layout_t> descriptorSetLayouts;
 	HashMap<uint64_t, VkPipelineLayout>           pipelineLayouts; // indexed by hash of array of descriptorSetLayoutCache keys per pipeline layout
+
+	HashMap<uint64_t, le_renderpass_signature_t> renderpassSignatures; // indexed by renderpass hash
+	le_pipeline_compile_queue_t                  compileQueue;         // graphics pipelines to compile in the background
+
+	std::mutex                              graphicsPipelineKeysMtx;
+	std::vector<le_graphics_pipeline_key_t> graphicsPipelineKeys; // one key per graphics pipeline created so far, protected by graphicsPipelineKeysMtx
+
+	// Bindless descriptors - only in use if enabled via backend settings.
+	VkDescriptorSetLayout                     bindlessSetLayout        = nullptr; // non-owning: owned by descriptorSetLayouts, nullptr if bindless descriptors are disabled
+	uint32_t                                  bindlessTexturesCapacity = 0;       // number of texture descriptors in bindless set
+	uint32_t                                  bindlessBuffersCapacity  = 0;       // number of storage buffer descriptors in bindless set
+	std::mutex                                bindlessIndicesMtx;                 // serialises assignment of bindless indices
+	uint32_t                                  bindlessTexturesCount = 0;          // number of assigned texture indices, protected by bindlessIndicesMtx
+	uint32_t                                  bindlessBuffersCount  = 0;          // number of assigned buffer indices, protected by bindlessIndicesMtx
+	HashMap<le_texture_handle, uint32_t>      bindlessTextureIndices;             // stable index per texture
+	HashMap<le_buf_resource_handle, uint32_t> bindlessBufferIndices;              // stable index per storage buffer
 };
 
+// Key under which the bindless descriptor set layout is stored with descriptorSetLayouts.
+static constexpr uint64_t LE_BINDLESS_SET_LAYOUT_KEY = hash_64_fnv1a_const( "le_bindless_set_layout" );
+
 static VkFormat vk_format_from_spv_reflect_format( SpvReflectFormat const& format ) {
 	// clang-format off
 	switch (format)
@@ -1170,7 +1251,8 @@ static void le_shader_manager_shader_module_update( le_shader_manager_o* self, l
 
 // ----------------------------------------------------------------------
 // this method is called via renderer::update - before frame processing.
-static void le_shader_manager_update_shader_modules( le_shader_manager_o* self ) {
+// Returns whether any shader modules have been tainted, and must be updated.
+static bool le_shader_manager_poll_shader_modules( le_shader_manager_o* self ) {
 
 	// -- find out which shader modules have been tainted
 
@@ -1178,6 +1260,13 @@ static void le_shader_manager_update_shader_modules( le_shader_manager_o* self )
 	// callbacks will modify le_backend->modifiedShaderModules
 	le_file_watcher::le_file_watcher_i.poll_notifications( self->shaderFileWatcher );
 
+	return !self->modifiedShaderModules.empty();
+}
+
+// ----------------------------------------------------------------------
+
+static void le_shader_manager_update_shader_modules( le_shader_manager_o* self ) {
+
 	// -- update only modules which have been tainted
 
 	for ( auto& s : self->modifiedShaderModules ) {
@@ -1763,9 +1852,36 @@ static VkPipeline le_pipeline_cache_create_rtx_pipeline( le_pipeline_manager_o*
 
 // ----------------------------------------------------------------------
 
+// Returns true if any of the given bindings refers to one of the reserved bindless argument names -
+// in which case the set which holds these bindings is the bindless descriptor set.
+static bool shader_bindings_use_bindless_set( std::vector<le_shader_binding_info> const& bindings ) {
+	static constexpr uint64_t BINDLESS_TEXTURES_NAME_HASH = hash_64_fnv1a_const( LE_BINDLESS_TEXTURES_ARGUMENT_NAME );
+	static constexpr uint64_t BINDLESS_BUFFERS_NAME_HASH  = hash_64_fnv1a_const( LE_BINDLESS_BUFFERS_ARGUMENT_NAME );
+	for ( auto const& b : bindings ) {
+		if ( b.name_hash == BINDLESS_TEXTURES_NAME_HASH || b.name_hash == BINDLESS_BUFFERS_NAME_HASH ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------
+
 /// \brief returns hash key for given bindings, creates and retains new vkDescriptorSetLayout inside backend if necessary
 static uint64_t le_pipeline_cache_produce_descriptor_set_layout( le_pipeline_manager_o* self, std::vector<le_shader_binding_info> const& bindings, VkDescriptorSetLayout* layout ) {
 
+	if ( shader_bindings_use_bindless_set( bindings ) ) {
+		if ( self->bindlessSetLayout ) {
+			// All pipelines share the same bindless set layout, so that the bindless set stays
+			// compatible - and bound - across pipeline changes.
+			*layout = self->bindlessSetLayout;
+			return LE_BINDLESS_SET_LAYOUT_KEY;
+		} else {
+			static auto logger = LeLog( LOGGER_LABEL );
+			logger.error( "Shader declares bindless arguments, but bindless descriptors are not enabled - enable these via backend settings." );
+		}
+	}
+
 	auto& descriptorSetLayouts = self->descriptorSetLayouts; // FIXME: this method only needs rw access to this, and the device
 
 	// -- Calculate hash based on le_shader_binding_infos for this set
@@ -2055,21 +2171,267 @@ static inline void le_pipeline_manager_produce_pipeline_layout_info(
 
 // ----------------------------------------------------------------------
 
+// Calculates a combined hash for pipeline, renderpass, and all contributing shader stages.
+static uint64_t le_pipeline_manager_calculate_graphics_pipeline_hash(
+    le_pipeline_manager_o*           self,
+    le_gpso_handle                   gpso_handle,
+    graphics_pipeline_state_o const* pso,
+    uint64_t                         renderpass_hash,
+    uint64_t                         pipeline_layout_hash ) {
+
+	uint64_t pso_renderpass_hash_data[ 12 ]       = {}; // we use a c-style array, with an entry count so that this is reliably allocated on the stack and not on the heap.
+	uint64_t pso_renderpass_hash_data_num_entries = 0;  // number of entries in pso_renderpass_hash_data
+
+	pso_renderpass_hash_data[ 0 ]        = reinterpret_cast<uint64_t>( gpso_handle ); // Hash associated with `pso`
+	pso_renderpass_hash_data[ 1 ]        = renderpass_hash;                           // Hash for *compatible* renderpass
+	pso_renderpass_hash_data_num_entries = 2;
+
+	for ( auto const& s : pso->shaderModules ) {
+		auto p_module = self->shaderManager->shaderModules.try_find( s );
+		assert( p_module && "shader module not found" );
+		pso_renderpass_hash_data[ pso_renderpass_hash_data_num_entries++ ] = p_module->hash; // Module state - may have been recompiled, hash must be current
+	}
+
+	// -- create combined hash for pipeline, renderpass
+	return SpookyHash::Hash64( pso_renderpass_hash_data, sizeof( uint64_t ) * pso_renderpass_hash_data_num_entries, pipeline_layout_hash );
+}
+
+// ----------------------------------------------------------------------
+// Stores a newly created graphics pipeline in the cache, and returns the cached pipeline.
+//
+// If another thread has stored a pipeline with the same hash in the meantime, the
+// pipeline which we were given is redundant: we destroy it, and return the cached one.
+static VkPipeline le_pipeline_manager_store_graphics_pipeline( le_pipeline_manager_o* self, uint64_t pipeline_hash, le_graphics_pipeline_key_t const& key, VkPipeline pipeline ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	if ( self->pipelines.try_insert( pipeline_hash, &pipeline ) ) {
+		logger.info( "New VK Graphics Pipeline created: %p", pipeline_hash );
+		auto lock = std::scoped_lock( self->graphicsPipelineKeysMtx );
+		self->graphicsPipelineKeys.push_back( key );
+		return pipeline;
+	}
+
+	// ----------| invariant: a pipeline with this hash was stored concurrently.
+
+	vkDestroyPipeline( self->device, pipeline, nullptr );
+
+	auto p = self->pipelines.try_find( pipeline_hash );
+	assert( p && "pipeline must exist in cache" );
+	return *p;
+}
+
+// ----------------------------------------------------------------------
+// Compiles one graphics pipeline which has been requested for background compilation.
+static void le_pipeline_manager_compile_requested_graphics_pipeline( le_pipeline_manager_o* self, le_pipeline_compile_queue_t::request_t const& request ) {
+	ZoneScoped;
+
+	if ( self->pipelines.try_find( request.pipeline_hash ) ) {
+		// Pipeline has already been created in the meantime.
+		return;
+	}
+
+	graphics_pipeline_state_o const* pso = self->graphicsPso.try_find( request.key.gpso );
+	le_renderpass_signature_t const* sig = self->renderpassSignatures.try_find( request.key.renderpass_hash );
+
+	if ( pso == nullptr || sig == nullptr ) {
+		return;
+	}
+
+	// Only these fields of BackendRenderPass are used when creating a graphics pipeline.
+	BackendRenderPass pass{};
+	pass.renderPass          = sig->renderpass;
+	pass.numColorAttachments = sig->num_color_attachments;
+	pass.sampleCount         = sig->sample_count;
+	pass.renderpassHash      = request.key.renderpass_hash;
+
+	VkPipeline pipeline = le_pipeline_cache_create_graphics_pipeline( self, pso, pass, request.key.subpass );
+
+	le_pipeline_manager_store_graphics_pipeline( self, request.pipeline_hash, request.key, pipeline );
+}
+
+// ----------------------------------------------------------------------
+
+static void le_pipeline_manager_compile_queue_worker( le_pipeline_manager_o* self ) {
+	auto& q    = self->compileQueue;
+	auto  lock = std::unique_lock( q.mtx );
+
+	for ( ;; ) {
+		q.cv.wait( lock, [ &q ]() { return q.should_stop || !q.requests.empty(); } );
+
+		if ( q.should_stop ) {
+			break;
+		}
+
+		auto request = q.requests.front();
+		q.requests.pop_front();
+		q.num_in_flight++;
+
+		lock.unlock();
+		le_pipeline_manager_compile_requested_graphics_pipeline( self, request );
+		lock.lock();
+
+		q.num_in_flight--;
+		q.pending.erase( request.pipeline_hash );
+		q.cv.notify_all(); // in case anyone waits for the queue to become idle
+	}
+}
+
+// ----------------------------------------------------------------------
+// Adds a request to compile a graphics pipeline in the background - does nothing
+// if a pipeline with the same hash is already queued, or being compiled.
+static void le_pipeline_manager_enqueue_graphics_pipeline( le_pipeline_manager_o* self, le_graphics_pipeline_key_t const& key, uint64_t pipeline_hash ) {
+	auto& q    = self->compileQueue;
+	auto  lock = std::scoped_lock( q.mtx );
+
+	if ( q.should_stop || false == q.pending.insert( pipeline_hash ).second ) {
+		return;
+	}
+
+	if ( !q.worker.joinable() ) {
+		q.worker = std::thread( le_pipeline_manager_compile_queue_worker, self );
+	}
+
+	q.requests.push_back( { key, pipeline_hash } );
+	q.cv.notify_all();
+}
+
+// ----------------------------------------------------------------------
+// Blocks until there are no more graphics pipelines queued or being compiled in the background.
+static void le_pipeline_manager_wait_for_compile_queue_idle( le_pipeline_manager_o* self ) {
+	auto& q    = self->compileQueue;
+	auto  lock = std::unique_lock( q.mtx );
+	q.cv.wait( lock, [ &q ]() { return q.should_stop || ( q.requests.empty() && q.num_in_flight == 0 ); } );
+}
+
+// ----------------------------------------------------------------------
+
+static void le_pipeline_manager_introduce_renderpass_signature( le_pipeline_manager_o* self, uint64_t renderpass_hash, VkRenderPassCreateInfo2 const* create_info, uint16_t num_color_attachments, le::SampleCountFlagBits sample_count ) {
+
+	if ( self->renderpassSignatures.try_find( renderpass_hash ) ) {
+		return;
+	}
+
+	// ----------| invariant: we have not yet seen a renderpass with this hash.
+
+	// Create our own renderpass - the backend's renderpasses only live as long as
+	// the frame they belong to, but we want to be able to create compatible
+	// pipelines at any time.
+
+	le_renderpass_signature_t signature{
+	    .renderpass            = nullptr,
+	    .num_color_attachments = num_color_attachments,
+	    .sample_count          = sample_count,
+	};
+
+	vkCreateRenderPass2( self->device, create_info, nullptr, &signature.renderpass );
+
+	if ( false == self->renderpassSignatures.try_insert( renderpass_hash, &signature ) ) {
+		// signature was introduced concurrently - we don't need our copy.
+		vkDestroyRenderPass( self->device, signature.renderpass, nullptr );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static bool le_pipeline_manager_prewarm_graphics_pipelines( le_pipeline_manager_o* self, le_graphics_pipeline_key_t const* keys, uint32_t num_keys ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+	bool        result = true;
+
+	for ( auto key = keys; key != keys + num_keys; key++ ) {
+
+		graphics_pipeline_state_o const* pso = self->graphicsPso.try_find( key->gpso );
+
+		if ( pso == nullptr || nullptr == self->renderpassSignatures.try_find( key->renderpass_hash ) ) {
+			logger.warn( "Cannot pre-warm pipeline for gpso %p: unknown pipeline state, or renderpass signature.", key->gpso );
+			result = false;
+			continue;
+		}
+
+		uint64_t pipeline_hash = 0;
+		{
+			// Pipeline layouts must be created sequentially, see produce_graphics_pipeline
+			auto lock = std::unique_lock( self->mtx );
+
+			le_pipeline_layout_info layout_info{};
+			uint64_t                pipeline_layout_hash{};
+			le_pipeline_manager_produce_pipeline_layout_info( self, pso->shaderModules.data(), pso->shaderModules.size(), &layout_info, &pipeline_layout_hash );
+
+			pipeline_hash = le_pipeline_manager_calculate_graphics_pipeline_hash( self, key->gpso, pso, key->renderpass_hash, pipeline_layout_hash );
+		}
+
+		if ( nullptr == self->pipelines.try_find( pipeline_hash ) ) {
+			le_pipeline_manager_enqueue_graphics_pipeline( self, *key, pipeline_hash );
+		}
+	}
+
+	return result;
+}
+
+// ----------------------------------------------------------------------
+
+static bool le_pipeline_manager_get_graphics_pipeline_keys( le_pipeline_manager_o* self, le_graphics_pipeline_key_t* keys, uint32_t* num_keys ) {
+	if ( num_keys == nullptr ) {
+		return false;
+	}
+
+	auto lock = std::scoped_lock( self->graphicsPipelineKeysMtx );
+
+	uint32_t available_keys = uint32_t( self->graphicsPipelineKeys.size() );
+
+	if ( keys == nullptr || *num_keys < available_keys ) {
+		*num_keys = available_keys;
+		return false;
+	}
+
+	memcpy( keys, self->graphicsPipelineKeys.data(), sizeof( le_graphics_pipeline_key_t ) * available_keys );
+	*num_keys = available_keys;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
 /// \brief Creates - or loads a pipeline from cache - based on current pipeline state
-/// \note This method may lock the gpso/cpso cache and is therefore costly.
+/// \note Cache hits are wait-free - only cache misses lock the pipeline manager, and are costly.
 //
 // + Only the 'command buffer recording'-slice of a frame shall be able to modify the cache.
 //   The cache must be exclusively accessed through this method
 //
-// + NOTE: Access to this method must be sequential - no two frames may access this method
-//   at the same time - and no two renderpasses may access this method at the same time.
+// + Any number of renderpasses may call this method concurrently: lookups go straight to the
+//   wait-free caches, and creating missing layouts, or pipelines, is serialised via self->mtx.
+//
+// + If LE_SETTING_PIPELINE_COMPILE_ASYNC is set, pipelines which are not yet in the cache get
+//   queued for compilation in the background, and the pipeline returned is nullptr until
+//   compilation has completed. Callers must then skip any draws which would use the pipeline.
 static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeline(
     le_pipeline_manager_o*   self,
     le_gpso_handle           gpso_handle,
     const BackendRenderPass& pass, uint32_t subpass ) {
 
-	// TODO: Do we need this lock, or are the try_finds with their internal mutexes enough?
-	auto lock = std::unique_lock( self->mtx ); // Enforce sequentiality via scoped lock: no two renderpasses may access cache concurrently.
+	LE_SETTING( bool, LE_SETTING_PIPELINE_COMPILE_ASYNC, false );
+
+	{
+		// Fast path: pso, pipeline layout info, and pipeline are all in the cache - this is what
+		// happens for nearly every call after the first few frames, and it does not need the lock.
+
+		graphics_pipeline_state_o const* pso = self->graphicsPso.try_find( gpso_handle );
+		assert( pso );
+
+		uint64_t const pipeline_layout_hash = shader_modules_get_pipeline_layout_hash( self->shaderManager, pso->shaderModules.data(), pso->shaderModules.size() );
+		auto const     pl                   = self->pipelineLayoutInfos.try_find( pipeline_layout_hash );
+
+		if ( pl ) {
+			uint64_t pipeline_hash = le_pipeline_manager_calculate_graphics_pipeline_hash( self, gpso_handle, pso, pass.renderpassHash, pipeline_layout_hash );
+
+			if ( auto p = self->pipelines.try_find( pipeline_hash ) ) {
+				return { *p, *pl };
+			}
+		}
+	}
+
+	// ----------| invariant: cache miss - we must create a pipeline layout, or a pipeline, or both.
+
+	auto lock = std::unique_lock( self->mtx ); // Serialise cache misses, so that we don't create the same objects twice.
 
 	// TODO: Check whether the current gpso is dirty - if not, we should be able to use a cached version
 	// via self.pipelines
@@ -2078,7 +2440,6 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeli
 	// was tainted. We could keep an internal table of modules -> gpso and taint any gpso that made use of
 	// a changed module.
 
-	static auto                   logger                   = LeLog( LOGGER_LABEL );
 	le_pipeline_and_layout_info_t pipeline_and_layout_info = {};
 
 	// -- 0. Fetch pso from cache using its hash key
@@ -2095,39 +2456,28 @@ static le_pipeline_and_layout_info_t le_pipeline_manager_produce_graphics_pipeli
 	// -- 2. get vk pipeline object
 	// we try to fetch it from the cache first, if it doesn't exist, we must create it, and add it to the cache.
 
-	uint64_t pipeline_hash = 0;
-	{
-		// Create a combined hash for pipeline, renderpass, and all contributing shader stages.
-
-		uint64_t pso_renderpass_hash_data[ 12 ]       = {}; // we use a c-style array, with an entry count so that this is reliably allocated on the stack and not on the heap.
-		uint64_t pso_renderpass_hash_data_num_entries = 0;  // number of entries in pso_renderpass_hash_data
-
-		pso_renderpass_hash_data[ 0 ]        = reinterpret_cast<uint64_t>( gpso_handle ); // Hash associated with `pso`
-		pso_renderpass_hash_data[ 1 ]        = pass.renderpassHash;                       // Hash for *compatible* renderpass
-		pso_renderpass_hash_data_num_entries = 2;
-
-		for ( auto const& s : pso->shaderModules ) {
-			auto p_module = self->shaderManager->shaderModules.try_find( s );
-			assert( p_module && "shader module not found" );
-			pso_renderpass_hash_data[ pso_renderpass_hash_data_num_entries++ ] = p_module->hash; // Module state - may have been recompiled, hash must be current
-		}
-
-		// -- create combined hash for pipeline, renderpass
-		pipeline_hash = SpookyHash::Hash64( pso_renderpass_hash_data, sizeof( uint64_t ) * pso_renderpass_hash_data_num_entries, pipeline_layout_hash );
-	}
+	uint64_t pipeline_hash = le_pipeline_manager_calculate_graphics_pipeline_hash( self, gpso_handle, pso, pass.renderpassHash, pipeline_layout_hash );
 
 	// -- look up if pipeline with this hash already exists in cache
 	auto p = self->pipelines.try_find( pipeline_hash );
 
+	le_graphics_pipeline_key_t key = {
+	    .gpso            = gpso_handle,
+	    .renderpass_hash = pass.renderpassHash,
+	    .subpass         = subpass,
+	};
+
 	if ( p ) {
 		// pipeline exists
 		pipeline_and_layout_info.pipeline = *p;
+	} else if ( *LE_SETTING_PIPELINE_COMPILE_ASYNC && self->renderpassSignatures.try_find( pass.renderpassHash ) ) {
+		// -- queue pipeline for compilation in the background, and signal that it is not ready yet.
+		le_pipeline_manager_enqueue_graphics_pipeline( self, key, pipeline_hash );
+		pipeline_and_layout_info.pipeline = nullptr;
 	} else {
 		// -- if not, create pipeline in pipeline cache and store / retain it
-		pipeline_and_layout_info.pipeline = le_pipeline_cache_create_graphics_pipeline( self, pso, pass, subpass );
-		logger.info( "New VK Graphics Pipeline created: %p", pipeline_hash );
-		bool result = self->pipelines.try_insert( pipeline_hash, &pipeline_and_layout_info.pipeline );
-		assert( result && " pipeline insertion must be successful " );
+		VkPipeline pipeline               = le_pipeline_cache_create_graphics_pipeline( self, pso, pass, subpass );
+		pipeline_and_layout_info.pipeline = le_pipeline_manager_store_graphics_pipeline( self, pipeline_hash, key, pipeline );
 	}
 
 	return pipeline_and_layout_info;
@@ -2438,6 +2788,165 @@ static const le_descriptor_set_layout_t* le_pipeline_manager_get_descriptor_set_
 	return self->descriptorSetLayouts.try_find( setlayout_key );
 };
 
+// ----------------------------------------------------------------------
+// Assigns a stable index to `handle`, unless it already has one.
+template <typename Handle>
+static uint32_t le_pipeline_manager_produce_bindless_index( le_pipeline_manager_o* self, HashMap<Handle, uint32_t>& indices, uint32_t& count, uint32_t capacity, Handle handle ) {
+
+	uint32_t const* found = indices.try_find( handle );
+
+	if ( found ) {
+		return *found;
+	}
+
+	if ( capacity == 0 ) {
+		return LE_BINDLESS_INDEX_INVALID;
+	}
+
+	// ----------| invariant: bindless descriptors are enabled, and handle had no index
+
+	auto lock = std::scoped_lock( self->bindlessIndicesMtx );
+
+	found = indices.try_find( handle ); // another thread may have assigned an index in the meantime
+
+	if ( found ) {
+		return *found;
+	}
+
+	if ( count == capacity ) {
+		static auto logger = LeLog( LOGGER_LABEL );
+		logger.error( "Could not assign bindless index: all %d indices are in use.", capacity );
+		return LE_BINDLESS_INDEX_INVALID;
+	}
+
+	uint32_t index = count++;
+	indices.try_insert( handle, &index );
+
+	return index;
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t le_pipeline_manager_produce_bindless_texture_index( le_pipeline_manager_o* self, le_texture_handle texture ) {
+	return le_pipeline_manager_produce_bindless_index( self, self->bindlessTextureIndices, self->bindlessTexturesCount, self->bindlessTexturesCapacity, texture );
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t le_pipeline_manager_produce_bindless_buffer_index( le_pipeline_manager_o* self, le_buf_resource_handle buffer ) {
+	return le_pipeline_manager_produce_bindless_index( self, self->bindlessBufferIndices, self->bindlessBuffersCount, self->bindlessBuffersCapacity, buffer );
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t le_pipeline_manager_find_bindless_texture_index( le_pipeline_manager_o* self, le_texture_handle texture ) {
+	uint32_t const* found = self->bindlessTextureIndices.try_find( texture );
+	return found ? *found : LE_BINDLESS_INDEX_INVALID;
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t le_pipeline_manager_find_bindless_buffer_index( le_pipeline_manager_o* self, le_buf_resource_handle buffer ) {
+	uint32_t const* found = self->bindlessBufferIndices.try_find( buffer );
+	return found ? *found : LE_BINDLESS_INDEX_INVALID;
+}
+
+// ----------------------------------------------------------------------
+
+static VkDescriptorSetLayout le_pipeline_manager_get_bindless_descriptor_set_layout( le_pipeline_manager_o* self ) {
+	return self->bindlessSetLayout;
+}
+
+// ----------------------------------------------------------------------
+// Creates the descriptor set layout for the bindless descriptor set, if bindless
+// descriptors were enabled via backend settings.
+//
+// Binding 0 holds an array of combined image samplers, binding 1 an array of storage
+// buffers. Bindings are partially bound: only descriptors which shaders actually
+// access must be valid.
+static void le_pipeline_manager_create_bindless_set_layout( le_pipeline_manager_o* self ) {
+
+	static auto logger = LeLog( LOGGER_LABEL );
+	using namespace le_backend_vk;
+
+	uint32_t num_textures = 0;
+	uint32_t num_buffers  = 0;
+	settings_i.get_bindless_descriptor_counts( &num_textures, &num_buffers );
+
+	if ( num_textures == 0 && num_buffers == 0 ) {
+		return;
+	}
+
+	// ----------| invariant: bindless descriptors were requested
+
+	// Clamp counts so that at least half of what the device allows per stage
+	// remains available for regular descriptor sets.
+	auto const& limits = vk_device_i.get_vk_physical_device_properties( self->le_device )->limits;
+
+	uint32_t max_textures = std::min( { limits.maxPerStageDescriptorSamplers, limits.maxPerStageDescriptorSampledImages, limits.maxDescriptorSetSamplers, limits.maxDescriptorSetSampledImages } ) / 2;
+	uint32_t max_buffers  = std::min( limits.maxPerStageDescriptorStorageBuffers, limits.maxDescriptorSetStorageBuffers ) / 2;
+
+	if ( num_textures > max_textures || num_buffers > max_buffers ) {
+		logger.warn( "Bindless descriptor counts (textures: %d, buffers: %d) clamped to device limits (textures: %d, buffers: %d).",
+		             num_textures, num_buffers, max_textures, max_buffers );
+		num_textures = std::min( num_textures, max_textures );
+		num_buffers  = std::min( num_buffers, max_buffers );
+	}
+
+	VkDescriptorSetLayoutBinding bindings[ 2 ] = {
+	    {
+	        .binding            = 0,
+	        .descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+	        .descriptorCount    = num_textures,
+	        .stageFlags         = VK_SHADER_STAGE_ALL,
+	        .pImmutableSamplers = nullptr,
+	    },
+	    {
+	        .binding            = 1,
+	        .descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+	        .descriptorCount    = num_buffers,
+	        .stageFlags         = VK_SHADER_STAGE_ALL,
+	        .pImmutableSamplers = nullptr,
+	    },
+	};
+
+	VkDescriptorBindingFlags binding_flags[ 2 ] = {
+	    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+	    VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+	};
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {
+	    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+	    .pNext         = nullptr,
+	    .bindingCount  = 2,
+	    .pBindingFlags = binding_flags,
+	};
+
+	VkDescriptorSetLayoutCreateInfo set_layout_info = {
+	    .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+	    .pNext        = &binding_flags_info,
+	    .flags        = 0,
+	    .bindingCount = 2,
+	    .pBindings    = bindings,
+	};
+
+	VkDescriptorSetLayout layout = nullptr;
+	vkCreateDescriptorSetLayout( self->device, &set_layout_info, nullptr, &layout );
+
+	le_descriptor_set_layout_t le_layout_info{};
+	le_layout_info.vk_descriptor_set_layout      = layout;
+	le_layout_info.vk_descriptor_update_template = nullptr;
+	le_layout_info.is_bindless                   = true;
+
+	self->descriptorSetLayouts.try_insert( LE_BINDLESS_SET_LAYOUT_KEY, &le_layout_info ); // descriptorSetLayouts takes ownership of vk objects
+
+	self->bindlessSetLayout        = layout;
+	self->bindlessTexturesCapacity = num_textures;
+	self->bindlessBuffersCapacity  = num_buffers;
+
+	logger.info( "Bindless descriptors enabled (textures: %d, storage buffers: %d).", num_textures, num_buffers );
+}
+
 // ----------------------------------------------------------------------
 
 static le_shader_module_handle le_pipeline_manager_create_shader_module(
@@ -2467,7 +2976,12 @@ static le_shader_module_handle le_pipeline_manager_create_shader_module(
 // ----------------------------------------------------------------------
 
 static void le_pipeline_manager_update_shader_modules( le_pipeline_manager_o* self ) {
-	le_shader_manager_update_shader_modules( self->shaderManager );
+	if ( le_shader_manager_poll_shader_modules( self->shaderManager ) ) {
+		// Pipelines which are being compiled in the background may use shader modules
+		// which are about to be updated - we must wait for these to complete first.
+		le_pipeline_manager_wait_for_compile_queue_idle( self );
+		le_shader_manager_update_shader_modules( self->shaderManager );
+	}
 }
 
 // ----------------------------------------------------------------------
@@ -2491,6 +3005,8 @@ static le_pipeline_manager_o* le_pipeline_manager_create( le_device_o* le_device
 	vkCreatePipelineCache( self->device, &info, nullptr, &self->vulkanCache );
 	self->shaderManager = le_shader_manager_create( self->device );
 
+	le_pipeline_manager_create_bindless_set_layout( self );
+
 	return self;
 }
 
@@ -2500,6 +3016,18 @@ static void le_pipeline_manager_destroy( le_pipeline_manager_o* self ) {
 
 	static auto logger = LeLog( LOGGER_LABEL );
 
+	{
+		// Stop background compilation - any requests which are still queued get dropped.
+		{
+			auto lock                      = std::scoped_lock( self->compileQueue.mtx );
+			self->compileQueue.should_stop = true;
+		}
+		self->compileQueue.cv.notify_all();
+		if ( self->compileQueue.worker.joinable() ) {
+			self->compileQueue.worker.join();
+		}
+	}
+
 	le_shader_manager_destroy( self->shaderManager );
 	self->shaderManager = nullptr;
 
@@ -2543,6 +3071,16 @@ static void le_pipeline_manager_destroy( le_pipeline_manager_o* self ) {
 
 	self->pipelines.clear();
 
+	// -- destroy renderpasses which we kept for creating compatible pipelines
+	self->renderpassSignatures.iterator(
+	    []( le_renderpass_signature_t* e, void* user_data ) {
+		    auto device = *static_cast<VkDevice*>( user_data );
+		    vkDestroyRenderPass( device, e->renderpass, nullptr );
+	    },
+	    &self->device );
+
+	self->renderpassSignatures.clear();
+
 	self->rtx_shader_group_data.iterator(
 	    []( char** p_buffer, void* ) {
 		    free( *p_buffer );
@@ -2572,16 +3110,24 @@ void register_le_pipeline_vk_api( void* api_ ) {
 		i.create  = le_pipeline_manager_create;
 		i.destroy = le_pipeline_manager_destroy;
 
-		i.create_shader_module              = le_pipeline_manager_create_shader_module;
-		i.update_shader_modules             = le_pipeline_manager_update_shader_modules;
-		i.introduce_graphics_pipeline_state = le_pipeline_manager_introduce_graphics_pipeline_state;
-		i.introduce_compute_pipeline_state  = le_pipeline_manager_introduce_compute_pipeline_state;
-		i.introduce_rtx_pipeline_state      = le_pipeline_manager_introduce_rtx_pipeline_state;
-		i.get_pipeline_layout               = le_pipeline_manager_get_pipeline_layout_public;
-		i.get_descriptor_set_layout         = le_pipeline_manager_get_descriptor_set_layout;
-		i.produce_graphics_pipeline         = le_pipeline_manager_produce_graphics_pipeline;
-		i.produce_rtx_pipeline              = le_pipeline_manager_produce_rtx_pipeline;
-		i.produce_compute_pipeline          = le_pipeline_manager_produce_compute_pipeline;
+		i.create_shader_module               = le_pipeline_manager_create_shader_module;
+		i.update_shader_modules              = le_pipeline_manager_update_shader_modules;
+		i.introduce_graphics_pipeline_state  = le_pipeline_manager_introduce_graphics_pipeline_state;
+		i.introduce_compute_pipeline_state   = le_pipeline_manager_introduce_compute_pipeline_state;
+		i.introduce_rtx_pipeline_state       = le_pipeline_manager_introduce_rtx_pipeline_state;
+		i.get_pipeline_layout                = le_pipeline_manager_get_pipeline_layout_public;
+		i.get_descriptor_set_layout          = le_pipeline_manager_get_descriptor_set_layout;
+		i.produce_graphics_pipeline          = le_pipeline_manager_produce_graphics_pipeline;
+		i.produce_rtx_pipeline               = le_pipeline_manager_produce_rtx_pipeline;
+		i.produce_compute_pipeline           = le_pipeline_manager_produce_compute_pipeline;
+		i.introduce_renderpass_signature     = le_pipeline_manager_introduce_renderpass_signature;
+		i.prewarm_graphics_pipelines         = le_pipeline_manager_prewarm_graphics_pipelines;
+		i.get_graphics_pipeline_keys         = le_pipeline_manager_get_graphics_pipeline_keys;
+		i.produce_bindless_texture_index     = le_pipeline_manager_produce_bindless_texture_index;
+		i.produce_bindless_buffer_index      = le_pipeline_manager_produce_bindless_buffer_index;
+		i.find_bindless_texture_index        = le_pipeline_manager_find_bindless_texture_index;
+		i.find_bindless_buffer_index         = le_pipeline_manager_find_bindless_buffer_index;
+		i.get_bindless_descriptor_set_layout = le_pipeline_manager_get_bindless_descriptor_set_layout;
 	}
 	{
 		auto& i = le_backend_vk_api_i->le_shader_module_i;
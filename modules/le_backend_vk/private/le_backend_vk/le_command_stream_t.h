@@ -2,6 +2,8 @@
 
 #include <cstdlib>
 #include <stddef.h>
+#include <new>
+#include <vector>
 
 /*
  * The Command Stream is where the renderer stores the bytecode for
@@ -24,53 +26,174 @@
  * Backend Frame creates new Command Streams so that there is one command
  * stream per renderpass. Command Streams are reset when a frame gets cleared.
  *
- * Command streams work as bump, or arena-allocators. This saves us allocating
- * and de-allocating command streams per-frame. At the same time, command
- * streams may grow, if there are a large number of commands to record.
+ * Command streams work as segmented arena-allocators: commands are bump-
+ * allocated from a list of memory segments. If a command does not fit into
+ * the current segment, we move on to the next segment, and only allocate a
+ * new segment if we have run out of segments. Segments never move, which
+ * means that pointers to commands stay valid until the stream gets reset.
+ *
+ * A command, together with its payload, is always stored contiguously,
+ * inside a single segment.
+ *
+ * Resetting a stream keeps all its segments, so that a stream which gets
+ * re-used each frame stops allocating once it has reached its steady-state
+ * capacity.
+ *
+ * Use `le_command_stream_t::reader_t` to visit the commands of a stream in
+ * the order in which they were recorded.
  *
  */
 
 struct le_command_stream_t {
-	char*  data      = nullptr;
-	size_t size      = 0;
-	size_t capacity  = 0;
-	size_t cmd_count = 0;
-
-	le_command_stream_t()
-	    : size( 0 )
-	    , capacity( 8 ) {
-		data = ( char* )malloc( capacity );
-	}
 
-	~le_command_stream_t() {
+	struct segment_t {
+		char*  data;     // owning
+		size_t size;     // number of bytes in use
+		size_t capacity; // number of bytes available
+	};
 
-		if ( data ) {
-			free( data );
-			size      = 0;
-			cmd_count = 0;
-			data      = nullptr;
+	static constexpr size_t MIN_SEGMENT_CAPACITY = 4096;      // 4 KiB
+	static constexpr size_t MAX_SEGMENT_CAPACITY = 1 << 20;   // 1 MiB, unless a single command needs more
+	std::vector<segment_t>  segments;                         // segments are only ever appended to, never removed until stream gets destroyed
+	size_t                  current_segment_idx = 0;          // index of segment into which we currently emplace commands
+	size_t                  size                = 0;          // total number of bytes in use, over all segments
+	size_t                  cmd_count           = 0;          // total number of commands, over all segments
+
+	le_command_stream_t() = default;
+
+	le_command_stream_t( le_command_stream_t const& )            = delete;
+	le_command_stream_t& operator=( le_command_stream_t const& ) = delete;
+
+	~le_command_stream_t() {
+		for ( auto& s : segments ) {
+			free( s.data );
 		}
+		segments.clear();
+		size      = 0;
+		cmd_count = 0;
 	}
 
 	void reset() {
-		this->cmd_count = 0;
-		this->size      = 0;
+		for ( auto& s : segments ) {
+			s.size = 0;
+		}
+		this->current_segment_idx = 0;
+		this->cmd_count           = 0;
+		this->size                = 0;
 	}
 
 	template <typename T>
 	inline T* emplace_cmd( size_t payload_sz = 0 ) {
 
-		size_t old_sz = this->size;
-		size_t new_sz = old_sz + sizeof( T ) + payload_sz;
+		size_t const cmd_sz = sizeof( T ) + payload_sz;
 
-		while ( new_sz > this->capacity ) {
-			this->capacity *= 2;
-			this->data = ( char* )realloc( this->data, this->capacity );
+		if ( segments.empty() ||
+		     segments[ current_segment_idx ].size + cmd_sz > segments[ current_segment_idx ].capacity ) {
+			produce_segment( cmd_sz );
 		}
 
-		this->size = new_sz;
+		segment_t& segment = segments[ current_segment_idx ];
+
+		char* addr = segment.data + segment.size;
+
+		segment.size += cmd_sz;
+		this->size += cmd_sz;
 		this->cmd_count++;
-		return new ( this->data + old_sz )( T );
+
+		return new ( addr )( T );
+	}
+
+	// Visits commands of a command stream in the order in which they were recorded.
+	//
+	// Note that the reader does not know where one command ends and the next one begins;
+	// the caller must tell it by how many bytes to advance, typically by reading the
+	// size field of the current command's header.
+	class reader_t {
+		segment_t const* segment     = nullptr;
+		segment_t const* segment_end = nullptr;
+		char const*      pos         = nullptr;
+		char const*      pos_end     = nullptr;
+
+		// If the current segment has been fully read, move to the next non-empty segment.
+		inline void skip_exhausted_segments() {
+			while ( pos == pos_end && segment + 1 < segment_end ) {
+				++segment;
+				pos     = segment->data;
+				pos_end = segment->data + segment->size;
+			}
+		}
+
+	  public:
+		explicit reader_t( le_command_stream_t const* stream ) {
+			if ( stream && !stream->segments.empty() ) {
+				segment     = stream->segments.data();
+				segment_end = segment + stream->current_segment_idx + 1; // only segments up to, and including the current segment hold data
+				pos         = segment->data;
+				pos_end     = segment->data + segment->size;
+				skip_exhausted_segments();
+			}
+		}
+
+		// Returns address of the current command.
+		inline void* get() const {
+			return const_cast<char*>( pos );
+		}
+
+		inline void advance( size_t num_bytes ) {
+			pos += num_bytes;
+			skip_exhausted_segments();
+		}
+	};
+
+  private:
+	// Makes the next segment that can hold at least `min_capacity` bytes current -
+	// re-uses a retained segment if possible, otherwise allocates a new segment.
+	void produce_segment( size_t min_capacity ) {
+
+		if ( !segments.empty() ) {
+			// Only ever move past a segment which holds data - this keeps the first
+			// segment in use, even if the first command we emplace is too large for it.
+			if ( segments[ current_segment_idx ].size != 0 ) {
+				current_segment_idx++;
+			}
+		}
+
+		if ( current_segment_idx < segments.size() ) {
+			segment_t& segment = segments[ current_segment_idx ];
+			if ( segment.capacity >= min_capacity ) {
+				return;
+			}
+			// ----------| invariant: retained segment is too small to hold the command
+			//
+			// Since this segment is not in use, we can replace its storage.
+			free( segment.data );
+			segment.capacity = next_segment_capacity( min_capacity );
+			segment.data     = static_cast<char*>( malloc( segment.capacity ) );
+			segment.size     = 0;
+			return;
+		}
+
+		size_t capacity = next_segment_capacity( min_capacity );
+
+		segments.push_back( {
+		    .data     = static_cast<char*>( malloc( capacity ) ),
+		    .size     = 0,
+		    .capacity = capacity,
+		} );
+
+		current_segment_idx = segments.size() - 1;
+	}
+
+	// Segment capacity doubles with every segment, up until MAX_SEGMENT_CAPACITY.
+	size_t next_segment_capacity( size_t min_capacity ) const {
+		size_t capacity = segments.empty() ? MIN_SEGMENT_CAPACITY : segments.back().capacity * 2;
+		if ( capacity > MAX_SEGMENT_CAPACITY ) {
+			capacity = MAX_SEGMENT_CAPACITY;
+		}
+		if ( capacity < min_capacity ) {
+			capacity = min_capacity;
+		}
+		return capacity;
 	}
 };
 
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * FlatMap is an open-addressing hash map with linear probing, which the backend
+ * uses for lookup tables that get rebuilt every frame.
+ *
+ * Unlike std::unordered_map, FlatMap does not allocate per element, and `clear()`
+ * keeps slot storage *and* the values stored in slots alive. A map which gets
+ * cleared and refilled each frame therefore stops allocating as soon as it has
+ * reached its steady-state capacity.
+ *
+ * When a slot gets re-used, its previous value is recycled via
+ * `flat_map_recycle_value()`. For `std::vector` values this calls `clear()`,
+ * so that vectors stored in a FlatMap keep their capacity across frames, too.
+ *
+ * Note that - unlike with std::unordered_map - pointers, references and
+ * iterators to elements are invalidated whenever an insertion makes the map
+ * grow. Individual elements can't be erased; maps may only be cleared in bulk.
+ *
+ */
+
+namespace le {
+
+template <typename V>
+inline void flat_map_recycle_value( V& v ) {
+	v = V{};
+}
+
+template <typename T, typename A>
+inline void flat_map_recycle_value( std::vector<T, A>& v ) {
+	v.clear(); // keep capacity
+}
+
+// ----------------------------------------------------------------------
+
+template <typename K>
+struct FlatMapHash {
+	inline uint64_t operator()( K const& key ) const noexcept {
+		if constexpr ( std::is_pointer_v<K> ) {
+			return uint64_t( reinterpret_cast<uintptr_t>( key ) );
+		} else if constexpr ( std::is_integral_v<K> || std::is_enum_v<K> ) {
+			return uint64_t( key );
+		} else {
+			return uint64_t( std::hash<K>()( key ) );
+		}
+	}
+};
+
+// ----------------------------------------------------------------------
+
+template <typename K, typename V, typename Hash = FlatMapHash<K>>
+class FlatMap {
+
+  public:
+	using key_type    = K;
+	using mapped_type = V;
+	using value_type  = std::pair<K, V>;
+
+  private:
+	std::vector<value_type> slots;      // number of slots is always zero, or a power of two
+	std::vector<uint8_t>    occupied;   // per slot: 1 if slot holds a live element, 0 otherwise
+	size_t                  count = 0;  // number of live elements
+	uint32_t                shift = 64; // 64 - log2( number of slots )
+
+	static constexpr size_t   npos           = ~size_t( 0 );
+	static constexpr size_t   MIN_SLOT_COUNT = 16;
+	static constexpr uint64_t FIBONACCI_MUL  = 0x9e3779b97f4a7c15ull; // 2^64 / golden ratio
+
+	// Fibonacci hashing - uses the high bits of the product, so that keys with
+	// low-entropy low bits (such as pointers) are spread out evenly.
+	inline size_t home_slot( K const& key ) const {
+		return size_t( ( Hash()( key ) * FIBONACCI_MUL ) >> shift );
+	}
+
+	size_t find_slot( K const& key ) const {
+		if ( count == 0 ) {
+			return npos;
+		}
+		size_t const mask = slots.size() - 1;
+		for ( size_t i = home_slot( key ); occupied[ i ]; i = ( i + 1 ) & mask ) {
+			if ( slots[ i ].first == key ) {
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	void rehash( size_t slot_count ) {
+		std::vector<value_type> old_slots( slot_count );
+		std::vector<uint8_t>    old_occupied( slot_count, 0 );
+
+		std::swap( slots, old_slots );
+		std::swap( occupied, old_occupied );
+
+		uint32_t log2_slot_count = 0;
+		while ( ( size_t( 1 ) << log2_slot_count ) < slot_count ) {
+			log2_slot_count++;
+		}
+
+		shift = 64 - log2_slot_count;
+		count = 0;
+
+		for ( size_t i = 0; i != old_slots.size(); i++ ) {
+			if ( old_occupied[ i ] ) {
+				bool   was_inserted;
+				size_t j          = produce_slot( old_slots[ i ].first, was_inserted );
+				slots[ j ].second = std::move( old_slots[ i ].second );
+			}
+		}
+	}
+
+	// Returns index of slot for key - inserts key if it was not yet present.
+	// Note that the value of a newly inserted slot still holds whatever value
+	// was previously stored in the slot; callers must assign or recycle it.
+	size_t produce_slot( K const& key, bool& was_inserted ) {
+		if ( ( count + 1 ) * 2 > slots.size() ) {
+			// keep load factor at or below 0.5
+			rehash( std::max( MIN_SLOT_COUNT, slots.size() * 2 ) );
+		}
+		size_t const mask = slots.size() - 1;
+		size_t       i    = home_slot( key );
+		for ( ; occupied[ i ]; i = ( i + 1 ) & mask ) {
+			if ( slots[ i ].first == key ) {
+				was_inserted = false;
+				return i;
+			}
+		}
+		occupied[ i ]    = 1;
+		slots[ i ].first = key;
+		count++;
+		was_inserted = true;
+		return i;
+	}
+
+	static void assign_value( V& dst ) {
+		flat_map_recycle_value( dst );
+	}
+
+	template <typename Arg>
+	static void assign_value( V& dst, Arg&& arg ) {
+		dst = std::forward<Arg>( arg );
+	}
+
+	template <typename Map, typename Value>
+	class iterator_t {
+		Map*   map;
+		size_t idx;
+
+		void skip_empty() {
+			while ( idx != map->slots.size() && !map->occupied[ idx ] ) {
+				idx++;
+			}
+		}
+
+	  public:
+		iterator_t( Map* map_, size_t idx_ )
+		    : map( map_ )
+		    , idx( idx_ ) {
+			skip_empty();
+		}
+		Value& operator*() const {
+			return map->slots[ idx ];
+		}
+		Value* operator->() const {
+			return &map->slots[ idx ];
+		}
+		iterator_t& operator++() {
+			idx++;
+			skip_empty();
+			return *this;
+		}
+		bool operator==( iterator_t const& rhs ) const {
+			return idx == rhs.idx;
+		}
+		bool operator!=( iterator_t const& rhs ) const {
+			return idx != rhs.idx;
+		}
+	};
+
+  public:
+	using iterator       = iterator_t<FlatMap, value_type>;
+	using const_iterator = iterator_t<FlatMap const, value_type const>;
+
+	iterator begin() {
+		return iterator( this, 0 );
+	}
+	iterator end() {
+		return iterator( this, slots.size() );
+	}
+	const_iterator begin() const {
+		return const_iterator( this, 0 );
+	}
+	const_iterator end() const {
+		return const_iterator( this, slots.size() );
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	// Removes all elements - keeps slot storage, and values, so that
+	// these may be recycled when the map gets filled again.
+	void clear() {
+		std::fill( occupied.begin(), occupied.end(), uint8_t( 0 ) );
+		count = 0;
+	}
+
+	void reserve( size_t num_elements ) {
+		size_t slot_count = MIN_SLOT_COUNT;
+		while ( slot_count < num_elements * 2 ) {
+			slot_count *= 2;
+		}
+		if ( slot_count > slots.size() ) {
+			rehash( slot_count );
+		}
+	}
+
+	iterator find( K const& key ) {
+		size_t i = find_slot( key );
+		return i == npos ? end() : iterator( this, i );
+	}
+
+	const_iterator find( K const& key ) const {
+		size_t i = find_slot( key );
+		return i == npos ? end() : const_iterator( this, i );
+	}
+
+	V& at( K const& key ) {
+		size_t i = find_slot( key );
+		assert( i != npos && "key must exist" );
+		return slots[ i ].second;
+	}
+
+	V const& at( K const& key ) const {
+		size_t i = find_slot( key );
+		assert( i != npos && "key must exist" );
+		return slots[ i ].second;
+	}
+
+	V& operator[]( K const& key ) {
+		bool   was_inserted;
+		size_t i = produce_slot( key, was_inserted );
+		if ( was_inserted ) {
+			assign_value( slots[ i ].second );
+		}
+		return slots[ i ].second;
+	}
+
+	// Inserts value for key only if key was not yet present, returns iterator
+	// to element for key, and whether insertion took place.
+	template <typename... Args>
+	std::pair<iterator, bool> try_emplace( K const& key, Args&&... args ) {
+		bool   was_inserted;
+		size_t i = produce_slot( key, was_inserted );
+		if ( was_inserted ) {
+			assign_value( slots[ i ].second, std::forward<Args>( args )... );
+		}
+		return { iterator( this, i ), was_inserted };
+	}
+
+	template <typename Arg>
+	std::pair<iterator, bool> emplace( K const& key, Arg&& value ) {
+		return try_emplace( key, std::forward<Arg>( value ) );
+	}
+};
+
+} // namespace le
@@ -12,6 +12,14 @@
 #include <filesystem>
 #include <iostream>
 #include <iomanip>
+#include <atomic>
+
+#ifndef _MSC_VER
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
 
 #define GLM_FORCE_RIGHT_HANDED // glTF uses right handed coordinate system, and we're following its lead.
 #define GLM_ENABLE_EXPERIMENTAL
@@ -47,20 +55,99 @@ How to use this library:
 // the stage may also optimise data
 
 struct le_gltf_o {
-	cgltf_options         options = {};
-	cgltf_data*           data    = nullptr;
-	cgltf_result          result  = {};
-	std::filesystem::path gltf_file_path; // owning
+	cgltf_options                     options = {};
+	cgltf_data*                       data    = nullptr;
+	cgltf_result                      result  = {};
+	std::filesystem::path             gltf_file_path; // owning
+	std::unordered_map<void*, size_t> file_mappings;  // memory-mapped files, and their sizes
+	std::atomic<uint32_t>             ref_count{ 1 }; // one for the le_gltf_o handle, plus one per buffer lent to a stage
 };
 
 // ----------------------------------------------------------------------
+// We memory-map .gltf, .glb and .bin files instead of reading them into
+// allocated memory - so that stage buffers may read from the mapping
+// directly, and we don't hold two copies of buffer data while importing.
+#ifndef _MSC_VER
+
+static cgltf_result gltf_file_read( cgltf_memory_options const* memory_options, cgltf_file_options const* file_options, char const* path, cgltf_size* size, void** data ) {
+
+	auto self = static_cast<le_gltf_o*>( file_options->user_data );
+
+	int fd = open( path, O_RDONLY );
+
+	if ( fd == -1 ) {
+		return cgltf_result_file_not_found;
+	}
 
+	struct stat file_stat {};
+
+	if ( fstat( fd, &file_stat ) == -1 || file_stat.st_size == 0 ) {
+		close( fd );
+		return cgltf_result_io_error;
+	}
+
+	size_t file_size = size_t( file_stat.st_size );
+	void*  mapping   = mmap( nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+	// The mapping keeps the file open, we don't need the file descriptor anymore.
+	close( fd );
+
+	if ( mapping == MAP_FAILED ) {
+		return cgltf_result_io_error;
+	}
+
+	self->file_mappings[ mapping ] = file_size;
+
+	if ( size ) {
+		*size = file_size;
+	}
+
+	*data = mapping;
+
+	return cgltf_result_success;
+}
+
+static void gltf_file_release( cgltf_memory_options const* memory_options, cgltf_file_options const* file_options, void* data ) {
+
+	auto self = static_cast<le_gltf_o*>( file_options->user_data );
+	auto it   = self->file_mappings.find( data );
+
+	if ( it != self->file_mappings.end() ) {
+		munmap( it->first, it->second );
+		self->file_mappings.erase( it );
+	}
+}
+
+#endif
+
+// ----------------------------------------------------------------------
+// Drops one reference - frees all gltf data once the last reference is gone.
+static void le_gltf_release( le_gltf_o* self ) {
+	if ( self->ref_count.fetch_sub( 1 ) != 1 ) {
+		return;
+	}
+
+	// ----------| invariant: this was the last reference
+
+	if ( self->data ) {
+		cgltf_free( self->data );
+	}
+
+	delete self;
+}
+
+// ----------------------------------------------------------------------
+// Called by stage once it has uploaded a buffer which it borrowed from us.
+static void gltf_buffer_release( void* user_data ) {
+	le_gltf_release( static_cast<le_gltf_o*>( user_data ) );
+}
+
+// ----------------------------------------------------------------------
+// Note that buffer data may outlive this call: stage buffers borrow buffer
+// data until they have been uploaded.
 static void le_gltf_destroy( le_gltf_o* self ) {
 	if ( self ) {
-		if ( self->data ) {
-			cgltf_free( self->data );
-		}
-		delete self;
+		le_gltf_release( self );
 	}
 }
 
@@ -70,7 +157,14 @@ static le_gltf_o* le_gltf_create( char const* path ) {
 
 	assert( path && "valid path must be set" );
 
-	auto self    = new le_gltf_o{};
+	auto self = new le_gltf_o{};
+
+#ifndef _MSC_VER
+	self->options.file.read      = gltf_file_read;
+	self->options.file.release   = gltf_file_release;
+	self->options.file.user_data = self;
+#endif
+
 	self->result = cgltf_parse_file( &self->options, path, &self->data );
 
 	if ( self->result == cgltf_result_success ) {
@@ -275,12 +369,21 @@ static bool le_gltf_import( le_gltf_o* self, le_stage_o* stage ) {
 		// We must copy because we cannot otherwise guarantee that the image data will still be available when stage
 		// uploads it to the gpu, as the upload step happens in another method than the import step.
 
+		// We hand all images to the stage in one go, so that the stage may decode them in parallel.
+
 		cgltf_image const* images_begin = self->data->images;
 		auto               images_end   = images_begin + self->data->images_count;
 
-		for ( auto img = images_begin; img != images_end; img++ ) {
+		std::vector<std::string>   image_paths( self->data->images_count ); // must outlive create_images
+		std::vector<le_image_info> image_infos( self->data->images_count );
+		std::vector<uint32_t>      image_indices( self->data->images_count );
+
+		uint32_t i = 0;
+		for ( auto img = images_begin; img != images_end; img++, i++ ) {
 
-			uint32_t stage_idx = 0;
+			le_image_info& info = image_infos[ i ];
+			info.debug_name     = img->name ? img->name : img->uri;
+			info.mip_levels     = 0;
 
 			// TODO: must check if uri is not a data uri!
 
@@ -294,20 +397,25 @@ static bool le_gltf_import( le_gltf_o* self, le_stage_o* stage ) {
 					img_path = self->gltf_file_path.parent_path() / img_path;
 				}
 
-				stage_idx = le_stage_i.create_image_from_file_path( stage, img_path.c_str(), img->name ? img->name : img->uri, 0 );
+				image_paths[ i ] = img_path.string();
+				info.file_path   = image_paths[ i ].c_str();
 
 			} else if ( img->buffer_view && img->buffer_view->buffer && img->buffer_view->buffer->data ) {
 
 				unsigned char const* data = static_cast<unsigned char const*>( img->buffer_view->buffer->data );
-				data += img->buffer_view->offset;
-				size_t data_sz = img->buffer_view->size;
-				stage_idx      = le_stage_i.create_image_from_memory( stage, data, uint32_t( data_sz ), img->name ? img->name : img->uri, 0 );
+				info.file_memory          = data + img->buffer_view->offset;
+				info.file_memory_sz       = uint32_t( img->buffer_view->size );
 
 			} else {
 				assert( false && "image must either have inline data or provide an uri" );
 			}
+		}
 
-			images_map.insert( { img, stage_idx } );
+		le_stage_i.create_images( stage, image_infos.data(), uint32_t( image_infos.size() ), image_indices.data() );
+
+		i = 0;
+		for ( auto img = images_begin; img != images_end; img++, i++ ) {
+			images_map.insert( { img, image_indices[ i ] } );
 		}
 	}
 
@@ -377,10 +485,15 @@ static bool le_gltf_import( le_gltf_o* self, le_stage_o* stage ) {
 
 		char debug_name[ 32 ];
 
+		// Stage buffers borrow buffer data from us, instead of copying it. Each
+		// borrowed buffer holds a reference, which the stage drops once the
+		// buffer has been uploaded.
+
 		int i = 0;
 		for ( auto b = buffers_begin; b != buffers_end; b++, ++i ) {
 			snprintf( debug_name, 32, "glTF_buffer_%d", i );
-			uint32_t stage_idx = le_stage_i.create_buffer( stage, b->data, uint32_t( b->size ), debug_name );
+			self->ref_count++;
+			uint32_t stage_idx = le_stage_i.create_buffer_borrowed( stage, b->data, uint32_t( b->size ), debug_name, gltf_buffer_release, self );
 			buffer_map.insert( { b, stage_idx } );
 		}
 	}
@@ -3,14 +3,28 @@
 
 #include <math.h>
 #include <vector>
+#include <algorithm>
 #include <filesystem> // for file loading
 #include <iostream>   // for file loading
 #include <fstream>    // for file loading
 #include <iomanip>    // for file loading
 
 #include <cstring>
+#include <atomic>
+
+#ifndef _MSC_VER
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
 
 #include "le_mesh_types.h" //
+#include "le_jobs.h"
+
+#ifndef LE_MT
+#	define LE_MT 0
+#endif
 
 #ifdef _WIN32
 #	define __PRETTY_FUNCTION__ __FUNCSIG__
@@ -39,160 +53,1344 @@ static void le_mesh_clear( le_mesh_o* self ) {
 	self->tangents.clear();
 	self->colours.clear();
 	self->indices.clear();
+	self->indices_u32.clear();
+	self->interleaved.clear();
+	self->meshlets.clear();
+	self->meshlet_vertices.clear();
+	self->meshlet_triangles.clear();
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_vertices( le_mesh_o* self, size_t* count, float const** vertices ) {
+	if ( count ) {
+		*count = self->vertices.size();
+	}
+	if ( vertices ) {
+		*vertices = static_cast<float*>( &self->vertices[ 0 ].x );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_tangents( le_mesh_o* self, size_t* count, float const** tangents ) {
+	if ( count ) {
+		*count = self->tangents.size();
+	}
+	if ( tangents ) {
+		*tangents = static_cast<float*>( &self->tangents[ 0 ].x );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_indices( le_mesh_o* self, size_t* count, uint16_t const** indices ) {
+	if ( count ) {
+		*count = self->indices.size();
+	}
+	if ( indices ) {
+		*indices = self->indices.data();
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_normals( le_mesh_o* self, size_t* count, float const** normals ) {
+	if ( count ) {
+		*count = self->normals.size();
+	}
+	if ( normals ) {
+		*normals = static_cast<float*>( &self->normals[ 0 ].x );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_colours( le_mesh_o* self, size_t* count, float const** colours ) {
+	if ( count ) {
+		*count = self->colours.size();
+	}
+	if ( colours ) {
+		*colours = static_cast<float*>( &self->colours[ 0 ].x );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_uvs( le_mesh_o* self, size_t* count, float const** uvs ) {
+	if ( count ) {
+		*count = self->normals.size();
+	}
+	if ( uvs ) {
+		*uvs = static_cast<float*>( &self->uvs[ 0 ].x );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_data( le_mesh_o* self, size_t* numVertices, size_t* numIndices, float const** vertices, float const** normals, float const** uvs, float const** colours, uint16_t const** indices ) {
+	if ( numVertices ) {
+		*numVertices = self->vertices.size();
+	}
+	if ( numIndices ) {
+		*numIndices = self->indices.size();
+	}
+
+	if ( vertices ) {
+		*vertices = self->vertices.empty() ? nullptr : static_cast<float const*>( &self->vertices[ 0 ].x );
+	}
+
+	if ( colours ) {
+		*colours = self->colours.empty() ? nullptr : static_cast<float const*>( &self->colours[ 0 ].x );
+	}
+
+	if ( normals ) {
+		*normals = self->normals.empty() ? nullptr : static_cast<float const*>( &self->normals[ 0 ].x );
+	}
+
+	if ( uvs ) {
+		*uvs = self->uvs.empty() ? nullptr : static_cast<float const*>( &self->uvs[ 0 ].x );
+	}
+
+	if ( indices ) {
+		*indices = self->indices.data();
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t le_mesh_get_index_size( le_mesh_o* self ) {
+	return self->indices_u32.empty() ? sizeof( uint16_t ) : sizeof( uint32_t );
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_indices_u32( le_mesh_o* self, size_t* count, uint32_t const** indices ) {
+	if ( count ) {
+		*count = self->indices_u32.size();
+	}
+	if ( indices ) {
+		*indices = self->indices_u32.data();
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief copies mesh indices into `indices`, whichever index size the mesh uses.
+static void mesh_read_indices( le_mesh_o const* self, std::vector<uint32_t>& indices ) {
+	if ( self->indices_u32.empty() ) {
+		indices.assign( self->indices.begin(), self->indices.end() );
+	} else {
+		indices = self->indices_u32;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief stores indices using the smallest index size which can address all vertices.
+static void mesh_write_indices( le_mesh_o* self, std::vector<uint32_t>& indices ) {
+	if ( self->vertices.size() <= 0x10000 ) {
+		self->indices.resize( indices.size() );
+		for ( size_t i = 0; i != indices.size(); i++ ) {
+			self->indices[ i ] = uint16_t( indices[ i ] );
+		}
+		self->indices_u32.clear();
+	} else {
+		self->indices.clear();
+		self->indices_u32.swap( indices );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_interleaved_vertices( le_mesh_o* self, size_t* count, le_mesh_vertex_layout_t* layout, float const** vertices ) {
+
+	size_t const num_vertices = self->vertices.size();
+
+	// Attributes which don't have one element per vertex are left out.
+
+	bool const has_normals  = self->normals.size() == num_vertices;
+	bool const has_uvs      = self->uvs.size() == num_vertices;
+	bool const has_colours  = self->colours.size() == num_vertices;
+	bool const has_tangents = self->tangents.size() == num_vertices;
+
+	le_mesh_vertex_layout_t l{};
+	uint32_t                num_floats = 0; // number of floats per vertex
+
+	auto add_attribute = [ & ]( bool has_attribute, uint32_t attribute_num_floats ) -> uint32_t {
+		if ( !has_attribute ) {
+			return LE_MESH_NO_ATTRIBUTE;
+		}
+		uint32_t offset = num_floats * sizeof( float );
+		num_floats += attribute_num_floats;
+		return offset;
+	};
+
+	l.position_offset = add_attribute( true, 3 );
+	l.normal_offset   = add_attribute( has_normals, 3 );
+	l.uv_offset       = add_attribute( has_uvs, 2 );
+	l.colour_offset   = add_attribute( has_colours, 4 );
+	l.tangent_offset  = add_attribute( has_tangents, 3 );
+	l.stride          = num_floats * sizeof( float );
+
+	self->interleaved.resize( num_vertices * num_floats );
+
+	float* dst = self->interleaved.data();
+
+	for ( size_t i = 0; i != num_vertices; i++ ) {
+		// clang-format off
+		dst = std::copy_n( &self->vertices[ i ].x, 3, dst );
+		if ( has_normals  ) dst = std::copy_n( &self->normals [ i ].x, 3, dst );
+		if ( has_uvs      ) dst = std::copy_n( &self->uvs     [ i ].x, 2, dst );
+		if ( has_colours  ) dst = std::copy_n( &self->colours [ i ].x, 4, dst );
+		if ( has_tangents ) dst = std::copy_n( &self->tangents[ i ].x, 3, dst );
+		// clang-format on
+	}
+
+	if ( count ) {
+		*count = num_vertices;
+	}
+	if ( layout ) {
+		*layout = l;
+	}
+	if ( vertices ) {
+		*vertices = self->interleaved.data();
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static constexpr uint32_t VERTEX_CACHE_SIZE      = 16;    // number of entries in simulated post-transform vertex cache
+static constexpr float    OVERDRAW_ACMR_THRESHOLD = 1.05f; // allowed vertex cache efficiency loss when splitting clusters for overdraw
+
+/// \brief reorders triangles for post-transform vertex cache efficiency, using "Tipsify",
+/// from: Sander, Nehab, Barczak: "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (2007).
+/// \details Writes the index of the first triangle of each cluster into `cluster_starts` - clusters
+/// begin wherever the algorithm had to jump, because it had run out of adjacent triangles.
+static void optimize_vertex_cache( std::vector<uint32_t>& indices, size_t num_vertices, std::vector<uint32_t>& cluster_starts ) {
+
+	size_t const num_triangles = indices.size() / 3;
+
+	// -- Build vertex-triangle adjacency: triangles for vertex v are
+	// adjacency[ offsets[ v ] ... offsets[ v + 1 ] )
+
+	std::vector<uint32_t> live( num_vertices, 0 ); // number of not yet emitted triangles per vertex
+	std::vector<uint32_t> offsets( num_vertices + 1, 0 );
+	std::vector<uint32_t> adjacency( indices.size() );
+
+	for ( uint32_t idx : indices ) {
+		live[ idx ]++;
+	}
+
+	for ( size_t v = 0; v != num_vertices; v++ ) {
+		offsets[ v + 1 ] = offsets[ v ] + live[ v ];
+	}
+
+	{
+		std::vector<uint32_t> fill( offsets.begin(), offsets.end() - 1 );
+		for ( size_t i = 0; i != indices.size(); i++ ) {
+			adjacency[ fill[ indices[ i ] ]++ ] = uint32_t( i / 3 );
+		}
+	}
+
+	// ----------| invariant: adjacency is complete
+
+	std::vector<uint32_t> cache_time( num_vertices, 0 );
+	std::vector<uint8_t>  is_emitted( num_triangles, 0 );
+	std::vector<uint32_t> dead_end; // stack of recently used vertices
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> result;
+
+	result.reserve( indices.size() );
+	cluster_starts.clear();
+
+	uint32_t time   = VERTEX_CACHE_SIZE + 1; // so that no vertex starts out in cache
+	size_t   cursor = 0;                     // next vertex to consider once we run out of dead-end vertices
+	int64_t  fan    = num_vertices ? 0 : -1; // current fanning vertex
+
+	cluster_starts.push_back( 0 );
+
+	while ( fan >= 0 ) {
+
+		candidates.clear();
+
+		// -- Emit all triangles around fanning vertex which were not emitted yet
+
+		for ( uint32_t a = offsets[ fan ]; a != offsets[ fan + 1 ]; a++ ) {
+
+			uint32_t const t = adjacency[ a ];
+
+			if ( is_emitted[ t ] ) {
+				continue;
+			}
+
+			for ( uint32_t k = 0; k != 3; k++ ) {
+				uint32_t const v = indices[ t * 3 + k ];
+				result.push_back( v );
+				dead_end.push_back( v );
+				candidates.push_back( v );
+				live[ v ]--;
+				if ( time - cache_time[ v ] > VERTEX_CACHE_SIZE ) {
+					cache_time[ v ] = time++;
+				}
+			}
+
+			is_emitted[ t ] = 1;
+		}
+
+		// -- Pick next fanning vertex: the candidate which stays in cache longest,
+		// yet still has triangles left to emit - it must not fall out of the
+		// cache while we emit its remaining triangles.
+
+		int64_t  next          = -1;
+		uint32_t best_priority = 0;
+
+		for ( uint32_t v : candidates ) {
+			if ( live[ v ] == 0 ) {
+				continue;
+			}
+			uint32_t priority = 0;
+			if ( time - cache_time[ v ] + 2 * live[ v ] <= VERTEX_CACHE_SIZE ) {
+				priority = time - cache_time[ v ];
+			}
+			if ( next < 0 || priority > best_priority ) {
+				next          = v;
+				best_priority = priority;
+			}
+		}
+
+		if ( next < 0 ) {
+
+			// Dead end - try most recently used vertices first, then any vertex
+			// with triangles left. Either way, we start a new cluster.
+
+			while ( !dead_end.empty() && next < 0 ) {
+				uint32_t v = dead_end.back();
+				dead_end.pop_back();
+				if ( live[ v ] ) {
+					next = v;
+				}
+			}
+
+			for ( ; cursor != num_vertices && next < 0; cursor++ ) {
+				if ( live[ cursor ] ) {
+					next = int64_t( cursor );
+				}
+			}
+
+			if ( next >= 0 && cluster_starts.back() != result.size() / 3 ) {
+				cluster_starts.push_back( uint32_t( result.size() / 3 ) );
+			}
+		}
+
+		fan = next;
+	}
+
+	indices.swap( result );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief splits clusters further, wherever the vertex cache efficiency of the cluster so far
+/// is already about as good as that of the whole cluster - so that we have more, and smaller
+/// clusters to sort for overdraw, without losing much vertex cache efficiency.
+static void split_clusters( std::vector<uint32_t> const& indices, size_t num_vertices, std::vector<uint32_t>& cluster_starts ) {
+
+	size_t const num_triangles = indices.size() / 3;
+
+	std::vector<uint32_t> cache_time( num_vertices, 0 );
+	uint32_t              time = VERTEX_CACHE_SIZE + 1;
+
+	// Returns number of cache misses for triangle t, and updates simulated cache.
+	auto simulate_triangle = [ & ]( size_t t ) -> uint32_t {
+		uint32_t misses = 0;
+		for ( size_t k = 0; k != 3; k++ ) {
+			uint32_t const v = indices[ t * 3 + k ];
+			if ( time - cache_time[ v ] > VERTEX_CACHE_SIZE ) {
+				cache_time[ v ] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	};
+
+	auto flush_cache = [ & ]() {
+		time += VERTEX_CACHE_SIZE + 1;
+	};
+
+	std::vector<uint32_t> result;
+
+	for ( size_t c = 0; c != cluster_starts.size(); c++ ) {
+
+		size_t const begin = cluster_starts[ c ];
+		size_t const end   = c + 1 != cluster_starts.size() ? cluster_starts[ c + 1 ] : num_triangles;
+
+		// -- Measure average cache misses per triangle (ACMR) for whole cluster
+
+		uint32_t cluster_misses = 0;
+
+		flush_cache();
+		for ( size_t t = begin; t != end; t++ ) {
+			cluster_misses += simulate_triangle( t );
+		}
+
+		float const threshold = OVERDRAW_ACMR_THRESHOLD * float( cluster_misses ) / float( end - begin );
+
+		// -- Split wherever ACMR since the last split drops below threshold
+
+		uint32_t misses = 0;
+		size_t   start  = begin;
+
+		result.push_back( uint32_t( begin ) );
+
+		flush_cache();
+		for ( size_t t = begin; t != end; t++ ) {
+			misses += simulate_triangle( t );
+			if ( t + 1 != end && float( misses ) / float( t + 1 - start ) <= threshold ) {
+				result.push_back( uint32_t( t + 1 ) );
+				start  = t + 1;
+				misses = 0;
+				flush_cache();
+			}
+		}
+	}
+
+	cluster_starts.swap( result );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief sorts clusters of triangles so that clusters which face away from the centre of the mesh
+/// come first - these are most likely to occlude other clusters, which reduces overdraw.
+static void optimize_overdraw( std::vector<uint32_t>& indices, std::vector<glm::vec3> const& positions, std::vector<uint32_t> const& cluster_starts ) {
+
+	size_t const num_triangles = indices.size() / 3;
+
+	if ( num_triangles == 0 ) {
+		return;
+	}
+
+	// -- Mesh centroid, weighted by triangle area
+
+	glm::vec3 mesh_centroid{ 0 };
+	float     mesh_area = 0;
+
+	for ( size_t t = 0; t != num_triangles; t++ ) {
+		glm::vec3 const& p0   = positions[ indices[ t * 3 + 0 ] ];
+		glm::vec3 const& p1   = positions[ indices[ t * 3 + 1 ] ];
+		glm::vec3 const& p2   = positions[ indices[ t * 3 + 2 ] ];
+		float const      area = glm::length( glm::cross( p1 - p0, p2 - p0 ) );
+		mesh_centroid += area * ( p0 + p1 + p2 ) / 3.f;
+		mesh_area += area;
+	}
+
+	if ( mesh_area > 0 ) {
+		mesh_centroid /= mesh_area;
+	}
+
+	// -- Sort key per cluster: how far its centroid lies out along its average normal
+
+	struct cluster_t {
+		uint32_t begin;
+		uint32_t end;
+		float    sort_key;
+	};
+
+	std::vector<cluster_t> clusters( cluster_starts.size() );
+
+	for ( size_t c = 0; c != cluster_starts.size(); c++ ) {
+
+		cluster_t& cluster = clusters[ c ];
+		cluster.begin      = cluster_starts[ c ];
+		cluster.end        = c + 1 != cluster_starts.size() ? cluster_starts[ c + 1 ] : uint32_t( num_triangles );
+
+		glm::vec3 centroid{ 0 };
+		glm::vec3 normal{ 0 };
+		float     area = 0;
+
+		for ( uint32_t t = cluster.begin; t != cluster.end; t++ ) {
+			glm::vec3 const& p0     = positions[ indices[ t * 3 + 0 ] ];
+			glm::vec3 const& p1     = positions[ indices[ t * 3 + 1 ] ];
+			glm::vec3 const& p2     = positions[ indices[ t * 3 + 2 ] ];
+			glm::vec3 const  cross  = glm::cross( p1 - p0, p2 - p0 ); // length is twice the triangle area
+			float const      t_area = glm::length( cross );
+			centroid += t_area * ( p0 + p1 + p2 ) / 3.f;
+			normal += cross;
+			area += t_area;
+		}
+
+		if ( area > 0 ) {
+			centroid /= area;
+		}
+
+		float const normal_length = glm::length( normal );
+
+		cluster.sort_key = normal_length > 0 ? glm::dot( centroid - mesh_centroid, normal / normal_length ) : 0.f;
+	}
+
+	std::stable_sort( clusters.begin(), clusters.end(), []( cluster_t const& lhs, cluster_t const& rhs ) {
+		return lhs.sort_key > rhs.sort_key;
+	} );
+
+	std::vector<uint32_t> result;
+	result.reserve( indices.size() );
+
+	for ( auto const& cluster : clusters ) {
+		result.insert( result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3 );
+	}
+
+	indices.swap( result );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief reorders vertex attributes so that vertices are stored in the order in which
+/// indices first refer to them - which makes vertex fetches more likely to hit memory
+/// that was fetched just before. Vertices which no index refers to move to the end.
+template <typename T>
+static void remap_attribute( std::vector<T>& attribute, std::vector<uint32_t> const& remap ) {
+	if ( attribute.size() != remap.size() ) {
+		return;
+	}
+	std::vector<T> result( attribute.size() );
+	for ( size_t v = 0; v != remap.size(); v++ ) {
+		result[ remap[ v ] ] = attribute[ v ];
+	}
+	attribute.swap( result );
+}
+
+static void optimize_vertex_fetch( le_mesh_o* self, std::vector<uint32_t>& indices ) {
+
+	size_t const num_vertices = self->vertices.size();
+
+	std::vector<uint32_t> remap( num_vertices, ~0u ); // old vertex index -> new vertex index
+	uint32_t              next = 0;
+
+	for ( uint32_t& idx : indices ) {
+		if ( remap[ idx ] == ~0u ) {
+			remap[ idx ] = next++;
+		}
+		idx = remap[ idx ];
+	}
+
+	for ( auto& r : remap ) {
+		if ( r == ~0u ) {
+			r = next++;
+		}
+	}
+
+	remap_attribute( self->vertices, remap );
+	remap_attribute( self->normals, remap );
+	remap_attribute( self->colours, remap );
+	remap_attribute( self->uvs, remap );
+	remap_attribute( self->tangents, remap );
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_optimize( le_mesh_o* self ) {
+
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> cluster_starts;
+
+	mesh_read_indices( self, indices );
+
+	size_t const num_vertices = self->vertices.size();
+
+	// Ignore any trailing incomplete triangle.
+	indices.resize( indices.size() - indices.size() % 3 );
+
+	if ( indices.empty() ) {
+		return;
+	}
+
+	if ( *std::max_element( indices.begin(), indices.end() ) >= num_vertices ) {
+		std::cerr << __PRETTY_FUNCTION__ << ": Mesh indices refer to missing vertices, cannot optimize." << std::endl
+		          << std::flush;
+		return;
+	}
+
+	optimize_vertex_cache( indices, num_vertices, cluster_starts );
+	split_clusters( indices, num_vertices, cluster_starts );
+	optimize_overdraw( indices, self->vertices, cluster_starts );
+	optimize_vertex_fetch( self, indices );
+
+	mesh_write_indices( self, indices );
+
+	// Meshlets refer to triangles in their previous order.
+	self->meshlets.clear();
+	self->meshlet_vertices.clear();
+	self->meshlet_triangles.clear();
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief splits mesh into meshlets, greedily, in index order - call optimize first, so that
+/// neighbouring triangles are likely to end up in the same meshlet.
+static void le_mesh_generate_meshlets( le_mesh_o* self, uint32_t max_vertices, uint32_t max_triangles ) {
+
+	max_vertices  = max_vertices ? std::min( max_vertices, 256u ) : 64; // meshlet triangles store 8 bit indices
+	max_triangles = max_triangles ? max_triangles : 124;
+
+	assert( max_vertices >= 3 && "meshlet must be able to hold at least one triangle" );
+
+	self->meshlets.clear();
+	self->meshlet_vertices.clear();
+	self->meshlet_triangles.clear();
+
+	std::vector<uint32_t> indices;
+	mesh_read_indices( self, indices );
+
+	size_t const num_vertices = self->vertices.size();
+
+	std::vector<uint8_t> local_index( num_vertices, 0xff ); // index of vertex within current meshlet, if used
+	std::vector<uint8_t> is_used( num_vertices, 0 );        // whether vertex is used by current meshlet
+
+	le_meshlet_t meshlet{};
+
+	auto finish_meshlet = [ & ]() {
+		if ( meshlet.triangle_count == 0 ) {
+			return;
+		}
+
+		// Bounding sphere around bounding box of meshlet vertices.
+
+		uint32_t const* v_begin = self->meshlet_vertices.data() + meshlet.vertex_offset;
+		uint32_t const* v_end   = v_begin + meshlet.vertex_count;
+
+		glm::vec3 bb_min = self->vertices[ *v_begin ];
+		glm::vec3 bb_max = bb_min;
+
+		for ( auto v = v_begin; v != v_end; v++ ) {
+			bb_min = glm::min( bb_min, self->vertices[ *v ] );
+			bb_max = glm::max( bb_max, self->vertices[ *v ] );
+		}
+
+		glm::vec3 const centre = ( bb_min + bb_max ) * 0.5f;
+		float           radius = 0;
+
+		for ( auto v = v_begin; v != v_end; v++ ) {
+			radius = std::max( radius, glm::distance( centre, self->vertices[ *v ] ) );
+			is_used[ *v ] = 0;
+		}
+
+		meshlet.bounding_sphere[ 0 ] = centre.x;
+		meshlet.bounding_sphere[ 1 ] = centre.y;
+		meshlet.bounding_sphere[ 2 ] = centre.z;
+		meshlet.bounding_sphere[ 3 ] = radius;
+
+		self->meshlets.push_back( meshlet );
+
+		meshlet                 = {};
+		meshlet.vertex_offset   = uint32_t( self->meshlet_vertices.size() );
+		meshlet.triangle_offset = uint32_t( self->meshlet_triangles.size() );
+	};
+
+	for ( size_t t = 0; t + 2 < indices.size(); t += 3 ) {
+
+		uint32_t const* tri = &indices[ t ];
+
+		if ( tri[ 0 ] >= num_vertices || tri[ 1 ] >= num_vertices || tri[ 2 ] >= num_vertices ) {
+			continue;
+		}
+
+		uint32_t num_new_vertices = 0;
+
+		for ( uint32_t k = 0; k != 3; k++ ) {
+			// Note that a degenerate triangle may use the same vertex twice.
+			bool const is_repeat = ( k > 0 && tri[ k ] == tri[ 0 ] ) || ( k > 1 && tri[ k ] == tri[ 1 ] );
+			if ( !is_used[ tri[ k ] ] && !is_repeat ) {
+				num_new_vertices++;
+			}
+		}
+
+		if ( meshlet.vertex_count + num_new_vertices > max_vertices ||
+		     meshlet.triangle_count + 1 > max_triangles ) {
+			finish_meshlet();
+		}
+
+		for ( uint32_t k = 0; k != 3; k++ ) {
+			uint32_t const v = tri[ k ];
+			if ( !is_used[ v ] ) {
+				is_used[ v ]     = 1;
+				local_index[ v ] = uint8_t( meshlet.vertex_count++ );
+				self->meshlet_vertices.push_back( v );
+			}
+			self->meshlet_triangles.push_back( local_index[ v ] );
+		}
+
+		meshlet.triangle_count++;
+	}
+
+	finish_meshlet();
+}
+
+// ----------------------------------------------------------------------
+
+static void le_mesh_get_meshlets( le_mesh_o* self, size_t* count, le_meshlet_t const** meshlets, uint32_t const** meshlet_vertices, uint8_t const** meshlet_triangles ) {
+	if ( count ) {
+		*count = self->meshlets.size();
+	}
+	if ( meshlets ) {
+		*meshlets = self->meshlets.data();
+	}
+	if ( meshlet_vertices ) {
+		*meshlet_vertices = self->meshlet_vertices.data();
+	}
+	if ( meshlet_triangles ) {
+		*meshlet_triangles = self->meshlet_triangles.data();
+	}
 }
 
 // ----------------------------------------------------------------------
+/// \brief   file loader utility method
+/// \details loads file given by filepath and returns a vector of chars if successful
+/// \note    returns an empty vector if not successful
+static std::vector<char> load_file( const std::filesystem::path& file_path, bool* success ) {
+
+	std::vector<char> contents;
+
+	size_t        fileSize = 0;
+	std::ifstream file( file_path, std::ios::in | std::ios::binary | std::ios::ate );
+
+	if ( !file.is_open() ) {
+		std::cerr << "Unable to open file: " << std::filesystem::canonical( file_path ) << std::endl
+		          << std::flush;
+		*success = false;
+		return contents;
+	}
+
+	//	std::cout << "OK Opened file:" << std::filesystem::canonical( file_path ) << std::endl
+	//	          << std::flush;
+
+	// ----------| invariant: file is open
+
+	auto endOfFilePos = file.tellg();
+
+	if ( endOfFilePos > 0 ) {
+		fileSize = size_t( endOfFilePos );
+	} else {
+		*success = false;
+		return contents;
+	}
+
+	// ----------| invariant: file has some bytes to read
+	contents.resize( fileSize );
+
+	file.seekg( 0, std::ios::beg );
+	file.read( contents.data(), endOfFilePos );
+	file.close();
+
+	*success = true;
+	return contents;
+}
+
+// ----------------------------------------------------------------------
+
+inline int does_start_with( char const* haystack, char const* needle, size_t& needle_len ) {
+	needle_len = strlen( needle );
+	return 0 == strncmp( haystack, needle, needle_len );
+};
+
+// ----------------------------------------------------------------------
+/*
+ * PLY element, and property descriptions, as parsed from the file header.
+ */
+
+struct PlyProperty {
+
+	// data type for the property
+	enum class Type : uint8_t {
+		eUnknown,
+		eList,
+		eChar,
+		eUchar,
+		eShort,
+		eUshort,
+		eInt,
+		eUint,
+		eFloat,
+		eDouble,
+	};
+
+	// name for attribute in context of a mesh
+	enum class AttributeType : uint8_t {
+		eUnknown,
+		eVX,
+		eVY,
+		eVZ,
+		eNX,
+		eNY,
+		eNZ,
+		eTexU,
+		eTexV,
+		eColR,
+		eColG,
+		eColB,
+		eColA,
+	};
+
+	Type          type              = Type::eUnknown;
+	AttributeType attribute_type    = AttributeType::eUnknown; // only used for attributes - not lists.
+	Type          list_size_type    = Type::eUnknown;          // only used for lists
+	Type          list_content_type = Type::eUnknown;          // only used for lists
+	char const*   name              = nullptr;
+	uint8_t       name_len          = 0; ///< number of chars for name (does not include \0)
+};
+
+struct PlyElement {
+
+	enum class Type : uint8_t {
+		eUnknown,
+		eVertex,
+		eFace,
+	};
+	char const*              name;
+	Type                     type;
+	uint8_t                  name_len; ///< number of chars for name (does not include \0)
+	uint32_t                 num_elements;
+	std::vector<PlyProperty> properties;
+};
+
+// ----------------------------------------------------------------------
+/// \brief returns type named by the token starting at `c`, and sets `token_len`
+///        to the number of chars in that token.
+static PlyProperty::Type ply_type_from_token( char const* c, size_t& token_len ) {
+
+	// clang-format off
+	static const struct {
+		char const*       name;
+		PlyProperty::Type type;
+	} type_names[] = {
+		{ "char"   , PlyProperty::Type::eChar   }, { "int8"   , PlyProperty::Type::eChar   },
+		{ "uchar"  , PlyProperty::Type::eUchar  }, { "uint8"  , PlyProperty::Type::eUchar  },
+		{ "short"  , PlyProperty::Type::eShort  }, { "int16"  , PlyProperty::Type::eShort  },
+		{ "ushort" , PlyProperty::Type::eUshort }, { "uint16" , PlyProperty::Type::eUshort },
+		{ "int"    , PlyProperty::Type::eInt    }, { "int32"  , PlyProperty::Type::eInt    },
+		{ "uint"   , PlyProperty::Type::eUint   }, { "uint32" , PlyProperty::Type::eUint   },
+		{ "float"  , PlyProperty::Type::eFloat  }, { "float32", PlyProperty::Type::eFloat  },
+		{ "double" , PlyProperty::Type::eDouble }, { "float64", PlyProperty::Type::eDouble },
+	};
+	// clang-format on
+
+	char const* token_end = strchr( c, ' ' );
+	token_len             = token_end ? size_t( token_end - c ) : strlen( c );
+
+	for ( auto const& t : type_names ) {
+		if ( strlen( t.name ) == token_len && 0 == strncmp( c, t.name, token_len ) ) {
+			return t.type;
+		}
+	}
+
+	return PlyProperty::Type::eUnknown;
+}
+
+// ----------------------------------------------------------------------
+/// \brief returns number of bytes for one value of given type, or 0 for lists and unknown types.
+static uint32_t ply_type_size( PlyProperty::Type type ) {
+	switch ( type ) {
+	case PlyProperty::Type::eChar:   // intentional fall-through
+	case PlyProperty::Type::eUchar:  // intentional fall-through
+		return 1;
+	case PlyProperty::Type::eShort:  // intentional fall-through
+	case PlyProperty::Type::eUshort: // intentional fall-through
+		return 2;
+	case PlyProperty::Type::eInt:    // intentional fall-through
+	case PlyProperty::Type::eUint:   // intentional fall-through
+	case PlyProperty::Type::eFloat:  // intentional fall-through
+		return 4;
+	case PlyProperty::Type::eDouble:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+// ----------------------------------------------------------------------
+/// \brief returns number of bytes per element, or 0 if the element has list properties,
+///        which means that its size varies per element.
+static uint32_t ply_element_fixed_size( PlyElement const& element ) {
+	uint32_t size = 0;
+	for ( auto const& p : element.properties ) {
+		uint32_t property_size = ply_type_size( p.type );
+		if ( property_size == 0 ) {
+			return 0;
+		}
+		size += property_size;
+	}
+	return size;
+}
+
+// ----------------------------------------------------------------------
+// Binary values are little-endian, and not necessarily aligned.
+template <typename T>
+static inline T ply_read_unaligned( char const* c ) {
+	T value;
+	memcpy( &value, c, sizeof( T ) );
+	return value;
+}
+
+static inline float ply_read_float( char const* c, PlyProperty::Type type ) {
+	// clang-format off
+	switch ( type ) {
+	case PlyProperty::Type::eChar   : return float( ply_read_unaligned<int8_t>( c ) );
+	case PlyProperty::Type::eUchar  : return float( ply_read_unaligned<uint8_t>( c ) );
+	case PlyProperty::Type::eShort  : return float( ply_read_unaligned<int16_t>( c ) );
+	case PlyProperty::Type::eUshort : return float( ply_read_unaligned<uint16_t>( c ) );
+	case PlyProperty::Type::eInt    : return float( ply_read_unaligned<int32_t>( c ) );
+	case PlyProperty::Type::eUint   : return float( ply_read_unaligned<uint32_t>( c ) );
+	case PlyProperty::Type::eFloat  : return ply_read_unaligned<float>( c );
+	case PlyProperty::Type::eDouble : return float( ply_read_unaligned<double>( c ) );
+	default: return 0.f;
+	}
+	// clang-format on
+}
+
+static inline uint32_t ply_read_uint( char const* c, PlyProperty::Type type ) {
+	// clang-format off
+	switch ( type ) {
+	case PlyProperty::Type::eChar   : return uint32_t( ply_read_unaligned<int8_t>( c ) );
+	case PlyProperty::Type::eUchar  : return uint32_t( ply_read_unaligned<uint8_t>( c ) );
+	case PlyProperty::Type::eShort  : return uint32_t( ply_read_unaligned<int16_t>( c ) );
+	case PlyProperty::Type::eUshort : return uint32_t( ply_read_unaligned<uint16_t>( c ) );
+	case PlyProperty::Type::eInt    : return uint32_t( ply_read_unaligned<int32_t>( c ) );
+	case PlyProperty::Type::eUint   : return ply_read_unaligned<uint32_t>( c );
+	case PlyProperty::Type::eFloat  : return uint32_t( ply_read_unaligned<float>( c ) );
+	case PlyProperty::Type::eDouble : return uint32_t( ply_read_unaligned<double>( c ) );
+	default: return 0;
+	}
+	// clang-format on
+}
+
+// ----------------------------------------------------------------------
+/// \brief Read-only view of a ply file. We memory-map the file where we can, so
+///        that binary data may be parsed straight from the page cache, without
+///        first copying the whole file into memory.
+struct PlyFile {
+	char const*       data = nullptr;
+	size_t            size = 0;
+	std::vector<char> contents; // only used if file is not memory-mapped
+
+	PlyFile()                  = default;
+	PlyFile( PlyFile const& )  = delete;
+	PlyFile& operator=( PlyFile const& ) = delete;
+
+	~PlyFile() {
+#ifndef _MSC_VER
+		if ( data && contents.empty() ) {
+			munmap( const_cast<char*>( data ), size );
+		}
+#endif
+	}
+};
+
+static bool ply_file_open( std::filesystem::path const& file_path, PlyFile& file ) {
+#ifndef _MSC_VER
+	int fd = open( file_path.c_str(), O_RDONLY );
+
+	if ( fd == -1 ) {
+		return false;
+	}
+
+	struct stat file_stat {};
 
-static void le_mesh_get_vertices( le_mesh_o* self, size_t* count, float const** vertices ) {
-	if ( count ) {
-		*count = self->vertices.size();
+	if ( fstat( fd, &file_stat ) == -1 || file_stat.st_size == 0 ) {
+		close( fd );
+		return false;
 	}
-	if ( vertices ) {
-		*vertices = static_cast<float*>( &self->vertices[ 0 ].x );
+
+	size_t file_size = size_t( file_stat.st_size );
+	void*  mapping   = mmap( nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+	// The mapping keeps the file open, we don't need the file descriptor anymore.
+	close( fd );
+
+	if ( mapping == MAP_FAILED ) {
+		return false;
 	}
+
+	file.data = static_cast<char const*>( mapping );
+	file.size = file_size;
+
+	return true;
+#else
+	bool success  = false;
+	file.contents = load_file( file_path, &success );
+	file.data     = file.contents.data();
+	file.size     = file.contents.size();
+	return success;
+#endif
 }
 
 // ----------------------------------------------------------------------
+/// \brief returns number of bytes up to, and including the `end_header` line,
+///        or 0 if there is no `end_header` line.
+static size_t ply_find_header_size( char const* data, size_t size ) {
+	char const* const end      = data + size;
+	size_t            line_len = 0;
 
-static void le_mesh_get_tangents( le_mesh_o* self, size_t* count, float const** tangents ) {
-	if ( count ) {
-		*count = self->tangents.size();
-	}
-	if ( tangents ) {
-		*tangents = static_cast<float*>( &self->tangents[ 0 ].x );
+	for ( char const* line = data; line < end; ) {
+		auto line_end = static_cast<char const*>( memchr( line, '\n', size_t( end - line ) ) );
+
+		if ( line_end == nullptr ) {
+			return 0;
+		}
+
+		if ( does_start_with( line, "end_header", line_len ) ) {
+			return size_t( line_end + 1 - data );
+		}
+
+		line = line_end + 1;
 	}
+
+	return 0;
 }
 
 // ----------------------------------------------------------------------
+// Binary elements are parsed in chunks of this many elements - chunks are
+// parsed in parallel if le_jobs is available.
+static constexpr size_t PLY_ELEMENTS_PER_CHUNK = 1 << 16;
 
-static void le_mesh_get_indices( le_mesh_o* self, size_t* count, uint16_t const** indices ) {
-	if ( count ) {
-		*count = self->indices.size();
+// ASCII files report progress once per this many lines.
+static constexpr uint32_t PLY_LINES_PER_PROGRESS_REPORT = 1 << 16;
+
+/// \brief runs `fun` once for each chunk, in parallel if le_jobs is available.
+template <typename T>
+static void ply_run_chunks( void ( *fun )( void* ), std::vector<T>& chunks ) {
+#if ( LE_MT > 0 )
+	if ( chunks.size() > 1 ) {
+
+		std::vector<le_jobs::job_t> jobs;
+		jobs.reserve( chunks.size() );
+
+		for ( auto& c : chunks ) {
+			jobs.push_back( { fun, &c } );
+		}
+
+		le_jobs::counter_t* counter;
+		le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+		le_jobs::wait_for_counter_and_free( counter, 0 );
+
+		return;
 	}
-	if ( indices ) {
-		*indices = self->indices.data();
+#endif
+
+	for ( auto& c : chunks ) {
+		fun( &c );
 	}
 }
 
 // ----------------------------------------------------------------------
 
-static void le_mesh_get_normals( le_mesh_o* self, size_t* count, float const** normals ) {
-	if ( count ) {
-		*count = self->normals.size();
-	}
-	if ( normals ) {
-		*normals = static_cast<float*>( &self->normals[ 0 ].x );
+// Where to store one property of a binary vertex.
+struct PlyVertexTarget {
+	uint32_t          src_offset; // byte offset of property within vertex
+	PlyProperty::Type type;       //
+	float             scale;      // colours which are stored as integers get normalised
+	float*            dst;        // first vertex' component in mesh attribute
+	uint32_t          dst_stride; // number of floats per element of mesh attribute
+};
+
+struct PlyVertexChunk {
+	char const*                         src;     // first byte of vertex block
+	uint32_t                            stride;  // number of bytes per vertex
+	std::vector<PlyVertexTarget> const* targets; //
+	size_t                              first;   // index of first vertex in chunk
+	size_t                              last;    // one past index of last vertex in chunk
+};
+
+static void ply_read_vertex_chunk( void* param ) {
+	auto chunk = static_cast<PlyVertexChunk const*>( param );
+
+	for ( size_t i = chunk->first; i != chunk->last; i++ ) {
+		char const* vertex = chunk->src + i * chunk->stride;
+		for ( auto const& t : *chunk->targets ) {
+			t.dst[ i * t.dst_stride ] = ply_read_float( vertex + t.src_offset, t.type ) * t.scale;
+		}
 	}
 }
 
 // ----------------------------------------------------------------------
 
-static void le_mesh_get_colours( le_mesh_o* self, size_t* count, float const** colours ) {
-	if ( count ) {
-		*count = self->colours.size();
-	}
-	if ( colours ) {
-		*colours = static_cast<float*>( &self->colours[ 0 ].x );
+// Faces are read optimistically, assuming that each face is a triangle, which
+// gives all faces the same size. Chunks which find a face which is not a triangle
+// flag this, and we then read faces one by one instead.
+struct PlyFaceChunk {
+	char const*        src;          // first byte of face block
+	uint32_t           stride;       // number of bytes per face, if face is a triangle
+	uint32_t           list_offset;  // byte offset of vertex index list within face
+	PlyProperty::Type  size_type;    // type of vertex index list size
+	PlyProperty::Type  index_type;   // type of vertex index
+	uint16_t*          indices_u16;  // either indices_u16, or indices_u32 is set
+	uint32_t*          indices_u32;  //
+	size_t             first;        // index of first face in chunk
+	size_t             last;         // one past index of last face in chunk
+	std::atomic<bool>* is_triangles; // cleared if chunk found a face which is not a triangle
+};
+
+static void ply_read_face_chunk( void* param ) {
+	auto chunk = static_cast<PlyFaceChunk const*>( param );
+
+	uint32_t const index_size = ply_type_size( chunk->index_type );
+
+	for ( size_t i = chunk->first; i != chunk->last; i++ ) {
+		char const* list = chunk->src + i * chunk->stride + chunk->list_offset;
+
+		if ( ply_read_uint( list, chunk->size_type ) != 3 ) {
+			chunk->is_triangles->store( false, std::memory_order_relaxed );
+			return;
+		}
+
+		list += ply_type_size( chunk->size_type );
+
+		for ( uint32_t j = 0; j != 3; j++ ) {
+			uint32_t index = ply_read_uint( list + j * index_size, chunk->index_type );
+			if ( chunk->indices_u16 ) {
+				chunk->indices_u16[ i * 3 + j ] = uint16_t( index );
+			} else {
+				chunk->indices_u32[ i * 3 + j ] = index;
+			}
+		}
 	}
 }
 
 // ----------------------------------------------------------------------
+/// \brief walks `element.num_elements` elements one by one, starting at `c`.
+///        If `indices` is given, triangulates the first list property of each
+///        element as a polygon, and appends triangle indices to `indices`.
+/// \return pointer past the last element, or nullptr if data ends early.
+static char const* ply_walk_elements( PlyElement const& element, char const* c, char const* const end, std::vector<uint32_t>* indices ) {
 
-static void le_mesh_get_uvs( le_mesh_o* self, size_t* count, float const** uvs ) {
-	if ( count ) {
-		*count = self->normals.size();
-	}
-	if ( uvs ) {
-		*uvs = static_cast<float*>( &self->uvs[ 0 ].x );
+	for ( uint32_t i = 0; i != element.num_elements; i++ ) {
+
+		bool is_first_list = true;
+
+		for ( auto const& p : element.properties ) {
+
+			if ( p.type != PlyProperty::Type::eList ) {
+				c += ply_type_size( p.type );
+				if ( c > end ) {
+					return nullptr;
+				}
+				continue;
+			}
+
+			// ----------| invariant: property is a list
+
+			uint32_t const size_bytes  = ply_type_size( p.list_size_type );
+			uint32_t const index_bytes = ply_type_size( p.list_content_type );
+
+			if ( c + size_bytes > end ) {
+				return nullptr;
+			}
+
+			uint32_t const count = ply_read_uint( c, p.list_size_type );
+			c += size_bytes;
+
+			if ( c + size_t( count ) * index_bytes > end ) {
+				return nullptr;
+			}
+
+			if ( indices && is_first_list && count >= 3 ) {
+				// Triangulate polygon as a fan around its first vertex
+				uint32_t const i0 = ply_read_uint( c, p.list_content_type );
+				for ( uint32_t k = 1; k + 1 < count; k++ ) {
+					indices->push_back( i0 );
+					indices->push_back( ply_read_uint( c + k * index_bytes, p.list_content_type ) );
+					indices->push_back( ply_read_uint( c + ( k + 1 ) * index_bytes, p.list_content_type ) );
+				}
+			}
+
+			is_first_list = false;
+			c += size_t( count ) * index_bytes;
+		}
 	}
+
+	return c;
 }
 
 // ----------------------------------------------------------------------
+/// \brief reads a binary vertex block straight into mesh attributes.
+/// \return pointer past the last vertex, or nullptr upon error.
+static char const* ply_read_binary_vertices( le_mesh_o* self, PlyElement const& element, char const* c, char const* const end ) {
 
-static void le_mesh_get_data( le_mesh_o* self, size_t* numVertices, size_t* numIndices, float const** vertices, float const** normals, float const** uvs, float const** colours, uint16_t const** indices ) {
-	if ( numVertices ) {
-		*numVertices = self->vertices.size();
-	}
-	if ( numIndices ) {
-		*numIndices = self->indices.size();
-	}
+	uint32_t const stride = ply_element_fixed_size( element );
 
-	if ( vertices ) {
-		*vertices = self->vertices.empty() ? nullptr : static_cast<float const*>( &self->vertices[ 0 ].x );
+	if ( stride == 0 ) {
+		std::cerr << "ERROR: " << __PRETTY_FUNCTION__ << ": vertex elements with list properties are not supported." << std::endl
+		          << std::flush;
+		return nullptr;
 	}
 
-	if ( colours ) {
-		*colours = self->colours.empty() ? nullptr : static_cast<float const*>( &self->colours[ 0 ].x );
+	if ( size_t( element.num_elements ) * stride > size_t( end - c ) ) {
+		return nullptr;
 	}
 
-	if ( normals ) {
-		*normals = self->normals.empty() ? nullptr : static_cast<float const*>( &self->normals[ 0 ].x );
-	}
+	// ----------| invariant: all vertices are within file data
 
-	if ( uvs ) {
-		*uvs = self->uvs.empty() ? nullptr : static_cast<float const*>( &self->uvs[ 0 ].x );
+	std::vector<PlyVertexTarget> targets;
+	targets.reserve( element.properties.size() );
+
+	uint32_t src_offset = 0;
+
+	for ( auto const& p : element.properties ) {
+
+		PlyVertexTarget target{ src_offset, p.type, 1.f, nullptr, 0 };
+		src_offset += ply_type_size( p.type );
+
+		auto attribute = [ & ]( auto& attribute_data, uint32_t component ) {
+			attribute_data.resize( element.num_elements, {} );
+			target.dst        = reinterpret_cast<float*>( attribute_data.data() ) + component;
+			target.dst_stride = uint32_t( sizeof( attribute_data[ 0 ] ) / sizeof( float ) );
+		};
+
+		// clang-format off
+		switch ( p.attribute_type ) {
+		case ( PlyProperty::AttributeType::eVX )   : attribute( self->vertices, 0 ); break;
+		case ( PlyProperty::AttributeType::eVY )   : attribute( self->vertices, 1 ); break;
+		case ( PlyProperty::AttributeType::eVZ )   : attribute( self->vertices, 2 ); break;
+		case ( PlyProperty::AttributeType::eNX )   : attribute( self->normals, 0 ); break;
+		case ( PlyProperty::AttributeType::eNY )   : attribute( self->normals, 1 ); break;
+		case ( PlyProperty::AttributeType::eNZ )   : attribute( self->normals, 2 ); break;
+		case ( PlyProperty::AttributeType::eTexU ) : attribute( self->uvs, 0 ); break;
+		case ( PlyProperty::AttributeType::eTexV ) : attribute( self->uvs, 1 ); break;
+		case ( PlyProperty::AttributeType::eColR ) : attribute( self->colours, 0 ); break;
+		case ( PlyProperty::AttributeType::eColG ) : attribute( self->colours, 1 ); break;
+		case ( PlyProperty::AttributeType::eColB ) : attribute( self->colours, 2 ); break;
+		case ( PlyProperty::AttributeType::eColA ) : attribute( self->colours, 3 ); break;
+		case ( PlyProperty::AttributeType::eUnknown ): break; // property is skipped
+		}
+		// clang-format on
+
+		if ( target.dst == nullptr ) {
+			continue;
+		}
+
+		switch ( p.attribute_type ) {
+		case ( PlyProperty::AttributeType::eColR ): // intentional fall-through
+		case ( PlyProperty::AttributeType::eColG ): // intentional fall-through
+		case ( PlyProperty::AttributeType::eColB ): // intentional fall-through
+		case ( PlyProperty::AttributeType::eColA ): // intentional fall-through
+			if ( p.type == PlyProperty::Type::eShort || p.type == PlyProperty::Type::eUshort ) {
+				target.scale = 1 / 65535.f;
+			} else if ( p.type != PlyProperty::Type::eFloat && p.type != PlyProperty::Type::eDouble ) {
+				target.scale = 1 / 255.f;
+			}
+			break;
+		default:
+			break;
+		}
+
+		targets.push_back( target );
 	}
 
-	if ( indices ) {
-		*indices = self->indices.data();
+	// Note that target pointers stay valid while we add further properties: resizing
+	// an attribute to the size which it already has does not reallocate.
+
+	std::vector<PlyVertexChunk> chunks;
+
+	for ( size_t first = 0; first < element.num_elements; first += PLY_ELEMENTS_PER_CHUNK ) {
+		size_t last = std::min<size_t>( first + PLY_ELEMENTS_PER_CHUNK, element.num_elements );
+		chunks.push_back( { c, stride, &targets, first, last } );
 	}
-}
 
-// ----------------------------------------------------------------------
-/// \brief   file loader utility method
-/// \details loads file given by filepath and returns a vector of chars if successful
-/// \note    returns an empty vector if not successful
-static std::vector<char> load_file( const std::filesystem::path& file_path, bool* success ) {
+	ply_run_chunks( ply_read_vertex_chunk, chunks );
 
-	std::vector<char> contents;
+	return c + size_t( element.num_elements ) * stride;
+}
 
-	size_t        fileSize = 0;
-	std::ifstream file( file_path, std::ios::in | std::ios::binary | std::ios::ate );
+// ----------------------------------------------------------------------
+/// \brief reads a binary face block straight into mesh indices.
+/// \return pointer past the last face, or nullptr upon error.
+static char const* ply_read_binary_faces( le_mesh_o* self, PlyElement const& element, size_t num_vertices, char const* c, char const* const end ) {
+
+	// Find the vertex index list - this must be the only list, for faces to
+	// be read in parallel.
+
+	PlyProperty const* list        = nullptr;
+	uint32_t           list_offset = 0;
+	uint32_t           other_size  = 0; // number of bytes for all non-list properties
+	bool               is_fixed    = true;
+
+	for ( auto const& p : element.properties ) {
+		if ( p.type == PlyProperty::Type::eList ) {
+			if ( list ) {
+				is_fixed = false;
+			} else {
+				list        = &p;
+				list_offset = other_size;
+			}
+		} else {
+			other_size += ply_type_size( p.type );
+		}
+	}
 
-	if ( !file.is_open() ) {
-		std::cerr << "Unable to open file: " << std::filesystem::canonical( file_path ) << std::endl
+	if ( list == nullptr ) {
+		std::cerr << "ERROR: " << __PRETTY_FUNCTION__ << ": face element has no vertex index list." << std::endl
 		          << std::flush;
-		*success = false;
-		return contents;
+		return nullptr;
 	}
 
-	//	std::cout << "OK Opened file:" << std::filesystem::canonical( file_path ) << std::endl
-	//	          << std::flush;
+	uint32_t const stride = other_size + ply_type_size( list->list_size_type ) + 3 * ply_type_size( list->list_content_type );
 
-	// ----------| invariant: file is open
+	if ( is_fixed && size_t( element.num_elements ) * stride <= size_t( end - c ) ) {
 
-	auto endOfFilePos = file.tellg();
+		std::atomic<bool> is_triangles{ true };
 
-	if ( endOfFilePos > 0 ) {
-		fileSize = size_t( endOfFilePos );
-	} else {
-		*success = false;
-		return contents;
+		size_t const num_indices = size_t( element.num_elements ) * 3;
+
+		// Parse straight into whichever index array the mesh will use.
+		bool const is_u16 = num_vertices <= 0x10000;
+
+		if ( is_u16 ) {
+			self->indices.resize( num_indices );
+			self->indices_u32.clear();
+		} else {
+			self->indices.clear();
+			self->indices_u32.resize( num_indices );
+		}
+
+		std::vector<PlyFaceChunk> chunks;
+
+		for ( size_t first = 0; first < element.num_elements; first += PLY_ELEMENTS_PER_CHUNK ) {
+			size_t last = std::min<size_t>( first + PLY_ELEMENTS_PER_CHUNK, element.num_elements );
+			chunks.push_back( {
+			    c, stride, list_offset,
+			    list->list_size_type, list->list_content_type,
+			    is_u16 ? self->indices.data() : nullptr,
+			    is_u16 ? nullptr : self->indices_u32.data(),
+			    first, last, &is_triangles } );
+		}
+
+		ply_run_chunks( ply_read_face_chunk, chunks );
+
+		if ( is_triangles.load() ) {
+			return c + size_t( element.num_elements ) * stride;
+		}
 	}
 
-	// ----------| invariant: file has some bytes to read
-	contents.resize( fileSize );
+	// ----------| invariant: faces don't all have the same size - we must read them one by one.
 
-	file.seekg( 0, std::ios::beg );
-	file.read( contents.data(), endOfFilePos );
-	file.close();
+	std::vector<uint32_t> indices;
+	indices.reserve( size_t( element.num_elements ) * 3 );
 
-	*success = true;
-	return contents;
-}
+	char const* faces_end = ply_walk_elements( element, c, end, &indices );
 
-// ----------------------------------------------------------------------
+	if ( faces_end ) {
+		mesh_write_indices( self, indices );
+	}
 
-inline int does_start_with( char const* haystack, char const* needle, size_t& needle_len ) {
-	needle_len = strlen( needle );
-	return 0 == strncmp( haystack, needle, needle_len );
-};
+	return faces_end;
+}
 
 // ----------------------------------------------------------------------
 /// \brief loads mesh from ply file
 /// \note any contents of mesh will be cleared before loading
-/// \return true upon success, false otherwise.
-static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_ ) {
+/// \note binary files must be little-endian; these are parsed in parallel,
+///       straight from the memory-mapped file.
+/// \param on_progress (optional) called with progress in [0..1] - return false to cancel loading.
+/// \return true upon success, false otherwise, or if loading was cancelled.
+static bool le_mesh_load_from_ply_file_with_progress( le_mesh_o* self, char const* file_path_, le_mesh_load_progress_fn on_progress, void* user_data ) {
 
 	// - Make sure file exists
 
@@ -205,79 +1403,34 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 	// --------| invariant: File path exists
 
-	// - Build mesh attributes structure based on header.
-
-	/*
-	 * element vertex structure: attribute index tells us where to store data which we parse
-	 */
-
-	struct Property {
-
-		// data type for the property
-		enum class Type : uint8_t {
-			eUnknown,
-			eList,
-			eFloat,
-			eUchar,
-			eUint,
-		};
-
-		// name for attribute in context of a mesh
-		enum class AttributeType : uint8_t {
-			eUnknown,
-			eVX,
-			eVY,
-			eVZ,
-			eNX,
-			eNY,
-			eNZ,
-			eTexU,
-			eTexV,
-			eColR,
-			eColG,
-			eColB,
-			eColA,
-		};
-
-		Type          type              = Type::eUnknown;
-		AttributeType attribute_type    = AttributeType::eUnknown; // only used for attributes - not lists.
-		Type          list_size_type    = Type::eUnknown;          // only used for lists
-		Type          list_content_type = Type::eUnknown;          // only used for lists
-		char const*   name              = nullptr;
-		uint8_t       name_len          = 0; ///< number of chars for name (does not include \0)
-	};
+	// - Map file into memory
 
-	struct Element {
+	PlyFile file;
 
-		enum class Type : uint8_t {
-			eUnknown,
-			eVertex,
-			eFace,
-		};
-		char const*           name;
-		Type                  type;
-		uint8_t               name_len; ///< number of chars for name (does not include \0)
-		uint32_t              num_elements;
-		std::vector<Property> properties;
-	};
+	if ( !ply_file_open( file_path, file ) ) {
+		std::cerr << "File could not be loaded: '" << file_path << "'";
+		return false;
+	}
 
-	// - Check that the header is correct (consistent, has minimum necessary attributes)
+	// - Copy header, so that we can tokenize it in-place - the header is
+	//   ascii, even for binary files.
 
-	// - Read file into memory
-	bool              file_load_success = true;
-	std::vector<char> file_data         = load_file( file_path, &file_load_success );
+	size_t const header_size = ply_find_header_size( file.data, file.size );
 
-	if ( !file_load_success ) {
-		std::cerr << "File could not be loaded: '" << file_path << "'";
+	if ( header_size == 0 ) {
+		std::cerr << "Invalid file header: '" << file_path << "'";
 		return false;
 	}
 
+	std::vector<char> header( file.data, file.data + header_size );
+	header.push_back( '\0' );
+
 	static auto DELIMS{ "\r\n\0" };
 	char*       c_save_ptr; //< we use the re-entrant version of strtok, for which state is stored in here
 
 	// --------| invariant: file was loaded.
 
-	char* c = strtok_r( file_data.data(), DELIMS, &c_save_ptr );
+	char* c = strtok_r( header.data(), DELIMS, &c_save_ptr );
 
 	if ( 0 != strcmp( c, "ply" ) ) {
 		std::cerr << "Invalid file header: '" << file_path << "'";
@@ -286,30 +1439,35 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 	c = strtok_r( nullptr, DELIMS, &c_save_ptr );
 
-	if ( 0 != strcmp( c, "format ascii 1.0" ) ) {
-		std::cerr << "Invalid file header: '" << file_path << "'";
+	bool is_binary = false;
+
+	if ( 0 == strcmp( c, "format binary_little_endian 1.0" ) ) {
+		is_binary = true;
+	} else if ( 0 != strcmp( c, "format ascii 1.0" ) ) {
+		std::cerr << "Unsupported file format: '" << c << "' in file: '" << file_path << "'";
 		return false;
 	}
 
 	c = strtok_r( nullptr, DELIMS, &c_save_ptr );
 
-	// Parse header data into a vector of Element
-	std::vector<Element> elements;
+	// Parse header data into a vector of PlyElement
+	std::vector<PlyElement> elements;
 
 	for ( ; c != nullptr; c = strtok_r( nullptr, DELIMS, &c_save_ptr ) ) {
 
 		size_t last_search_string_len = 0;
 
-		if ( does_start_with( c, "comment", last_search_string_len ) ) {
+		if ( does_start_with( c, "comment", last_search_string_len ) ||
+		     does_start_with( c, "obj_info", last_search_string_len ) ) {
 			// Anything after a comment will be ignored
 			continue;
 		}
 
 		else if ( does_start_with( c, "element", last_search_string_len ) ) {
-			Element element;
+			PlyElement element;
 
 			// Note: This method replaces spaces between in-element tokens with \0 characters.
-			auto parse_element_line = []( char* c, Element& element ) -> bool {
+			auto parse_element_line = []( char* c, PlyElement& element ) -> bool {
 				element.name = c;
 				char* c_next = strchr( c, ' ' );
 				if ( c_next == nullptr ) {
@@ -319,11 +1477,12 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 				}
 				*c_next          = 0; // insert an end-of-string token
 				element.name_len = uint8_t( c_next - c );
+				element.type     = PlyElement::Type::eUnknown;
 
 				if ( 0 == strncmp( element.name, "vertex", element.name_len ) ) {
-					element.type = Element::Type::eVertex;
+					element.type = PlyElement::Type::eVertex;
 				} else if ( 0 == strncmp( element.name, "face", element.name_len ) ) {
-					element.type = Element::Type::eFace;
+					element.type = PlyElement::Type::eFace;
 				}
 
 				c = c_next + 1; // adding one because we don't want the zero terminator.
@@ -343,45 +1502,43 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 		}
 
 		else if ( does_start_with( c, "property", last_search_string_len ) ) {
-			Property property;
+			PlyProperty property;
 
 			// Note: this replaces spaces between in-element tokens with \0 characters.
-			auto parse_property_line = []( char* c, Property& property ) -> bool {
+			auto parse_property_line = []( char* c, PlyProperty& property ) -> bool {
 				size_t last_search_string_len = 0;
 
-				// now, we expect either list or [float|uchar] as property type
+				// now, we expect either list or a scalar type as property type
 				if ( does_start_with( c, "list", last_search_string_len ) ) {
 					c += last_search_string_len + 1;
-					property.type = Property::Type::eList;
+					property.type = PlyProperty::Type::eList;
 
 					// next item will be list size type
 
-					if ( does_start_with( c, "uchar", last_search_string_len ) ) {
-						property.list_size_type = Property::Type::eUchar;
-						c += last_search_string_len + 1;
-					} else if ( does_start_with( c, "uint", last_search_string_len ) ) {
-						property.list_size_type = Property::Type::eUint;
-						c += last_search_string_len + 1;
-					} else {
+					property.list_size_type = ply_type_from_token( c, last_search_string_len );
+
+					if ( property.list_size_type == PlyProperty::Type::eUnknown ) {
 						std::cerr << "Unknown list size type: '" << c << "'" << std::endl
 						          << std::flush;
 						assert( false );
+						return false;
 					}
 
+					c += last_search_string_len + 1;
+
 					// next item will be list content type
 
-					if ( does_start_with( c, "uchar", last_search_string_len ) ) {
-						property.list_content_type = Property::Type::eUchar;
-						c += last_search_string_len + 1;
-					} else if ( does_start_with( c, "uint", last_search_string_len ) ) {
-						property.list_content_type = Property::Type::eUint;
-						c += last_search_string_len + 1;
-					} else {
+					property.list_content_type = ply_type_from_token( c, last_search_string_len );
+
+					if ( property.list_content_type == PlyProperty::Type::eUnknown ) {
 						std::cerr << "Unknown list content type: '" << c << "'" << std::endl
 						          << std::flush;
 						assert( false );
+						return false;
 					}
 
+					c += last_search_string_len + 1;
+
 					// last item will be list name
 
 					property.name     = c;
@@ -391,13 +1548,9 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 					// Non-list type
 
-					if ( does_start_with( c, "float", last_search_string_len ) ) {
-						property.type = Property::Type::eFloat;
-					} else if ( does_start_with( c, "uint", last_search_string_len ) ) {
-						property.type = Property::Type::eUint;
-					} else if ( does_start_with( c, "uchar", last_search_string_len ) ) {
-						property.type = Property::Type::eUchar;
-					} else {
+					property.type = ply_type_from_token( c, last_search_string_len );
+
+					if ( property.type == PlyProperty::Type::eUnknown ) {
 						// Unknown property type.
 						std::cerr << __PRETTY_FUNCTION__ << ": Unknown property type: " << c << std::endl
 						          << std::flush;
@@ -410,35 +1563,35 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 					property.name_len = uint8_t( strlen( c ) );
 
 					if ( 0 == strncmp( c, "x", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eVX;
+						property.attribute_type = PlyProperty::AttributeType::eVX;
 					} else if ( 0 == strncmp( c, "y", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eVY;
+						property.attribute_type = PlyProperty::AttributeType::eVY;
 					} else if ( 0 == strncmp( c, "z", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eVZ;
+						property.attribute_type = PlyProperty::AttributeType::eVZ;
 					} else if ( 0 == strncmp( c, "nx", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eNX;
+						property.attribute_type = PlyProperty::AttributeType::eNX;
 					} else if ( 0 == strncmp( c, "ny", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eNY;
+						property.attribute_type = PlyProperty::AttributeType::eNY;
 					} else if ( 0 == strncmp( c, "nz", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eNZ;
+						property.attribute_type = PlyProperty::AttributeType::eNZ;
 					} else if ( 0 == strncmp( c, "s", property.name_len ) ||
 					            0 == strncmp( c, "u", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eTexU;
+						property.attribute_type = PlyProperty::AttributeType::eTexU;
 					} else if ( 0 == strncmp( c, "t", property.name_len ) ||
 					            0 == strncmp( c, "v", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eTexV;
+						property.attribute_type = PlyProperty::AttributeType::eTexV;
 					} else if ( 0 == strncmp( c, "red", property.name_len ) ||
 					            0 == strncmp( c, "r", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eColR;
+						property.attribute_type = PlyProperty::AttributeType::eColR;
 					} else if ( 0 == strncmp( c, "green", property.name_len ) ||
 					            0 == strncmp( c, "g", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eColG;
+						property.attribute_type = PlyProperty::AttributeType::eColG;
 					} else if ( 0 == strncmp( c, "blue", property.name_len ) ||
 					            0 == strncmp( c, "b", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eColB;
+						property.attribute_type = PlyProperty::AttributeType::eColB;
 					} else if ( 0 == strncmp( c, "alpha", property.name_len ) ||
 					            0 == strncmp( c, "a", property.name_len ) ) {
-						property.attribute_type = Property::AttributeType::eColA;
+						property.attribute_type = PlyProperty::AttributeType::eColA;
 					} else {
 						std::cerr << "WARNING: Attribute name not recognised: '" << c << "'" << std::endl
 						          << std::flush;
@@ -446,10 +1599,6 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 					return true;
 				}
-				std::cerr << "Expected property type must be either 'list', or one of non-list type: uchar, float, uint, but given: " << c << std::endl
-				          << std::flush;
-				assert( false );
-				return false;
 			};
 
 			c += last_search_string_len + 1;
@@ -463,8 +1612,6 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 		else if ( does_start_with( c, "end_header", last_search_string_len ) ) {
 			// we have reached the marker which signals the end of the header.
-			// - Move file data pointer past "end_header" line
-			c = strtok_r( nullptr, DELIMS, &c_save_ptr );
 			break;
 		}
 
@@ -484,10 +1631,77 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 	le_mesh_clear( self );
 
-	// - Load file data
+	// Returns false if loading was cancelled - in which case the mesh is cleared.
+	auto report_progress = [ & ]( size_t bytes_done ) -> bool {
+		if ( on_progress && !on_progress( float( bytes_done ) / float( file.size ), user_data ) ) {
+			le_mesh_clear( self );
+			return false;
+		}
+		return true;
+	};
+
+	// Once loading is complete, it can't be cancelled anymore.
+	auto report_complete = [ & ]() {
+		if ( on_progress ) {
+			on_progress( 1.f, user_data );
+		}
+	};
+
+	size_t num_vertices = 0;
+
+	for ( auto const& e : elements ) {
+		if ( e.type == PlyElement::Type::eVertex ) {
+			num_vertices = e.num_elements;
+		}
+	}
+
+	// - Load binary file data
+
+	if ( is_binary ) {
+
+		char const*       b   = file.data + header_size;
+		char const* const end = file.data + file.size;
+
+		for ( auto const& element : elements ) {
+
+			if ( !report_progress( size_t( b - file.data ) ) ) {
+				return false;
+			}
+
+			if ( element.type == PlyElement::Type::eVertex ) {
+				b = ply_read_binary_vertices( self, element, b, end );
+			} else if ( element.type == PlyElement::Type::eFace ) {
+				b = ply_read_binary_faces( self, element, num_vertices, b, end );
+			} else {
+				b = ply_walk_elements( element, b, end, nullptr );
+			}
+
+			if ( b == nullptr ) {
+				std::cerr << "ERROR: " << __PRETTY_FUNCTION__ << ": Unexpected end of file data for element '" << element.name << "' in file: '" << file_path << "'" << std::endl
+				          << std::flush;
+				le_mesh_clear( self );
+				return false;
+			}
+		}
+
+		report_complete();
+
+		return true;
+	}
+
+	// - Load ascii file data - we copy it, so that we can tokenize it in-place.
+
+	std::vector<char> file_data( file.data + header_size, file.data + file.size );
+	file_data.push_back( '\0' );
+
+	c = strtok_r( file_data.data(), DELIMS, &c_save_ptr );
+
+	auto report_ascii_progress = [ & ]( char const* c ) -> bool {
+		return report_progress( header_size + size_t( c - file_data.data() ) );
+	};
 
-	Element const* element_archetype     = elements.data();
-	auto const     element_archetype_end = elements.data() + elements.size();
+	PlyElement const* element_archetype     = elements.data();
+	auto const        element_archetype_end = elements.data() + elements.size();
 
 	// What follows now is a list of elements, one element per line.
 	// elements have properties, which are separated by commas.
@@ -499,33 +1713,33 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 		// Element archetype can be either face vertex or face
 
-		if ( element_archetype->type == Element::Type::eVertex ) {
+		if ( element_archetype->type == PlyElement::Type::eVertex ) {
 
 			// - Make space over all attributes for number of elements.
 
 			for ( auto const& p : element_archetype->properties ) {
 				switch ( p.attribute_type ) {
-				case ( Property::AttributeType::eVX ): // intentional fall-through
-				case ( Property::AttributeType::eVY ): // intentional fall-through
-				case ( Property::AttributeType::eVZ ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eVX ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eVY ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eVZ ): // intentional fall-through
 					self->vertices.resize( element_archetype->num_elements, {} );
 					break;
-				case ( Property::AttributeType::eNX ): // intentional fall-through
-				case ( Property::AttributeType::eNY ): // intentional fall-through
-				case ( Property::AttributeType::eNZ ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eNX ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eNY ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eNZ ): // intentional fall-through
 					self->normals.resize( element_archetype->num_elements, {} );
 					break;
-				case ( Property::AttributeType::eColR ): // intentional fall-through
-				case ( Property::AttributeType::eColG ): // intentional fall-through
-				case ( Property::AttributeType::eColB ): // intentional fall-through
-				case ( Property::AttributeType::eColA ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eColR ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eColG ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eColB ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eColA ): // intentional fall-through
 					self->colours.resize( element_archetype->num_elements, {} );
 					break;
-				case ( Property::AttributeType::eTexU ): // intentional fall-through
-				case ( Property::AttributeType::eTexV ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eTexU ): // intentional fall-through
+				case ( PlyProperty::AttributeType::eTexV ): // intentional fall-through
 					self->uvs.resize( element_archetype->num_elements, {} );
 					break;
-				case ( Property::AttributeType::eUnknown ):
+				case ( PlyProperty::AttributeType::eUnknown ):
 					break;
 				}
 				// TODO: check for tangents.
@@ -534,6 +1748,10 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 			for ( uint32_t i = 0; i != element_archetype->num_elements && c != nullptr; ++i, c = strtok_r( nullptr, DELIMS, &c_save_ptr ) ) {
 				char* s = c;
 
+				if ( i % PLY_LINES_PER_PROGRESS_REPORT == 0 && !report_ascii_progress( c ) ) {
+					return false;
+				}
+
 				auto* v_data  = self->vertices.empty() ? nullptr : &self->vertices[ i ];
 				auto* n_data  = self->normals.empty() ? nullptr : &self->normals[ i ];
 				auto* uv_data = self->uvs.empty() ? nullptr : &self->uvs[ i ];
@@ -543,23 +1761,23 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 					// clang-format off
 					switch ( p.attribute_type ) {
-					case ( Property::AttributeType::eVX )   : v_data->x  = strtof( s, &s ); break;
-					case ( Property::AttributeType::eVY )   : v_data->y  = strtof( s, &s ); break;
-					case ( Property::AttributeType::eVZ )   : v_data->z  = strtof( s, &s ); break;
-					case ( Property::AttributeType::eNX )   : n_data->x  = strtof( s, &s ); break;
-					case ( Property::AttributeType::eNY )   : n_data->y  = strtof( s, &s ); break;
-					case ( Property::AttributeType::eNZ )   : n_data->z  = strtof( s, &s ); break;
-					case ( Property::AttributeType::eTexU ) : uv_data->x = strtof( s, &s ); break;
-					case ( Property::AttributeType::eTexV ) : uv_data->y = strtof( s, &s ); break;
-					case ( Property::AttributeType::eColR ):
-						c_data->x = p.type == Property::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
-					case ( Property::AttributeType::eColG ):
-						c_data->y = p.type == Property::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
-					case ( Property::AttributeType::eColB ):
-						c_data->z = p.type == Property::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
-					case ( Property::AttributeType::eColA ):
-						c_data->w = p.type == Property::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
-					case ( Property::AttributeType::eUnknown ):
+					case ( PlyProperty::AttributeType::eVX )   : v_data->x  = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eVY )   : v_data->y  = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eVZ )   : v_data->z  = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eNX )   : n_data->x  = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eNY )   : n_data->y  = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eNZ )   : n_data->z  = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eTexU ) : uv_data->x = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eTexV ) : uv_data->y = strtof( s, &s ); break;
+					case ( PlyProperty::AttributeType::eColR ):
+						c_data->x = p.type == PlyProperty::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
+					case ( PlyProperty::AttributeType::eColG ):
+						c_data->y = p.type == PlyProperty::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
+					case ( PlyProperty::AttributeType::eColB ):
+						c_data->z = p.type == PlyProperty::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
+					case ( PlyProperty::AttributeType::eColA ):
+						c_data->w = p.type == PlyProperty::Type::eFloat ? strtof( s, &s ) : strtoul( s, &s, 0 )/255.f; break;
+					case ( PlyProperty::AttributeType::eUnknown ):
 						// TODO: what do we do if there is an unknown attribute?
 						assert( false );
 						break;
@@ -568,13 +1786,16 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 				}
 			}
 
-		} else if ( element_archetype->type == Element::Type::eFace ) {
+		} else if ( element_archetype->type == PlyElement::Type::eFace ) {
 
 			// must be 3 indices per face - because our meshes can only be built from triangles, not quads or anything else.
-			self->indices.resize( element_archetype->num_elements * 3, {} );
+			//
+			// We parse into 32 bit indices first, as large meshes may have more vertices
+			// than 16 bit indices can address.
+			std::vector<uint32_t> indices( size_t( element_archetype->num_elements ) * 3, 0 );
 
-			auto*       current_index = self->indices.data();
-			auto* const indices_end   = self->indices.data() + self->indices.size();
+			auto*       current_index = indices.data();
+			auto* const indices_end   = indices.data() + indices.size();
 
 			// this goes through line-by line.
 			for ( size_t line_num = 0;
@@ -583,22 +1804,28 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 
 				char* s = c;
 
+				if ( line_num % PLY_LINES_PER_PROGRESS_REPORT == 0 && !report_ascii_progress( c ) ) {
+					return false;
+				}
+
 				auto three = strtoul( s, &s, 0 );
 				assert( three == 3 ); // first element must be three
 
-				*current_index++ = strtoul( s, &s, 0 ); // first index
-				*current_index++ = strtoul( s, &s, 0 ); // second index
-				*current_index++ = strtoul( s, &s, 0 ); // third index
+				*current_index++ = uint32_t( strtoul( s, &s, 0 ) ); // first index
+				*current_index++ = uint32_t( strtoul( s, &s, 0 ) ); // second index
+				*current_index++ = uint32_t( strtoul( s, &s, 0 ) ); // third index
 
 				c = strtok_r( nullptr, DELIMS, &c_save_ptr );
 			}
 
+			mesh_write_indices( self, indices );
+
 			// parse face properties
 		}
-		if ( element_archetype->type == Element::Type::eUnknown ) {
+		if ( element_archetype->type == PlyElement::Type::eUnknown ) {
 			// Not implemented yet.
 
-			auto skip_lines = [ & ]( char const* c, Element const* archetype ) {
+			auto skip_lines = [ & ]( char const* c, PlyElement const* archetype ) {
 				for ( uint32_t i = 0; i != archetype->num_elements && c != nullptr; ++i ) {
 					c = strtok_r( nullptr, DELIMS, &c_save_ptr );
 				}
@@ -610,9 +1837,19 @@ static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path_
 		}
 	}
 
+	report_complete();
+
 	return true;
 }
 
+// ----------------------------------------------------------------------
+/// \brief loads mesh from ply file
+/// \note any contents of mesh will be cleared before loading
+/// \return true upon success, false otherwise.
+static bool le_mesh_load_from_ply_file( le_mesh_o* self, char const* file_path ) {
+	return le_mesh_load_from_ply_file_with_progress( self, file_path, nullptr, nullptr );
+}
+
 // ----------------------------------------------------------------------
 
 LE_MODULE_REGISTER_IMPL( le_mesh, api ) {
@@ -626,7 +1863,15 @@ LE_MODULE_REGISTER_IMPL( le_mesh, api ) {
 	le_mesh_i.get_colours  = le_mesh_get_colours;
 	le_mesh_i.get_data     = le_mesh_get_data;
 
-	le_mesh_i.load_from_ply_file = le_mesh_load_from_ply_file;
+	le_mesh_i.get_index_size           = le_mesh_get_index_size;
+	le_mesh_i.get_indices_u32          = le_mesh_get_indices_u32;
+	le_mesh_i.get_interleaved_vertices = le_mesh_get_interleaved_vertices;
+	le_mesh_i.optimize                 = le_mesh_optimize;
+	le_mesh_i.generate_meshlets        = le_mesh_generate_meshlets;
+	le_mesh_i.get_meshlets             = le_mesh_get_meshlets;
+
+	le_mesh_i.load_from_ply_file               = le_mesh_load_from_ply_file;
+	le_mesh_i.load_from_ply_file_with_progress = le_mesh_load_from_ply_file_with_progress;
 
 	le_mesh_i.clear   = le_mesh_clear;
 	le_mesh_i.create  = le_mesh_create;
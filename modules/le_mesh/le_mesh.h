@@ -5,6 +5,33 @@
 
 struct le_mesh_o;
 
+// Byte offsets of vertex attributes within one interleaved vertex. Attributes
+// which the mesh does not have are left out, and their offset is LE_MESH_NO_ATTRIBUTE.
+struct le_mesh_vertex_layout_t {
+	uint32_t stride;          // number of bytes per vertex
+	uint32_t position_offset; // 3 floats
+	uint32_t normal_offset;   // 3 floats
+	uint32_t uv_offset;       // 2 floats
+	uint32_t colour_offset;   // 4 floats
+	uint32_t tangent_offset;  // 3 floats
+};
+
+static const uint32_t LE_MESH_NO_ATTRIBUTE = ~0u;
+
+// Called while a mesh loads, with progress in [0..1]. Return false to cancel loading.
+typedef bool ( *le_mesh_load_progress_fn )( float progress, void* user_data );
+
+// A small cluster of triangles, so that a mesh may be culled, and drawn in pieces.
+// Meshlet vertices hold indices into the mesh's vertices; meshlet triangles hold
+// three indices into the meshlet's vertices per triangle.
+struct le_meshlet_t {
+	uint32_t vertex_offset;        // index of first vertex in meshlet_vertices
+	uint32_t triangle_offset;      // index of first triangle index in meshlet_triangles
+	uint32_t vertex_count;         //
+	uint32_t triangle_count;       //
+	float    bounding_sphere[ 4 ]; // xyz: centre, w: radius - in model space
+};
+
 // clang-format off
 struct le_mesh_api {
 
@@ -20,12 +47,29 @@ struct le_mesh_api {
 		void (*get_colours  )( le_mesh_o *self, size_t* count, float const **   colours ); 	// 4 floats per vertex
 		void (*get_uvs      )( le_mesh_o *self, size_t* count, float const **   uvs     ); 	// 3 floats per vertex
 		void (*get_tangents )( le_mesh_o *self, size_t* count, float const **   tangents); 	// 3 floats per vertex
-		void (*get_indices  )( le_mesh_o *self, size_t* count, uint16_t const ** indices ); // 1 uint16_t per index
+		void (*get_indices  )( le_mesh_o *self, size_t* count, uint16_t const ** indices ); // 1 uint16_t per index, only if index size is 2
 
 		void (*get_data     )( le_mesh_o *self, size_t* numVertices, size_t* numIndices, float const** vertices, float const **normals, float const **uvs, float const  ** colours, uint16_t const **indices);
 
+		uint32_t (*get_index_size )( le_mesh_o *self ); // number of bytes per index: 2, or 4 if mesh has more than 65536 vertices
+		void     (*get_indices_u32)( le_mesh_o *self, size_t* count, uint32_t const ** indices ); // 1 uint32_t per index, only if index size is 4
+
+		// Interleaves all vertex attributes which the mesh has, in order: position, normal, uv, colour, tangent.
+		void (*get_interleaved_vertices)( le_mesh_o *self, size_t* count, le_mesh_vertex_layout_t* layout, float const ** vertices );
+
+		// Reorders triangles for vertex cache efficiency, then for less overdraw, and then
+		// reorders vertices in the order in which they are first used. Discards meshlets.
+		void (*optimize         )( le_mesh_o *self );
+
+		// Splits mesh into meshlets, in index order. Zero means to use defaults: 64 vertices, 124 triangles.
+		void (*generate_meshlets)( le_mesh_o *self, uint32_t max_vertices, uint32_t max_triangles );
+		void (*get_meshlets     )( le_mesh_o *self, size_t* count, le_meshlet_t const ** meshlets, uint32_t const ** meshlet_vertices, uint8_t const ** meshlet_triangles );
+
 		bool (*load_from_ply_file)( le_mesh_o *self, char const *file_path );
 
+		// Binary little-endian files are memory-mapped, and parsed in parallel. Returns false if cancelled.
+		bool (*load_from_ply_file_with_progress)( le_mesh_o *self, char const *file_path, le_mesh_load_progress_fn on_progress, void* user_data );
+
 	};
 
 	le_mesh_interface_t       le_mesh_i;
@@ -84,6 +128,30 @@ class LeMesh : NoCopy, NoMove {
 		this_i.get_indices( self, count, pIndices );
 	}
 
+	uint32_t getIndexSize() {
+		return this_i.get_index_size( self );
+	}
+
+	void getIndicesU32( size_t* count, uint32_t const** pIndices = nullptr ) {
+		this_i.get_indices_u32( self, count, pIndices );
+	}
+
+	void getInterleavedVertices( size_t* count, le_mesh_vertex_layout_t* layout, float const** pVertices = nullptr ) {
+		this_i.get_interleaved_vertices( self, count, layout, pVertices );
+	}
+
+	void optimize() {
+		this_i.optimize( self );
+	}
+
+	void generateMeshlets( uint32_t max_vertices = 0, uint32_t max_triangles = 0 ) {
+		this_i.generate_meshlets( self, max_vertices, max_triangles );
+	}
+
+	void getMeshlets( size_t* count, le_meshlet_t const** pMeshlets = nullptr, uint32_t const** pMeshletVertices = nullptr, uint8_t const** pMeshletTriangles = nullptr ) {
+		this_i.get_meshlets( self, count, pMeshlets, pMeshletVertices, pMeshletTriangles );
+	}
+
 	void getData( size_t* numVertices, size_t* numIndices, float const** pVertices = nullptr, float const** pNormals = nullptr, float const** pUvs = nullptr, float const** pColours = nullptr, uint16_t const** pIndices = nullptr ) {
 		this_i.get_data( self, numVertices, numIndices, pVertices, pNormals, pUvs, pColours, pIndices );
 	}
@@ -92,6 +160,10 @@ class LeMesh : NoCopy, NoMove {
 		return this_i.load_from_ply_file( self, file_path );
 	}
 
+	bool loadFromPlyFile( char const* file_path, le_mesh_load_progress_fn on_progress, void* user_data = nullptr ) {
+		return this_i.load_from_ply_file_with_progress( self, file_path, on_progress, user_data );
+	}
+
 	operator auto() {
 		return self;
 	}
@@ -4,14 +4,21 @@
 #include <stdint.h>
 #include <vector>
 #include "glm/glm.hpp"
+#include "le_mesh.h" // for le_meshlet_t
 
 struct le_mesh_o {
-	std::vector<uint16_t>  indices;  // list of indices
-	std::vector<glm::vec3> vertices; // 3d position in model space
-	std::vector<glm::vec3> normals;  // normalised normal, per-vertex
-	std::vector<glm::vec4> colours;  // rgba colour, per-vertex
-	std::vector<glm::vec2> uvs;      // uv coordintates    , per-vertex
-	std::vector<glm::vec3> tangents; // normalised tangents, per-vertex
+	std::vector<uint16_t>  indices;     // list of indices
+	std::vector<uint32_t>  indices_u32; // list of indices - used instead of indices if mesh has more than 65536 vertices
+	std::vector<glm::vec3> vertices;    // 3d position in model space
+	std::vector<glm::vec3> normals;     // normalised normal, per-vertex
+	std::vector<glm::vec4> colours;     // rgba colour, per-vertex
+	std::vector<glm::vec2> uvs;         // uv coordintates    , per-vertex
+	std::vector<glm::vec3> tangents;    // normalised tangents, per-vertex
+
+	std::vector<float>        interleaved;       // scratch: rebuilt by get_interleaved_vertices
+	std::vector<le_meshlet_t> meshlets;          // optional, see generate_meshlets
+	std::vector<uint32_t>     meshlet_vertices;  // indices into vertices, per meshlet
+	std::vector<uint8_t>      meshlet_triangles; // three indices into meshlet vertices per triangle
 };
 
 #endif
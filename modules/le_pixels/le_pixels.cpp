@@ -1,15 +1,59 @@
 #include "le_pixels.h"
 #include "le_log.h"
 #include "le_core.h"
+#include "le_hash_util.h"
+#include "le_jobs.h"
 #include "3rdparty/stb_image.h"
+#include "3rdparty/src/spooky/SpookyV2.h"
 #include "assert.h"
 #include <iostream>
 #include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <filesystem>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+#ifndef _MSC_VER
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#ifndef LE_MT
+#	define LE_MT 0
+#endif
+
+// Describes one mip level, of one array layer. Laid out so that it may be
+// written to, and read from the mip chain cache as it is.
+struct le_pixels_level_t {
+	uint64_t offset;     // in bytes, from start of image_data
+	uint32_t width;      //
+	uint32_t height;     //
+	uint32_t byte_count; //
+	uint32_t reserved;   // padding
+};
+
+// A container file, memory-mapped - or read into memory where we can't map files.
+struct le_pixels_file_mapping_t {
+	unsigned char* data      = nullptr;
+	size_t         num_bytes = 0;
+};
 
 struct le_pixels_o {
 	// members
-	void*          image_data = nullptr;
-	le_pixels_info info{};
+	void*                          image_data = nullptr;
+	le_pixels_info                 info{};
+	std::vector<unsigned char>     storage; // owns image_data, unless image_data was allocated by stb_image, or points into mapping
+	std::vector<le_pixels_level_t> levels;  // empty for a single level - otherwise indexed by array_layer * mip_levels + mip_level
+	le_pixels_file_mapping_t       mapping; // owns image_data, if pixels were loaded from a container file
 };
 
 // ----------------------------------------------------------------------
@@ -39,9 +83,16 @@ struct image_source_info_t {
 
 // ----------------------------------------------------------------------
 
+static void file_mapping_destroy( le_pixels_file_mapping_t* mapping ); // ffdecl.
+
 static void le_pixels_destroy( le_pixels_o* self ) {
 
-	if ( self && self->image_data ) {
+	if ( self && self->mapping.data ) {
+		file_mapping_destroy( &self->mapping );
+		self->image_data = nullptr;
+	}
+
+	if ( self && self->image_data && self->storage.empty() ) {
 		stbi_image_free( self->image_data );
 		self->image_data = nullptr;
 	}
@@ -55,9 +106,489 @@ static inline uint32_t get_num_bytes_for_type( le_pixels_info::Type const& type
 	return ( 1 << ( type & 0b11 ) );
 }
 
+// ----------------------------------------------------------------------
+// Container files: KTX2, and DDS
+//
+// Containers hold pixels which were encoded offline - in the exact format
+// in which they will be uploaded, including all mip levels, and array layers.
+// We don't decode these: we memory-map the file, and point levels straight
+// into the mapping.
+
+enum class container_type_t : uint32_t {
+	eNone = 0,
+	eKTX2,
+	eDDS,
+};
+
+static constexpr unsigned char KTX2_MAGIC[ 12 ] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static constexpr unsigned char DDS_MAGIC[ 4 ]   = { 'D', 'D', 'S', ' ' };
+
+struct container_format_t {
+	uint32_t                    vk_format;    // VkFormat
+	uint32_t                    dxgi_format;  // DXGI_FORMAT, as used by DDS
+	le_pixels_info::BlockFormat block_format; //
+	le_pixels_info::Type        type;         //
+	uint32_t                    num_channels; //
+	uint32_t                    num_bytes;    // per 4x4 block if block-compressed, per texel otherwise
+};
+
+// Formats which we can describe via le_pixels_info - containers holding
+// any other format are rejected.
+static constexpr container_format_t CONTAINER_FORMATS[] = {
+    // clang-format off
+	{   9, 61, le_pixels_info::eUncompressed, le_pixels_info::eUInt8,   1,  1 }, // R8_UNORM
+	{  16, 49, le_pixels_info::eUncompressed, le_pixels_info::eUInt8,   2,  2 }, // R8G8_UNORM
+	{  37, 28, le_pixels_info::eUncompressed, le_pixels_info::eUInt8,   4,  4 }, // R8G8B8A8_UNORM
+	{  43, 29, le_pixels_info::eUncompressed, le_pixels_info::eUInt8,   4,  4 }, // R8G8B8A8_SRGB
+	{  44, 87, le_pixels_info::eUncompressed, le_pixels_info::eUInt8,   4,  4 }, // B8G8R8A8_UNORM
+	{  50, 91, le_pixels_info::eUncompressed, le_pixels_info::eUInt8,   4,  4 }, // B8G8R8A8_SRGB
+	{  91, 11, le_pixels_info::eUncompressed, le_pixels_info::eUInt16,  4,  8 }, // R16G16B16A16_UNORM
+	{ 109,  2, le_pixels_info::eUncompressed, le_pixels_info::eFloat32, 4, 16 }, // R32G32B32A32_SFLOAT
+	{ 133, 71, le_pixels_info::eBC1,          le_pixels_info::eUInt8,   4,  8 }, // BC1_RGBA_UNORM
+	{ 134, 72, le_pixels_info::eBC1,          le_pixels_info::eUInt8,   4,  8 }, // BC1_RGBA_SRGB
+	{ 137, 77, le_pixels_info::eBC3,          le_pixels_info::eUInt8,   4, 16 }, // BC3_UNORM
+	{ 138, 78, le_pixels_info::eBC3,          le_pixels_info::eUInt8,   4, 16 }, // BC3_SRGB
+	{ 139, 80, le_pixels_info::eBC4,          le_pixels_info::eUInt8,   1,  8 }, // BC4_UNORM
+	{ 141, 83, le_pixels_info::eBC5,          le_pixels_info::eUInt8,   2, 16 }, // BC5_UNORM
+	{ 145, 98, le_pixels_info::eBC7,          le_pixels_info::eUInt8,   4, 16 }, // BC7_UNORM
+	{ 146, 99, le_pixels_info::eBC7,          le_pixels_info::eUInt8,   4, 16 }, // BC7_SRGB
+    // clang-format on
+};
+
+static container_format_t const* container_find_format( uint32_t vk_format, uint32_t dxgi_format ) {
+	for ( auto const& f : CONTAINER_FORMATS ) {
+		if ( ( vk_format && f.vk_format == vk_format ) || ( dxgi_format && f.dxgi_format == dxgi_format ) ) {
+			return &f;
+		}
+	}
+	return nullptr;
+}
+
+// Containers may not have images wider, or higher than this - so that byte counts for
+// levels can't overflow 64 bits. Byte counts must further fit into 32 bits, see below.
+static constexpr uint32_t CONTAINER_MAX_EXTENT = 1 << 16;
+
+static inline uint64_t container_format_get_level_byte_count( container_format_t const& format, uint32_t width, uint32_t height ) {
+	if ( format.block_format != le_pixels_info::eUncompressed ) {
+		return ( ( uint64_t( width ) + 3 ) / 4 ) * ( ( uint64_t( height ) + 3 ) / 4 ) * format.num_bytes;
+	}
+	return uint64_t( width ) * height * format.num_bytes;
+}
+
+// Offsets computed from header fields may overflow - these saturate instead,
+// which puts the result out of bounds for any file.
+static inline uint64_t container_add( uint64_t a, uint64_t b ) {
+	return ( a > UINT64_MAX - b ) ? UINT64_MAX : a + b;
+}
+
+static inline uint64_t container_mul( uint64_t a, uint64_t b ) {
+	return ( a != 0 && b > UINT64_MAX / a ) ? UINT64_MAX : a * b;
+}
+
+// ----------------------------------------------------------------------
+
+static container_type_t container_get_type( unsigned char const* data, size_t num_bytes ) {
+	if ( num_bytes >= sizeof( KTX2_MAGIC ) && 0 == memcmp( data, KTX2_MAGIC, sizeof( KTX2_MAGIC ) ) ) {
+		return container_type_t::eKTX2;
+	}
+	if ( num_bytes >= sizeof( DDS_MAGIC ) && 0 == memcmp( data, DDS_MAGIC, sizeof( DDS_MAGIC ) ) ) {
+		return container_type_t::eDDS;
+	}
+	return container_type_t::eNone;
+}
+
+// Reads just enough of the source to tell whether it is a container file.
+static container_type_t container_get_type( image_source_info_t const& source ) {
+
+	if ( source.type == image_source_info_t::Type::eBuffer ) {
+		return container_get_type( source.data.as_buffer.buffer, source.data.as_buffer.buffer_num_bytes );
+	}
+
+	unsigned char magic[ sizeof( KTX2_MAGIC ) ]{};
+
+	FILE* file = fopen( source.data.as_file.file_path, "rb" );
+
+	if ( file == nullptr ) {
+		return container_type_t::eNone;
+	}
+
+	size_t num_bytes = fread( magic, 1, sizeof( magic ), file );
+	fclose( file );
+
+	return container_get_type( magic, num_bytes );
+}
+
+// ----------------------------------------------------------------------
+
+template <typename T>
+static inline T container_read( unsigned char const* data, size_t offset ) {
+	T value;
+	memcpy( &value, data + offset, sizeof( T ) );
+	return value;
+}
+
+/// \brief fills in info, and levels, given level 0 extents, format, and per-image offsets.
+/// `get_offset` returns the offset, in bytes, of an image, given its mip level, and array layer.
+template <typename F>
+static bool container_set_levels( container_format_t const& format, uint32_t width, uint32_t height, uint32_t mip_levels, uint32_t array_layers, size_t num_bytes, F get_offset, le_pixels_info* info, std::vector<le_pixels_level_t>* levels ) {
+
+	if ( width == 0 || height == 0 || mip_levels == 0 || array_layers == 0 || mip_levels > 32 ) {
+		return false;
+	}
+
+	if ( width > CONTAINER_MAX_EXTENT || height > CONTAINER_MAX_EXTENT ) {
+		return false;
+	}
+
+	if ( container_format_get_level_byte_count( format, width, height ) > UINT32_MAX ) {
+		return false; // level byte counts must fit into 32 bits - and level 0 is the largest level
+	}
+
+	if ( uint64_t( array_layers ) * mip_levels > num_bytes ) {
+		return false; // each image takes up at least one byte - this is a broken header, and we must not allocate levels for it
+	}
+
+	if ( levels ) {
+		levels->resize( size_t( array_layers ) * mip_levels );
+
+		for ( uint32_t layer = 0; layer != array_layers; layer++ ) {
+			for ( uint32_t l = 0; l != mip_levels; l++ ) {
+				auto& level      = ( *levels )[ size_t( layer ) * mip_levels + l ];
+				level.width      = std::max( 1u, width >> l );
+				level.height     = std::max( 1u, height >> l );
+				level.byte_count = uint32_t( container_format_get_level_byte_count( format, level.width, level.height ) );
+				level.offset     = get_offset( l, layer );
+				level.reserved   = 0;
+
+				// We must not add offset, and byte count, as this may overflow for offsets read from the file.
+				if ( level.offset > num_bytes || level.byte_count > num_bytes - level.offset ) {
+					return false; // file is truncated, or header is broken
+				}
+			}
+		}
+	}
+
+	info->width        = width;
+	info->height       = height;
+	info->depth        = 1;
+	info->num_channels = format.num_channels;
+	info->type         = format.type;
+	info->block_format = format.block_format;
+	info->mip_levels   = mip_levels;
+	info->array_layers = array_layers;
+	info->vk_format    = format.vk_format;
+	info->byte_count   = uint32_t( container_format_get_level_byte_count( format, width, height ) );
+	info->bpp          = format.block_format != le_pixels_info::eUncompressed ? format.num_bytes / 2 : format.num_bytes * 8;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+static bool container_parse_ktx2( unsigned char const* data, size_t num_bytes, le_pixels_info* info, std::vector<le_pixels_level_t>* levels ) {
+
+	static auto logger = LeLog( "le_pixels" );
+
+	constexpr size_t HEADER_SIZE      = 80; // identifier, header, and index
+	constexpr size_t LEVEL_INDEX_SIZE = 24; // byteOffset, byteLength, uncompressedByteLength
+
+	if ( num_bytes < HEADER_SIZE ) {
+		return false;
+	}
+
+	uint32_t const vk_format                = container_read<uint32_t>( data, 12 );
+	uint32_t const width                    = container_read<uint32_t>( data, 20 );
+	uint32_t const height                   = container_read<uint32_t>( data, 24 );
+	uint32_t const depth                    = container_read<uint32_t>( data, 28 );
+	uint32_t const layer_count              = std::max( 1u, container_read<uint32_t>( data, 32 ) );
+	uint32_t const face_count               = container_read<uint32_t>( data, 36 );
+	uint32_t const level_count              = std::max( 1u, container_read<uint32_t>( data, 40 ) ); // 0 means: generate mip levels at load time - we only use level 0
+	uint32_t const supercompression_scheme  = container_read<uint32_t>( data, 44 );
+	size_t const   level_index_end          = HEADER_SIZE + size_t( level_count ) * LEVEL_INDEX_SIZE;
+	auto const*    format                   = container_find_format( vk_format, 0 );
+
+	if ( supercompression_scheme != 0 ) {
+		logger.error( "KTX2 supercompression is not supported." );
+		return false;
+	}
+
+	if ( format == nullptr ) {
+		logger.error( "KTX2 file has unsupported VkFormat: %d", vk_format );
+		return false;
+	}
+
+	if ( depth > 1 ) {
+		logger.error( "KTX2 files with 3d images are not supported." );
+		return false;
+	}
+
+	if ( face_count != 1 && face_count != 6 ) {
+		logger.error( "KTX2 file has invalid face count: %d", face_count );
+		return false;
+	}
+
+	if ( layer_count > UINT32_MAX / face_count ) {
+		return false;
+	}
+
+	if ( level_index_end > num_bytes ) {
+		return false;
+	}
+
+	// Cube faces become array layers: faces of each layer are stored in the order +x, -x, +y, -y, +z, -z,
+	// which is how Vulkan expects them.
+	uint32_t const num_images_per_level = layer_count * face_count;
+
+	// Returns UINT64_MAX if the image lies outside of its level's byteLength, as given by the level index.
+	auto get_offset = [ & ]( uint32_t mip_level, uint32_t array_layer ) -> uint64_t {
+		uint64_t const level_offset     = container_read<uint64_t>( data, HEADER_SIZE + mip_level * LEVEL_INDEX_SIZE );
+		uint64_t const level_byte_count = container_read<uint64_t>( data, HEADER_SIZE + mip_level * LEVEL_INDEX_SIZE + 8 );
+		uint64_t const image_byte_count = container_format_get_level_byte_count( *format, std::max( 1u, width >> mip_level ), std::max( 1u, height >> mip_level ) );
+		uint64_t const image_end        = container_mul( uint64_t( array_layer ) + 1, image_byte_count );
+		if ( image_end > level_byte_count ) {
+			return UINT64_MAX;
+		}
+		return container_add( level_offset, image_end - image_byte_count );
+	};
+
+	return container_set_levels( *format, width, height, level_count, num_images_per_level, num_bytes, get_offset, info, levels );
+}
+
+// ----------------------------------------------------------------------
+
+static bool container_parse_dds( unsigned char const* data, size_t num_bytes, le_pixels_info* info, std::vector<le_pixels_level_t>* levels ) {
+
+	static auto logger = LeLog( "le_pixels" );
+
+	constexpr size_t   HEADER_SIZE            = 4 + 124; // magic, and DDS_HEADER
+	constexpr size_t   HEADER_DX10_SIZE       = 20;      // DDS_HEADER_DXT10
+	constexpr uint32_t DDPF_FOURCC            = 0x4;
+	constexpr uint32_t DDPF_RGB               = 0x40;
+	constexpr uint32_t DDSCAPS2_CUBEMAP       = 0x200;
+	constexpr uint32_t DDSCAPS2_VOLUME        = 0x200000;
+	constexpr uint32_t DDS_RESOURCE_MISC_CUBE = 0x4;
+
+	auto fourcc = []( char const ( &c )[ 5 ] ) {
+		return uint32_t( c[ 0 ] ) | ( uint32_t( c[ 1 ] ) << 8 ) | ( uint32_t( c[ 2 ] ) << 16 ) | ( uint32_t( c[ 3 ] ) << 24 );
+	};
+
+	if ( num_bytes < HEADER_SIZE ) {
+		return false;
+	}
+
+	uint32_t const height        = container_read<uint32_t>( data, 12 );
+	uint32_t const width         = container_read<uint32_t>( data, 16 );
+	uint32_t const mip_levels    = std::max( 1u, container_read<uint32_t>( data, 28 ) );
+	uint32_t const pf_flags      = container_read<uint32_t>( data, 80 );
+	uint32_t const pf_fourcc     = container_read<uint32_t>( data, 84 );
+	uint32_t const pf_bit_count  = container_read<uint32_t>( data, 88 );
+	uint32_t const pf_r_mask     = container_read<uint32_t>( data, 92 );
+	uint32_t const pf_b_mask     = container_read<uint32_t>( data, 100 );
+	uint32_t const caps_2        = container_read<uint32_t>( data, 112 );
+	uint32_t       dxgi_format   = 0;
+	uint32_t       array_layers  = 1;
+	bool           is_cube       = caps_2 & DDSCAPS2_CUBEMAP;
+	size_t         data_offset   = HEADER_SIZE;
+
+	if ( ( pf_flags & DDPF_FOURCC ) && pf_fourcc == fourcc( "DX10" ) ) {
+		if ( num_bytes < HEADER_SIZE + HEADER_DX10_SIZE ) {
+			return false;
+		}
+		dxgi_format  = container_read<uint32_t>( data, HEADER_SIZE + 0 );
+		is_cube      = container_read<uint32_t>( data, HEADER_SIZE + 8 ) & DDS_RESOURCE_MISC_CUBE;
+		array_layers = std::max( 1u, container_read<uint32_t>( data, HEADER_SIZE + 12 ) );
+		data_offset += HEADER_DX10_SIZE;
+	} else if ( pf_flags & DDPF_FOURCC ) {
+		// clang-format off
+		if      ( pf_fourcc == fourcc( "DXT1" ) ) dxgi_format = 71; // BC1_UNORM
+		else if ( pf_fourcc == fourcc( "DXT5" ) ) dxgi_format = 77; // BC3_UNORM
+		else if ( pf_fourcc == fourcc( "ATI1" ) ) dxgi_format = 80; // BC4_UNORM
+		else if ( pf_fourcc == fourcc( "BC4U" ) ) dxgi_format = 80; // BC4_UNORM
+		else if ( pf_fourcc == fourcc( "ATI2" ) ) dxgi_format = 83; // BC5_UNORM
+		else if ( pf_fourcc == fourcc( "BC5U" ) ) dxgi_format = 83; // BC5_UNORM
+		// clang-format on
+	} else if ( ( pf_flags & DDPF_RGB ) && pf_bit_count == 32 ) {
+		if ( pf_r_mask == 0x000000ff && pf_b_mask == 0x00ff0000 ) {
+			dxgi_format = 28; // R8G8B8A8_UNORM
+		} else if ( pf_r_mask == 0x00ff0000 && pf_b_mask == 0x000000ff ) {
+			dxgi_format = 87; // B8G8R8A8_UNORM
+		}
+	}
+
+	auto const* format = container_find_format( 0, dxgi_format );
+
+	if ( format == nullptr ) {
+		logger.error( "DDS file has unsupported pixel format." );
+		return false;
+	}
+
+	if ( caps_2 & DDSCAPS2_VOLUME ) {
+		logger.error( "DDS files with 3d images are not supported." );
+		return false;
+	}
+
+	if ( is_cube ) {
+		if ( array_layers > UINT32_MAX / 6 ) {
+			return false;
+		}
+		array_layers *= 6; // faces are stored in the order +x, -x, +y, -y, +z, -z
+	}
+
+	if ( width > CONTAINER_MAX_EXTENT || height > CONTAINER_MAX_EXTENT || mip_levels > 32 ) {
+		return false; // checked again in container_set_levels - but we need this before we sum up level byte counts
+	}
+
+	// DDS stores all mip levels of an array layer before the next array layer.
+
+	uint64_t layer_byte_count = 0;
+
+	for ( uint32_t l = 0; l != mip_levels; l++ ) {
+		layer_byte_count += container_format_get_level_byte_count( *format, std::max( 1u, width >> l ), std::max( 1u, height >> l ) );
+	}
+
+	auto get_offset = [ & ]( uint32_t mip_level, uint32_t array_layer ) -> uint64_t {
+		uint64_t offset = container_add( data_offset, container_mul( array_layer, layer_byte_count ) );
+		for ( uint32_t l = 0; l != mip_level; l++ ) {
+			offset = container_add( offset, container_format_get_level_byte_count( *format, std::max( 1u, width >> l ), std::max( 1u, height >> l ) ) );
+		}
+		return offset;
+	};
+
+	return container_set_levels( *format, width, height, mip_levels, array_layers, num_bytes, get_offset, info, levels );
+}
+
+// ----------------------------------------------------------------------
+/// \brief parses container header, and - if levels is not nullptr - the offsets of all levels.
+static bool container_parse( container_type_t type, unsigned char const* data, size_t num_bytes, le_pixels_info* info, std::vector<le_pixels_level_t>* levels ) {
+	switch ( type ) {
+	case container_type_t::eKTX2:
+		return container_parse_ktx2( data, num_bytes, info, levels );
+	case container_type_t::eDDS:
+		return container_parse_dds( data, num_bytes, info, levels );
+	case container_type_t::eNone:
+		break;
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------
+// We map container files privately, and writable - so that get_data may
+// hand out a writable pointer, while writes never reach the file.
+static bool file_mapping_create( char const* file_path, le_pixels_file_mapping_t* mapping ) {
+#ifndef _MSC_VER
+	int fd = open( file_path, O_RDONLY );
+
+	if ( fd == -1 ) {
+		return false;
+	}
+
+	struct stat file_stat {};
+
+	if ( fstat( fd, &file_stat ) == -1 || file_stat.st_size == 0 ) {
+		close( fd );
+		return false;
+	}
+
+	size_t num_bytes = size_t( file_stat.st_size );
+	void*  data      = mmap( nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+
+	// The mapping keeps the file open, we don't need the file descriptor anymore.
+	close( fd );
+
+	if ( data == MAP_FAILED ) {
+		return false;
+	}
+
+	mapping->data      = static_cast<unsigned char*>( data );
+	mapping->num_bytes = num_bytes;
+
+	return true;
+#else
+	FILE* file = fopen( file_path, "rb" );
+
+	if ( file == nullptr ) {
+		return false;
+	}
+
+	fseek( file, 0, SEEK_END );
+	long num_bytes = ftell( file );
+	fseek( file, 0, SEEK_SET );
+
+	bool success = num_bytes > 0;
+
+	if ( success ) {
+		mapping->data      = static_cast<unsigned char*>( malloc( size_t( num_bytes ) ) );
+		mapping->num_bytes = size_t( num_bytes );
+		success            = fread( mapping->data, 1, mapping->num_bytes, file ) == mapping->num_bytes;
+	}
+
+	fclose( file );
+
+	return success;
+#endif
+}
+
+static void file_mapping_destroy( le_pixels_file_mapping_t* mapping ) {
+	if ( mapping->data ) {
+#ifndef _MSC_VER
+		munmap( mapping->data, mapping->num_bytes );
+#else
+		free( mapping->data );
+#endif
+	}
+	mapping->data      = nullptr;
+	mapping->num_bytes = 0;
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_o* le_pixels_create_from_container( image_source_info_t const& source, container_type_t type ) {
+
+	static auto logger = LeLog( "le_pixels" );
+
+	auto self = new le_pixels_o{};
+
+	unsigned char const* data      = nullptr;
+	size_t               num_bytes = 0;
+
+	if ( source.type == image_source_info_t::Type::eFile ) {
+		if ( !file_mapping_create( source.data.as_file.file_path, &self->mapping ) ) {
+			logger.error( "ERROR: Could not map file: '%s'", source.data.as_file.file_path );
+			le_pixels_destroy( self );
+			return nullptr;
+		}
+		data      = self->mapping.data;
+		num_bytes = self->mapping.num_bytes;
+	} else {
+		// We can't tell how long the buffer will live, so we must keep a copy.
+		self->storage.assign( source.data.as_buffer.buffer, source.data.as_buffer.buffer + source.data.as_buffer.buffer_num_bytes );
+		data      = self->storage.data();
+		num_bytes = self->storage.size();
+	}
+
+	if ( !container_parse( type, data, num_bytes, &self->info, &self->levels ) ) {
+		if ( source.type == image_source_info_t::Type::eFile ) {
+			logger.error( "ERROR: Could not read container file: '%s'", source.data.as_file.file_path );
+		} else {
+			logger.error( "ERROR: Could not read container from buffer at address: %p", source.data.as_buffer.buffer );
+		}
+		le_pixels_destroy( self );
+		return nullptr;
+	}
+
+	self->image_data = const_cast<unsigned char*>( data );
+
+	return self;
+}
+
 // ----------------------------------------------------------------------
 
 static le_pixels_o* le_pixels_create( image_source_info_t const& info ) {
+
+	if ( auto container = container_get_type( info ); container != container_type_t::eNone ) {
+		return le_pixels_create_from_container( info, container );
+	}
+
 	auto self = new le_pixels_o{};
 
 	int width;
@@ -130,6 +661,9 @@ static le_pixels_o* le_pixels_create( image_source_info_t const& info ) {
 	self->info.depth        = 1;
 	self->info.num_channels = uint32_t( num_channels );
 	self->info.byte_count   = ( self->info.bpp / 8 ) * ( self->info.width * self->info.height * self->info.depth );
+	self->info.mip_levels   = 1;
+	self->info.array_layers = 1;
+	self->info.block_format = le_pixels_info::eUncompressed;
 
 	return self;
 }
@@ -172,7 +706,11 @@ static le_pixels_info le_pixels_get_info( le_pixels_o* self ) {
 // ----------------------------------------------------------------------
 
 static void* le_pixels_get_data( le_pixels_o* self ) {
-	return self->image_data;
+	if ( self->levels.empty() || self->image_data == nullptr ) {
+		return self->image_data;
+	}
+	// Level 0 of container files does not necessarily start at the beginning of image_data.
+	return static_cast<unsigned char*>( self->image_data ) + self->levels[ 0 ].offset;
 }
 
 // ----------------------------------------------------------------------
@@ -196,6 +734,25 @@ static bool le_pixels_get_info_from_source( image_source_info_t const& source, l
 		assert( false );
 	}
 
+	if ( auto container = container_get_type( source ); container != container_type_t::eNone ) {
+
+		if ( source.type == image_source_info_t::Type::eBuffer ) {
+			return container_parse( container, source.data.as_buffer.buffer, source.data.as_buffer.buffer_num_bytes, info, nullptr );
+		}
+
+		// Mapping the file only reads the pages which we touch - which is just the header.
+		le_pixels_file_mapping_t mapping{};
+
+		if ( !file_mapping_create( source.data.as_file.file_path, &mapping ) ) {
+			return false;
+		}
+
+		bool result = container_parse( container, mapping.data, mapping.num_bytes, info, nullptr );
+		file_mapping_destroy( &mapping );
+
+		return result;
+	}
+
 	int width;
 	int height;
 	int components;
@@ -245,6 +802,11 @@ static bool le_pixels_get_info_from_source( image_source_info_t const& source, l
 	info->bpp        = 8 * get_num_bytes_for_type( info->type ) * uint32_t( info->num_channels ); // note * 8, since we're returning bits per pixels!
 	info->byte_count = ( info->bpp / 8 ) * ( info->width * info->height * info->depth );
 
+	info->mip_levels   = 1;
+	info->array_layers = 1;
+	info->block_format = le_pixels_info::eUncompressed;
+	info->vk_format    = 0;
+
 	return true;
 }
 
@@ -269,16 +831,1475 @@ static bool le_pixels_get_info_from_memory( unsigned char const* buffer, size_t
 
 // ----------------------------------------------------------------------
 
-LE_MODULE_REGISTER_IMPL( le_pixels, api ) {
-	auto& le_pixels_i = static_cast<le_pixels_api*>( api )->le_pixels_i;
+static void const* le_pixels_get_level_data( le_pixels_o* self, uint32_t mip_level, uint32_t array_layer, le_pixels_level_info* level_info ) {
 
-	le_pixels_i.create             = le_pixels_create_from_file;
-	le_pixels_i.create_from_memory = le_pixels_create_from_memory;
+	if ( mip_level >= self->info.mip_levels || array_layer >= self->info.array_layers ) {
+		return nullptr;
+	}
 
-	le_pixels_i.get_info_from_memory = le_pixels_get_info_from_memory;
-	le_pixels_i.get_info_from_file   = le_pixels_get_info_from_file;
+	if ( self->levels.empty() ) {
+		// Pixels which were decoded by stb_image have just the one level.
+		if ( level_info ) {
+			*level_info = { self->info.width, self->info.height, self->info.byte_count };
+		}
+		return self->image_data;
+	}
 
-	le_pixels_i.destroy  = le_pixels_destroy;
-	le_pixels_i.get_data = le_pixels_get_data;
-	le_pixels_i.get_info = le_pixels_get_info;
+	auto const& level = self->levels[ array_layer * self->info.mip_levels + mip_level ];
+
+	if ( level_info ) {
+		*level_info = { level.width, level.height, level.byte_count };
+	}
+
+	return static_cast<unsigned char const*>( self->image_data ) + level.offset;
+}
+
+// ----------------------------------------------------------------------
+// Mip chain generation
+//
+// Each mip level is filtered from the previous level. Filters are written as
+// plain loops over rows of texels, so that the compiler may vectorise them.
+// Rows of a level - and block rows, when we block-compress - are split into
+// batches, which run on le_jobs if LE_MT is enabled.
+
+static constexpr uint32_t MIP_ROWS_PER_JOB      = 64; // rows of texels per job when filtering, rows of blocks per job when compressing
+static constexpr float    KAISER_FILTER_WIDTH   = 3;  // in texels of the target level
+static constexpr float    KAISER_FILTER_ALPHA   = 4;  //
+static constexpr int32_t  KAISER_FILTER_NUM_TAP = 12; // 2 * ceil( 2 * KAISER_FILTER_WIDTH ) - taps in texels of the source level
+
+/// \brief runs `fun` once for each element of `params`, in parallel if le_jobs is available.
+template <typename T>
+static void pixels_run_jobs( void ( *fun )( void* ), std::vector<T>& params ) {
+#if ( LE_MT > 0 )
+	if ( params.size() > 1 ) {
+
+		std::vector<le_jobs::job_t> jobs;
+		jobs.reserve( params.size() );
+
+		for ( auto& p : params ) {
+			jobs.push_back( { fun, &p } );
+		}
+
+		le_jobs::counter_t* counter;
+		le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+		le_jobs::wait_for_counter_and_free( counter, 0 );
+
+		return;
+	}
+#endif
+
+	for ( auto& p : params ) {
+		fun( &p );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static float const* get_srgb_to_linear_table() {
+	static auto const table = []() {
+		std::array<float, 256> t{};
+		for ( uint32_t i = 0; i != 256; i++ ) {
+			float c = i / 255.f;
+			t[ i ]  = c <= 0.04045f ? c / 12.92f : powf( ( c + 0.055f ) / 1.055f, 2.4f );
+		}
+		return t;
+	}();
+	return table.data();
+}
+
+static inline float linear_to_srgb( float c ) {
+	return c <= 0.0031308f ? c * 12.92f : 1.055f * powf( c, 1 / 2.4f ) - 0.055f;
+}
+
+// Components are filtered as floats in [0..1] - 8 bit colour channels are
+// optionally decoded from, and encoded to sRGB.
+
+static inline float component_to_float( uint8_t v, bool is_srgb ) {
+	return is_srgb ? get_srgb_to_linear_table()[ v ] : v * ( 1 / 255.f );
+}
+static inline float component_to_float( uint16_t v, bool ) {
+	return v * ( 1 / 65535.f );
+}
+static inline float component_to_float( float v, bool ) {
+	return v;
+}
+
+static inline void float_to_component( float f, bool is_srgb, uint8_t& out ) {
+	f   = std::clamp( f, 0.f, 1.f );
+	out = uint8_t( ( is_srgb ? linear_to_srgb( f ) : f ) * 255.f + 0.5f );
+}
+static inline void float_to_component( float f, bool, uint16_t& out ) {
+	out = uint16_t( std::clamp( f, 0.f, 1.f ) * 65535.f + 0.5f );
+}
+static inline void float_to_component( float f, bool, float& out ) {
+	out = f;
+}
+
+/// \brief returns whether channel holds colour - as opposed to alpha. Two-channel pixels are grey, alpha.
+static inline bool channel_is_colour( uint32_t channel, uint32_t num_channels ) {
+	return num_channels >= 3 ? channel < 3 : channel == 0;
+}
+
+// ----------------------------------------------------------------------
+
+template <typename T>
+struct mip_filter_job_t {
+	T const*     src;       //
+	uint32_t     src_w;     //
+	uint32_t     src_h;     //
+	T*           dst;       //
+	uint32_t     dst_w;     //
+	uint32_t     dst_h;     //
+	uint32_t     num_channels;
+	bool         is_srgb;   //
+	float*       tmp;       // kaiser only: horizontally filtered source rows, dst_w * src_h texels
+	float const* weights;   // kaiser only: KAISER_FILTER_NUM_TAP weights
+	uint32_t     first_row; // box, and kaiser vertical pass: rows of dst - kaiser horizontal pass: rows of src
+	uint32_t     last_row;  // one past last row
+};
+
+template <typename T>
+static void mip_box_filter_job( void* param ) {
+	auto           j = static_cast<mip_filter_job_t<T> const*>( param );
+	uint32_t const C = j->num_channels;
+
+	for ( uint32_t y = j->first_row; y != j->last_row; y++ ) {
+		T const* row_0   = j->src + size_t( std::min( 2 * y, j->src_h - 1 ) ) * j->src_w * C;
+		T const* row_1   = j->src + size_t( std::min( 2 * y + 1, j->src_h - 1 ) ) * j->src_w * C;
+		T*       dst_row = j->dst + size_t( y ) * j->dst_w * C;
+
+		for ( uint32_t x = 0; x != j->dst_w; x++ ) {
+			uint32_t const x_0 = std::min( 2 * x, j->src_w - 1 ) * C;
+			uint32_t const x_1 = std::min( 2 * x + 1, j->src_w - 1 ) * C;
+
+			for ( uint32_t c = 0; c != C; c++ ) {
+				bool const is_srgb = j->is_srgb && channel_is_colour( c, C );
+				float      sum     = component_to_float( row_0[ x_0 + c ], is_srgb ) +
+				              component_to_float( row_0[ x_1 + c ], is_srgb ) +
+				              component_to_float( row_1[ x_0 + c ], is_srgb ) +
+				              component_to_float( row_1[ x_1 + c ], is_srgb );
+				float_to_component( sum * 0.25f, is_srgb, dst_row[ x * C + c ] );
+			}
+		}
+	}
+}
+
+// Tap k reads source texel 2 * x - ( KAISER_FILTER_NUM_TAP / 2 - 1 ) + k, for target texel x.
+static inline int32_t kaiser_tap_texel( uint32_t x, int32_t k, uint32_t size ) {
+	return std::clamp( int32_t( 2 * x ) - ( KAISER_FILTER_NUM_TAP / 2 - 1 ) + k, 0, int32_t( size ) - 1 );
+}
+
+template <typename T>
+static void mip_kaiser_filter_horizontal_job( void* param ) {
+	auto           j = static_cast<mip_filter_job_t<T> const*>( param );
+	uint32_t const C = j->num_channels;
+
+	for ( uint32_t y = j->first_row; y != j->last_row; y++ ) {
+		T const* src_row = j->src + size_t( y ) * j->src_w * C;
+		float*   tmp_row = j->tmp + size_t( y ) * j->dst_w * C;
+
+		for ( uint32_t x = 0; x != j->dst_w; x++ ) {
+			for ( uint32_t c = 0; c != C; c++ ) {
+				bool const is_srgb = j->is_srgb && channel_is_colour( c, C );
+				float      sum     = 0;
+				for ( int32_t k = 0; k != KAISER_FILTER_NUM_TAP; k++ ) {
+					sum += j->weights[ k ] * component_to_float( src_row[ kaiser_tap_texel( x, k, j->src_w ) * C + c ], is_srgb );
+				}
+				tmp_row[ x * C + c ] = sum;
+			}
+		}
+	}
+}
+
+template <typename T>
+static void mip_kaiser_filter_vertical_job( void* param ) {
+	auto           j = static_cast<mip_filter_job_t<T> const*>( param );
+	uint32_t const C = j->num_channels;
+
+	size_t const row_stride = size_t( j->dst_w ) * C;
+
+	for ( uint32_t y = j->first_row; y != j->last_row; y++ ) {
+		T* dst_row = j->dst + size_t( y ) * row_stride;
+
+		for ( uint32_t i = 0; i != row_stride; i++ ) {
+			float sum = 0;
+			for ( int32_t k = 0; k != KAISER_FILTER_NUM_TAP; k++ ) {
+				sum += j->weights[ k ] * j->tmp[ kaiser_tap_texel( y, k, j->src_h ) * row_stride + i ];
+			}
+			float_to_component( sum, j->is_srgb && channel_is_colour( i % C, C ), dst_row[ i ] );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+/// \brief returns kaiser-windowed sinc weights for downsampling by two, normalised.
+static std::array<float, KAISER_FILTER_NUM_TAP> get_kaiser_weights() {
+
+	// zeroth order modified Bessel function of the first kind
+	auto bessel_i0 = []( float x ) {
+		float sum  = 1;
+		float term = 1;
+		for ( int k = 1; k != 32; k++ ) {
+			term *= ( x / ( 2.f * k ) ) * ( x / ( 2.f * k ) );
+			sum += term;
+		}
+		return sum;
+	};
+
+	std::array<float, KAISER_FILTER_NUM_TAP> weights{};
+
+	float sum = 0;
+
+	for ( int32_t k = 0; k != KAISER_FILTER_NUM_TAP; k++ ) {
+		// Distance from target texel centre to source texel centre, in target texels.
+		float d = ( float( k - ( KAISER_FILTER_NUM_TAP / 2 - 1 ) ) - 0.5f ) / 2.f;
+
+		float sinc   = fabsf( d ) < 1e-6f ? 1.f : sinf( float( M_PI ) * d ) / ( float( M_PI ) * d );
+		float x      = d / KAISER_FILTER_WIDTH;
+		float window = fabsf( x ) < 1.f ? bessel_i0( KAISER_FILTER_ALPHA * sqrtf( 1.f - x * x ) ) / bessel_i0( KAISER_FILTER_ALPHA ) : 0.f;
+
+		weights[ k ] = sinc * window;
+		sum += weights[ k ];
+	}
+
+	for ( auto& w : weights ) {
+		w /= sum;
+	}
+
+	return weights;
+}
+
+// ----------------------------------------------------------------------
+/// \brief filters each level in `levels` from its previous level - level 0 must already be filled in.
+template <typename T>
+static void mip_chain_filter_levels( unsigned char* data, std::vector<le_pixels_level_t> const& levels, uint32_t num_channels, le_pixels_mip_chain_settings const& settings ) {
+
+	auto const weights = get_kaiser_weights();
+
+	std::vector<mip_filter_job_t<T>> jobs;
+	std::vector<float>               tmp;
+
+	for ( size_t l = 1; l < levels.size(); l++ ) {
+		auto const& src = levels[ l - 1 ];
+		auto const& dst = levels[ l ];
+
+		mip_filter_job_t<T> job{};
+		job.src          = reinterpret_cast<T const*>( data + src.offset );
+		job.src_w        = src.width;
+		job.src_h        = src.height;
+		job.dst          = reinterpret_cast<T*>( data + dst.offset );
+		job.dst_w        = dst.width;
+		job.dst_h        = dst.height;
+		job.num_channels = num_channels;
+		job.is_srgb      = settings.is_srgb;
+		job.weights      = weights.data();
+
+		auto add_jobs_for_rows = [ & ]( uint32_t num_rows ) {
+			jobs.clear();
+			for ( uint32_t row = 0; row < num_rows; row += MIP_ROWS_PER_JOB ) {
+				job.first_row = row;
+				job.last_row  = std::min( row + MIP_ROWS_PER_JOB, num_rows );
+				jobs.push_back( job );
+			}
+		};
+
+		if ( settings.filter == le_pixels_mip_chain_settings::eKaiser ) {
+			tmp.resize( size_t( dst.width ) * src.height * num_channels );
+			job.tmp = tmp.data();
+
+			add_jobs_for_rows( src.height );
+			pixels_run_jobs( mip_kaiser_filter_horizontal_job<T>, jobs );
+
+			add_jobs_for_rows( dst.height );
+			pixels_run_jobs( mip_kaiser_filter_vertical_job<T>, jobs );
+		} else {
+			add_jobs_for_rows( dst.height );
+			pixels_run_jobs( mip_box_filter_job<T>, jobs );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+// Block compression
+//
+// Encoders fit endpoints along the principal axis of a block's texels, then
+// pick the nearest palette entry for each texel. BC1 refines its endpoints
+// once via least squares. BC7 uses mode 6 only: a single subset with RGBA
+// endpoints, and 16 palette entries.
+
+static inline uint32_t block_format_get_block_size( le_pixels_info::BlockFormat format ) {
+	return ( format == le_pixels_info::eBC1 || format == le_pixels_info::eBC4 ) ? 8 : 16;
+}
+
+/// \brief finds principal axis of `num_texels` points with `N` components, via power iteration.
+template <uint32_t N>
+static void block_fit_principal_axis( float const ( *points )[ N ], uint32_t num_points, float ( &mean )[ N ], float ( &axis )[ N ] ) {
+
+	for ( uint32_t c = 0; c != N; c++ ) {
+		mean[ c ] = 0;
+		for ( uint32_t i = 0; i != num_points; i++ ) {
+			mean[ c ] += points[ i ][ c ];
+		}
+		mean[ c ] /= float( num_points );
+	}
+
+	float cov[ N ][ N ] = {};
+
+	for ( uint32_t i = 0; i != num_points; i++ ) {
+		for ( uint32_t a = 0; a != N; a++ ) {
+			for ( uint32_t b = 0; b != N; b++ ) {
+				cov[ a ][ b ] += ( points[ i ][ a ] - mean[ a ] ) * ( points[ i ][ b ] - mean[ b ] );
+			}
+		}
+	}
+
+	for ( uint32_t c = 0; c != N; c++ ) {
+		axis[ c ] = 1;
+	}
+
+	for ( int iteration = 0; iteration != 8; iteration++ ) {
+		float next[ N ] = {};
+		float len       = 0;
+		for ( uint32_t a = 0; a != N; a++ ) {
+			for ( uint32_t b = 0; b != N; b++ ) {
+				next[ a ] += cov[ a ][ b ] * axis[ b ];
+			}
+			len += next[ a ] * next[ a ];
+		}
+		if ( len < 1e-12f ) {
+			// All points are (nearly) the same - any axis will do.
+			return;
+		}
+		len = 1 / sqrtf( len );
+		for ( uint32_t c = 0; c != N; c++ ) {
+			axis[ c ] = next[ c ] * len;
+		}
+	}
+}
+
+/// \brief projects points onto principal axis, and returns the extreme points along it.
+template <uint32_t N>
+static void block_fit_endpoints( float const ( *points )[ N ], uint32_t num_points, float ( &e0 )[ N ], float ( &e1 )[ N ] ) {
+	float mean[ N ];
+	float axis[ N ];
+	block_fit_principal_axis<N>( points, num_points, mean, axis );
+
+	float t_min = 0;
+	float t_max = 0;
+
+	for ( uint32_t i = 0; i != num_points; i++ ) {
+		float t = 0;
+		for ( uint32_t c = 0; c != N; c++ ) {
+			t += ( points[ i ][ c ] - mean[ c ] ) * axis[ c ];
+		}
+		t_min = std::min( t_min, t );
+		t_max = std::max( t_max, t );
+	}
+
+	for ( uint32_t c = 0; c != N; c++ ) {
+		e0[ c ] = std::clamp( mean[ c ] + axis[ c ] * t_max, 0.f, 255.f );
+		e1[ c ] = std::clamp( mean[ c ] + axis[ c ] * t_min, 0.f, 255.f );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static inline uint16_t pack_565( float const ( &c )[ 3 ] ) {
+	return uint16_t( ( uint32_t( c[ 0 ] * ( 31 / 255.f ) + 0.5f ) << 11 ) |
+	                 ( uint32_t( c[ 1 ] * ( 63 / 255.f ) + 0.5f ) << 5 ) |
+	                 ( uint32_t( c[ 2 ] * ( 31 / 255.f ) + 0.5f ) ) );
+}
+
+static inline void unpack_565( uint16_t v, int32_t ( &c )[ 3 ] ) {
+	int32_t r = ( v >> 11 ) & 31;
+	int32_t g = ( v >> 5 ) & 63;
+	int32_t b = v & 31;
+	c[ 0 ]    = ( r << 3 ) | ( r >> 2 );
+	c[ 1 ]    = ( g << 2 ) | ( g >> 4 );
+	c[ 2 ]    = ( b << 3 ) | ( b >> 2 );
+}
+
+/// \brief picks the nearest palette entry per texel, and returns the sum of squared errors.
+/// Texels which are transparent get index 3 in three-colour mode.
+static uint32_t bc1_pick_indices( uint8_t const ( *texels )[ 4 ], uint16_t c0, uint16_t c1, bool has_transparent, uint32_t* indices ) {
+
+	int32_t palette[ 4 ][ 3 ];
+	unpack_565( c0, palette[ 0 ] );
+	unpack_565( c1, palette[ 1 ] );
+
+	bool const is_four_colour = c0 > c1;
+
+	for ( int c = 0; c != 3; c++ ) {
+		if ( is_four_colour ) {
+			palette[ 2 ][ c ] = ( 2 * palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 3;
+			palette[ 3 ][ c ] = ( palette[ 0 ][ c ] + 2 * palette[ 1 ][ c ] ) / 3;
+		} else {
+			palette[ 2 ][ c ] = ( palette[ 0 ][ c ] + palette[ 1 ][ c ] ) / 2;
+			palette[ 3 ][ c ] = 0;
+		}
+	}
+
+	uint32_t const num_candidates = is_four_colour ? 4 : 3;
+	uint32_t       total_error    = 0;
+
+	*indices = 0;
+
+	for ( uint32_t i = 0; i != 16; i++ ) {
+
+		if ( has_transparent && texels[ i ][ 3 ] < 128 ) {
+			*indices |= 3u << ( 2 * i );
+			continue;
+		}
+
+		uint32_t best       = 0;
+		uint32_t best_error = ~0u;
+
+		for ( uint32_t p = 0; p != num_candidates; p++ ) {
+			uint32_t error = 0;
+			for ( int c = 0; c != 3; c++ ) {
+				int32_t d = int32_t( texels[ i ][ c ] ) - palette[ p ][ c ];
+				error += uint32_t( d * d );
+			}
+			if ( error < best_error ) {
+				best_error = error;
+				best       = p;
+			}
+		}
+
+		*indices |= best << ( 2 * i );
+		total_error += best_error;
+	}
+
+	return total_error;
+}
+
+/// \brief encodes the colour part of a BC1, or BC3 block. If `allow_transparent`, texels with
+/// alpha < 128 are encoded as transparent, via BC1 three-colour mode.
+static void encode_bc1_block( uint8_t const ( *texels )[ 4 ], bool allow_transparent, uint8_t* out ) {
+
+	bool     has_transparent = false;
+	float    points[ 16 ][ 3 ];
+	uint32_t num_points = 0;
+
+	for ( uint32_t i = 0; i != 16; i++ ) {
+		if ( allow_transparent && texels[ i ][ 3 ] < 128 ) {
+			has_transparent = true;
+			continue;
+		}
+		for ( int c = 0; c != 3; c++ ) {
+			points[ num_points ][ c ] = texels[ i ][ c ];
+		}
+		num_points++;
+	}
+
+	uint16_t c0      = 0;
+	uint16_t c1      = 0;
+	uint32_t indices = 0xffffffff; // all transparent
+
+	if ( num_points != 0 ) {
+
+		float e0[ 3 ];
+		float e1[ 3 ];
+		block_fit_endpoints<3>( points, num_points, e0, e1 );
+
+		// Four-colour mode requires c0 > c1, three-colour mode requires c0 <= c1.
+		auto order_endpoints = [ has_transparent ]( uint16_t& a, uint16_t& b ) {
+			if ( has_transparent ? a > b : a < b ) {
+				std::swap( a, b );
+			}
+		};
+
+		c0 = pack_565( e0 );
+		c1 = pack_565( e1 );
+		order_endpoints( c0, c1 );
+
+		uint32_t error = bc1_pick_indices( texels, c0, c1, has_transparent, &indices );
+
+		// Refine endpoints once, via least squares, given the indices which we just picked.
+		// `weights` holds how much each palette entry weighs endpoint c0.
+
+		float const weights_four[ 4 ]  = { 1, 0, 2 / 3.f, 1 / 3.f };
+		float const weights_three[ 4 ] = { 1, 0, 1 / 2.f, 0 };
+
+		float const* weights = c0 > c1 ? weights_four : weights_three;
+
+		float a = 0, b = 0, d = 0;
+		float x0[ 3 ] = {};
+		float x1[ 3 ] = {};
+
+		for ( uint32_t i = 0; i != 16; i++ ) {
+			uint32_t idx = ( indices >> ( 2 * i ) ) & 3;
+			if ( c0 <= c1 && idx == 3 ) {
+				continue; // transparent
+			}
+			float w = weights[ idx ];
+			a += w * w;
+			b += w * ( 1 - w );
+			d += ( 1 - w ) * ( 1 - w );
+			for ( int c = 0; c != 3; c++ ) {
+				x0[ c ] += w * texels[ i ][ c ];
+				x1[ c ] += ( 1 - w ) * texels[ i ][ c ];
+			}
+		}
+
+		float det = a * d - b * b;
+
+		if ( fabsf( det ) > 1e-6f ) {
+			float r0[ 3 ];
+			float r1[ 3 ];
+			for ( int c = 0; c != 3; c++ ) {
+				r0[ c ] = std::clamp( ( d * x0[ c ] - b * x1[ c ] ) / det, 0.f, 255.f );
+				r1[ c ] = std::clamp( ( a * x1[ c ] - b * x0[ c ] ) / det, 0.f, 255.f );
+			}
+
+			uint16_t r_c0 = pack_565( r0 );
+			uint16_t r_c1 = pack_565( r1 );
+			order_endpoints( r_c0, r_c1 );
+
+			uint32_t r_indices;
+			uint32_t r_error = bc1_pick_indices( texels, r_c0, r_c1, has_transparent, &r_indices );
+
+			if ( r_error < error ) {
+				c0      = r_c0;
+				c1      = r_c1;
+				indices = r_indices;
+			}
+		}
+
+		if ( !has_transparent && c0 == c1 ) {
+			// Block is a single colour - c0 == c1 would mean three-colour mode,
+			// which is fine, as long as no texel uses index 3.
+			indices = 0;
+		}
+	}
+
+	memcpy( out + 0, &c0, 2 );
+	memcpy( out + 2, &c1, 2 );
+	memcpy( out + 4, &indices, 4 );
+}
+
+// ----------------------------------------------------------------------
+
+static void encode_bc4_block( uint8_t const* values, uint8_t* out ) {
+
+	uint8_t v_min = 255;
+	uint8_t v_max = 0;
+
+	for ( uint32_t i = 0; i != 16; i++ ) {
+		v_min = std::min( v_min, values[ i ] );
+		v_max = std::max( v_max, values[ i ] );
+	}
+
+	uint64_t bits = uint64_t( v_max ) | ( uint64_t( v_min ) << 8 );
+
+	if ( v_max != v_min ) {
+		// Eight-value mode: index 0 is v_max, index 1 is v_min, indices 2..7
+		// interpolate from v_max towards v_min.
+		float const scale = 7.f / float( v_max - v_min );
+		for ( uint32_t i = 0; i != 16; i++ ) {
+			uint32_t steps = uint32_t( float( values[ i ] - v_min ) * scale + 0.5f ); // 0 is v_min, 7 is v_max
+			uint32_t index = steps == 7 ? 0 : steps == 0 ? 1
+			                                             : 8 - steps;
+			bits |= uint64_t( index ) << ( 16 + 3 * i );
+		}
+	}
+
+	memcpy( out, &bits, 8 );
+}
+
+// ----------------------------------------------------------------------
+
+static void block_write_bits( uint8_t* out, uint32_t& bit_pos, uint32_t value, uint32_t num_bits ) {
+	for ( uint32_t i = 0; i != num_bits; i++, bit_pos++ ) {
+		out[ bit_pos / 8 ] |= uint8_t( ( ( value >> i ) & 1 ) << ( bit_pos % 8 ) );
+	}
+}
+
+static void encode_bc7_block( uint8_t const ( *texels )[ 4 ], uint8_t* out ) {
+
+	static uint32_t const weights[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float points[ 16 ][ 4 ];
+
+	for ( uint32_t i = 0; i != 16; i++ ) {
+		for ( int c = 0; c != 4; c++ ) {
+			points[ i ][ c ] = texels[ i ][ c ];
+		}
+	}
+
+	float e0[ 4 ];
+	float e1[ 4 ];
+	block_fit_endpoints<4>( points, 16, e0, e1 );
+
+	// Mode 6 endpoints have 7 bits per component, plus one shared lowest bit
+	// (p-bit) per endpoint. We try all four p-bit combinations.
+
+	uint32_t best_error = ~0u;
+	uint32_t best_q[ 2 ][ 4 ];
+	uint32_t best_p[ 2 ];
+	uint32_t best_indices[ 16 ];
+
+	for ( uint32_t p_bits = 0; p_bits != 4; p_bits++ ) {
+		uint32_t p[ 2 ] = { p_bits & 1, p_bits >> 1 };
+		uint32_t q[ 2 ][ 4 ];
+		int32_t  endpoint[ 2 ][ 4 ];
+
+		for ( int c = 0; c != 4; c++ ) {
+			q[ 0 ][ c ]        = uint32_t( std::clamp( ( e0[ c ] - p[ 0 ] ) / 2.f + 0.5f, 0.f, 127.f ) );
+			q[ 1 ][ c ]        = uint32_t( std::clamp( ( e1[ c ] - p[ 1 ] ) / 2.f + 0.5f, 0.f, 127.f ) );
+			endpoint[ 0 ][ c ] = int32_t( ( q[ 0 ][ c ] << 1 ) | p[ 0 ] );
+			endpoint[ 1 ][ c ] = int32_t( ( q[ 1 ][ c ] << 1 ) | p[ 1 ] );
+		}
+
+		int32_t palette[ 16 ][ 4 ];
+
+		for ( uint32_t k = 0; k != 16; k++ ) {
+			for ( int c = 0; c != 4; c++ ) {
+				palette[ k ][ c ] = ( ( 64 - weights[ k ] ) * endpoint[ 0 ][ c ] + weights[ k ] * endpoint[ 1 ][ c ] + 32 ) >> 6;
+			}
+		}
+
+		uint32_t error = 0;
+		uint32_t indices[ 16 ];
+
+		for ( uint32_t i = 0; i != 16; i++ ) {
+			uint32_t texel_best_error = ~0u;
+			for ( uint32_t k = 0; k != 16; k++ ) {
+				uint32_t e = 0;
+				for ( int c = 0; c != 4; c++ ) {
+					int32_t d = int32_t( texels[ i ][ c ] ) - palette[ k ][ c ];
+					e += uint32_t( d * d );
+				}
+				if ( e < texel_best_error ) {
+					texel_best_error = e;
+					indices[ i ]     = k;
+				}
+			}
+			error += texel_best_error;
+		}
+
+		if ( error < best_error ) {
+			best_error = error;
+			memcpy( best_q, q, sizeof( q ) );
+			memcpy( best_p, p, sizeof( p ) );
+			memcpy( best_indices, indices, sizeof( indices ) );
+		}
+	}
+
+	// The highest bit of the first index is implied to be zero - if it isn't,
+	// we swap endpoints, and invert all indices.
+	if ( best_indices[ 0 ] & 8 ) {
+		for ( int c = 0; c != 4; c++ ) {
+			std::swap( best_q[ 0 ][ c ], best_q[ 1 ][ c ] );
+		}
+		std::swap( best_p[ 0 ], best_p[ 1 ] );
+		for ( auto& idx : best_indices ) {
+			idx = 15 - idx;
+		}
+	}
+
+	memset( out, 0, 16 );
+
+	uint32_t bit_pos = 0;
+
+	block_write_bits( out, bit_pos, 1 << 6, 7 ); // mode 6
+
+	for ( int c = 0; c != 4; c++ ) {
+		block_write_bits( out, bit_pos, best_q[ 0 ][ c ], 7 );
+		block_write_bits( out, bit_pos, best_q[ 1 ][ c ], 7 );
+	}
+
+	block_write_bits( out, bit_pos, best_p[ 0 ], 1 );
+	block_write_bits( out, bit_pos, best_p[ 1 ], 1 );
+
+	for ( uint32_t i = 0; i != 16; i++ ) {
+		block_write_bits( out, bit_pos, best_indices[ i ], i == 0 ? 3 : 4 );
+	}
+
+	assert( bit_pos == 128 );
+}
+
+// ----------------------------------------------------------------------
+
+struct block_encode_job_t {
+	uint8_t const*              src;          // uncompressed level
+	uint32_t                    width;        //
+	uint32_t                    height;       //
+	uint32_t                    num_channels; //
+	uint8_t*                    dst;          // compressed level
+	le_pixels_info::BlockFormat format;       //
+	uint32_t                    first_row;    // first row of blocks
+	uint32_t                    last_row;     // one past last row of blocks
+};
+
+static void block_encode_job( void* param ) {
+	auto j = static_cast<block_encode_job_t const*>( param );
+
+	uint32_t const C          = j->num_channels;
+	uint32_t const num_blocks = ( j->width + 3 ) / 4;
+	uint32_t const block_size = block_format_get_block_size( j->format );
+
+	uint8_t texels[ 16 ][ 4 ];
+
+	for ( uint32_t by = j->first_row; by != j->last_row; by++ ) {
+		for ( uint32_t bx = 0; bx != num_blocks; bx++ ) {
+
+			// Gather block texels as rgba - texels beyond the edge of the level repeat edge texels.
+			for ( uint32_t i = 0; i != 16; i++ ) {
+				uint32_t       x = std::min( bx * 4 + i % 4, j->width - 1 );
+				uint32_t       y = std::min( by * 4 + i / 4, j->height - 1 );
+				uint8_t const* s = j->src + ( size_t( y ) * j->width + x ) * C;
+
+				switch ( C ) {
+				case 1: texels[ i ][ 0 ] = texels[ i ][ 1 ] = texels[ i ][ 2 ] = s[ 0 ], texels[ i ][ 3 ] = 255; break;
+				case 2: texels[ i ][ 0 ] = s[ 0 ], texels[ i ][ 1 ] = s[ 1 ], texels[ i ][ 2 ] = 0, texels[ i ][ 3 ] = 255; break;
+				case 3: texels[ i ][ 0 ] = s[ 0 ], texels[ i ][ 1 ] = s[ 1 ], texels[ i ][ 2 ] = s[ 2 ], texels[ i ][ 3 ] = 255; break;
+				default: memcpy( texels[ i ], s, 4 ); break;
+				}
+			}
+
+			uint8_t* out = j->dst + ( size_t( by ) * num_blocks + bx ) * block_size;
+
+			uint8_t channel[ 16 ];
+
+			auto gather_channel = [ & ]( int c ) {
+				for ( uint32_t i = 0; i != 16; i++ ) {
+					channel[ i ] = texels[ i ][ c ];
+				}
+			};
+
+			switch ( j->format ) {
+			case le_pixels_info::eBC1:
+				encode_bc1_block( texels, true, out );
+				break;
+			case le_pixels_info::eBC3:
+				gather_channel( 3 );
+				encode_bc4_block( channel, out );
+				encode_bc1_block( texels, false, out + 8 );
+				break;
+			case le_pixels_info::eBC4:
+				gather_channel( 0 );
+				encode_bc4_block( channel, out );
+				break;
+			case le_pixels_info::eBC5:
+				gather_channel( 0 );
+				encode_bc4_block( channel, out );
+				gather_channel( 1 );
+				encode_bc4_block( channel, out + 8 );
+				break;
+			case le_pixels_info::eBC7:
+				encode_bc7_block( texels, out );
+				break;
+			case le_pixels_info::eUncompressed:
+				assert( false );
+				break;
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+/// \brief creates pixels with a mip chain from level 0 of `source`.
+static le_pixels_o* mip_chain_generate( le_pixels_o* source, le_pixels_mip_chain_settings const& settings ) {
+
+	static auto logger = LeLog( "le_pixels" );
+
+	le_pixels_info const& src = source->info;
+
+	if ( src.block_format != le_pixels_info::eUncompressed || src.depth != 1 ) {
+		logger.error( "Mip chains can only be generated from uncompressed, 2d pixels." );
+		return nullptr;
+	}
+
+	if ( settings.block_format != le_pixels_info::eUncompressed && src.type != le_pixels_info::eUInt8 ) {
+		logger.error( "Block compression requires 8 bit source pixels." );
+		return nullptr;
+	}
+
+	// ----------| invariant: we can generate a mip chain from source
+
+	uint32_t num_levels = 1;
+
+	while ( ( std::max( src.width, src.height ) >> num_levels ) > 0 ) {
+		num_levels++;
+	}
+
+	if ( settings.max_levels ) {
+		num_levels = std::min( num_levels, settings.max_levels );
+	}
+
+	uint32_t const texel_size = get_num_bytes_for_type( src.type ) * src.num_channels;
+
+	// - Generate uncompressed levels
+
+	std::vector<le_pixels_level_t> levels( num_levels );
+	size_t                         num_bytes = 0;
+
+	for ( uint32_t l = 0; l != num_levels; l++ ) {
+		levels[ l ].width      = std::max( 1u, src.width >> l );
+		levels[ l ].height     = std::max( 1u, src.height >> l );
+		levels[ l ].offset     = num_bytes;
+		levels[ l ].byte_count = levels[ l ].width * levels[ l ].height * texel_size;
+		num_bytes += levels[ l ].byte_count;
+	}
+
+	std::vector<unsigned char> storage( num_bytes );
+	memcpy( storage.data(), le_pixels_get_data( source ), levels[ 0 ].byte_count );
+
+	switch ( src.type ) {
+	case le_pixels_info::eUInt8:
+		mip_chain_filter_levels<uint8_t>( storage.data(), levels, src.num_channels, settings );
+		break;
+	case le_pixels_info::eUInt16:
+		mip_chain_filter_levels<uint16_t>( storage.data(), levels, src.num_channels, settings );
+		break;
+	case le_pixels_info::eFloat32:
+		mip_chain_filter_levels<float>( storage.data(), levels, src.num_channels, settings );
+		break;
+	}
+
+	auto self               = new le_pixels_o{};
+	self->info              = src;
+	self->info.mip_levels   = num_levels;
+	self->info.array_layers = 1;
+	self->info.vk_format    = 0; // format is now implied by type, and block_format
+
+	if ( settings.block_format == le_pixels_info::eUncompressed ) {
+		self->storage.swap( storage );
+		self->levels.swap( levels );
+	} else {
+
+		// - Block-compress all levels
+
+		uint32_t const block_size = block_format_get_block_size( settings.block_format );
+
+		self->levels = levels;
+		num_bytes    = 0;
+
+		for ( auto& l : self->levels ) {
+			l.offset     = num_bytes;
+			l.byte_count = ( ( l.width + 3 ) / 4 ) * ( ( l.height + 3 ) / 4 ) * block_size;
+			num_bytes += l.byte_count;
+		}
+
+		self->storage.resize( num_bytes );
+
+		std::vector<block_encode_job_t> jobs;
+
+		for ( uint32_t l = 0; l != num_levels; l++ ) {
+			uint32_t const num_block_rows = ( levels[ l ].height + 3 ) / 4;
+			for ( uint32_t row = 0; row < num_block_rows; row += MIP_ROWS_PER_JOB ) {
+				jobs.push_back( {
+				    storage.data() + levels[ l ].offset,
+				    levels[ l ].width,
+				    levels[ l ].height,
+				    src.num_channels,
+				    self->storage.data() + self->levels[ l ].offset,
+				    settings.block_format,
+				    row,
+				    std::min( row + MIP_ROWS_PER_JOB, num_block_rows ),
+				} );
+			}
+		}
+
+		pixels_run_jobs( block_encode_job, jobs );
+
+		self->info.block_format = settings.block_format;
+		self->info.bpp          = block_size / 2; // 16 texels per block
+	}
+
+	self->image_data      = self->storage.data();
+	self->info.byte_count = self->levels[ 0 ].byte_count;
+
+	return self;
+}
+
+// ----------------------------------------------------------------------
+// Mip chain cache
+//
+// Cache files hold a header, followed by level descriptions, and then all
+// level data. Keys are hashes of source data, and of settings.
+
+struct le_pixels_mip_chain_cache_o {
+	std::mutex  mtx;
+	std::string directory; // empty means that the cache is disabled
+};
+
+static le_pixels_mip_chain_cache_o* mip_chain_cache = nullptr; // singleton, survives module reloads - see LE_MODULE_REGISTER_IMPL
+
+struct mip_chain_cache_header_t {
+	char     magic[ 8 ]; // "LEPIXMC1"
+	uint32_t width;
+	uint32_t height;
+	uint32_t num_channels;
+	uint32_t type;
+	uint32_t block_format;
+	uint32_t mip_levels;
+	uint32_t bpp;
+	uint32_t reserved;
+	uint64_t num_bytes; // total number of bytes of level data
+};
+
+static constexpr char MIP_CHAIN_CACHE_MAGIC[ 8 ] = { 'L', 'E', 'P', 'I', 'X', 'M', 'C', '1' };
+
+static uint64_t mip_chain_settings_hash( le_pixels_mip_chain_settings const& settings, uint64_t seed ) {
+	uint32_t const fields[] = { settings.filter, settings.block_format, settings.max_levels, settings.is_srgb ? 1u : 0u };
+	return SpookyHash::Hash64( fields, sizeof( fields ), seed );
+}
+
+/// \brief returns false if cache is disabled
+static bool mip_chain_cache_get_file_path( uint64_t key, std::string& path ) {
+	std::scoped_lock lock( mip_chain_cache->mtx );
+
+	if ( mip_chain_cache->directory.empty() ) {
+		return false;
+	}
+
+	char file_name[ 32 ];
+	snprintf( file_name, sizeof( file_name ), "%016llx.lepix", ( unsigned long long )key );
+
+	path = mip_chain_cache->directory + "/" + file_name;
+	return true;
+}
+
+static bool mip_chain_cache_is_enabled() {
+	std::scoped_lock lock( mip_chain_cache->mtx );
+	return !mip_chain_cache->directory.empty();
+}
+
+/// \brief returns nullptr if there is no valid cache entry for key
+static le_pixels_o* mip_chain_cache_load( uint64_t key ) {
+
+	std::string path;
+
+	if ( !mip_chain_cache_get_file_path( key, path ) ) {
+		return nullptr;
+	}
+
+	FILE* file = fopen( path.c_str(), "rb" );
+
+	if ( file == nullptr ) {
+		return nullptr;
+	}
+
+	fseek( file, 0, SEEK_END );
+	long file_sz = ftell( file );
+	fseek( file, 0, SEEK_SET );
+
+	mip_chain_cache_header_t header{};
+
+	auto self = new le_pixels_o{};
+
+	// We don't trust cache files: they may be truncated, corrupted, or written by
+	// an older version. Sizes from the header must account for the file exactly,
+	// before we allocate anything based on them.
+	bool success =
+	    file_sz > 0 &&
+	    fread( &header, sizeof( header ), 1, file ) == 1 &&
+	    0 == memcmp( header.magic, MIP_CHAIN_CACHE_MAGIC, sizeof( header.magic ) ) &&
+	    header.mip_levels != 0 &&
+	    header.mip_levels <= 32 &&
+	    uint64_t( file_sz ) > sizeof( header ) + sizeof( le_pixels_level_t ) * header.mip_levels &&
+	    header.num_bytes == uint64_t( file_sz ) - sizeof( header ) - sizeof( le_pixels_level_t ) * header.mip_levels;
+
+	if ( success ) {
+		self->levels.resize( header.mip_levels );
+		self->storage.resize( header.num_bytes );
+		success =
+		    fread( self->levels.data(), sizeof( le_pixels_level_t ), header.mip_levels, file ) == header.mip_levels &&
+		    fread( self->storage.data(), 1, header.num_bytes, file ) == header.num_bytes;
+	}
+
+	fclose( file );
+
+	if ( success ) {
+		// Each level must lie within level data. We must not add offset, and byte count,
+		// as this may overflow for offsets read from the file.
+		for ( auto const& level : self->levels ) {
+			if ( level.offset > header.num_bytes || level.byte_count > header.num_bytes - level.offset ) {
+				success = false;
+				break;
+			}
+		}
+		success = success &&
+		          header.width == self->levels[ 0 ].width &&
+		          header.height == self->levels[ 0 ].height;
+	}
+
+	if ( !success ) {
+		delete self;
+		return nullptr;
+	}
+
+	self->image_data        = self->storage.data();
+	self->info.width        = header.width;
+	self->info.height       = header.height;
+	self->info.depth        = 1;
+	self->info.num_channels = header.num_channels;
+	self->info.type         = le_pixels_info::Type( header.type );
+	self->info.block_format = le_pixels_info::BlockFormat( header.block_format );
+	self->info.mip_levels   = header.mip_levels;
+	self->info.array_layers = 1;
+	self->info.bpp          = header.bpp;
+	self->info.byte_count   = self->levels[ 0 ].byte_count;
+
+	return self;
+}
+
+static void mip_chain_cache_store( uint64_t key, le_pixels_o const* pixels ) {
+
+	std::string path;
+
+	if ( !mip_chain_cache_get_file_path( key, path ) ) {
+		return;
+	}
+
+	mip_chain_cache_header_t header{};
+	memcpy( header.magic, MIP_CHAIN_CACHE_MAGIC, sizeof( header.magic ) );
+	header.width        = pixels->info.width;
+	header.height       = pixels->info.height;
+	header.num_channels = pixels->info.num_channels;
+	header.type         = pixels->info.type;
+	header.block_format = pixels->info.block_format;
+	header.mip_levels   = pixels->info.mip_levels;
+	header.bpp          = pixels->info.bpp;
+	header.num_bytes    = pixels->storage.size();
+
+	// We write to a temporary file first, and then rename it - so that
+	// nobody may read a cache file which is only partially written.
+	std::string tmp_path = path + ".tmp";
+
+	FILE* file = fopen( tmp_path.c_str(), "wb" );
+
+	if ( file == nullptr ) {
+		return;
+	}
+
+	bool success =
+	    fwrite( &header, sizeof( header ), 1, file ) == 1 &&
+	    fwrite( pixels->levels.data(), sizeof( le_pixels_level_t ), pixels->levels.size(), file ) == pixels->levels.size() &&
+	    fwrite( pixels->storage.data(), 1, pixels->storage.size(), file ) == pixels->storage.size();
+
+	fclose( file );
+
+	if ( !success || 0 != rename( tmp_path.c_str(), path.c_str() ) ) {
+		remove( tmp_path.c_str() );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_o* le_pixels_create_mip_chain( le_pixels_o* source, le_pixels_mip_chain_settings const* settings ) {
+
+	if ( source == nullptr || settings == nullptr ) {
+		return nullptr;
+	}
+
+	uint64_t key = 0;
+
+	if ( mip_chain_cache_is_enabled() ) {
+		uint32_t const source_fields[] = { source->info.width, source->info.height, source->info.num_channels, source->info.type };
+
+		key = SpookyHash::Hash64( source_fields, sizeof( source_fields ), 0 );
+		key = SpookyHash::Hash64( le_pixels_get_data( source ), source->info.byte_count, mip_chain_settings_hash( *settings, key ) );
+
+		if ( auto cached = mip_chain_cache_load( key ) ) {
+			return cached;
+		}
+	}
+
+	le_pixels_o* chain = mip_chain_generate( source, *settings );
+
+	if ( chain && key ) {
+		mip_chain_cache_store( key, chain );
+	}
+
+	return chain;
+}
+
+// ----------------------------------------------------------------------
+
+static void le_pixels_set_mip_chain_cache_directory( char const* directory_path ) {
+
+	std::scoped_lock lock( mip_chain_cache->mtx );
+
+	if ( directory_path == nullptr ) {
+		mip_chain_cache->directory.clear();
+		return;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories( directory_path, ec );
+
+	if ( ec ) {
+		static auto logger = LeLog( "le_pixels" );
+		logger.error( "Could not create mip chain cache directory: '%s'", directory_path );
+		mip_chain_cache->directory.clear();
+		return;
+	}
+
+	mip_chain_cache->directory = directory_path;
+}
+
+// ----------------------------------------------------------------------
+// Asynchronous decoding
+//
+// Decodes are queued, and start in order of request, for as long as the
+// decoded size of all started, but unclaimed decodes stays within budget.
+// We estimate decoded size from the image header, which stb_image reads
+// without decoding the image.
+
+static constexpr auto DEFAULT_DECODE_BUDGET_BYTES = uint64_t( 256 * 1024 * 1024 );
+
+struct le_pixels_decode_o {
+	image_source_info_t source;
+	std::string         file_path;            // owning copy of source file path, if source is a file
+	uint64_t            num_bytes   = 0;       // estimated decoded size, counts against budget once decode has started
+	le_pixels_o*        pixels      = nullptr; // result, nullptr if decode failed
+	std::atomic<bool>   is_complete = false;   // set by decode job once pixels are set
+	bool                was_started = false;   // protected by decode service mutex
+
+	bool                         has_mip_chain = false; // if true, decode job also creates a mip chain
+	le_pixels_mip_chain_settings mip_chain_settings{};  //
+#if ( LE_MT > 0 )
+	le_jobs::counter_t* counter = nullptr;
+#endif
+};
+
+struct le_pixels_decode_service_o {
+	std::mutex                      mtx;
+	std::deque<le_pixels_decode_o*> queue;                                      // decodes which have not started yet, in order of request
+	uint64_t                        bytes_in_use = 0;                           // estimated decoded size of started, unclaimed decodes
+	uint64_t                        budget_bytes = DEFAULT_DECODE_BUDGET_BYTES; // 0 means unlimited
+};
+
+static le_pixels_decode_service_o* decode_service = nullptr; // singleton, survives module reloads - see LE_MODULE_REGISTER_IMPL
+
+// ----------------------------------------------------------------------
+
+// Decodes, and creates a mip chain. With the mip chain cache enabled, we key
+// the cache by the file's contents, so that a cache hit skips decoding.
+static le_pixels_o* decode_mip_chain( le_pixels_decode_o* decode ) {
+
+	uint64_t                   key = 0;
+	std::vector<unsigned char> file_contents;
+	image_source_info_t        source = decode->source;
+
+	if ( mip_chain_cache_is_enabled() && source.type == image_source_info_t::Type::eFile ) {
+
+		FILE* file = fopen( decode->file_path.c_str(), "rb" );
+
+		if ( file ) {
+			fseek( file, 0, SEEK_END );
+			long num_bytes = ftell( file );
+			fseek( file, 0, SEEK_SET );
+
+			if ( num_bytes > 0 ) {
+				file_contents.resize( size_t( num_bytes ) );
+				if ( fread( file_contents.data(), 1, file_contents.size(), file ) != file_contents.size() ) {
+					file_contents.clear();
+				}
+			}
+
+			fclose( file );
+		}
+
+		if ( !file_contents.empty() ) {
+			int32_t const request_fields[] = { source.requested_num_channels, int32_t( source.requested_pixel_type ) };
+
+			key = SpookyHash::Hash64( request_fields, sizeof( request_fields ), 1 ); // seed differs from create_mip_chain, as keys hash encoded data
+			key = SpookyHash::Hash64( file_contents.data(), file_contents.size(), mip_chain_settings_hash( decode->mip_chain_settings, key ) );
+
+			if ( auto cached = mip_chain_cache_load( key ) ) {
+				return cached;
+			}
+
+			// We already have the file's contents in memory - no need to read it again.
+			source.type                            = image_source_info_t::Type::eBuffer;
+			source.data.as_buffer.buffer           = file_contents.data();
+			source.data.as_buffer.buffer_num_bytes = file_contents.size();
+		}
+	}
+
+	le_pixels_o* pixels = le_pixels_create( source );
+
+	if ( pixels == nullptr ) {
+		return nullptr;
+	}
+
+	le_pixels_o* chain = mip_chain_generate( pixels, decode->mip_chain_settings );
+	le_pixels_destroy( pixels );
+
+	if ( chain && key ) {
+		mip_chain_cache_store( key, chain );
+	}
+
+	return chain;
+}
+
+// ----------------------------------------------------------------------
+
+static void decode_job( void* user_data ) {
+	auto decode = static_cast<le_pixels_decode_o*>( user_data );
+
+	if ( decode->has_mip_chain ) {
+		decode->pixels = decode_mip_chain( decode );
+	} else {
+		decode->pixels = le_pixels_create( decode->source );
+	}
+
+	decode->is_complete.store( true, std::memory_order_release );
+}
+
+// ----------------------------------------------------------------------
+// Must be called while holding decode service mutex.
+static void decode_start( le_pixels_decode_service_o* service, le_pixels_decode_o* decode ) {
+
+	service->bytes_in_use += decode->num_bytes;
+	decode->was_started = true;
+
+#if ( LE_MT > 0 )
+	le_jobs::job_t job{ decode_job, decode };
+	le_jobs::run_jobs( &job, 1, &decode->counter );
+#else
+	decode_job( decode );
+#endif
+}
+
+// ----------------------------------------------------------------------
+// Starts queued decodes for as long as they fit within budget - but always
+// lets at least one decode run, so that images larger than the budget get
+// decoded eventually. Must be called while holding decode service mutex.
+static void decode_service_pump( le_pixels_decode_service_o* service ) {
+	while ( !service->queue.empty() ) {
+		auto decode = service->queue.front();
+
+		if ( service->budget_bytes != 0 &&
+		     service->bytes_in_use != 0 &&
+		     service->bytes_in_use + decode->num_bytes > service->budget_bytes ) {
+			break;
+		}
+
+		service->queue.pop_front();
+		decode_start( service, decode );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_decode_o* le_pixels_decode_create( image_source_info_t const& source, le_pixels_mip_chain_settings const* mip_chain_settings = nullptr ) {
+
+	auto decode    = new le_pixels_decode_o{};
+	decode->source = source;
+
+	if ( mip_chain_settings ) {
+		decode->has_mip_chain      = true;
+		decode->mip_chain_settings = *mip_chain_settings;
+	}
+
+	if ( source.type == image_source_info_t::Type::eFile ) {
+		decode->file_path                     = source.data.as_file.file_path;
+		decode->source.data.as_file.file_path = decode->file_path.c_str();
+	}
+
+	le_pixels_info info{};
+
+	// If we can't read the header, the decode will fail, too - but it
+	// will fail quickly, and without using any memory. Container files
+	// don't count against the budget either, as they are only mapped.
+	if ( le_pixels_get_info_from_source( decode->source, &info ) && info.vk_format == 0 ) {
+		// Decoded size depends on the requested number of channels, and type,
+		// and not on what is stored in the file.
+		uint32_t num_channels = source.requested_num_channels ? uint32_t( source.requested_num_channels ) : info.num_channels;
+		decode->num_bytes     = uint64_t( info.width ) * info.height * num_channels * get_num_bytes_for_type( source.requested_pixel_type );
+
+		if ( decode->has_mip_chain ) {
+			decode->num_bytes = decode->num_bytes * 4 / 3; // a full mip chain adds a third
+		}
+	}
+
+	std::scoped_lock lock( decode_service->mtx );
+	decode_service->queue.push_back( decode );
+	decode_service_pump( decode_service );
+
+	return decode;
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_decode_o* le_pixels_decode_async( char const* file_path, int num_channels_requested, le_pixels_info::Type type ) {
+
+	image_source_info_t info{};
+
+	info.type                   = image_source_info_t::Type::eFile;
+	info.data.as_file.file_path = file_path;
+	info.requested_pixel_type   = type;
+	info.requested_num_channels = num_channels_requested;
+
+	return le_pixels_decode_create( info );
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_decode_o* le_pixels_decode_async_from_memory( unsigned char const* buffer, size_t buffer_byte_count, int num_channels_requested, le_pixels_info::Type type ) {
+
+	image_source_info_t info{};
+
+	info.type                            = image_source_info_t::Type::eBuffer;
+	info.data.as_buffer.buffer           = buffer;
+	info.data.as_buffer.buffer_num_bytes = buffer_byte_count;
+	info.requested_pixel_type            = type;
+	info.requested_num_channels          = num_channels_requested;
+
+	return le_pixels_decode_create( info );
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_decode_o* le_pixels_decode_async_mip_chain( char const* file_path, int num_channels_requested, le_pixels_info::Type type, le_pixels_mip_chain_settings const* settings ) {
+
+	image_source_info_t info{};
+
+	info.type                   = image_source_info_t::Type::eFile;
+	info.data.as_file.file_path = file_path;
+	info.requested_pixel_type   = type;
+	info.requested_num_channels = num_channels_requested;
+
+	return le_pixels_decode_create( info, settings );
+}
+
+// ----------------------------------------------------------------------
+
+static bool le_pixels_decode_poll( le_pixels_decode_o* decode ) {
+	{
+		// Earlier decodes may have been claimed since we last looked - which
+		// means that there may be budget to start more decodes.
+		std::scoped_lock lock( decode_service->mtx );
+		decode_service_pump( decode_service );
+	}
+	return decode->is_complete.load( std::memory_order_acquire );
+}
+
+// ----------------------------------------------------------------------
+// Blocks until decode is complete. If decode has not started yet, it starts
+// right away, even if this exceeds the budget - as someone is waiting for it.
+static void decode_wait( le_pixels_decode_o* decode ) {
+	{
+		std::scoped_lock lock( decode_service->mtx );
+
+		if ( !decode->was_started ) {
+			auto& queue = decode_service->queue;
+			queue.erase( std::find( queue.begin(), queue.end(), decode ) );
+			decode_start( decode_service, decode );
+		}
+	}
+
+#if ( LE_MT > 0 )
+	le_jobs::wait_for_counter_and_free( decode->counter, 0 );
+	decode->counter = nullptr;
+#endif
+
+	assert( decode->is_complete.load( std::memory_order_acquire ) );
+}
+
+// ----------------------------------------------------------------------
+// Returns decode's budget to the decode service, and frees decode.
+static void decode_release( le_pixels_decode_o* decode ) {
+	{
+		std::scoped_lock lock( decode_service->mtx );
+		decode_service->bytes_in_use -= decode->num_bytes;
+		decode_service_pump( decode_service );
+	}
+	delete decode;
+}
+
+// ----------------------------------------------------------------------
+
+static le_pixels_o* le_pixels_decode_claim( le_pixels_decode_o* decode ) {
+	decode_wait( decode );
+	le_pixels_o* pixels = decode->pixels;
+	decode_release( decode );
+	return pixels;
+}
+
+// ----------------------------------------------------------------------
+
+static void le_pixels_decode_destroy( le_pixels_decode_o* decode ) {
+
+	if ( decode == nullptr ) {
+		return;
+	}
+
+	{
+		std::scoped_lock lock( decode_service->mtx );
+
+		if ( !decode->was_started ) {
+			auto& queue = decode_service->queue;
+			queue.erase( std::find( queue.begin(), queue.end(), decode ) );
+			delete decode;
+			return;
+		}
+	}
+
+	// ----------| invariant: decode has started - we must wait for it to complete.
+
+	decode_wait( decode );
+
+	if ( decode->pixels ) {
+		le_pixels_destroy( decode->pixels );
+	}
+
+	decode_release( decode );
+}
+
+// ----------------------------------------------------------------------
+
+static void le_pixels_set_decode_budget( uint64_t num_bytes ) {
+	std::scoped_lock lock( decode_service->mtx );
+	decode_service->budget_bytes = num_bytes;
+	decode_service_pump( decode_service );
+}
+
+// ----------------------------------------------------------------------
+
+LE_MODULE_REGISTER_IMPL( le_pixels, api ) {
+	auto& le_pixels_i = static_cast<le_pixels_api*>( api )->le_pixels_i;
+
+	le_pixels_i.create             = le_pixels_create_from_file;
+	le_pixels_i.create_from_memory = le_pixels_create_from_memory;
+
+	le_pixels_i.get_info_from_memory = le_pixels_get_info_from_memory;
+	le_pixels_i.get_info_from_file   = le_pixels_get_info_from_file;
+
+	le_pixels_i.destroy  = le_pixels_destroy;
+	le_pixels_i.get_data = le_pixels_get_data;
+	le_pixels_i.get_info = le_pixels_get_info;
+
+	le_pixels_i.get_level_data                = le_pixels_get_level_data;
+	le_pixels_i.create_mip_chain              = le_pixels_create_mip_chain;
+	le_pixels_i.set_mip_chain_cache_directory = le_pixels_set_mip_chain_cache_directory;
+
+	le_pixels_i.decode_async             = le_pixels_decode_async;
+	le_pixels_i.decode_async_from_memory = le_pixels_decode_async_from_memory;
+	le_pixels_i.decode_async_mip_chain   = le_pixels_decode_async_mip_chain;
+	le_pixels_i.decode_poll              = le_pixels_decode_poll;
+	le_pixels_i.decode_claim             = le_pixels_decode_claim;
+	le_pixels_i.decode_destroy           = le_pixels_decode_destroy;
+	le_pixels_i.set_decode_budget        = le_pixels_set_decode_budget;
+
+	auto decode_service_addr = le_core_produce_dictionary_entry( hash_64_fnv1a_const( "le_pixels_decode_service" ) );
+
+	if ( *decode_service_addr == nullptr ) {
+		*decode_service_addr = new le_pixels_decode_service_o();
+	}
+
+	decode_service = static_cast<le_pixels_decode_service_o*>( *decode_service_addr );
+
+	auto mip_chain_cache_addr = le_core_produce_dictionary_entry( hash_64_fnv1a_const( "le_pixels_mip_chain_cache" ) );
+
+	if ( *mip_chain_cache_addr == nullptr ) {
+		*mip_chain_cache_addr = new le_pixels_mip_chain_cache_o();
+	}
+
+	mip_chain_cache = static_cast<le_pixels_mip_chain_cache_o*>( *mip_chain_cache_addr );
 }
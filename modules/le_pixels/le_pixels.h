@@ -4,6 +4,7 @@
 #include "le_core.h"
 
 struct le_pixels_o;
+struct le_pixels_decode_o; // an asynchronous decode - pending, or complete
 
 struct le_pixels_info {
 	// Note that we store the log2 of the number of Bytes needed to store values of a type
@@ -13,13 +14,43 @@ struct le_pixels_info {
 		eUInt16  = ( 1 << 2 ) | 1,
 		eFloat32 = ( 2 << 2 ) | 2, // 32 bit float type
 	};
-	uint32_t width;        //
-	uint32_t height;       //
-	uint32_t depth;        // 1 by default
-	uint32_t bpp;          // bits per pixel
-	uint32_t num_channels; // number of channels
-	uint32_t byte_count;   // total number of bytes
-	Type     type;
+	// Block-compressed formats store 4x4 texel blocks - pixel data for these is always of type eUInt8.
+	enum BlockFormat : uint32_t {
+		eUncompressed = 0,
+		eBC1,              // rgb, 1 bit alpha - 8 bytes per block
+		eBC3,              // rgba  - 16 bytes per block
+		eBC4,              // r     - 8 bytes per block
+		eBC5,              // rg    - 16 bytes per block
+		eBC7,              // rgba  - 16 bytes per block
+	};
+	uint32_t    width;        // of mip level 0
+	uint32_t    height;       // of mip level 0
+	uint32_t    depth;        // 1 by default
+	uint32_t    bpp;          // bits per pixel
+	uint32_t    num_channels; // number of channels
+	uint32_t    byte_count;   // number of bytes for mip level 0, of array layer 0
+	Type        type;         //
+	uint32_t    mip_levels;   // 1 by default
+	uint32_t    array_layers; // 1 by default
+	BlockFormat block_format; // eUncompressed by default
+	uint32_t    vk_format;    // VkFormat of pixels loaded from a KTX2, or DDS container - 0 (undefined) otherwise
+};
+
+struct le_pixels_level_info {
+	uint32_t width;      // in texels
+	uint32_t height;     // in texels
+	uint32_t byte_count; // number of bytes for this mip level, of one array layer
+};
+
+struct le_pixels_mip_chain_settings {
+	enum Filter : uint32_t {
+		eBox = 0, // averages 2x2 texels - fast
+		eKaiser,  // kaiser-windowed sinc - sharper, but slower
+	};
+	Filter                      filter;       //
+	le_pixels_info::BlockFormat block_format; // eUncompressed keeps source pixel type - anything else requires eUInt8 source pixels
+	uint32_t                    max_levels;   // 0 means full mip chain, down to 1x1
+	bool                        is_srgb;      // if true, 8 bit colour channels are filtered in linear space - alpha is always linear
 };
 
 // clang-format off
@@ -30,12 +61,41 @@ struct le_pixels_api {
 		bool (* get_info_from_memory ) ( unsigned char const * buffer, size_t buffer_byte_count, le_pixels_info * info);
 		bool (* get_info_from_file   ) ( char const * file_name, le_pixels_info * info);
 
+		// KTX2, and DDS container files are not decoded: their levels, and array layers are used as they are
+		// stored - in which case num_channels_requested, and type are ignored. Container files are memory-mapped.
 		le_pixels_o *    ( * create_from_memory )( unsigned char const * buffer, size_t buffer_byte_count, int num_channels_requested, le_pixels_info::Type type);
 		le_pixels_o *    ( * create   ) ( char const * file_path, int num_channels_requested, le_pixels_info::Type type);
 		void             ( * destroy  ) ( le_pixels_o* self );
 
 		le_pixels_info   ( * get_info ) ( le_pixels_o* self );
-		void *           ( * get_data ) ( le_pixels_o* self );
+		void *           ( * get_data ) ( le_pixels_o* self ); // data for mip level 0, of array layer 0
+
+		// Returns nullptr if there is no such level.
+		void const *     ( * get_level_data ) ( le_pixels_o* self, uint32_t mip_level, uint32_t array_layer, le_pixels_level_info* level_info );
+
+		// Creates new pixels with a full mip chain, which is optionally block-compressed - so that all levels may
+		// be uploaded as they are. Runs on le_jobs if LE_MT is enabled. Results are cached in the mip chain cache
+		// directory, if one is set, keyed by a hash of source pixels, and settings. Returns nullptr upon failure.
+		le_pixels_o *    ( * create_mip_chain ) ( le_pixels_o* source, le_pixels_mip_chain_settings const * settings );
+		void             ( * set_mip_chain_cache_directory ) ( char const * directory_path ); // nullptr disables the cache
+
+		// Asynchronous decoding: decodes start in the order in which they were requested - but only
+		// while the decoded size of all started, unclaimed decodes fits within the decode budget.
+		// Decodes run on le_jobs if LE_MT is enabled. For decodes from memory, the buffer must stay
+		// alive until the decode has been claimed, or destroyed.
+
+		le_pixels_decode_o * ( * decode_async             ) ( char const * file_path, int num_channels_requested, le_pixels_info::Type type);
+		le_pixels_decode_o * ( * decode_async_from_memory ) ( unsigned char const * buffer, size_t buffer_byte_count, int num_channels_requested, le_pixels_info::Type type);
+
+		// Decodes, and then creates a mip chain as part of the same decode. Cached mip chains are keyed by a
+		// hash of the file's contents, so that a cache hit skips decoding, too.
+		le_pixels_decode_o * ( * decode_async_mip_chain   ) ( char const * file_path, int num_channels_requested, le_pixels_info::Type type, le_pixels_mip_chain_settings const * settings );
+
+		bool                 ( * decode_poll              ) ( le_pixels_decode_o* decode ); // true once decode is complete - whether successful or not
+		le_pixels_o *        ( * decode_claim             ) ( le_pixels_decode_o* decode ); // waits for decode, then destroys it. returns pixels, owned by caller - or nullptr if decode failed
+		void                 ( * decode_destroy           ) ( le_pixels_decode_o* decode ); // discards decode - waits for it if it has already started
+
+		void                 ( * set_decode_budget        ) ( uint64_t num_bytes ); // 0 means unlimited. default: 256 MiB
 	};
 
 	le_pixels_interface_t       le_pixels_i;
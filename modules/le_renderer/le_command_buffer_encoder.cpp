@@ -90,6 +90,12 @@ struct le_command_buffer_encoder_o {
 	le_staging_allocator_o*                 stagingAllocator   = nullptr; // Borrowed from backend - used for larger, permanent resources, shared amongst encoders
 	le::Extent2D                            extent             = {};      // Renderpass extent, otherwise swapchain extent inferred via renderer, this may be queried by users of encoder.
 	std::vector<le_shader_binding_table_o*> shader_binding_tables;        // owning
+
+	// We keep track of the most recently encoded buffer bindings, so that we can skip
+	// encoding bindings which would not change state. These point into the command
+	// stream, which is fine, because commands don't move until the stream gets reset.
+	le::CommandBindIndexBuffer const*   last_index_buffer_cmd   = nullptr; // non-owning
+	le::CommandBindVertexBuffers const* last_vertex_buffers_cmd = nullptr; // non-owning
 };
 
 // ----------------------------------------------------------------------
@@ -174,6 +180,13 @@ static void cbe_draw( le_command_buffer_encoder_o* self,
                       uint32_t                     firstVertex,
                       uint32_t                     firstInstance ) {
 
+	if ( instanceCount == 1 && firstInstance == 0 ) {
+		// Most draws are not instanced - we can use the compact encoding.
+		auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawCompact>(); // placement new!
+		cmd->info = { vertexCount, firstVertex };
+		return;
+	}
+
 	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDraw>(); // placement new!
 	cmd->info = { vertexCount, instanceCount, firstVertex, firstInstance };
 }
@@ -187,6 +200,13 @@ static void cbe_draw_indexed( le_command_buffer_encoder_o* self,
                               int32_t                      vertexOffset,
                               uint32_t                     firstInstance ) {
 
+	if ( instanceCount == 1 && vertexOffset == 0 && firstInstance == 0 ) {
+		// Most draws are not instanced - we can use the compact encoding.
+		auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawIndexedCompact>();
+		cmd->info = { indexCount, firstIndex };
+		return;
+	}
+
 	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawIndexed>();
 	cmd->info = {
 	    indexCount,
@@ -206,6 +226,157 @@ static void cbe_draw_mesh_tasks( le_command_buffer_encoder_o* self,
 	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawMeshTasks>(); // placement new!
 	cmd->info = { taskCount, firstTask };
 }
+
+// ----------------------------------------------------------------------
+
+static void cbe_draw_indirect( le_command_buffer_encoder_o* self,
+                               le_buf_resource_handle const buffer,
+                               uint64_t                     offset,
+                               uint32_t                     drawCount,
+                               uint32_t                     stride ) {
+
+	if ( drawCount == 0 ) {
+		return;
+	}
+
+	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawIndirect>(); // placement new!
+	cmd->info = { buffer, offset, drawCount, stride };
+}
+
+// ----------------------------------------------------------------------
+
+static void cbe_draw_indexed_indirect( le_command_buffer_encoder_o* self,
+                                       le_buf_resource_handle const buffer,
+                                       uint64_t                     offset,
+                                       uint32_t                     drawCount,
+                                       uint32_t                     stride ) {
+
+	if ( drawCount == 0 ) {
+		return;
+	}
+
+	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawIndexedIndirect>(); // placement new!
+	cmd->info = { buffer, offset, drawCount, stride };
+}
+
+// ----------------------------------------------------------------------
+
+static void cbe_draw_indexed_indirect_count( le_command_buffer_encoder_o* self,
+                                             le_buf_resource_handle const buffer,
+                                             uint64_t                     offset,
+                                             le_buf_resource_handle const countBuffer,
+                                             uint64_t                     countBufferOffset,
+                                             uint32_t                     maxDrawCount,
+                                             uint32_t                     stride ) {
+
+	if ( maxDrawCount == 0 ) {
+		return;
+	}
+
+	// drawIndirectCount is an optional device feature, which must be requested via backend settings.
+	static bool const has_draw_count = []() {
+		bool draw_count = false;
+		le_backend_vk::settings_i.get_indirect_draw_features( nullptr, &draw_count );
+		return draw_count;
+	}();
+
+	if ( !has_draw_count ) {
+		std::cerr << "ERROR " << __PRETTY_FUNCTION__ << " drawIndirectCount device feature not enabled - "
+		          << "enable it via backend settings set_indirect_draw_features. Draw ignored." << std::endl
+		          << std::flush;
+		return;
+	}
+
+	auto cmd  = self->mCommandStream->emplace_cmd<le::CommandDrawIndexedIndirectCount>(); // placement new!
+	cmd->info = { buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride };
+}
+
+// ----------------------------------------------------------------------
+// Copies draw parameters into transient memory, and returns the location of the copy
+// via `buffer`, and `offset`. Returns false if memory could not be allocated.
+static bool cbe_upload_draw_parameters( le_command_buffer_encoder_o* self,
+                                        void const*                  data,
+                                        uint64_t                     numBytes,
+                                        le_buf_resource_handle*      buffer,
+                                        uint64_t*                    offset ) {
+
+	using namespace le_backend_vk; // for le_allocator_linear_i
+
+	void*           memAddr   = nullptr;
+	le_allocator_o* allocator = fetch_allocator( self->ppAllocator );
+
+	if ( !le_allocator_linear_i.allocate( allocator, numBytes, &memAddr, offset, buffer ) ) {
+		std::cerr << "ERROR " << __PRETTY_FUNCTION__ << " could not allocate " << numBytes << " Bytes." << std::endl
+		          << std::flush;
+		return false;
+	}
+
+	memcpy( memAddr, data, numBytes );
+	return true;
+}
+
+// ----------------------------------------------------------------------
+// Returns true if the multiDrawIndirect, and drawIndirectFirstInstance device features were requested.
+static bool cbe_has_indirect_multi_draw() {
+	static bool const has_multi_draw = []() {
+		bool multi_draw = false;
+		le_backend_vk::settings_i.get_indirect_draw_features( &multi_draw, nullptr );
+		return multi_draw;
+	}();
+	return has_multi_draw;
+}
+
+// ----------------------------------------------------------------------
+
+static void cbe_set_draw_indirect_data( le_command_buffer_encoder_o*   self,
+                                        le::DrawIndirectCommand const* draws,
+                                        uint32_t                       drawCount ) {
+
+	if ( draws == nullptr || drawCount == 0 ) {
+		return;
+	}
+
+	if ( !cbe_has_indirect_multi_draw() ) {
+		// Draws may use firstInstance, which indirect draws can't without drawIndirectFirstInstance - we
+		// have draw parameters on the cpu, so we can issue direct draws instead.
+		for ( auto d = draws; d != draws + drawCount; d++ ) {
+			cbe_draw( self, d->vertexCount, d->instanceCount, d->firstVertex, d->firstInstance );
+		}
+		return;
+	}
+
+	le_buf_resource_handle buffer;
+	uint64_t               offset = 0;
+
+	if ( cbe_upload_draw_parameters( self, draws, sizeof( le::DrawIndirectCommand ) * drawCount, &buffer, &offset ) ) {
+		cbe_draw_indirect( self, buffer, offset, drawCount, sizeof( le::DrawIndirectCommand ) );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void cbe_set_draw_indexed_indirect_data( le_command_buffer_encoder_o*          self,
+                                                le::DrawIndexedIndirectCommand const* draws,
+                                                uint32_t                              drawCount ) {
+
+	if ( draws == nullptr || drawCount == 0 ) {
+		return;
+	}
+
+	if ( !cbe_has_indirect_multi_draw() ) {
+		for ( auto d = draws; d != draws + drawCount; d++ ) {
+			cbe_draw_indexed( self, d->indexCount, d->instanceCount, d->firstIndex, d->vertexOffset, d->firstInstance );
+		}
+		return;
+	}
+
+	le_buf_resource_handle buffer;
+	uint64_t               offset = 0;
+
+	if ( cbe_upload_draw_parameters( self, draws, sizeof( le::DrawIndexedIndirectCommand ) * drawCount, &buffer, &offset ) ) {
+		cbe_draw_indexed_indirect( self, buffer, offset, drawCount, sizeof( le::DrawIndexedIndirectCommand ) );
+	}
+}
 // ----------------------------------------------------------------------
 
 static void cbe_set_viewport( le_command_buffer_encoder_o* self,
@@ -285,7 +456,27 @@ static void cbe_bind_vertex_buffers( le_command_buffer_encoder_o*  self,
 	size_t data_offsets_size = ( sizeof( uint64_t ) ) * bindingCount;
 
 	size_t data_size = data_buffers_size + data_offsets_size;
-	auto   cmd       = self->mCommandStream->emplace_cmd<le::CommandBindVertexBuffers>( data_size ); // placement new!
+
+	if ( auto prev = self->last_vertex_buffers_cmd;
+	     prev &&
+	     prev->info.firstBinding == firstBinding &&
+	     prev->info.bindingCount == bindingCount ) {
+
+		// If the previous binding command bound the same buffers at the same
+		// offsets, binding them again would not change state, and we can skip it.
+
+		auto prevBuffers = ( le_buf_resource_handle const* )( prev + 1 );
+		auto prevOffsets = ( uint64_t const* )( prevBuffers + bindingCount );
+
+		if ( 0 == memcmp( prevBuffers, pBuffers, data_buffers_size ) &&
+		     0 == memcmp( prevOffsets, pOffsets, data_offsets_size ) ) {
+			return;
+		}
+	}
+
+	auto cmd = self->mCommandStream->emplace_cmd<le::CommandBindVertexBuffers>( data_size ); // placement new!
+
+	self->last_vertex_buffers_cmd = cmd;
 
 	le_buf_resource_handle* dataBuffers = ( le_buf_resource_handle* )( cmd + 1 );
 	uint64_t*               dataOffsets = ( uint64_t* )( dataBuffers + bindingCount ); // start address for offset data
@@ -304,10 +495,21 @@ static void cbe_bind_index_buffer( le_command_buffer_encoder_o* self,
                                    uint64_t                     offset,
                                    le::IndexType const&         indexType ) {
 
+	if ( auto prev = self->last_index_buffer_cmd;
+	     prev &&
+	     prev->info.buffer == buffer &&
+	     prev->info.offset == offset &&
+	     prev->info.indexType == indexType ) {
+		// Index buffer is already bound - no need to bind it again.
+		return;
+	}
+
 	auto cmd = self->mCommandStream->emplace_cmd<le::CommandBindIndexBuffer>();
 
 	// Note: indexType==0 means uint16, indexType==1 means uint32
 	cmd->info = { buffer, offset, indexType, 0 };
+
+	self->last_index_buffer_cmd = cmd;
 }
 
 // ----------------------------------------------------------------------
@@ -873,14 +1075,8 @@ void cbe_build_rtx_tlas( le_command_buffer_encoder_o*      self,
 
 // ----------------------------------------------------------------------
 
-static void cbe_get_encoded_data( le_command_buffer_encoder_o* self,
-                                  void**                       data,
-                                  size_t*                      numBytes,
-                                  size_t*                      numCommands ) {
-
-	*data        = self->mCommandStream->data;
-	*numBytes    = self->mCommandStream->size;
-	*numCommands = self->mCommandStream->cmd_count;
+static le_command_stream_t const* cbe_get_command_stream( le_command_buffer_encoder_o* self ) {
+	return self->mCommandStream;
 }
 
 // ----------------------------------------------------------------------
@@ -889,6 +1085,21 @@ static le_pipeline_manager_o* cbe_get_pipeline_manager( le_command_buffer_encode
 	return self->pipelineManager;
 }
 
+// ----------------------------------------------------------------------
+// Returns the index under which a texture can be found in the bindless texture array.
+// Indices are stable for as long as the pipeline manager lives.
+static uint32_t cbe_get_bindless_texture_index( le_command_buffer_encoder_o* self, le_texture_handle const textureId ) {
+	using namespace le_backend_vk;
+	return le_pipeline_manager_i.produce_bindless_texture_index( self->pipelineManager, textureId );
+}
+
+// ----------------------------------------------------------------------
+
+static uint32_t cbe_get_bindless_buffer_index( le_command_buffer_encoder_o* self, le_buf_resource_handle const bufferId ) {
+	using namespace le_backend_vk;
+	return le_pipeline_manager_i.produce_bindless_buffer_index( self->pipelineManager, bufferId );
+}
+
 // ----------------------------------------------------------------------
 
 le_shader_binding_table_o* cbe_build_shader_binding_table( le_command_buffer_encoder_o* self, le_rtxpso_handle pipeline ) {
@@ -948,41 +1159,50 @@ void register_le_command_buffer_encoder_api( void* api_ ) {
 	    .create               = cbe_create,
 	    .destroy              = cbe_destroy,
 	    .get_pipeline_manager = cbe_get_pipeline_manager,
-	    .get_encoded_data     = cbe_get_encoded_data,
+	    .get_command_stream   = cbe_get_command_stream,
 	};
 
 	cbe_graphics_i = {
-	    .get_pipeline_manager   = cbe_get_pipeline_manager,
-	    .set_push_constant_data = cbe_set_push_constant_data,
-	    .bind_argument_buffer   = cbe_bind_argument_buffer,
-	    .buffer_memory_barrier  = cbe_buffer_memory_barrier,
-	    .set_argument_data      = cbe_set_argument_data,
-	    .set_argument_texture   = cbe_set_argument_texture,
-	    .set_argument_image     = cbe_set_argument_image,
-	    .draw                   = cbe_draw,
-	    .draw_indexed           = cbe_draw_indexed,
-	    .draw_mesh_tasks        = cbe_draw_mesh_tasks,
-	    .bind_graphics_pipeline = cbe_bind_graphics_pipeline,
-	    .set_line_width         = cbe_set_line_width,
-	    .set_viewport           = cbe_set_viewport,
-	    .set_scissor            = cbe_set_scissor,
-	    .bind_index_buffer      = cbe_bind_index_buffer,
-	    .bind_vertex_buffers    = cbe_bind_vertex_buffers,
-	    .set_index_data         = cbe_set_index_data,
-	    .set_vertex_data        = cbe_set_vertex_data,
-	    .get_extent             = cbe_get_extent,
+	    .get_pipeline_manager           = cbe_get_pipeline_manager,
+	    .set_push_constant_data         = cbe_set_push_constant_data,
+	    .bind_argument_buffer           = cbe_bind_argument_buffer,
+	    .buffer_memory_barrier          = cbe_buffer_memory_barrier,
+	    .set_argument_data              = cbe_set_argument_data,
+	    .set_argument_texture           = cbe_set_argument_texture,
+	    .set_argument_image             = cbe_set_argument_image,
+	    .get_bindless_texture_index     = cbe_get_bindless_texture_index,
+	    .get_bindless_buffer_index      = cbe_get_bindless_buffer_index,
+	    .draw                           = cbe_draw,
+	    .draw_indexed                   = cbe_draw_indexed,
+	    .draw_mesh_tasks                = cbe_draw_mesh_tasks,
+	    .draw_indirect                  = cbe_draw_indirect,
+	    .draw_indexed_indirect          = cbe_draw_indexed_indirect,
+	    .draw_indexed_indirect_count    = cbe_draw_indexed_indirect_count,
+	    .set_draw_indirect_data         = cbe_set_draw_indirect_data,
+	    .set_draw_indexed_indirect_data = cbe_set_draw_indexed_indirect_data,
+	    .bind_graphics_pipeline         = cbe_bind_graphics_pipeline,
+	    .set_line_width                 = cbe_set_line_width,
+	    .set_viewport                   = cbe_set_viewport,
+	    .set_scissor                    = cbe_set_scissor,
+	    .bind_index_buffer              = cbe_bind_index_buffer,
+	    .bind_vertex_buffers            = cbe_bind_vertex_buffers,
+	    .set_index_data                 = cbe_set_index_data,
+	    .set_vertex_data                = cbe_set_vertex_data,
+	    .get_extent                     = cbe_get_extent,
 	};
 
 	cbe_compute_i = {
-	    .get_pipeline_manager   = cbe_get_pipeline_manager,
-	    .bind_compute_pipeline  = cbe_bind_compute_pipeline,
-	    .set_push_constant_data = cbe_set_push_constant_data,
-	    .bind_argument_buffer   = cbe_bind_argument_buffer,
-	    .set_argument_data      = cbe_set_argument_data,
-	    .set_argument_texture   = cbe_set_argument_texture,
-	    .set_argument_image     = cbe_set_argument_image,
-	    .dispatch               = cbe_dispatch,
-	    .buffer_memory_barrier  = cbe_buffer_memory_barrier,
+	    .get_pipeline_manager       = cbe_get_pipeline_manager,
+	    .bind_compute_pipeline      = cbe_bind_compute_pipeline,
+	    .set_push_constant_data     = cbe_set_push_constant_data,
+	    .bind_argument_buffer       = cbe_bind_argument_buffer,
+	    .set_argument_data          = cbe_set_argument_data,
+	    .set_argument_texture       = cbe_set_argument_texture,
+	    .set_argument_image         = cbe_set_argument_image,
+	    .get_bindless_texture_index = cbe_get_bindless_texture_index,
+	    .get_bindless_buffer_index  = cbe_get_bindless_buffer_index,
+	    .dispatch                   = cbe_dispatch,
+	    .buffer_memory_barrier      = cbe_buffer_memory_barrier,
 	};
 
 	cbe_transfer_i = {
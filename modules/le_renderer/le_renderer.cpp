@@ -57,9 +57,19 @@ struct FrameData {
 
 	le_rendergraph_o* rendergraph = nullptr;
 
-	size_t frameNumber = size_t( ~0 );
+	size_t frameNumber        = size_t( ~0 );
+	size_t timingsFrameNumber = size_t( ~0 ); // frame number for which backend holds gpu pass timings for this frame
+
+	le_renderer_frame_timings_t cpuTimings;          // cpu time per update stage for frame `frameNumber`, gathered while the frame is in flight
+	le_renderer_frame_timings_t completedCpuTimings; // cpu time per update stage for frame `timingsFrameNumber`
 };
 
+// ----------------------------------------------------------------------
+
+static inline uint64_t nanoseconds_since( NanoTime const& start ) {
+	return uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::high_resolution_clock::now() - start ).count() );
+}
+
 struct le_texture_handle_t {
 	std::string debug_name;
 };
@@ -137,6 +147,12 @@ static le_resource_handle_store_t* get_resource_handle_library( bool erase = fal
 
 // ----------------------------------------------------------------------
 
+// Parameters for frame jobs which may still be running after renderer_update() returns.
+struct frame_job_params_t {
+	le_renderer_o* renderer;
+	size_t         frame_index;
+};
+
 struct le_renderer_o {
 	// uint64_t      swapchainDirty = false;
 	le_backend_o* backend        = nullptr; // Owned, created in setup
@@ -145,10 +161,23 @@ struct le_renderer_o {
 	size_t                 backendDataFramesCount = 0;
 	size_t                 currentFrameNumber = size_t( ~0 ); // ever increasing number of current frame
 	le_renderer_settings_t settings;
+
+	le_jobs::counter_t* frame_jobs_counter = nullptr; // counter for process/dispatch and clear jobs in flight, joined at the start of the next update
+	frame_job_params_t  frame_jobs_params[ 2 ]{};     // parameters for process/dispatch and clear jobs - must outlive the jobs
 };
 
 static void renderer_clear_frame( le_renderer_o* self, size_t frameIndex ); // ffdecl
 
+// ----------------------------------------------------------------------
+// Waits for process/dispatch and clear jobs which were started by the previous
+// call to update(). Must be called before accessing frame data from the main thread.
+static void renderer_join_frame_jobs( le_renderer_o* self ) {
+	if ( self->frame_jobs_counter ) {
+		le_jobs::wait_for_counter_and_free( self->frame_jobs_counter, 0 );
+		self->frame_jobs_counter = nullptr;
+	}
+}
+
 // ----------------------------------------------------------------------
 
 static le_renderer_o* renderer_create() {
@@ -291,6 +320,8 @@ static void renderer_destroy( le_renderer_o* self ) {
 
 	using namespace le_renderer; // for rendergraph_i
 
+	renderer_join_frame_jobs( self );
+
 	const auto& lastIndex = self->currentFrameNumber;
 
 	for ( size_t i = 0; i != self->frames.size(); ++i ) {
@@ -352,6 +383,67 @@ static le_backend_o* renderer_get_backend( le_renderer_o* self ) {
 	return self->backend;
 }
 
+// ----------------------------------------------------------------------
+// Fetch gpu timings per renderpass for a frame which has completed on the gpu.
+// Timings for a frame become available once the frame has been cleared, which
+// is typically one to two updates after it was recorded.
+// Returns false if timings for `frame_number` are not (or no longer) available.
+static bool renderer_get_pass_timings( le_renderer_o* self, size_t frame_number, le_pass_timing_t* timings, uint32_t* count ) {
+	using namespace le_backend_vk;
+
+	renderer_join_frame_jobs( self );
+
+	for ( size_t i = 0; i != self->frames.size(); i++ ) {
+		if ( self->frames[ i ].timingsFrameNumber == frame_number ) {
+			return vk_backend_i.get_pass_timings( self->backend, i, timings, count );
+		}
+	}
+
+	*count = 0;
+	return false;
+}
+
+// ----------------------------------------------------------------------
+// Fetch pipeline barrier counts for a frame which has been processed by the backend.
+// Returns false if `frame_number` has not yet been processed, or if its
+// frame slot has since been re-used.
+static bool renderer_get_barrier_stats( le_renderer_o* self, size_t frame_number, le_barrier_stats_t* stats ) {
+	using namespace le_backend_vk;
+
+	renderer_join_frame_jobs( self );
+
+	for ( size_t i = 0; i != self->frames.size(); i++ ) {
+		auto const& frame = self->frames[ i ];
+		if ( frame.frameNumber == frame_number &&
+		     ( frame.state == FrameData::State::eProcessed ||
+		       frame.state == FrameData::State::eDispatched ||
+		       frame.state == FrameData::State::eCleared ) ) {
+			vk_backend_i.get_barrier_stats( self->backend, i, stats );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ----------------------------------------------------------------------
+// Fetch cpu time spent on each update stage of a frame which has completed.
+// Like gpu pass timings, these become available once the frame has been cleared.
+// Returns false if timings for `frame_number` are not (or no longer) available.
+static bool renderer_get_frame_timings( le_renderer_o* self, size_t frame_number, le_renderer_frame_timings_t* timings ) {
+
+	renderer_join_frame_jobs( self );
+
+	for ( auto const& frame : self->frames ) {
+		if ( frame.timingsFrameNumber == frame_number ) {
+			*timings = frame.completedCpuTimings;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 // ----------------------------------------------------------------------
 
 static le_pipeline_manager_o* renderer_get_pipeline_manager( le_renderer_o* self ) {
@@ -411,6 +503,35 @@ static void renderer_setup( le_renderer_o* self, le_renderer_settings_t const* s
 			}
 		}
 
+		// An explicit request for the number of frames in flight overrides
+		// whatever number of data frames was inferred from swapchains.
+		//
+		// Every frame in flight holds on to an acquired swapchain image, which
+		// is why we must not ask for more data frames than the smallest swapchain
+		// can provide images.
+		if ( self->settings.frames_in_flight_hint != 0 ) {
+			using namespace le_backend_vk;
+			uint32_t frames_count = std::max<uint32_t>( 2, self->settings.frames_in_flight_hint );
+
+			size_t num_swapchains = 0;
+			vk_backend_i.get_swapchains( self->backend, &num_swapchains, nullptr );
+			std::vector<le_swapchain_handle> swapchains( num_swapchains );
+			if ( num_swapchains && vk_backend_i.get_swapchains( self->backend, &num_swapchains, swapchains.data() ) ) {
+				uint32_t min_image_count = ~uint32_t( 0 );
+				for ( auto const& swapchain : swapchains ) {
+					min_image_count = std::min( min_image_count, vk_backend_i.get_swapchain_image_count( self->backend, swapchain ) );
+				}
+				if ( frames_count > min_image_count ) {
+					static auto logger = LeLog( "le_renderer" );
+					logger.warn( "Frames in flight hint (%u) exceeds swapchain image count (%u) - clamping.",
+					             self->settings.frames_in_flight_hint, min_image_count );
+					frames_count = std::max<uint32_t>( 2, min_image_count );
+				}
+			}
+
+			settings_i.set_data_frames_count( frames_count );
+		}
+
 #if ( LE_MT > 0 )
 		le_backend_vk::settings_i.set_concurrency_count( LE_MT );
 #endif
@@ -420,6 +541,32 @@ static void renderer_setup( le_renderer_o* self, le_renderer_settings_t const* s
 
 	self->backendDataFramesCount = le_backend_vk::vk_backend_i.get_data_frames_count( self->backend );
 
+	{
+		// Record, process/dispatch, and clear must each operate on a distinct frame,
+		// otherwise stages race each other once they run as concurrent jobs.
+		//
+		// With only two data frames this is not possible: process/dispatch then
+		// shares the frame being recorded, and is serialised after recording.
+		size_t const num_frames     = self->backendDataFramesCount;
+		size_t const clear_index    = self->settings.clear_frame_offset % num_frames;
+		size_t const dispatch_index = self->settings.dispatch_frame_offset % num_frames;
+
+		bool offsets_valid = ( num_frames >= 3 )
+		                         ? ( dispatch_index != 0 && clear_index != 0 && clear_index != dispatch_index )
+		                         : ( dispatch_index == 0 && clear_index == 1 );
+
+		if ( !offsets_valid ) {
+			uint32_t const fallback_dispatch_offset = num_frames >= 3 ? 2 : 0;
+			uint32_t const fallback_clear_offset    = 1;
+			static auto    logger                   = LeLog( "le_renderer" );
+			logger.warn( "Invalid frame offsets (dispatch: %u, clear: %u) for %zu frames in flight - falling back to (dispatch: %u, clear: %u).",
+			             self->settings.dispatch_frame_offset, self->settings.clear_frame_offset, num_frames,
+			             fallback_dispatch_offset, fallback_clear_offset );
+			self->settings.dispatch_frame_offset = fallback_dispatch_offset;
+			self->settings.clear_frame_offset    = fallback_clear_offset;
+		}
+	}
+
 	using namespace le_renderer; // for rendergraph_i
 	self->frames.reserve( self->backendDataFramesCount );
 
@@ -459,6 +606,8 @@ static void renderer_clear_frame( le_renderer_o* self, size_t frameIndex ) {
 	     frame.state == FrameData::State::eFailedDispatch ||
 	     frame.state == FrameData::State::eFailedClear ) {
 
+		NanoTime fence_wait_start = std::chrono::high_resolution_clock::now();
+
 		while ( false == vk_backend_i.poll_frame_fence( self->backend, frameIndex ) ) {
 			// Note: this call may block until the fence has been reached.
 #if ( LE_MT > 0 )
@@ -466,12 +615,22 @@ static void renderer_clear_frame( le_renderer_o* self, size_t frameIndex ) {
 #endif
 		}
 
+		frame.cpuTimings.fence_wait_ns = nanoseconds_since( fence_wait_start );
+
+		NanoTime clear_start = std::chrono::high_resolution_clock::now();
+
 		bool result = vk_backend_i.clear_frame( self->backend, frameIndex );
 
 		if ( result != true ) {
 			frame.state = FrameData::State::eFailedClear;
 			return;
 		}
+
+		frame.cpuTimings.clear_ns = nanoseconds_since( clear_start );
+
+		// Clearing the backend frame harvests gpu timings for the frame that just completed.
+		frame.timingsFrameNumber  = frame.frameNumber;
+		frame.completedCpuTimings = frame.cpuTimings;
 	}
 
 	rendergraph_i.reset( frame.rendergraph );
@@ -502,6 +661,8 @@ static void renderer_record_frame( le_renderer_o* self, size_t frameIndex, le_re
 
 	// ---------| invariant: Frame was previously acquired successfully.
 
+	NanoTime record_start = std::chrono::high_resolution_clock::now();
+	frame.cpuTimings      = {};
 
 	// - build up dependencies for graph, create table of unique resources for graph
 
@@ -523,6 +684,8 @@ static void renderer_record_frame( le_renderer_o* self, size_t frameIndex, le_re
 	//
 	le_renderer::api->le_rendergraph_private_i.execute( frame.rendergraph, frameIndex, self->backend );
 
+	frame.cpuTimings.record_ns = nanoseconds_since( record_start );
+
 	frame.state = FrameData::State::eRecorded;
 }
 
@@ -545,6 +708,8 @@ static const FrameData::State& renderer_acquire_backend_resources( le_renderer_o
 
 	// ----------| invariant: frame is either initial, or cleared.
 
+	NanoTime acquire_start = std::chrono::high_resolution_clock::now();
+
 	le_renderpass_o** passes          = frame.rendergraph->passes.data();
 	size_t            numRenderPasses = frame.rendergraph->passes.size();
 
@@ -561,6 +726,14 @@ static const FrameData::State& renderer_acquire_backend_resources( le_renderer_o
 	        declared_resources_infos,
 	        declared_resources_count );
 
+	if ( !frame.rendergraph->released_resources_id.empty() ) {
+		vk_backend_i.release_physical_resources(
+		    self->backend,
+		    frameIndex,
+		    frame.rendergraph->released_resources_id.data(),
+		    frame.rendergraph->released_resources_id.size() );
+	}
+
 	{
 		// apply root node affinity masks to backend render frame
 		// so that the frame can decide how best to dispatch
@@ -574,6 +747,8 @@ static const FrameData::State& renderer_acquire_backend_resources( le_renderer_o
 	}
 
 
+	frame.cpuTimings.acquire_ns = nanoseconds_since( acquire_start );
+
 	frame.state = FrameData::State::eAcquired;
 
 	return frame.state;
@@ -593,9 +768,13 @@ static const FrameData::State& renderer_process_frame( le_renderer_o* self, size
 	}
 	// ---------| invariant: frame was previously recorded successfully
 
+	NanoTime process_start = std::chrono::high_resolution_clock::now();
+
 	// translate intermediate draw lists into vk command buffers, and sync primitives
 	vk_backend_i.process_frame( self->backend, frameIndex );
 
+	frame.cpuTimings.process_ns = nanoseconds_since( process_start );
+
 	frame.state = FrameData::State::eProcessed;
 	return frame.state;
 }
@@ -614,8 +793,12 @@ static void renderer_dispatch_frame( le_renderer_o* self, size_t frameIndex ) {
 
 	// ---------| invariant: frame was successfully processed previously
 
+	NanoTime dispatch_start = std::chrono::high_resolution_clock::now();
+
 	vk_backend_i.dispatch_frame( self->backend, frameIndex );
 
+	frame.cpuTimings.dispatch_ns = nanoseconds_since( dispatch_start );
+
 	frame.state = FrameData::State::eDispatched;
 }
 
@@ -649,6 +832,7 @@ static le_swapchain_handle renderer_add_swapchain( le_renderer_o* self, le_swapc
 	ZoneScoped;
 	using namespace le_backend_vk;
 	assert( self->backend && "Backend must exist" );
+	renderer_join_frame_jobs( self );
 	return vk_backend_i.add_swapchain( self->backend, settings );
 };
 // ----------------------------------------------------------------------
@@ -657,6 +841,7 @@ static bool renderer_remove_swapchain( le_renderer_o* self, le_swapchain_handle
 	ZoneScoped;
 	using namespace le_backend_vk;
 	assert( self->backend && "Backend must exist" );
+	renderer_join_frame_jobs( self );
 	return vk_backend_i.remove_swapchain( self->backend, swapchain );
 };
 
@@ -677,12 +862,23 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 	const auto& index     = self->currentFrameNumber;
 	const auto& numFrames = self->frames.size();
 
+	// Frame indices for each stage - by default we record into frame `index+0`,
+	// process and dispatch frame `index+2`, and clear frame `index+1`.
+	const size_t record_frame_index   = ( index + 0 ) % numFrames;
+	const size_t dispatch_frame_index = ( index + self->settings.dispatch_frame_offset ) % numFrames;
+	const size_t clear_frame_index    = ( index + self->settings.clear_frame_offset ) % numFrames;
+
 	// If necessary, recompile and reload shader modules
 	// - this must be complete before the record_frame step
 
 	if ( LE_MT > 0 ) {
 		// use task system (experimental)
 
+		// Process/dispatch and clear jobs from the previous update may still be in
+		// flight - we must wait for them, as the frame we are about to record was
+		// cleared by the previous update.
+		renderer_join_frame_jobs( self );
+
 		le_jobs::counter_t* shader_counter;
 
 		le_jobs::job_t j{
@@ -693,11 +889,6 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 
 		le_jobs::run_jobs( &j, 1, &shader_counter );
 
-		struct frame_params_t {
-			le_renderer_o* renderer;
-			size_t         frame_index;
-		};
-
 		struct record_params_t {
 			le_renderer_o*      renderer;
 			size_t              frame_index;
@@ -715,7 +906,7 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 		};
 
 		auto process_frame_fun = []( void* param_ ) {
-			auto p = static_cast<frame_params_t*>( param_ );
+			auto p = static_cast<frame_job_params_t*>( param_ );
 			// acquire external backend resources such as swapchain
 			// and create any temporary resources
 			renderer_acquire_backend_resources( p->renderer, p->frame_index );
@@ -726,40 +917,48 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 		};
 
 		auto clear_frame_fun = []( void* param_ ) {
-			auto p = static_cast<frame_params_t*>( param_ );
+			auto p = static_cast<frame_job_params_t*>( param_ );
 			renderer_clear_frame( p->renderer, p->frame_index );
 		};
 
-		le_jobs::job_t jobs[ 3 ];
-
 		record_params_t record_frame_params;
 		record_frame_params.renderer             = self;
-		record_frame_params.frame_index          = ( index + 0 ) % numFrames;
+		record_frame_params.frame_index          = record_frame_index;
 		record_frame_params.rendergraph          = graph_;
 		record_frame_params.current_frame_number = self->currentFrameNumber;
 		record_frame_params.shader_counter       = shader_counter;
 
-		frame_params_t process_frame_params;
-		process_frame_params.renderer    = self;
-		process_frame_params.frame_index = ( index + 2 ) % numFrames;
+		// Parameters for process and clear jobs are stored with the renderer,
+		// as these jobs may still be running once this method returns.
+		self->frame_jobs_params[ 0 ] = { self, dispatch_frame_index };
+		self->frame_jobs_params[ 1 ] = { self, clear_frame_index };
 
-		frame_params_t clear_frame_params;
-		clear_frame_params.renderer    = self;
-		clear_frame_params.frame_index = ( index + 1 ) % numFrames;
+		le_jobs::job_t frame_jobs[ 2 ];
+		frame_jobs[ 0 ] = { process_frame_fun, &self->frame_jobs_params[ 0 ] };
+		frame_jobs[ 1 ] = { clear_frame_fun, &self->frame_jobs_params[ 1 ] };
 
-		jobs[ 0 ] = { process_frame_fun, &process_frame_params };
-		jobs[ 1 ] = { clear_frame_fun, &clear_frame_params };
-		jobs[ 2 ] = { record_frame_fun, &record_frame_params };
-
-		le_jobs::counter_t* counter;
+		le_jobs::job_t record_job = { record_frame_fun, &record_frame_params };
 
 		assert( self->backend );
 
-		le_jobs::run_jobs( jobs, 3, &counter );
+		le_jobs::counter_t* record_counter;
+
+		if ( dispatch_frame_index == record_frame_index ) {
+			// With only two frames in flight, process/dispatch operates on the frame
+			// which we are recording - it may only start once recording is complete.
+			le_jobs::run_jobs( &record_job, 1, &record_counter );
+			le_jobs::wait_for_counter_and_free( record_counter, 0 );
+			le_jobs::run_jobs( frame_jobs, 2, &self->frame_jobs_counter );
+		} else {
+			le_jobs::run_jobs( frame_jobs, 2, &self->frame_jobs_counter );
+			le_jobs::run_jobs( &record_job, 1, &record_counter );
 
-		// we could theoretically do some more work on the main thread here...
+			// We only wait for the record job, as it is the only job which calls back
+			// into user code, and which accesses the rendergraph owned by the caller.
+			// Process/dispatch and clear jobs get joined at the start of the next update.
 
-		le_jobs::wait_for_counter_and_free( counter, 0 );
+			le_jobs::wait_for_counter_and_free( record_counter, 0 );
+		}
 
 	} else {
 
@@ -768,28 +967,25 @@ static void renderer_update( le_renderer_o* self, le_rendergraph_o* graph_ ) {
 
 		{
 			// RECORD FRAME
-			auto frameIndex = ( index + 0 ) % numFrames;
-			// logger.info( "+++ [%5d] RECO", frameIndex );
-			renderer_record_frame( self, frameIndex, graph_, self->currentFrameNumber ); // generate an intermediary, api-agnostic, representation of the frame
+			// logger.info( "+++ [%5d] RECO", record_frame_index );
+			renderer_record_frame( self, record_frame_index, graph_, self->currentFrameNumber ); // generate an intermediary, api-agnostic, representation of the frame
 		}
 
 		{
 			// DISPATCH FRAME
 			// acquire external backend resources such as swapchain
 			// and create any temporary resources
-			auto frameIndex = ( index + 2 ) % numFrames;
-			// logger.info( "+++ [%5d] DISP", frameIndex );
-			renderer_acquire_backend_resources( self, frameIndex ); //
-			renderer_process_frame( self, frameIndex );             // generate api commands for the frame
-			renderer_dispatch_frame( self, frameIndex );            //
+			// logger.info( "+++ [%5d] DISP", dispatch_frame_index );
+			renderer_acquire_backend_resources( self, dispatch_frame_index ); //
+			renderer_process_frame( self, dispatch_frame_index );             // generate api commands for the frame
+			renderer_dispatch_frame( self, dispatch_frame_index );            //
 		}
 
 		{
 			// CLEAR FRAME
 			// wait for frame to come back (important to do this last, as it may block...)
-			auto frameIndex = ( index + 1 ) % numFrames;
-			// logger.info( "+++ [%5d] CLEA", frameIndex );
-			renderer_clear_frame( self, frameIndex );
+			// logger.info( "+++ [%5d] CLEA", clear_frame_index );
+			renderer_clear_frame( self, clear_frame_index );
 		}
 	}
 
@@ -854,6 +1050,9 @@ LE_MODULE_REGISTER_IMPL( le_renderer, api ) {
 	le_renderer_i.get_swapchain_extent           = renderer_get_swapchain_extent;
 	le_renderer_i.get_pipeline_manager           = renderer_get_pipeline_manager;
 	le_renderer_i.get_backend                    = renderer_get_backend;
+	le_renderer_i.get_pass_timings               = renderer_get_pass_timings;
+	le_renderer_i.get_barrier_stats              = renderer_get_barrier_stats;
+	le_renderer_i.get_frame_timings              = renderer_get_frame_timings;
 	le_renderer_i.get_swapchain_resource         = renderer_get_swapchain_resource;
 	le_renderer_i.get_swapchain_resource_default = renderer_get_swapchain_resource_default;
 	le_renderer_i.add_swapchain                  = renderer_add_swapchain;
@@ -17,6 +17,8 @@ struct le_command_stream_t; // ffdecl
 
 struct le_allocator_o;         // from backend
 struct le_staging_allocator_o; // from backend
+struct le_pass_timing_t;       // from backend
+struct le_barrier_stats_t;     // from backend
 
 LE_OPAQUE_HANDLE( le_shader_module_handle );
 LE_OPAQUE_HANDLE( le_swapchain_handle );
@@ -43,6 +45,14 @@ struct le_renderer_api {
 
 		le_backend_o*                  ( *get_backend             )( le_renderer_o* self );
 
+		// Gpu timings per renderpass for a completed frame - see le_pass_timing_t in le_backend_vk.h
+		// If `timings` is nullptr, `*count` is set to the number of available timings.
+		bool                           ( *get_pass_timings        )( le_renderer_o* self, size_t frame_number, le_pass_timing_t* timings, uint32_t* count );
+		// Pipeline barrier counts for a processed frame - see le_barrier_stats_t in le_backend_vk.h
+		bool                           ( *get_barrier_stats       )( le_renderer_o* self, size_t frame_number, le_barrier_stats_t* stats );
+		// Cpu time per update stage for a completed frame - available for as long as gpu pass timings are.
+		bool                           ( *get_frame_timings       )( le_renderer_o* self, size_t frame_number, le_renderer_frame_timings_t* timings );
+
 	
 		// note: this method must be called before setup()
 
@@ -122,6 +132,7 @@ struct le_renderer_api {
 		void                 ( *reset            ) ( le_rendergraph_o *self );
 		void                 ( *add_renderpass   ) ( le_rendergraph_o *self, le_renderpass_o *rp );
 		void                 ( *declare_resource ) ( le_rendergraph_o *self, le_resource_handle const & resource_id, le_resource_info_t const & info);
+		void                 ( *release_resource ) ( le_rendergraph_o *self, le_resource_handle const & resource_id ); // frees resource's memory once no frames in flight use it - unless it is used by passes of this rendergraph
 	};
 
 	struct rendergraph_private_interface_t {
@@ -142,7 +153,7 @@ struct le_renderer_api {
 		void                         ( *destroy                )( le_command_buffer_encoder_o *obj );
 
 		le_pipeline_manager_o*		 ( *get_pipeline_manager   )( le_command_buffer_encoder_o *self);
-		void                         ( *get_encoded_data       )( le_command_buffer_encoder_o *self, void **data, size_t *numBytes, size_t *numCommands );
+		le_command_stream_t const*   ( *get_command_stream     )( le_command_buffer_encoder_o *self );
 	};
 
 	struct command_buffer_graphics_encoder_interface_t{
@@ -155,9 +166,29 @@ struct le_renderer_api {
 		void                         ( *set_argument_texture   )( le_command_buffer_encoder_o *self, le_texture_handle const textureId, uint64_t argumentName, uint64_t arrayIndex);
 		void                         ( *set_argument_image     )( le_command_buffer_encoder_o *self, le_img_resource_handle const imageId, uint64_t argumentName, uint64_t arrayIndex);
 
+		// Bindless mode: return index of texture/buffer in the bindless descriptor arrays, or LE_BINDLESS_INDEX_INVALID
+		// if bindless mode is not enabled. Texture/buffer must be used by the current renderpass.
+		uint32_t                     ( *get_bindless_texture_index )( le_command_buffer_encoder_o *self, le_texture_handle const textureId );
+		uint32_t                     ( *get_bindless_buffer_index  )( le_command_buffer_encoder_o *self, le_buf_resource_handle const bufferId );
+
 		void                         ( *draw                   )( le_command_buffer_encoder_o *self, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance );
 		void                         ( *draw_indexed           )( le_command_buffer_encoder_o *self, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
 		void                         ( *draw_mesh_tasks        )( le_command_buffer_encoder_o *self, uint32_t taskCount, uint32_t fistTask);
+
+		// Indirect draws: draw parameters are read on the gpu from `buffer`, which must have been created with
+		// BufferUsageFlagBits::eIndirectBuffer, and which must be used by the renderpass with AccessFlagBits2::eIndirectCommandRead.
+		// If draw parameters are written on the gpu, issue a buffer_memory_barrier before the draw.
+		// Multi-draws (drawCount > 1), and non-zero firstInstance need the multi_draw indirect draw feature, and
+		// draw_indexed_indirect_count needs the draw_count feature - see backend settings set_indirect_draw_features.
+		void                         ( *draw_indirect               )( le_command_buffer_encoder_o *self, le_buf_resource_handle const buffer, uint64_t offset, uint32_t drawCount, uint32_t stride );
+		void                         ( *draw_indexed_indirect       )( le_command_buffer_encoder_o *self, le_buf_resource_handle const buffer, uint64_t offset, uint32_t drawCount, uint32_t stride );
+		void                         ( *draw_indexed_indirect_count )( le_command_buffer_encoder_o *self, le_buf_resource_handle const buffer, uint64_t offset, le_buf_resource_handle const countBuffer, uint64_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride );
+
+		// Upload draw parameters to transient memory, then issue a single indirect draw which covers all `drawCount` draws.
+		// Without the multi_draw indirect draw feature, these issue direct draws instead.
+		void                         ( *set_draw_indirect_data         )( le_command_buffer_encoder_o *self, le::DrawIndirectCommand const* draws, uint32_t drawCount );
+		void                         ( *set_draw_indexed_indirect_data )( le_command_buffer_encoder_o *self, le::DrawIndexedIndirectCommand const* draws, uint32_t drawCount );
+
 		void                         ( *bind_graphics_pipeline )( le_command_buffer_encoder_o *self, le_gpso_handle pipelineHandle);
 		void                         ( *set_line_width         )( le_command_buffer_encoder_o *self, float line_width_ );
 		void                         ( *set_viewport           )( le_command_buffer_encoder_o *self, uint32_t firstViewport, const uint32_t viewportCount, const le::Viewport *pViewports );
@@ -179,6 +210,8 @@ struct le_renderer_api {
 		void                         ( *set_argument_data      )( le_command_buffer_encoder_o *self, uint64_t argumentNameId, void const * data, size_t numBytes);
 		void                         ( *set_argument_texture   )( le_command_buffer_encoder_o *self, le_texture_handle const textureId, uint64_t argumentName, uint64_t arrayIndex);
 		void                         ( *set_argument_image     )( le_command_buffer_encoder_o *self, le_img_resource_handle const imageId, uint64_t argumentName, uint64_t arrayIndex);
+		uint32_t                     ( *get_bindless_texture_index )( le_command_buffer_encoder_o *self, le_texture_handle const textureId );
+		uint32_t                     ( *get_bindless_buffer_index  )( le_command_buffer_encoder_o *self, le_buf_resource_handle const bufferId );
 		void                         ( *dispatch               )( le_command_buffer_encoder_o *self, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ );
 		void                         ( *buffer_memory_barrier  )( le_command_buffer_encoder_o *self, le::PipelineStageFlags2 const srcStageMask, le::PipelineStageFlags2 const dstStageMask, le::AccessFlags2 const  dstAccessMask, le_buf_resource_handle const buffer, uint64_t const  offset, uint64_t const  range );
 	 };
@@ -117,6 +117,25 @@ class RendererInfoBuilder {
 				return *this;
 			}
 
+			// Write images into a memory-mapped ring file instead of a pipe - use a path
+			// in /dev/shm to hand images to another process via shared memory.
+			ImgSwapchainInfoBuilder& setRingPath( char const* ring_path = "", uint32_t ring_slot_count = 8 ) {
+				parent.parent.swapchain_settings->img_settings.ring_path       = ring_path;
+				parent.parent.swapchain_settings->img_settings.ring_slot_count = ring_slot_count;
+				return *this;
+			}
+
+			ImgSwapchainInfoBuilder& setReadbackQueueDepth( uint32_t readback_queue_depth = 2 ) {
+				parent.parent.swapchain_settings->img_settings.readback_queue_depth = readback_queue_depth;
+				return *this;
+			}
+
+			// Read back images, but don't write them anywhere - neither pipe, nor ring, nor file.
+			ImgSwapchainInfoBuilder& setNullOutput( bool discard_output = true ) {
+				parent.parent.swapchain_settings->img_settings.discard_output = discard_output ? 1 : 0;
+				return *this;
+			}
+
 			SwapchainInfoBuilder& end() {
 				parent.parent.swapchain_settings->type = le_swapchain_settings_t::Type::LE_IMG_SWAPCHAIN;
 				return parent;
@@ -155,6 +174,10 @@ class RendererInfoBuilder {
 		return mSwapchainInfoBuilder;
 	}
 
+	BUILDER_IMPLEMENT( RendererInfoBuilder, setFramesInFlight, uint32_t, frames_in_flight_hint, = 0 )
+	BUILDER_IMPLEMENT( RendererInfoBuilder, setDispatchFrameOffset, uint32_t, dispatch_frame_offset, = 2 )
+	BUILDER_IMPLEMENT( RendererInfoBuilder, setClearFrameOffset, uint32_t, clear_frame_offset, = 1 )
+
 	/// If you want to add a swapchain later, you must have declared one of its type
 	/// to the renderer. This will not automatically create the swapchain on renderer setup,
 	/// but it will create the renderer and the backend with the necessary extensions
@@ -369,6 +392,21 @@ class Renderer {
 		return le_renderer::renderer_i.get_pipeline_manager( self );
 	}
 
+	/// Copies gpu timings per renderpass for a frame that has completed on the gpu - see `le_pass_timing_t`.
+	bool getPassTimings( size_t frame_number, le_pass_timing_t* timings, uint32_t* count ) const {
+		return le_renderer::renderer_i.get_pass_timings( self, frame_number, timings, count );
+	}
+
+	/// Copies pipeline barrier counts for a frame that has been processed - see `le_barrier_stats_t`.
+	bool getBarrierStats( size_t frame_number, le_barrier_stats_t* stats ) const {
+		return le_renderer::renderer_i.get_barrier_stats( self, frame_number, stats );
+	}
+
+	/// Copies cpu time per update stage for a frame that has completed - see `le_renderer_frame_timings_t`.
+	bool getFrameTimings( size_t frame_number, le_renderer_frame_timings_t* timings ) const {
+		return le_renderer::renderer_i.get_frame_timings( self, frame_number, timings );
+	}
+
 	static le_texture_handle produceTextureHandle( char const* maybe_name ) {
 		return le_renderer::renderer_i.produce_texture_handle( maybe_name );
 	}
@@ -563,6 +601,11 @@ class RenderGraph {
 		le_renderer::rendergraph_i.declare_resource( self, resource_id, info );
 		return *this;
 	}
+
+	RenderGraph& releaseResource( le_resource_handle const& resource_id ) {
+		le_renderer::rendergraph_i.release_resource( self, resource_id );
+		return *this;
+	}
 };
 
 // ----------------------------------------------------------------------
@@ -719,6 +762,14 @@ class GraphicsEncoder {
 		return *this;
 	}
 
+	uint32_t getBindlessTextureIndex( le_texture_handle const& textureId ) {
+		return le_renderer::encoder_graphics_i.get_bindless_texture_index( self, textureId );
+	}
+
+	uint32_t getBindlessBufferIndex( le_buf_resource_handle const& bufferId ) {
+		return le_renderer::encoder_graphics_i.get_bindless_buffer_index( self, bufferId );
+	}
+
 	GraphicsEncoder& draw( const uint32_t& vertexCount, const uint32_t& instanceCount = 1, const uint32_t& firstVertex = 0, const uint32_t& firstInstance = 0 ) {
 		le_renderer::encoder_graphics_i.draw( self, vertexCount, instanceCount, firstVertex, firstInstance );
 		return *this;
@@ -734,6 +785,31 @@ class GraphicsEncoder {
 		return *this;
 	}
 
+	GraphicsEncoder& drawIndirect( le_buf_resource_handle const& buffer, uint64_t const& offset = 0, uint32_t const& drawCount = 1, uint32_t const& stride = sizeof( le::DrawIndirectCommand ) ) {
+		le_renderer::encoder_graphics_i.draw_indirect( self, buffer, offset, drawCount, stride );
+		return *this;
+	}
+
+	GraphicsEncoder& drawIndexedIndirect( le_buf_resource_handle const& buffer, uint64_t const& offset = 0, uint32_t const& drawCount = 1, uint32_t const& stride = sizeof( le::DrawIndexedIndirectCommand ) ) {
+		le_renderer::encoder_graphics_i.draw_indexed_indirect( self, buffer, offset, drawCount, stride );
+		return *this;
+	}
+
+	GraphicsEncoder& drawIndexedIndirectCount( le_buf_resource_handle const& buffer, uint64_t const& offset, le_buf_resource_handle const& countBuffer, uint64_t const& countBufferOffset, uint32_t const& maxDrawCount, uint32_t const& stride = sizeof( le::DrawIndexedIndirectCommand ) ) {
+		le_renderer::encoder_graphics_i.draw_indexed_indirect_count( self, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride );
+		return *this;
+	}
+
+	GraphicsEncoder& drawIndirect( le::DrawIndirectCommand const* draws, uint32_t const& drawCount ) {
+		le_renderer::encoder_graphics_i.set_draw_indirect_data( self, draws, drawCount );
+		return *this;
+	}
+
+	GraphicsEncoder& drawIndexedIndirect( le::DrawIndexedIndirectCommand const* draws, uint32_t const& drawCount ) {
+		le_renderer::encoder_graphics_i.set_draw_indexed_indirect_data( self, draws, drawCount );
+		return *this;
+	}
+
 	GraphicsEncoder& bindGraphicsPipeline( le_gpso_handle pipelineHandle ) {
 		le_renderer::encoder_graphics_i.bind_graphics_pipeline( self, pipelineHandle );
 		return *this;
@@ -843,6 +919,14 @@ class ComputeEncoder {
 		return *this;
 	}
 
+	uint32_t getBindlessTextureIndex( le_texture_handle const& textureId ) {
+		return le_renderer::encoder_compute_i.get_bindless_texture_index( self, textureId );
+	}
+
+	uint32_t getBindlessBufferIndex( le_buf_resource_handle const& bufferId ) {
+		return le_renderer::encoder_compute_i.get_bindless_buffer_index( self, bufferId );
+	}
+
 	ComputeEncoder& dispatch( const uint32_t& groupCountX = 1, const uint32_t& groupCountY = 1, const uint32_t& groupCountZ = 1 ) {
 		le_renderer::encoder_compute_i.dispatch( self, groupCountX, groupCountY, groupCountZ );
 		return *this;
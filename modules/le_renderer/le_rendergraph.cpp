@@ -373,6 +373,7 @@ static void rendergraph_reset( le_rendergraph_o* self ) {
 	self->root_passes_affinity_masks.clear();
 	self->declared_resources_id.clear();
 	self->declared_resources_info.clear();
+	self->released_resources_id.clear();
 }
 
 // ----------------------------------------------------------------------
@@ -1112,6 +1113,7 @@ static void rendergraph_setup_passes( le_rendergraph_o* src_rendergraph, le_rend
 	// Move any resource ids and resource infos from module into rendergraph
 	dst_rendergraph->declared_resources_id   = std::move( src_rendergraph->declared_resources_id );
 	dst_rendergraph->declared_resources_info = std::move( src_rendergraph->declared_resources_info );
+	dst_rendergraph->released_resources_id   = std::move( src_rendergraph->released_resources_id );
 
 	src_rendergraph->passes.clear();
 };
@@ -1125,6 +1127,12 @@ static void rendergraph_declare_resource( le_rendergraph_o* self, le_resource_ha
 
 // ----------------------------------------------------------------------
 
+static void rendergraph_release_resource( le_rendergraph_o* self, le_resource_handle const& resource_id ) {
+	self->released_resources_id.emplace_back( resource_id );
+}
+
+// ----------------------------------------------------------------------
+
 void register_le_rendergraph_api( void* api_ ) {
 
 	auto le_renderer_api_i = static_cast<le_renderer_api*>( api_ );
@@ -1135,6 +1143,7 @@ void register_le_rendergraph_api( void* api_ ) {
 	le_rendergraph_i.reset            = rendergraph_reset;
 	le_rendergraph_i.add_renderpass   = rendergraph_add_renderpass;
 	le_rendergraph_i.declare_resource = rendergraph_declare_resource;
+	le_rendergraph_i.release_resource = rendergraph_release_resource;
 
 	auto& le_rendergraph_private_i        = le_renderer_api_i->le_rendergraph_private_i;
 	le_rendergraph_private_i.setup_passes = rendergraph_setup_passes;
@@ -122,6 +122,23 @@ struct Viewport {
 	float maxDepth;
 };
 
+// Layout matches VkDrawIndirectCommand - one element of an indirect draw argument buffer.
+struct DrawIndirectCommand {
+	uint32_t vertexCount;
+	uint32_t instanceCount;
+	uint32_t firstVertex;
+	uint32_t firstInstance;
+};
+
+// Layout matches VkDrawIndexedIndirectCommand - one element of an indexed indirect draw argument buffer.
+struct DrawIndexedIndirectCommand {
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t  vertexOffset;
+	uint32_t firstInstance;
+};
+
 struct Rect2D {
 	uint32_t x;
 	uint32_t y;
@@ -243,7 +260,11 @@ struct le_swapchain_settings_t {
 		char const*                 display_name; // will be matched against display name
 	};
 	struct img_settings_t {
-		char const* pipe_cmd; // command used to save images - will receive stream of images via stdin
+		char const* pipe_cmd;             // command used to save images - will receive stream of images via stdin
+		char const* ring_path;            // if not empty, write images into a memory-mapped ring file at this path instead of into pipe_cmd
+		uint32_t    ring_slot_count;      // number of images which the ring file holds
+		uint32_t    readback_queue_depth; // number of extra readback buffers, so that images may queue up for writing without stalling rendering
+		uint32_t    discard_output;       // if non-zero, images are read back as usual, but never written out - useful for benchmarks
 	};
 
 	Type       type            = LE_KHR_SWAPCHAIN;
@@ -270,14 +291,31 @@ struct le_swapchain_settings_t {
 		this->khr_direct_mode_settings.vk_surface       = nullptr;
 	}
 	void init_img_settings() {
-		this->img_settings.pipe_cmd = "";
+		this->img_settings.pipe_cmd             = "";
+		this->img_settings.ring_path            = "";
+		this->img_settings.ring_slot_count      = 8;
+		this->img_settings.readback_queue_depth = 2;
+		this->img_settings.discard_output       = 0;
 	}
 };
 
 struct le_renderer_settings_t {
 	le_swapchain_settings_t swapchain_settings[ 16 ] = {};
 	size_t                  num_swapchain_settings   = 0;
-	// TODO: add a hint for number of swapchain frames
+	uint32_t                frames_in_flight_hint    = 0; // number of backend data frames; 0 means: infer from swapchain image count (2..3); clamped to swapchain image count
+	uint32_t                dispatch_frame_offset    = 2; // offset (modulo frames in flight) from the frame being recorded to the frame being processed and dispatched; must be non-zero for 3+ frames
+	uint32_t                clear_frame_offset       = 1; // offset (modulo frames in flight) from the frame being recorded to the frame being cleared; must differ from both other stages
+};
+
+// Cpu time spent by the renderer on each update stage of a single frame, in nanoseconds.
+// Stages may run on different threads if LE_MT is set; times are wall-clock per stage.
+struct le_renderer_frame_timings_t {
+	uint64_t record_ns     = 0; // setup and execute renderpasses: calls into user code, encodes command streams
+	uint64_t acquire_ns    = 0; // allocate physical resources for the frame
+	uint64_t process_ns    = 0; // translate command streams into vulkan command buffers
+	uint64_t dispatch_ns   = 0; // submit command buffers, present swapchain images
+	uint64_t fence_wait_ns = 0; // wait for the gpu to signal that the frame has completed
+	uint64_t clear_ns      = 0; // recycle frame resources once the frame has completed
 };
 
 // specifies parameters for an image write operation.
@@ -577,8 +615,20 @@ enum class CommandType : uint32_t {
 	eBindRtxPipeline,
 	eWriteToBuffer,
 	eWriteToImage,
-};
-
+	eDrawCompact,        // compact encoding for eDraw, used if instanceCount == 1, and firstInstance == 0
+	eDrawIndexedCompact, // compact encoding for eDrawIndexed, used if instanceCount == 1, vertexOffset == 0, and firstInstance == 0
+	eDrawIndirect,
+	eDrawIndexedIndirect,
+	eDrawIndexedIndirectCount,
+};
+
+// Note: We keep the header at 8 bytes. A smaller header would misalign the
+// 64-bit fields (handles, offsets) which most commands carry, and these
+// would then need unaligned loads when decoding. Per-command state is not
+// delta-encoded either; instead, the encoder skips buffer bindings which
+// would not change state - see `le_command_buffer_encoder.cpp`.
+// `apps/benchmarks/command_stream_benchmark` measures encode and decode
+// throughput for full and compact encodings.
 struct CommandHeader {
 	union {
 		struct {
@@ -611,6 +661,61 @@ struct CommandDraw {
 	} info;
 };
 
+// Compact version of CommandDraw: 16 instead of 24 bytes.
+struct CommandDrawCompact {
+	CommandHeader header = { { { CommandType::eDrawCompact, sizeof( CommandDrawCompact ) } } };
+	struct {
+		uint32_t vertexCount;
+		uint32_t firstVertex;
+	} info;
+};
+
+// Compact version of CommandDrawIndexed: 16 instead of 32 bytes.
+struct CommandDrawIndexedCompact {
+	CommandHeader header = { { { CommandType::eDrawIndexedCompact, sizeof( CommandDrawIndexedCompact ) } } };
+	struct {
+		uint32_t indexCount;
+		uint32_t firstIndex;
+	} info;
+};
+
+// Draw parameters are sourced from `buffer`, which must hold `drawCount` tightly
+// packed (or `stride` apart) le::DrawIndirectCommand elements, starting at `offset`.
+struct CommandDrawIndirect {
+	CommandHeader header = { { { CommandType::eDrawIndirect, sizeof( CommandDrawIndirect ) } } };
+	struct {
+		le_buf_resource_handle buffer; // buffer holding draw parameters
+		uint64_t               offset; // offset in bytes into buffer, must be a multiple of 4
+		uint32_t               drawCount;
+		uint32_t               stride; // byte stride between successive sets of draw parameters
+	} info;
+};
+
+// Same as CommandDrawIndirect, but `buffer` holds le::DrawIndexedIndirectCommand elements.
+struct CommandDrawIndexedIndirect {
+	CommandHeader header = { { { CommandType::eDrawIndexedIndirect, sizeof( CommandDrawIndexedIndirect ) } } };
+	struct {
+		le_buf_resource_handle buffer;
+		uint64_t               offset;
+		uint32_t               drawCount;
+		uint32_t               stride;
+	} info;
+};
+
+// Same as CommandDrawIndexedIndirect, but the number of draws is read on the gpu from
+// `count_buffer` at `count_buffer_offset`, and clamped to `maxDrawCount`.
+struct CommandDrawIndexedIndirectCount {
+	CommandHeader header = { { { CommandType::eDrawIndexedIndirectCount, sizeof( CommandDrawIndexedIndirectCount ) } } };
+	struct {
+		le_buf_resource_handle buffer;
+		uint64_t               offset;
+		le_buf_resource_handle count_buffer;        // buffer holding draw count as a uint32_t
+		uint64_t               count_buffer_offset; // must be a multiple of 4
+		uint32_t               maxDrawCount;
+		uint32_t               stride;
+	} info;
+};
+
 struct CommandDrawMeshTasks {
 	CommandHeader header = { { { CommandType::eDrawMeshTasks, sizeof( CommandDrawMeshTasks ) } } };
 	struct {
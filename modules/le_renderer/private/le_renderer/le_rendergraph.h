@@ -149,6 +149,7 @@ struct le_rendergraph_o : NoCopy, NoMove {
 	std::vector<le_renderpass_o*>    passes;                     //
 	std::vector<le_resource_handle>  declared_resources_id;      // | pre-declared resources (declared via module)
 	std::vector<le_resource_info_t>  declared_resources_info;    // | pre-declared resources (declared via module)
+	std::vector<le_resource_handle>  released_resources_id;      // resources which the backend may free, see release_resource
 	std::vector<le::RootPassesField> root_passes_affinity_masks; // vector of masks, one per distinct subgraph within the rendergraph,
 	                                                             // each mask represents a filter: passes whose root_passes_affinity
 	                                                             // match via OR are contributing to the distinct tree whose key it was tested against.
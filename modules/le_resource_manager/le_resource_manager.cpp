@@ -2,9 +2,11 @@
 #include "le_core.h"
 #include "le_renderer.hpp"
 #include "le_pixels.h"
+#include "le_log.h"
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <assert.h>
 
 #include "private/le_renderer/le_resource_handle_t.inl"
@@ -14,54 +16,203 @@
 struct le_resource_manager_o {
 
 	struct image_data_layer_t {
-		le_pixels_o* pixels;
-		std::string  path;
-		bool         was_uploaded = false;
+		le_pixels_decode_o* decode; // pending decode, nullptr once claimed
+		le_pixels_o*        pixels; // nullptr until decode was claimed, or if decode failed - released once uploaded
+		std::string         path;
+		bool                was_uploaded = false;
+
+		// How to decode this layer - we keep these so that we can decode the layer again after eviction.
+		uint32_t                     num_channels  = 0;
+		le_pixels_info::Type         pixels_type   = le_pixels_info::eUInt8;
+		bool                         has_mip_chain = false;
+		le_pixels_mip_chain_settings mip_chain_settings{};
 	};
 
 	struct resource_item_t {
 		le_img_resource_handle          image_handle;
 		le_resource_info_t              image_info;
-		std::vector<image_data_layer_t> image_layers; // must have at least one element
+		std::vector<image_data_layer_t> image_layers;        // must have at least one element
+		int32_t                         priority        = 0; // items with higher priority get uploaded first
+		uint64_t                        last_used_frame = 0; // frame in which item was last referenced via is_item_ready
+		uint64_t                        resident_bytes  = 0; // estimated device memory held by the item's image, 0 if not resident
+		bool                            is_evicted  = false; // image memory was released - layers are decoded again once item is referenced
+		bool                            is_declared = false; // image was declared to rendergraph this frame - we only upload to declared images
 	};
 
-	std::vector<resource_item_t> resources;
+	struct layer_upload_t {
+		uint32_t resource_idx; // index into resources
+		uint32_t layer;        // index into resource's image_layers
+		uint32_t num_bytes;    //
+	};
+
+	std::vector<resource_item_t>        resources;
+	std::vector<layer_upload_t>         frame_uploads;          // layers picked for upload this frame
+	std::vector<le_img_resource_handle> released_images;        // images of removed items, released to the backend with the next update
+	uint64_t                            upload_budget_bytes;    // max number of bytes to upload per frame, 0 means unlimited
+	uint64_t                            residency_budget_bytes; // max estimated device memory for all images, 0 means unlimited
+	uint32_t                            evict_after_frames;     // items must not have been referenced for this many frames before they may be evicted
+	uint64_t                            frame_counter = 0;      // incremented with each update
 };
 
-// TODO:
-// * add a method to remove resources from the manager
+static constexpr auto DEFAULT_UPLOAD_BUDGET_BYTES = uint64_t( 64 * 1024 * 1024 );
+static constexpr auto DEFAULT_EVICT_AFTER_FRAMES  = uint32_t( 120 );
 
 // ----------------------------------------------------------------------
-static bool setupTransferPass( le_renderpass_o* pRp, void* user_data ) {
-	le::RenderPass rp{ pRp };
-	auto           manager = static_cast<le_resource_manager_o const*>( user_data );
+// Starts decoding a layer, as described by the layer's decode settings.
+static void layer_start_decode( le_resource_manager_o::image_data_layer_t& layer ) {
 
-	if ( manager->resources.empty() ) {
-		return false;
+	using namespace le_pixels;
+
+	if ( layer.has_mip_chain ) {
+		layer.decode = le_pixels_i.decode_async_mip_chain( layer.path.c_str(), int( layer.num_channels ), layer.pixels_type, &layer.mip_chain_settings );
+	} else {
+		layer.decode = le_pixels_i.decode_async( layer.path.c_str(), int( layer.num_channels ), layer.pixels_type );
 	}
+}
 
-	// --------| invariant: some elements need upload
+// ----------------------------------------------------------------------
+// Discards a layer's pending decode, and its pixels.
+static void layer_release_pixels( le_resource_manager_o::image_data_layer_t& layer ) {
 
-	bool needsTransfer = false;
+	using namespace le_pixels;
 
-	for ( auto const& r : manager->resources ) {
+	if ( layer.decode ) {
+		le_pixels_i.decode_destroy( layer.decode );
+		layer.decode = nullptr;
+	}
+	if ( layer.pixels ) {
+		le_pixels_i.destroy( layer.pixels );
+		layer.pixels = nullptr;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Claims pixels for a layer once its decode is complete. Returns true if
+// the layer has pixels.
+static bool layer_claim_pixels( le_resource_manager_o::image_data_layer_t& layer ) {
+
+	using namespace le_pixels;
+
+	if ( layer.decode && le_pixels_i.decode_poll( layer.decode ) ) {
+		layer.pixels = le_pixels_i.decode_claim( layer.decode );
+		layer.decode = nullptr;
+
+		if ( layer.pixels == nullptr ) {
+			static auto logger = LeLog( "le_resource_manager" );
+			logger.error( "Could not decode image layer: '%s'", layer.path.c_str() );
+		}
+	}
 
-		bool uses_resource = false;
+	return layer.pixels != nullptr;
+}
+
+// ----------------------------------------------------------------------
+// Returns the number of bytes for all mip levels, of all array layers of pixels.
+static uint32_t pixels_get_num_bytes( le_pixels_o* pixels ) {
+
+	using namespace le_pixels;
+
+	auto const info      = le_pixels_i.get_info( pixels );
+	uint32_t   num_bytes = 0;
 
-		for ( auto const& layer : r.image_layers ) {
-			if ( layer.was_uploaded == false ) {
-				uses_resource = true;
+	for ( uint32_t array_layer = 0; array_layer != info.array_layers; array_layer++ ) {
+		for ( uint32_t mip_level = 0; mip_level != info.mip_levels; mip_level++ ) {
+			le_pixels_level_info level_info{};
+			le_pixels_i.get_level_data( pixels, mip_level, array_layer, &level_info );
+			num_bytes += level_info.byte_count;
+		}
+	}
+
+	return num_bytes;
+}
+
+// ----------------------------------------------------------------------
+// Picks image layers to upload this frame: layers of items with higher priority
+// go first, items of equal priority go in the order in which they were added.
+// We pick layers until the upload budget is spent - but we always pick at
+// least one layer, so that layers larger than the budget get uploaded eventually.
+// Layers which are still being decoded are skipped until their pixels are ready.
+//
+// Layers of an item are picked strictly in order: the backend transitions all array
+// layers from the written layer upwards out of an undefined layout when it writes to
+// an image, which would discard any layers above which had already been uploaded.
+// We therefore don't pick a layer while any layer below it is still being decoded.
+// Since sorting is stable, and the budget cuts off a prefix, picked layers of an
+// item keep their order, and are never separated by a layer left for later.
+static void select_uploads( le_resource_manager_o* manager ) {
+
+	using namespace le_pixels;
+
+	auto& uploads = manager->frame_uploads;
+	uploads.clear();
+
+	for ( uint32_t i = 0; i != manager->resources.size(); i++ ) {
+		auto& r = manager->resources[ i ];
+		if ( r.is_declared == false ) {
+			continue;
+		}
+		for ( uint32_t layer = 0; layer != r.image_layers.size(); layer++ ) {
+			auto& l = r.image_layers[ layer ];
+			if ( l.was_uploaded ) {
+				continue;
+			}
+			if ( layer_claim_pixels( l ) ) {
+				uploads.push_back( { i, layer, pixels_get_num_bytes( l.pixels ) } );
+			} else if ( l.decode ) {
+				// Layer is still being decoded - layers above it must wait.
 				break;
 			}
+			// Otherwise, decoding this layer failed - it never gets uploaded,
+			// and so it can't discard layers above it.
 		}
+	}
+
+	if ( uploads.empty() || manager->upload_budget_bytes == 0 ) {
+		return;
+	}
 
-		if ( uses_resource ) {
-			rp.useImageResource( r.image_handle, le::AccessFlagBits2::eTransferWrite );
-			needsTransfer = true;
+	std::stable_sort( uploads.begin(), uploads.end(), [ manager ]( le_resource_manager_o::layer_upload_t const& lhs, le_resource_manager_o::layer_upload_t const& rhs ) {
+		return manager->resources[ lhs.resource_idx ].priority > manager->resources[ rhs.resource_idx ].priority;
+	} );
+
+	uint64_t budget_used = 0;
+	size_t   num_picked  = 0;
+
+	for ( ; num_picked != uploads.size(); num_picked++ ) {
+		if ( num_picked != 0 && budget_used + uploads[ num_picked ].num_bytes > manager->upload_budget_bytes ) {
+			break;
 		}
+		budget_used += uploads[ num_picked ].num_bytes;
 	}
 
-	return needsTransfer;
+	uploads.resize( num_picked );
+}
+
+// ----------------------------------------------------------------------
+static bool setupTransferPass( le_renderpass_o* pRp, void* user_data ) {
+	le::RenderPass rp{ pRp };
+	auto           manager = static_cast<le_resource_manager_o*>( user_data );
+
+	select_uploads( manager );
+
+	if ( manager->frame_uploads.empty() ) {
+		return false;
+	}
+
+	// --------| invariant: some elements need upload
+
+	uint32_t previous_resource_idx = ~0u;
+
+	for ( auto const& u : manager->frame_uploads ) {
+		// Several layers of the same resource may be picked - but we
+		// only need to declare each resource once.
+		if ( u.resource_idx != previous_resource_idx ) {
+			rp.useImageResource( manager->resources[ u.resource_idx ].image_handle, le::AccessFlagBits2::eTransferWrite );
+			previous_resource_idx = u.resource_idx;
+		}
+	}
+
+	return true;
 }
 
 // ----------------------------------------------------------------------
@@ -76,50 +227,106 @@ static void execTransferPass( le_command_buffer_encoder_o* pEncoder, void* user_
 
 	using namespace le_pixels;
 
-	for ( auto& r : manager->resources ) {
+	for ( auto const& u : manager->frame_uploads ) {
+
+		auto& r = manager->resources[ u.resource_idx ];
 
-		uint32_t const num_layers     = uint32_t( r.image_layers.size() );
-		uint32_t const image_width    = r.image_info.image.extent.width;
-		uint32_t const image_height   = r.image_info.image.extent.height;
 		uint32_t const image_depth    = r.image_info.image.extent.depth;
 		uint32_t const num_mip_levels = r.image_info.image.mipLevels;
 
-		for ( uint32_t layer = 0; layer != num_layers; layer++ ) {
+		uint32_t const layer = u.layer;
 
-			// we can fill in the correct handling for mutliple mip levels later.
-			// for now, assert that there is exatcly one mip level.
-			if ( r.image_layers[ layer ].was_uploaded ) {
-				continue;
-			}
+		auto pixels = r.image_layers[ layer ].pixels;
+		auto info   = le_pixels_i.get_info( pixels );
+
+		// If pixels come with a mip chain, we upload each level as it is - otherwise
+		// we upload level 0, and let the backend generate the remaining levels by blitting.
+		//
+		// Pixels loaded from a container file may hold more than one array layer,
+		// these go to consecutive array layers of the image, starting at `layer`.
 
-			// --------| invariant: layer was not yet uploaded.
+		uint32_t const num_levels_to_upload = std::min( info.mip_levels, num_mip_levels );
 
-			for ( uint32_t mip_level = 0; mip_level != 1; mip_level++ ) {
+		for ( uint32_t array_layer = 0; array_layer != info.array_layers; array_layer++ ) {
+			for ( uint32_t mip_level = 0; mip_level != num_levels_to_upload; mip_level++ ) {
 
-				assert( mip_level == 0 && "mip level greater than 0 not implemented" );
-				uint32_t width  = image_width >> mip_level;
-				uint32_t height = image_height >> mip_level;
-				uint32_t depth  = image_depth;
+				le_pixels_level_info level_info{};
+				void const*          bytes = le_pixels_i.get_level_data( pixels, mip_level, array_layer, &level_info );
 
 				le_write_to_image_settings_t write_info =
 				    le::WriteToImageSettingsBuilder()
 				        .setDstMiplevel( mip_level )
-				        .setNumMiplevels( num_mip_levels )
-				        .setArrayLayer( layer ) // faces are indexed: +x, -x, +y, -y, +z, -z
-				        .setImageH( height )
-				        .setImageW( width )
-				        .setImageD( depth )
+				        .setNumMiplevels( info.mip_levels == 1 ? num_mip_levels : 1 )
+				        .setArrayLayer( layer + array_layer ) // faces are indexed: +x, -x, +y, -y, +z, -z
+				        .setImageH( level_info.height )
+				        .setImageW( level_info.width )
+				        .setImageD( image_depth )
 				        .build();
 
-				auto     pixels    = r.image_layers[ layer ].pixels;
-				auto     info      = le_pixels_i.get_info( pixels );
-				uint32_t num_bytes = info.byte_count; // TODO: make sure to get correct byte count for mip level, or compressed image.
-				void*    bytes     = le_pixels_i.get_data( pixels );
+				encoder.writeToImage( r.image_handle, write_info, bytes, level_info.byte_count );
+			}
+		}
+
+		// If the backend generates mip levels, these add about a third.
+		r.resident_bytes += ( info.mip_levels == 1 && num_mip_levels > 1 ) ? u.num_bytes * 4 / 3 : u.num_bytes;
+
+		// writeToImage has copied pixels into staging memory, we don't need to keep them.
+		r.image_layers[ layer ].was_uploaded = true;
+		le_pixels_i.destroy( pixels );
+		r.image_layers[ layer ].pixels = nullptr;
+	}
+
+	manager->frame_uploads.clear();
+}
+
+// ----------------------------------------------------------------------
+
+// Evicts least recently used items until the estimated device memory for all
+// images fits within the residency budget. Only items which have not been
+// referenced for at least `evict_after_frames` frames may be evicted.
+static void evict_items( le_resource_manager_o* manager ) {
+
+	if ( manager->residency_budget_bytes == 0 ) {
+		return;
+	}
+
+	uint64_t resident_bytes = 0;
+
+	for ( auto const& r : manager->resources ) {
+		resident_bytes += r.resident_bytes;
+	}
 
-				encoder.writeToImage( r.image_handle, write_info, bytes, num_bytes );
+	while ( resident_bytes > manager->residency_budget_bytes ) {
+
+		le_resource_manager_o::resource_item_t* lru_item = nullptr;
+
+		for ( auto& r : manager->resources ) {
+			if ( r.resident_bytes == 0 || manager->frame_counter - r.last_used_frame < manager->evict_after_frames ) {
+				continue;
 			}
-			r.image_layers[ layer ].was_uploaded = true;
+			if ( lru_item == nullptr || r.last_used_frame < lru_item->last_used_frame ) {
+				lru_item = &r;
+			}
+		}
+
+		if ( lru_item == nullptr ) {
+			// Everything which is resident has been used recently.
+			return;
+		}
+
+		// ----------| invariant: lru_item may be evicted
+
+		for ( auto& layer : lru_item->image_layers ) {
+			layer_release_pixels( layer );
+			layer.was_uploaded = false;
 		}
+
+		resident_bytes -= lru_item->resident_bytes;
+
+		lru_item->resident_bytes = 0;
+		lru_item->is_evicted     = true;
+
+		manager->released_images.push_back( lru_item->image_handle );
 	}
 }
 
@@ -130,10 +337,25 @@ static void le_resource_manager_update( le_resource_manager_o* manager, le_rende
 
 	// TODO: reload any images if you detect that their source on disk has changed.
 
+	manager->frame_counter++;
+
+	evict_items( manager );
+
 	for ( auto& r : manager->resources ) {
-		rendergraph_i.declare_resource( module, r.image_handle, r.image_info );
+		// Evicted items are not declared, so that their images don't get allocated again
+		// until they are referenced again.
+		r.is_declared = !r.is_evicted;
+		if ( r.is_declared ) {
+			rendergraph_i.declare_resource( module, r.image_handle, r.image_info );
+		}
+	}
+
+	for ( auto const& image_handle : manager->released_images ) {
+		rendergraph_i.release_resource( module, image_handle );
 	}
 
+	manager->released_images.clear();
+
 	auto renderPassTransfer =
 	    le::RenderPass( "xfer_le_resource_manager", le::QueueFlagBits::eTransfer )
 	        .setSetupCallback( manager, setupTransferPass )  // decide whether to go forward
@@ -145,7 +367,12 @@ static void le_resource_manager_update( le_resource_manager_o* manager, le_rende
 
 // ----------------------------------------------------------------------
 
-static void infer_from_le_format( le::Format const& format, uint32_t* num_channels, le_pixels_info::Type* pixels_type ) {
+// Block-compressed formats are always encoded from 8 bit rgba pixels.
+static void infer_from_le_format( le::Format const& format, uint32_t* num_channels, le_pixels_info::Type* pixels_type, le_pixels_info::BlockFormat* block_format, bool* is_srgb ) {
+
+	*block_format = le_pixels_info::eUncompressed;
+	*is_srgb      = false;
+
 	switch ( format ) {
 	case le::Format::eUndefined: // deliberate fall-through
 	case le::Format::eR8G8B8A8Unorm:
@@ -160,15 +387,37 @@ static void infer_from_le_format( le::Format const& format, uint32_t* num_channe
 		*num_channels = 4;
 		*pixels_type  = le_pixels_info::Type::eUInt16;
 		return;
+	case le::Format::eBc1RgbaSrgbBlock: *is_srgb = true; // deliberate fall-through
+	case le::Format::eBc1RgbaUnormBlock: *block_format = le_pixels_info::eBC1; break;
+	case le::Format::eBc3SrgbBlock: *is_srgb = true; // deliberate fall-through
+	case le::Format::eBc3UnormBlock: *block_format = le_pixels_info::eBC3; break;
+	case le::Format::eBc4UnormBlock: *block_format = le_pixels_info::eBC4; break;
+	case le::Format::eBc5UnormBlock: *block_format = le_pixels_info::eBC5; break;
+	case le::Format::eBc7SrgbBlock: *is_srgb = true; // deliberate fall-through
+	case le::Format::eBc7UnormBlock: *block_format = le_pixels_info::eBC7; break;
 	default:
 		assert( false && "Unhandled image format." );
+		return;
 	}
+
+	// ----------| invariant: format is block-compressed
+
+	*num_channels = 4;
+	*pixels_type  = le_pixels_info::Type::eUInt8;
 }
 
 // ----------------------------------------------------------------------
 // NOTE: You must provide an array of paths in image_paths, and the
 // array's size must match `image_info.image.arrayLayers`
 // Most meta-data about the image file is loaded via image_info
+// Image layers are decoded asynchronously, see le_pixels decode_async - we
+// only read image headers here, in case we must infer image extents.
+// Layers for block-compressed formats are encoded, together with their full
+// mip chain, on the CPU as part of decoding.
+// Layers may also be KTX2, or DDS container files, which are uploaded as they
+// are stored - these decide the image's mip levels, and - if the image's format
+// is undefined - its format. A single container file may hold all array layers
+// of an image, in which case only the first path is used.
 static void le_resource_manager_add_item( le_resource_manager_o*        self,
                                           le_img_resource_handle const* image_handle,
                                           le_resource_info_t const*     image_info,
@@ -176,10 +425,15 @@ static void le_resource_manager_add_item( le_resource_manager_o*        self,
 
 	le_resource_manager_o::resource_item_t item{};
 
-	item.image_handle = *image_handle;
-	item.image_info   = *image_info;
+	item.image_handle    = *image_handle;
+	item.image_info      = *image_info;
+	item.last_used_frame = self->frame_counter;
 	item.image_layers.reserve( image_info->image.arrayLayers );
 
+	le_pixels_info::BlockFormat block_format        = le_pixels_info::eUncompressed;
+	bool                        is_srgb             = false;
+	bool                        is_block_compressed = false;
+
 	bool extents_inferred = false;
 	if ( item.image_info.image.extent.width == 0 ||
 	     item.image_info.image.extent.height == 0 ||
@@ -187,30 +441,73 @@ static void le_resource_manager_add_item( le_resource_manager_o*        self,
 		extents_inferred = true;
 	}
 
-	for ( size_t i = 0; i != item.image_info.image.arrayLayers; ++i ) {
+	uint32_t num_paths = item.image_info.image.arrayLayers;
+
+	for ( uint32_t i = 0; i != num_paths; ++i ) {
 		le_resource_manager_o::image_data_layer_t layer_data{};
 		layer_data.path         = std::string{ image_paths[ i ] };
 		layer_data.was_uploaded = false;
+		layer_data.pixels       = nullptr;
 
-		// we must find out the pixels type from image info format
-		uint32_t             num_channels = 0;
-		le_pixels_info::Type pixels_type{};
-
-		infer_from_le_format( item.image_info.image.format, &num_channels, &pixels_type );
-
-		layer_data.pixels = le_pixels::le_pixels_i.create( layer_data.path.c_str(), num_channels, pixels_type );
+		le_pixels_info info{};
+		bool const     has_info = le_pixels::le_pixels_i.get_info_from_file( layer_data.path.c_str(), &info );
 
-		if ( extents_inferred ) {
-			auto info                           = le_pixels::le_pixels_i.get_info( layer_data.pixels );
+		if ( extents_inferred && has_info ) {
 			item.image_info.image.extent.depth  = std::max( item.image_info.image.extent.depth, info.depth );
 			item.image_info.image.extent.width  = std::max( item.image_info.image.extent.width, info.width );
 			item.image_info.image.extent.height = std::max( item.image_info.image.extent.height, info.height );
 		}
 
+		if ( has_info && info.vk_format != 0 ) {
+
+			// Container file: nothing to decode, or to convert - pixels are mapped, and uploaded as they are.
+
+			layer_start_decode( layer_data );
+
+			if ( item.image_info.image.format == le::Format::eUndefined ) {
+				item.image_info.image.format = le::Format( info.vk_format );
+			} else if ( item.image_info.image.format != le::Format( info.vk_format ) ) {
+				static auto logger = LeLog( "le_resource_manager" );
+				logger.warn( "Image format for '%s' does not match format stored in file.", layer_data.path.c_str() );
+			}
+
+			item.image_info.image.mipLevels = info.mip_levels;
+
+			if ( i == 0 && info.array_layers > 1 ) {
+				item.image_info.image.arrayLayers = info.array_layers;
+				num_paths                         = 1;
+			}
+
+			is_block_compressed |= ( info.block_format != le_pixels_info::eUncompressed );
+
+			item.image_layers.emplace_back( layer_data );
+			continue;
+		}
+
+		// we must find out the pixels type from image info format
+		infer_from_le_format( item.image_info.image.format, &layer_data.num_channels, &layer_data.pixels_type, &block_format, &is_srgb );
+
+		is_block_compressed |= ( block_format != le_pixels_info::eUncompressed );
+
+		if ( block_format != le_pixels_info::eUncompressed ) {
+			layer_data.has_mip_chain                   = true;
+			layer_data.mip_chain_settings.filter       = le_pixels_mip_chain_settings::eKaiser;
+			layer_data.mip_chain_settings.block_format = block_format;
+			layer_data.mip_chain_settings.max_levels   = item.image_info.image.mipLevels;
+			layer_data.mip_chain_settings.is_srgb      = is_srgb;
+		}
+
+		layer_start_decode( layer_data );
+
 		item.image_layers.emplace_back( layer_data );
 	}
 
-	item.image_info.image.usage = le::ImageUsageFlagBits::eTransferDst | le::ImageUsageFlagBits::eSampled | le::ImageUsageFlagBits::eStorage;
+	item.image_info.image.usage = le::ImageUsageFlagBits::eTransferDst | le::ImageUsageFlagBits::eSampled;
+
+	if ( !is_block_compressed ) {
+		// Block-compressed formats can't be used for storage images.
+		item.image_info.image.usage = item.image_info.image.usage | le::ImageUsageFlagBits::eStorage;
+	}
 
 	assert( item.image_info.image.extent.width != 0 &&
 	        item.image_info.image.extent.height != 0 &&
@@ -223,22 +520,112 @@ static void le_resource_manager_add_item( le_resource_manager_o*        self,
 // ----------------------------------------------------------------------
 
 static le_resource_manager_o* le_resource_manager_create() {
-	auto self = new le_resource_manager_o{};
+	auto self                    = new le_resource_manager_o{};
+	self->upload_budget_bytes    = DEFAULT_UPLOAD_BUDGET_BYTES;
+	self->residency_budget_bytes = 0;
+	self->evict_after_frames     = DEFAULT_EVICT_AFTER_FRAMES;
 	return self;
 }
 
 // ----------------------------------------------------------------------
+// Sets maximum number of bytes to upload per frame - 0 means to upload all
+// pending layers at once.
+static void le_resource_manager_set_upload_budget( le_resource_manager_o* self, uint64_t bytes_per_frame ) {
+	self->upload_budget_bytes = bytes_per_frame;
+}
 
-static void le_resource_manager_destroy( le_resource_manager_o* self ) {
+// ----------------------------------------------------------------------
+// Once the estimated device memory for all images exceeds `num_bytes`, items
+// which have not been referenced - via is_item_ready - for `evict_after_frames`
+// frames get evicted, least recently used first.
+static void le_resource_manager_set_residency_budget( le_resource_manager_o* self, uint64_t num_bytes, uint32_t evict_after_frames ) {
+	self->residency_budget_bytes = num_bytes;
+	self->evict_after_frames     = evict_after_frames;
+}
 
-	using namespace le_pixels;
+// ----------------------------------------------------------------------
+
+static le_resource_manager_o::resource_item_t* find_item( le_resource_manager_o* self, le_img_resource_handle const* image_handle ) {
+	for ( auto& r : self->resources ) {
+		if ( r.image_handle == *image_handle ) {
+			return &r;
+		}
+	}
+	return nullptr;
+}
+
+// ----------------------------------------------------------------------
+// Items with higher priority are uploaded first - set the priority of items
+// which are visible, or close to the camera, to a higher value.
+static void le_resource_manager_set_item_priority( le_resource_manager_o* self, le_img_resource_handle const* image_handle, int32_t priority ) {
+	auto item = find_item( self, image_handle );
+	if ( item ) {
+		item->priority = priority;
+	}
+}
+
+// ----------------------------------------------------------------------
+// Returns true once all layers of an item have been uploaded. Until then,
+// you should not sample from the item's image, but use a fallback instead.
+// Calling this marks the item as referenced - an evicted item gets decoded,
+// and uploaded again.
+static bool le_resource_manager_is_item_ready( le_resource_manager_o* self, le_img_resource_handle const* image_handle ) {
+	auto item = find_item( self, image_handle );
+
+	if ( item == nullptr ) {
+		return false;
+	}
+
+	item->last_used_frame = self->frame_counter;
+
+	if ( item->is_evicted ) {
+		item->is_evicted = false;
+		for ( auto& layer : item->image_layers ) {
+			layer_start_decode( layer );
+		}
+		return false;
+	}
+
+	for ( auto const& layer : item->image_layers ) {
+		if ( layer.was_uploaded == false ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+// Removes an item - its image is released to the backend with the next update.
+static void le_resource_manager_remove_item( le_resource_manager_o* self, le_img_resource_handle const* image_handle ) {
+
+	auto it = std::find_if( self->resources.begin(), self->resources.end(), [ image_handle ]( le_resource_manager_o::resource_item_t const& r ) {
+		return r.image_handle == *image_handle;
+	} );
+
+	if ( it == self->resources.end() ) {
+		return;
+	}
+
+	for ( auto& l : it->image_layers ) {
+		layer_release_pixels( l );
+	}
+
+	if ( !it->is_evicted ) {
+		self->released_images.push_back( it->image_handle );
+	}
+
+	self->resources.erase( it );
+}
+
+// ----------------------------------------------------------------------
+
+static void le_resource_manager_destroy( le_resource_manager_o* self ) {
 
 	for ( auto& r : self->resources ) {
 		for ( auto& l : r.image_layers ) {
-			if ( l.pixels ) {
-				le_pixels_i.destroy( l.pixels );
-				l.pixels = nullptr;
-			}
+			layer_release_pixels( l );
 		}
 	}
 	delete ( self );
@@ -253,4 +640,11 @@ LE_MODULE_REGISTER_IMPL( le_resource_manager, api ) {
 	le_resource_manager_i.destroy  = le_resource_manager_destroy;
 	le_resource_manager_i.update   = le_resource_manager_update;
 	le_resource_manager_i.add_item = le_resource_manager_add_item;
+
+	le_resource_manager_i.remove_item = le_resource_manager_remove_item;
+
+	le_resource_manager_i.set_upload_budget    = le_resource_manager_set_upload_budget;
+	le_resource_manager_i.set_residency_budget = le_resource_manager_set_residency_budget;
+	le_resource_manager_i.set_item_priority    = le_resource_manager_set_item_priority;
+	le_resource_manager_i.is_item_ready        = le_resource_manager_is_item_ready;
 }
@@ -9,9 +9,28 @@ Helper module for dealing with image resources. ResourceManager automatically
 loads image resources from file, and uploads image resources, and declares
 image resources to a rendermodule.
 
+Image files are decoded asynchronously, via le_pixels: `add_item()` only
+reads image headers, and returns right away. Layers are uploaded once they
+have been decoded.
+
 Once an image was uploaded, it will not be transferred again, ResourceManager
 keeps track of uploaded images.
 
+Uploads are spread over frames: each frame uploads at most as many bytes as
+set via `set_upload_budget()` (default: 64 MiB), but at least one image layer.
+Items with higher priority (see `set_item_priority()`) are uploaded first.
+Use `is_item_ready()` to find out whether all layers of an item have been
+uploaded - until then, draw with a fallback image, or skip the draw.
+
+Host pixels are released once they have been uploaded. Use `remove_item()` to
+remove an item: its image memory is released once no frame in flight uses it.
+
+If you set a residency budget via `set_residency_budget()` (default: none),
+items which have not been referenced via `is_item_ready()` for a number of
+frames get evicted - least recently used first - while the estimated device
+memory for all images exceeds the budget. An evicted item is decoded, and
+uploaded again when it is next referenced via `is_item_ready()`.
+
 ## Usage
 
     // In app definition:
@@ -69,6 +88,17 @@ when you specify the image info for the resource
 
         app->resource_manager.add_item( cube_image, image_info, paths );
 
+* * *
+
+KTX2, and DDS container files are not decoded: they are memory-mapped, and
+their mip levels, and array layers are uploaded as they are stored. Their
+stored format is used if the image's format is `le::Format::eUndefined`. A
+container file may hold all array layers - all faces of a cubemap, for
+example - in which case you pass only its path:
+
+        char const* path = "./local_resources/cubemap.ktx2";
+        app->resource_manager.add_item( cube_image, image_info, &path );
+
 */
 
 #include "le_core.h"
@@ -88,6 +118,12 @@ struct le_resource_manager_api {
 		void                     ( * destroy   ) ( le_resource_manager_o* self );
 		void                     ( * update    ) ( le_resource_manager_o* self, le_rendergraph_o* module );
         void                     ( * add_item  ) ( le_resource_manager_o* self, le_img_resource_handle const * image_handle, le_resource_info_t const * image_info, char const * const * arr_image_paths);
+		void                     ( * remove_item ) ( le_resource_manager_o* self, le_img_resource_handle const * image_handle );
+
+		void                     ( * set_upload_budget    ) ( le_resource_manager_o* self, uint64_t bytes_per_frame ); // 0 means unlimited
+		void                     ( * set_residency_budget ) ( le_resource_manager_o* self, uint64_t num_bytes, uint32_t evict_after_frames ); // 0 bytes means unlimited (default)
+		void                     ( * set_item_priority ) ( le_resource_manager_o* self, le_img_resource_handle const * image_handle, int32_t priority );
+		bool                     ( * is_item_ready     ) ( le_resource_manager_o* self, le_img_resource_handle const * image_handle );
 
 	};
 
@@ -126,6 +162,26 @@ class LeResourceManager : NoCopy, NoMove {
 		le_resource_manager::le_resource_manager_i.add_item( self, &image_handle, &image_info, arr_image_paths );
 	}
 
+	void remove_item( le_img_resource_handle const& image_handle ) {
+		le_resource_manager::le_resource_manager_i.remove_item( self, &image_handle );
+	}
+
+	void set_upload_budget( uint64_t bytes_per_frame ) {
+		le_resource_manager::le_resource_manager_i.set_upload_budget( self, bytes_per_frame );
+	}
+
+	void set_residency_budget( uint64_t num_bytes, uint32_t evict_after_frames = 120 ) {
+		le_resource_manager::le_resource_manager_i.set_residency_budget( self, num_bytes, evict_after_frames );
+	}
+
+	void set_item_priority( le_img_resource_handle const& image_handle, int32_t priority ) {
+		le_resource_manager::le_resource_manager_i.set_item_priority( self, &image_handle, priority );
+	}
+
+	bool is_item_ready( le_img_resource_handle const& image_handle ) {
+		return le_resource_manager::le_resource_manager_i.is_item_ready( self, &image_handle );
+	}
+
 	operator auto() {
 		return self;
 	}
@@ -12,6 +12,7 @@
 #include "le_camera.h"
 #include "le_pixels.h"
 #include "le_timebase.h"
+#include "le_jobs.h"
 
 #include "3rdparty/src/spooky/SpookyV2.h"
 
@@ -23,6 +24,8 @@
 #include <string>
 #include <unordered_map>
 #include <algorithm>
+#include <tuple>
+#include <limits>
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE // vulkan clip space is from 0 to 1
 #define GLM_FORCE_RIGHT_HANDED      // glTF uses right handed coordinate system, and we're following its lead.
@@ -32,6 +35,10 @@
 #include "glm/gtx/quaternion.hpp"
 #include <glm/gtx/matrix_decompose.hpp>
 
+#ifndef LE_MT
+#	define LE_MT 0
+#endif
+
 // It could be nice if le_mesh_o could live outside of the stage - so that
 // we could use it as a method to generate primitives for example, like spheres etc.
 
@@ -48,8 +55,18 @@
  *
  */
 
-static const auto     RTX_IMAGE_TARGET_HANDLE = LE_IMG_RESOURCE( "rtx_target_img" );
-static constexpr auto LOGGER_LABEL            = "le_backend";
+static const auto     RTX_IMAGE_TARGET_HANDLE     = LE_IMG_RESOURCE( "rtx_target_img" );
+static const auto     INDIRECT_DRAWS_HANDLE       = LE_BUF_RESOURCE( "le_stage_indirect_draws" );      // written by gpu culling pass
+static const auto     INSTANCE_TRANSFORMS_HANDLE  = LE_BUF_RESOURCE( "le_stage_instance_transforms" ); // written by gpu culling pass
+static const auto     DEFORMED_VERTICES_HANDLE    = LE_BUF_RESOURCE( "le_stage_deformed_vertices" );   // written by deform pass
+static constexpr auto LOGGER_LABEL                = "le_backend";
+static constexpr auto NO_TRANSFORM_IDX            = uint32_t( ~0u );
+static constexpr auto TRANSFORM_JOB_MIN_NODES     = uint32_t( 512 );              // minimum number of nodes per transform update job
+static constexpr auto DEFAULT_UPLOAD_BUDGET_BYTES = uint64_t( 64 * 1024 * 1024 ); // max bytes uploaded per frame, unless set via set_upload_budget
+static constexpr auto NO_DEFORM_JOB               = uint32_t( ~0u );
+static constexpr auto DEFORM_SOURCE_VEC4S         = uint32_t( 7 );                // vec4s per vertex in deform source: position, normal, tangent, joints[2], weights[2]
+static constexpr auto DEFORM_TARGET_VEC4S         = uint32_t( 3 );                // vec4s per vertex, per morph target in deform source: position, normal, tangent
+static constexpr auto DEFORMED_VERTEX_STRIDE      = uint32_t( sizeof( float ) * 10 ); // position.xyz, normal.xyz, tangent.xyzw - must match deform.glsl
 
 // Wrappers so that we can pass data via opaque pointers across header boundaries
 
@@ -85,12 +102,14 @@ struct le_texture_o {
 };
 
 struct le_buffer_o {
-	void*                  mem;    // nullptr if not owning
-	le_buf_resource_handle handle; // renderer resource handle
-	le_resource_info_t     resource_info;
-	uint32_t               size;            // number of bytes
-	bool                   was_transferred; // whether this buffer was transferred to gpu already
-	bool                   owns_mem;        // true if sole owner of memory pointed to in mem
+	void*                         mem;    // nullptr once uploaded
+	le_buf_resource_handle        handle; // renderer resource handle
+	le_resource_info_t            resource_info;
+	uint32_t                      size;                  // number of bytes
+	bool                          was_transferred;       // whether this buffer was transferred to gpu already
+	bool                          owns_mem;              // true if sole owner of memory pointed to in mem
+	le_borrowed_memory_release_fn release_mem;           // if memory is borrowed: optional, called once memory is not needed anymore
+	void*                         release_mem_user_data; //
 };
 
 struct le_buffer_view_o {
@@ -205,20 +224,31 @@ struct le_primitive_o {
 	le_resource_info_t      rtx_blas_info;
 	bool                    rtx_was_transferred;
 
+	glm::vec3 bounds_min; // local-space bounding box, taken from min/max of POSITION accessor
+	glm::vec3 bounds_max; //
+
+	uint32_t deform_source_buffer_idx; // cached: buffer holding vertex data packed for deform pass, if is_deformed
+	uint32_t deform_slot;              // cached: index of this primitive among deformed primitives of its mesh
+
 	bool has_indices;
 	bool has_material;
+	bool has_bounds;  // false if POSITION accessor does not specify min and max
+	bool is_resident; // cached: true once all buffers and images used by this primitive were uploaded
+	bool is_deformed; // cached: true if skinned, or morphed by deform pass - vertex shader then reads deformed vertices
 };
 
 // has many primitives
 struct le_mesh_o {
 	std::vector<le_primitive_o> primitives;
+
+	uint32_t deformed_primitive_count; // cached: number of primitives which are skinned, or morphed
+
+	glm::vec3 bounds_min; // local-space bounding box over all primitives
+	glm::vec3 bounds_max; //
+	bool      has_bounds; // false if any primitive has no bounds, or has morph targets
 };
 
 struct le_node_o {
-	glm::mat4 global_transform;
-	glm::mat4 inverse_global_transform;
-	glm::mat4 local_transform;
-
 	glm::vec3 local_translation;
 	glm::quat local_rotation;
 	glm::vec3 local_scale;
@@ -227,8 +257,8 @@ struct le_node_o {
 
 	char name[ 32 ];
 
-	bool local_transform_cached;   // whether local transform is accurate wrt local[translation|rotation|scale]
-	bool global_transform_chached; // whether global transform is current
+	bool     local_transform_cached; // whether local transform is accurate wrt local[translation|rotation|scale]
+	uint32_t transform_idx;          // index into le_stage_o::transforms, NO_TRANSFORM_IDX if node is not part of any scene
 
 	bool     has_mesh;
 	uint32_t mesh_idx;
@@ -245,6 +275,11 @@ struct le_node_o {
 	// or whether a node should be used for raytracing for example.
 	uint64_t scene_bit_flags; // one bit for every scene this node is included in -
 
+	glm::vec4 world_bounding_sphere; // xyz: centre in world space, w: radius - updated in le_stage_update
+	bool      has_world_bounds;      // false means this node must never be culled
+
+	uint32_t deform_job_idx; // index of deform job for first deformed primitive of mesh, NO_DEFORM_JOB if none this frame
+
 	std::vector<le_node_o*> children; // non-owning
 };
 
@@ -280,12 +315,31 @@ struct le_animation_channel_o {
 	uint64_t ticks_duration; // Offset (in ticks) of last keyframe, designating total duration in ticks for this channel, since keyframes are defined as: [0..n[
 	//
 	std::vector<le_keyframe_o> sampler;        // (non-owning) keyframes for this channel, their time is relative to this channel.
+	std::vector<uint64_t>      key_ticks;      // delta_ticks for each keyframe in sampler, kept separately so that searching for keyframes is cache-friendly
+	uint32_t                   cursor;         // index of keyframe we interpolated towards in most recent update
 	                                           //
 	le_compound_num_type target_compound_type; // numeric type for target - we keep this mostly because quaternion requires slerp rather than lerp.
 	le_node_o*           target_node;          // (non-owning) pointer to targeted node						 : how do we deal with deleted nodes?
 	void*                target_node_element;  // (non-owning) pointer to targeted node element (t, r, or s) : how do we deal with deleted nodes?
 };
 
+// Animation channels of the same target type are evaluated together: each
+// frame, we gather their keyframe values into structure-of-arrays lanes,
+// interpolate all lanes in one loop, and then write results to their targets.
+enum le_animation_batch_type : uint32_t {
+	ANIMATION_BATCH_SCALAR = 0, // morph target weights, one lane per weight
+	ANIMATION_BATCH_VEC3,       // translation, scale
+	ANIMATION_BATCH_QUAT,       // rotation
+	ANIMATION_BATCH_COUNT,
+};
+
+struct le_animation_batch_o {
+	std::vector<float>  t;       // normalised time between previous and next keyframe, per lane
+	std::vector<float>  a[ 4 ];  // value at previous keyframe, one array per component
+	std::vector<float>  b[ 4 ];  // value at next keyframe, one array per component
+	std::vector<float*> targets; // (non-owning) where to write the interpolated value, per lane
+};
+
 /// An animation is a collection of channels
 struct le_animation_o {
 
@@ -366,6 +420,83 @@ struct le_scene_o {
 	std::vector<le_light_o> lights;
 };
 
+// One entry per draw of a primitive - we sort these by state to build draw batches.
+struct le_draw_item_o {
+	uint32_t         scene_idx;
+	uintptr_t        pipeline_key;  // pipeline_state_handle of primitive
+	uint32_t         material_idx;  // ~0u if primitive has no material
+	uint32_t         mesh_idx;      //
+	uint32_t         primitive_idx; // index of primitive within mesh
+	uintptr_t        unique_key;    // non-zero if this draw must not be merged with other draws
+	le_node_o const* node;          // non-owning
+};
+
+// A run of draws of the same primitive, with the same scene, pipeline, and material,
+// which we issue as a single instanced draw.
+struct le_draw_batch_o {
+	le_scene_o const*     scene;          // non-owning
+	le_node_o const*      node;           // non-owning, first node in batch - only batches of one instance use this for deformed vertices
+	le_primitive_o const* primitive;      // non-owning
+	uint32_t              first_instance; // index into le_stage_o::draw_instances
+	uint32_t              instance_count; //
+};
+
+// Per-instance transforms - this struct is used in a tightly packed vector
+// as an ssbo, it must therefore obey the std430 packing rules.
+struct le_draw_instance_o {
+	glm::mat4 model_matrix;
+	glm::mat4 normal_matrix; // given in world-space, transpose(inverse(model_matrix))
+};
+
+// Skinning and morphing of one primitive, as drawn by one node - executed by the deform pass.
+struct le_deform_job_o {
+	le_node_o const*      node;         // non-owning
+	le_primitive_o const* primitive;    // non-owning
+	uint32_t              joint_offset; // index of first joint of node's skin in le_stage_o::joint_palette
+	uint32_t              first_vertex; // index of first output vertex in DEFORMED_VERTICES_HANDLE
+	bool                  is_active;    // false if primitive is not resident yet - we neither deform, nor draw it
+};
+
+// A buffer or image which waits to be uploaded to the gpu.
+struct le_upload_item_o {
+	float    distance;  // distance from camera to closest node which uses this resource
+	uint64_t num_bytes; //
+	uint32_t index;     // index into stage->buffers, or stage->images
+	bool     is_image;  // whether index refers to stage->images
+};
+
+struct le_transform_hierarchy_o;
+
+// Range of nodes [begin, end) in transform hierarchy, updated as one job.
+// A range is made up of one or more consecutive, complete subtrees.
+struct le_transform_update_range_t {
+	le_transform_hierarchy_o* hierarchy;
+	uint32_t                  begin;
+	uint32_t                  end;
+};
+
+// Transforms for all nodes in the scene graph, stored as structure-of-arrays.
+// Nodes are stored in depth-first order, so that parents come before their
+// children, and so that each subtree occupies a contiguous range of indices:
+// [ idx, subtree_end[ idx ] ).
+struct le_transform_hierarchy_o {
+	std::vector<le_node_o*> nodes;          // non-owning
+	std::vector<uint32_t>   parent_idx;     // NO_TRANSFORM_IDX for root nodes
+	std::vector<uint32_t>   subtree_end;    // one past index of last descendant
+	std::vector<glm::mat4>  local;          //
+	std::vector<glm::mat4>  global;         //
+	std::vector<glm::mat4>  inverse_global; // calculated lazily, only if inverse_valid is false
+	std::vector<uint8_t>    local_dirty;    // local transform changed since last update
+	std::vector<uint8_t>    global_dirty;   // global transform changed in most recent update - only valid during update, and only for visited nodes
+	std::vector<uint8_t>    subtree_dirty;  // whether any node in subtree [ idx, subtree_end[ idx ] ) has a dirty local transform
+	std::vector<uint8_t>    inverse_valid;  // whether inverse_global matches global
+	std::vector<uint32_t>   roots;          // indices of root nodes, ascending
+	bool                    is_valid;       // false if nodes or scenes were added since we last built the hierarchy
+
+	std::vector<le_transform_update_range_t> update_ranges; // scratch, kept so that we retain capacity
+	std::vector<le_jobs::job_t>              update_jobs;   // scratch, kept so that we retain capacity
+};
+
 // Owns all the data
 struct le_stage_o {
 	le_renderer_o*                      renderer;        // non-owning
@@ -386,6 +517,21 @@ struct le_stage_o {
 	std::vector<stage_image_o*>         images;          // owning
 	std::vector<le_img_resource_handle> image_handles;   //
 	std::vector<le_skin_o*>             skins;           // owning
+	le_transform_hierarchy_o            transforms;      // global, local transforms for all nodes
+	std::vector<le_draw_item_o>         draw_items;           // scratch: unsorted draws, kept so that we retain capacity
+	std::vector<le_draw_batch_o>        draw_batches;         // rebuilt every frame, sorted by state
+	std::vector<le_draw_instance_o>     draw_instances;       // per-instance transforms, grouped by batch
+	std::vector<glm::vec4>              draw_instance_bounds; // per-instance world bounding sphere, negative radius: never cull
+	float                               cull_w_over_h;        // aspect ratio of most recent draw pass, used by gpu culling pass
+	bool                                gpu_culling;          // whether draws are culled by compute pass, rather than on the cpu
+	std::vector<le_upload_item_o>       frame_uploads;        // resources picked for upload this frame
+	std::vector<float>                  upload_distances;     // scratch: per buffer, then per image, distance to camera
+	glm::vec3                           camera_position_hint; // camera position of most recent draw pass, used to prioritise uploads
+	uint64_t                            upload_budget_bytes;  // max number of bytes to upload per frame, 0 means unlimited
+	le_animation_batch_o                animation_batches[ ANIMATION_BATCH_COUNT ]; // scratch, kept so that we retain capacity
+	std::vector<le_deform_job_o>        deform_jobs;            // rebuilt every frame: one per deformed primitive, per node
+	std::vector<glm::mat4>              joint_palette;          // rebuilt every frame: joint matrix, then joint normal matrix, for every joint of every skinned node
+	uint32_t                            deformed_vertex_count;  // number of vertices written by deform pass this frame
 };
 
 // clang-format off
@@ -401,133 +547,299 @@ struct le_stage_o {
 		        };
 // clang-format on
 
-/// \brief Create image by interpreting given memory as an image.
-/// \note  Image memory is decoded via stb_image.
-/// \param debug_name : (optional) name to remember the image by.
-/// \param mip_levels_: (optional) number of mip-levels to auto-generate:
-///        0 means generate the full mip chain, any other number limits
-///        the number of mip levels.
-static uint32_t le_stage_create_image_from_memory(
-    le_stage_o*          stage,
-    unsigned char const* image_file_memory,
-    uint32_t             image_file_sz,
-    char const*          debug_name,
-    uint32_t             mip_levels_ ) {
+/// \brief decodes image file memory into img, and fills in image resource info.
+/// \note  does not touch the stage, so that we may call this from many threads at once.
+/// \return false if image could not be decoded - in which case img is left without pixels.
+static bool stage_image_decode( stage_image_o* img, unsigned char const* image_file_memory, uint32_t image_file_sz, uint32_t mip_levels_ ) {
 
-	assert( image_file_memory && "must point to memory" );
-	assert( image_file_sz && "must have size > 0" );
+	using namespace le_pixels;
 
-	assert( stage->images.size() == stage->image_handles.size() );
+	// We want to find out whether this image uses a 16 bit type.
+	// further, if this image uses a single channel, we are fine with it,
+	if ( !le_pixels_i.get_info_from_memory( image_file_memory, image_file_sz, &img->info ) ) {
+		return false;
+	}
 
-	using namespace le_pixels;
+	// If image more than 1 channel, we will request 4 channels, as
+	// we cannot sample from RGB images (must be RGBA).
+	if ( img->info.num_channels > 1 ) {
+		img->info.num_channels = 4;
+	}
 
-	le_img_resource_handle res = LE_IMG_RESOURCE( "" ); // force unique handle
+	// update pixel information after load, since load hints/requests may have changed
+	// how image was decoded in the end.
 
-#if LE_RESOURCE_LABEL_LENGTH > 0
-	if ( debug_name ) {
-		// Copy debug name if such was given, and handle has debug name field.
-		strncpy( res.debug_name, debug_name, LE_RESOURCE_LABEL_LENGTH - 1 );
+	img->pixels = le_pixels_i.create_from_memory( image_file_memory, image_file_sz, img->info.num_channels, img->info.type );
+
+	if ( nullptr == img->pixels ) {
+		return false;
 	}
-#endif
 
-	uint32_t image_handle_idx = 0;
-	for ( auto& h : stage->image_handles ) {
-		if ( h == res ) {
-			break;
+	img->info            = le_pixels_i.get_info( img->pixels );
+	img->was_transferred = false;
+
+	le::Format imageFormat{};
+
+	if ( img->info.type == le_pixels_info::Type::eUInt8 ) {
+		if ( img->info.num_channels == 1 ) {
+			imageFormat = le::Format::eR8Unorm;
+		} else if ( img->info.num_channels == 4 ) {
+			imageFormat = le::Format::eR8G8B8A8Unorm;
 		}
-		image_handle_idx++;
 	}
 
-	if ( image_handle_idx == stage->image_handles.size() ) {
+	uint32_t mip_levels =
+	    mip_levels_
+	        ? mip_levels_
+	        : uint32_t( ceilf( log2f( std::max( img->info.width, img->info.height ) ) ) );
+
+	img->resource_info =
+	    le::ImageInfoBuilder()
+	        .setExtent( img->info.width, img->info.height, img->info.depth )
+	        .setFormat( imageFormat )
+	        .setUsageFlags( le::ImageUsageFlagBits::eSampled |
+	                        le::ImageUsageFlagBits::eTransferDst )
+	        .setMipLevels( mip_levels )
+	        .build();
+
+	return true;
+}
 
-		stage_image_o* img = new stage_image_o{};
+// ----------------------------------------------------------------------
 
-		// We want to find out whether this image uses a 16 bit type.
-		// further, if this image uses a single channel, we are fine with it,
-		le_pixels_i.get_info_from_memory( image_file_memory, image_file_sz, &img->info );
+/// \brief gives an image which could not be decoded a 1x1 texel image resource, so
+/// that it may still be declared, and sampled. The image is never uploaded, and its
+/// contents are therefore undefined.
+static void stage_image_set_placeholder( stage_image_o* img ) {
+
+	img->pixels          = nullptr;
+	img->info            = {};
+	img->was_transferred = true; // there is nothing to transfer
+
+	img->resource_info =
+	    le::ImageInfoBuilder()
+	        .setExtent( 1, 1, 1 )
+	        .setFormat( le::Format::eR8G8B8A8Unorm )
+	        .setUsageFlags( le::ImageUsageFlagBits::eSampled |
+	                        le::ImageUsageFlagBits::eTransferDst )
+	        .setMipLevels( 1 )
+	        .build();
+}
 
-		// If image more than 1 channel, we will request 4 channels, as
-		// we cannot sample from RGB images (must be RGBA).
-		if ( img->info.num_channels > 1 ) {
-			img->info.num_channels = 4;
-		}
+// ----------------------------------------------------------------------
 
-		// update pixel information after load, since load hints/requests may have changed
-		// how image was decoded in the end.
+/// \brief reads file at given path into memory - caller must free returned memory.
+/// \return nullptr if file could not be read.
+static unsigned char* load_file( char const* file_path, uint32_t* file_sz ) {
 
-		img->pixels          = le_pixels_i.create_from_memory( image_file_memory, image_file_sz, img->info.num_channels, img->info.type );
-		img->info            = le_pixels_i.get_info( img->pixels );
-		img->handle          = res;
-		img->was_transferred = false;
+	FILE* file = fopen( file_path, "rb" );
 
-		le::Format imageFormat{};
+	if ( nullptr == file ) {
+		return nullptr;
+	}
+
+	fseek( file, 0, SEEK_END );
+	long tell_sz = ftell( file );
+	rewind( file );
+
+	unsigned char* file_memory = nullptr;
+
+	if ( tell_sz > 0 ) {
+		file_memory = static_cast<unsigned char*>( malloc( size_t( tell_sz ) ) );
+	}
+
+	if ( file_memory && fread( file_memory, 1, size_t( tell_sz ), file ) != size_t( tell_sz ) ) {
+		free( file_memory );
+		file_memory = nullptr;
+	}
+
+	fclose( file );
+
+	*file_sz = uint32_t( tell_sz );
+
+	return file_memory;
+}
+
+// ----------------------------------------------------------------------
+
+struct image_decode_job_t {
+	stage_image_o*       img;
+	le_image_info const* info;
+	bool                 could_read   = false; // set by job: whether image file could be read
+	bool                 could_decode = false; // set by job: whether image could be decoded
+};
+
+// Failures are only recorded here - they get reported, and handled on the
+// calling thread, once all decode jobs have completed.
+static void image_decode_job( void* param ) {
+	auto job = static_cast<image_decode_job_t*>( param );
+
+	if ( job->info->file_memory ) {
+		job->could_read   = true;
+		job->could_decode = stage_image_decode( job->img, job->info->file_memory, job->info->file_memory_sz, job->info->mip_levels );
+		return;
+	}
+
+	if ( nullptr == job->info->file_path ) {
+		return; // image has neither file memory, nor file path
+	}
+
+	// ----------| invariant: image must be loaded from file
+
+	uint32_t       file_sz     = 0;
+	unsigned char* file_memory = load_file( job->info->file_path, &file_sz );
+
+	if ( nullptr == file_memory ) {
+		return;
+	}
+
+	job->could_read   = true;
+	job->could_decode = stage_image_decode( job->img, file_memory, file_sz, job->info->mip_levels );
+
+	free( file_memory );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief Create images from encoded image file data, or image files.
+/// \details Decoding an image is expensive - we therefore first add all images
+/// to the stage, and then decode them in parallel.
+/// \note  Image memory is decoded via stb_image.
+/// \param out_image_indices: array of num_infos elements, receives index of each image inside stage.
+static void le_stage_create_images( le_stage_o* stage, le_image_info const* infos, uint32_t num_infos, uint32_t* out_image_indices ) {
+
+	assert( stage->images.size() == stage->image_handles.size() );
+
+	std::vector<image_decode_job_t> decode_jobs;
+	decode_jobs.reserve( num_infos );
+
+	for ( uint32_t i = 0; i != num_infos; i++ ) {
+
+		le_image_info const& info = infos[ i ];
 
-		if ( img->info.type == le_pixels_info::Type::eUInt8 ) {
-			if ( img->info.num_channels == 1 ) {
-				imageFormat = le::Format::eR8Unorm;
-			} else if ( img->info.num_channels == 4 ) {
-				imageFormat = le::Format::eR8G8B8A8Unorm;
+		assert( ( info.file_path || ( info.file_memory && info.file_memory_sz ) ) && "image must have either file path, or file memory" );
+
+		le_img_resource_handle res = LE_IMG_RESOURCE( "" ); // force unique handle
+
+#if LE_RESOURCE_LABEL_LENGTH > 0
+		if ( info.debug_name ) {
+			// Copy debug name if such was given, and handle has debug name field.
+			strncpy( res.debug_name, info.debug_name, LE_RESOURCE_LABEL_LENGTH - 1 );
+		}
+#endif
+
+		uint32_t image_handle_idx = 0;
+		for ( auto& h : stage->image_handles ) {
+			if ( h == res ) {
+				break;
 			}
+			image_handle_idx++;
 		}
 
-		uint32_t mip_levels =
-		    mip_levels_
-		        ? mip_levels_
-		        : uint32_t( ceilf( log2f( std::max( img->info.width, img->info.height ) ) ) );
+		if ( image_handle_idx == stage->image_handles.size() ) {
+
+			stage_image_o* img = new stage_image_o{};
+			img->handle        = res;
 
-		img->resource_info =
-		    le::ImageInfoBuilder()
-		        .setExtent( img->info.width, img->info.height, img->info.depth )
-		        .setFormat( imageFormat )
-		        .setUsageFlags( le::ImageUsageFlagBits::eSampled |
-		                        le::ImageUsageFlagBits::eTransferDst )
-		        .setMipLevels( mip_levels )
-		        .build();
+			stage->images.emplace_back( img );
+			stage->image_handles.emplace_back( res );
 
-		stage->images.emplace_back( img );
-		stage->image_handles.emplace_back( res );
+			decode_jobs.push_back( { img, &info } );
+		}
+
+		out_image_indices[ i ] = image_handle_idx;
 	}
 
-	return image_handle_idx;
-}
+#if ( LE_MT > 0 )
+	if ( decode_jobs.size() > 1 ) {
 
-/// \brief create image by loading file at given filepath into memory,
-/// then handing over to `create_image_from_memory`
-static uint32_t le_stage_create_image_from_file_path( le_stage_o* stage, char const* image_file_path, char const* debug_name, uint32_t mip_levels ) {
+		std::vector<le_jobs::job_t> jobs;
+		jobs.reserve( decode_jobs.size() );
 
-	void*  image_file_memory = nullptr;
-	size_t image_file_sz     = 0;
+		for ( auto& j : decode_jobs ) {
+			jobs.push_back( { image_decode_job, &j } );
+		}
 
-	FILE* file = fopen( image_file_path, "r" );
-	assert( file );
+		le_jobs::counter_t* counter;
+		le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+		le_jobs::wait_for_counter_and_free( counter, 0 );
 
-	{
-		fseek( file, 0, SEEK_END );
-		long tell_sz = ftell( file );
-		rewind( file );
-		assert( tell_sz > 0 && "file cannot be empty" );
-		image_file_sz = size_t( tell_sz );
+	} else {
+		for ( auto& j : decode_jobs ) {
+			image_decode_job( &j );
+		}
+	}
+#else
+	for ( auto& j : decode_jobs ) {
+		image_decode_job( &j );
 	}
+#endif
+
+	// Images which could not be read, or decoded, get a placeholder which is never uploaded.
 
-	image_file_memory = malloc( image_file_sz );
+	static auto logger = LeLog( LOGGER_LABEL );
 
-	size_t num_bytes_read = fread( image_file_memory, 1, image_file_sz, file );
+	for ( auto const& j : decode_jobs ) {
 
-	assert( num_bytes_read == image_file_sz );
+		if ( j.could_decode ) {
+			continue;
+		}
 
-	// load into memory, call create_image_from_memory
-	uint32_t result =
-	    le_stage_create_image_from_memory(
-	        stage,
-	        static_cast<unsigned char const*>( image_file_memory ),
-	        uint32_t( image_file_sz ), debug_name, mip_levels );
+		char const* name = j.info->file_path ? j.info->file_path : ( j.info->debug_name ? j.info->debug_name : "<unnamed>" );
 
-	free( image_file_memory );
+		if ( !j.could_read ) {
+			logger.error( "Could not read image file: '%s' - image will not be uploaded.", name );
+		} else {
+			logger.error( "Could not decode image: '%s' - image will not be uploaded.", name );
+		}
 
-	fclose( file );
-	// free file memory
+		stage_image_set_placeholder( j.img );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief Create image by interpreting given memory as an image.
+/// \note  Image memory is decoded via stb_image.
+/// \param debug_name : (optional) name to remember the image by.
+/// \param mip_levels_: (optional) number of mip-levels to auto-generate:
+///        0 means generate the full mip chain, any other number limits
+///        the number of mip levels.
+static uint32_t le_stage_create_image_from_memory(
+    le_stage_o*          stage,
+    unsigned char const* image_file_memory,
+    uint32_t             image_file_sz,
+    char const*          debug_name,
+    uint32_t             mip_levels_ ) {
+
+	assert( image_file_memory && "must point to memory" );
+	assert( image_file_sz && "must have size > 0" );
+
+	le_image_info info{};
+	info.file_memory    = image_file_memory;
+	info.file_memory_sz = image_file_sz;
+	info.debug_name     = debug_name;
+	info.mip_levels     = mip_levels_;
+
+	uint32_t image_idx = 0;
+	le_stage_create_images( stage, &info, 1, &image_idx );
+
+	return image_idx;
+}
 
-	return result;
+/// \brief create image by loading file at given filepath into memory,
+/// then decoding it as in `create_image_from_memory`
+static uint32_t le_stage_create_image_from_file_path( le_stage_o* stage, char const* image_file_path, char const* debug_name, uint32_t mip_levels ) {
+
+	le_image_info info{};
+	info.file_path  = image_file_path;
+	info.debug_name = debug_name;
+	info.mip_levels = mip_levels;
+
+	uint32_t image_idx = 0;
+	le_stage_create_images( stage, &info, 1, &image_idx );
+
+	return image_idx;
 }
 
 /// \brief add a sampler to stage, return index to sampler within this stage.
@@ -597,8 +909,11 @@ static le::BufferUsageFlags get_defaults_buffer_usage_flags() {
 }
 
 /// \brief Add a buffer to stage, return index to buffer within this stage.
-///
-static uint32_t le_stage_create_buffer( le_stage_o* stage, void* mem, uint32_t sz, char const* debug_name ) {
+/// \details If `borrow_mem` is false, we copy `mem`. Otherwise, we read directly
+/// from `mem` until the buffer has been uploaded - and then call `release_fn`,
+/// if given, to signal that we don't need `mem` anymore.
+static uint32_t stage_create_buffer( le_stage_o* stage, void* mem, uint32_t sz, char const* debug_name,
+                                     bool borrow_mem, le_borrowed_memory_release_fn release_fn, void* release_fn_user_data ) {
 
 	assert( mem && "must point to memory" );
 	assert( sz && "must have size > 0" );
@@ -632,9 +947,14 @@ static uint32_t le_stage_create_buffer( le_stage_o* stage, void* mem, uint32_t s
 		le_buffer_o* buffer = new le_buffer_o{};
 
 		buffer->handle = res;
-		buffer->mem    = malloc( sz );
 
-		if ( buffer->mem ) {
+		if ( borrow_mem ) {
+			buffer->mem                   = mem;
+			buffer->owns_mem              = false;
+			buffer->size                  = sz;
+			buffer->release_mem           = release_fn;
+			buffer->release_mem_user_data = release_fn_user_data;
+		} else if ( ( buffer->mem = malloc( sz ) ) ) {
 			memcpy( buffer->mem, mem, sz );
 			buffer->owns_mem = true;
 			buffer->size     = sz;
@@ -653,11 +973,39 @@ static uint32_t le_stage_create_buffer( le_stage_o* stage, void* mem, uint32_t s
 
 		stage->buffer_handles.push_back( res );
 		stage->buffers.push_back( buffer );
+
+	} else if ( borrow_mem && release_fn ) {
+		// We already have a buffer for this handle - we won't read from mem.
+		release_fn( release_fn_user_data );
 	}
 
 	return buffer_handle_idx;
 }
 
+/// \brief Add a buffer to stage, copying `mem`. Return index to buffer within this stage.
+static uint32_t le_stage_create_buffer( le_stage_o* stage, void* mem, uint32_t sz, char const* debug_name ) {
+	return stage_create_buffer( stage, mem, sz, debug_name, false, nullptr, nullptr );
+}
+
+/// \brief Add a buffer to stage, borrowing `mem` until the buffer has been uploaded.
+/// Return index to buffer within this stage.
+static uint32_t le_stage_create_buffer_borrowed( le_stage_o* stage, void* mem, uint32_t sz, char const* debug_name,
+                                                 le_borrowed_memory_release_fn release_fn, void* release_fn_user_data ) {
+	return stage_create_buffer( stage, mem, sz, debug_name, true, release_fn, release_fn_user_data );
+}
+
+/// \brief frees, or gives back memory for buffer, depending on who owns it.
+static void buffer_release_mem( le_buffer_o* b ) {
+	if ( b->owns_mem ) {
+		free( b->mem );
+	} else if ( b->release_mem ) {
+		b->release_mem( b->release_mem_user_data );
+	}
+	b->mem         = nullptr;
+	b->owns_mem    = false;
+	b->release_mem = nullptr;
+}
+
 /// \brief add buffer view to stage, return index of added buffer view inside of stage
 static uint32_t le_stage_create_buffer_view( le_stage_o* self, le_buffer_view_info const* info ) {
 	le_buffer_view_o view{};
@@ -844,7 +1192,7 @@ static uint32_t le_stage_create_material( le_stage_o* stage, le_material_info co
 /// \brief add mesh to stage, return index of newly added mesh as it appears in stage.
 static uint32_t le_stage_create_mesh( le_stage_o* self, le_mesh_info const* info ) {
 
-	le_mesh_o mesh;
+	le_mesh_o mesh{};
 
 	{
 		le_primitive_info const* primitive_info_begin = info->primitives;
@@ -925,6 +1273,28 @@ static uint32_t le_stage_create_mesh( le_stage_o* self, le_mesh_info const* info
 				primitive.material_idx = p->material_idx;
 			}
 
+			{
+				// -- Fetch local-space bounds from the POSITION accessor - glTF requires
+				// POSITION accessors to specify min and max, but we don't rely on it.
+
+				auto position_attr =
+				    std::find_if( primitive.attributes.begin(),
+				                  primitive.attributes.end(),
+				                  []( le_attribute_o const& attr ) {
+					                  return attr.type == le_primitive_attribute_info::Type::ePosition &&
+					                         !attr.morph.target.is_target;
+				                  } );
+
+				if ( position_attr != primitive.attributes.end() ) {
+					le_accessor_o const& accessor = self->accessors[ position_attr->accessor_idx ];
+					if ( accessor.has_min && accessor.has_max && accessor.type == le_compound_num_type::eVec3 ) {
+						primitive.bounds_min = glm::vec3( accessor.min[ 0 ], accessor.min[ 1 ], accessor.min[ 2 ] );
+						primitive.bounds_max = glm::vec3( accessor.max[ 0 ], accessor.max[ 1 ], accessor.max[ 2 ] );
+						primitive.has_bounds = true;
+					}
+				}
+			}
+
 			{
 				// -- Calculate the number of joints sets and weights sets used by this
 				// primitve using attribute information. We use this to set aside memory
@@ -949,6 +1319,16 @@ static uint32_t le_stage_create_mesh( le_stage_o* self, le_mesh_info const* info
 				primitive.num_joints_sets = uint32_t( count_joints_sets );
 			}
 
+			// -- Skinned and morphed primitives get their vertices from the deform pass.
+			// The deform slot tells us which of a node's deform jobs belongs to this primitive.
+
+			primitive.deform_source_buffer_idx = ~0u;
+
+			if ( primitive.num_joints_sets || primitive.morph_target_count ) {
+				primitive.is_deformed = true;
+				primitive.deform_slot = mesh.deformed_primitive_count++;
+			}
+
 #ifdef LE_FEATURE_RTX
 			{
 
@@ -1019,6 +1399,27 @@ static uint32_t le_stage_create_mesh( le_stage_o* self, le_mesh_info const* info
 		}
 	}
 
+	// -- Mesh bounds are the union over all primitive bounds. Morph targets may
+	// move vertices outside of the bounds of the base mesh - we therefore
+	// don't give bounds to meshes with morph targets, which means that these
+	// meshes will never be culled.
+
+	mesh.has_bounds = !mesh.primitives.empty();
+
+	for ( auto const& primitive : mesh.primitives ) {
+		if ( !primitive.has_bounds || primitive.morph_target_count ) {
+			mesh.has_bounds = false;
+			break;
+		}
+		if ( &primitive == &mesh.primitives.front() ) {
+			mesh.bounds_min = primitive.bounds_min;
+			mesh.bounds_max = primitive.bounds_max;
+		} else {
+			mesh.bounds_min = glm::min( mesh.bounds_min, primitive.bounds_min );
+			mesh.bounds_max = glm::max( mesh.bounds_max, primitive.bounds_max );
+		}
+	}
+
 	uint32_t idx = uint32_t( self->meshes.size() );
 	self->meshes.emplace_back( mesh );
 	return idx;
@@ -1042,8 +1443,11 @@ static uint32_t le_stage_create_nodes( le_stage_o* self, le_node_info const* inf
 		node->local_scale       = n->local_scale->data;
 		node->local_rotation    = glm::quat{ n->local_rotation->data };
 		node->local_translation = n->local_translation->data;
+		node->transform_idx     = NO_TRANSFORM_IDX;
+		node->deform_job_idx    = NO_DEFORM_JOB;
 
-		node->local_transform = n->local_transform->data;
+		// Note that local transform matrices are always derived from
+		// local translation, rotation, and scale.
 
 		if ( n->has_mesh ) {
 			node->has_mesh = true;
@@ -1067,6 +1471,8 @@ static uint32_t le_stage_create_nodes( le_stage_o* self, le_node_info const* inf
 		self->nodes.push_back( node );
 	}
 
+	self->transforms.is_valid = false;
+
 	// -- Resolve child references
 	// these are relative to the first index, because we assume
 	// that the array of nodes is self-contained.
@@ -1336,6 +1742,12 @@ static uint32_t le_stage_create_animation( le_stage_o* self, le_animation_info c
 			break;
 		}
 
+		for ( auto const& k : channel.sampler ) {
+			channel.key_ticks.push_back( k.delta_ticks );
+		}
+
+		channel.cursor = 1;
+
 		if ( !channel.sampler.empty() ) {
 
 			assert( channel.target_compound_type == channel.sampler.front().compound_num_type );
@@ -1434,92 +1846,308 @@ static uint32_t le_stage_create_scene( le_stage_o* self, uint32_t* node_idx, uin
 
 	self->scenes.emplace_back( scene );
 
+	self->transforms.is_valid = false;
+
 	return idx;
 }
 
 // ----------------------------------------------------------------------
 
-/// \brief
-static bool pass_xfer_setup_resources( le_renderpass_o* pRp, void* user_data ) {
-	le::RenderPass rp{ pRp };
-	auto           stage = static_cast<le_stage_o*>( user_data );
+/// \brief returns global transform for node, as calculated by the most recent le_stage_update.
+static glm::mat4 const& node_get_global_transform( le_stage_o const* stage, le_node_o const* node ) {
+	static glm::mat4 const identity = glm::identity<glm::mat4>();
 
-	bool needsUpload = false;
+	if ( node->transform_idx == NO_TRANSFORM_IDX ) {
+		return identity;
+	}
 
-	for ( auto& b : stage->buffers ) {
-		needsUpload |= !b->was_transferred;
-		if ( !b->was_transferred ) {
-			rp.useBufferResource( b->handle, { le::BufferUsageFlags( le::BufferUsageFlagBits::eTransferDst ) } );
-		}
+	return stage->transforms.global[ node->transform_idx ];
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief returns inverse global transform for node.
+/// \details inverse is only calculated on demand, and then cached until
+/// the node's global transform changes.
+static glm::mat4 const& node_get_inverse_global_transform( le_stage_o* stage, le_node_o const* node ) {
+	static glm::mat4 const identity = glm::identity<glm::mat4>();
+
+	if ( node->transform_idx == NO_TRANSFORM_IDX ) {
+		return identity;
 	}
 
-	for ( auto& img : stage->images ) {
-		needsUpload |= !img->was_transferred;
-		if ( !img->was_transferred ) {
-			rp.useImageResource( img->handle, { le::ImageUsageFlags( le::ImageUsageFlagBits::eTransferDst ) } );
-		}
+	auto&          t   = stage->transforms;
+	uint32_t const idx = node->transform_idx;
+
+	if ( !t.inverse_valid[ idx ] ) {
+		t.inverse_global[ idx ] = glm::inverse( t.global[ idx ] );
+		t.inverse_valid[ idx ]  = true;
 	}
 
-	return needsUpload; // false means not to execute the execute callback.
+	return t.inverse_global[ idx ];
 }
 
 // ----------------------------------------------------------------------
 
-static void pass_xfer_resources( le_command_buffer_encoder_o* encoder_, void* user_data ) {
-	auto stage   = static_cast<le_stage_o*>( user_data );
-	auto encoder = le::Encoder{ encoder_ };
+/// \brief calculates, for every buffer and image, the distance from camera to the
+/// closest node which uses it. Distances are stored in stage->upload_distances,
+/// first for all buffers, then for all images.
+/// \details resources used by nodes without bounds get distance 0, resources not
+/// used by any node get the largest possible distance - these upload last.
+static void stage_calculate_upload_distances( le_stage_o* stage ) {
 
-	for ( auto& b : stage->buffers ) {
-		if ( !b->was_transferred ) {
+	auto&        distances    = stage->upload_distances;
+	size_t const images_begin = stage->buffers.size();
 
-			// upload buffer
-			encoder.writeToBuffer( b->handle, 0, b->mem, b->size );
+	distances.assign( stage->buffers.size() + stage->images.size(), std::numeric_limits<float>::max() );
 
-			// we could possibly free mem once that's done.
-			free( b->mem );
-			b->mem             = nullptr;
-			b->owns_mem        = false;
-			b->was_transferred = true;
+	auto use_texture_view = [ & ]( le_texture_view_o const* view, float distance ) {
+		if ( view && view->texture_id < stage->textures.size() ) {
+			float& d = distances[ images_begin + stage->textures[ view->texture_id ].image_idx ];
+			d        = std::min( d, distance );
 		}
-	}
+	};
 
-	for ( auto& img : stage->images ) {
-		if ( !img->was_transferred && img->pixels ) {
-			using namespace le_pixels;
-			void* pix_data = le_pixels_i.get_data( img->pixels );
+	auto use_accessor = [ & ]( uint32_t accessor_idx, float distance ) {
+		float& d = distances[ stage->buffer_views[ stage->accessors[ accessor_idx ].buffer_view_idx ].buffer_idx ];
+		d        = std::min( d, distance );
+	};
 
-			auto write_info = le::WriteToImageSettingsBuilder()
-			                      .setImageW( img->info.width )
-			                      .setImageH( img->info.height )
-			                      .setNumMiplevels( img->resource_info.image.mipLevels )
-			                      .build();
+	for ( le_node_o const* n : stage->nodes ) {
 
-			encoder.writeToImage( img->handle, write_info, pix_data, img->info.byte_count );
+		if ( !n->has_mesh ) {
+			continue;
+		}
 
-			le_pixels_i.destroy( img->pixels );
-			img->pixels          = nullptr;
-			img->was_transferred = true;
+		float distance = 0.f;
+
+		if ( n->has_world_bounds ) {
+			distance = glm::max( 0.f, glm::distance( glm::vec3( n->world_bounding_sphere ), stage->camera_position_hint ) - n->world_bounding_sphere.w );
+		}
+
+		for ( auto const& primitive : stage->meshes[ n->mesh_idx ].primitives ) {
+
+			for ( auto const& attr : primitive.attributes ) {
+				use_accessor( attr.accessor_idx, distance );
+			}
+
+			if ( primitive.has_indices ) {
+				use_accessor( primitive.indices_accessor_idx, distance );
+			}
+
+			if ( primitive.deform_source_buffer_idx < stage->buffers.size() ) {
+				float& d = distances[ primitive.deform_source_buffer_idx ];
+				d        = std::min( d, distance );
+			}
+
+			if ( primitive.has_material ) {
+				auto const& material = stage->materials[ primitive.material_idx ];
+				use_texture_view( material.normal_texture, distance );
+				use_texture_view( material.occlusion_texture, distance );
+				use_texture_view( material.emissive_texture, distance );
+				if ( material.metallic_roughness ) {
+					use_texture_view( material.metallic_roughness->base_color, distance );
+					use_texture_view( material.metallic_roughness->metallic_roughness, distance );
+				}
+			}
 		}
 	}
 }
 
 // ----------------------------------------------------------------------
 
-/// \brief add setup and execute callbacks to rendermodule so that rendermodule
-/// knows which resources are needed to render the stage.
-/// There are two resource types which potentially need uploading: buffers,
-/// and images.
-static void le_stage_update_render_module( le_stage_o* stage, le_rendergraph_o* module ) {
+/// \brief picks buffers and images to upload this frame.
+/// \details resources closest to the camera upload first. We pick resources until
+/// the stage's per-frame upload budget is spent - but we always pick at least one
+/// resource, so that resources larger than the budget get uploaded eventually.
+static void stage_select_uploads( le_stage_o* stage ) {
 
-	using namespace le_renderer;
+	auto& uploads = stage->frame_uploads;
+	uploads.clear();
 
-	auto rp = le::RenderPass( "Stage_Xfer", le::QueueFlagBits::eTransfer )
-	              .setSetupCallback( stage, pass_xfer_setup_resources )
-	              .setExecuteCallback( stage, pass_xfer_resources )
-	              .setIsRoot( true );
+	for ( uint32_t i = 0; i != stage->buffers.size(); i++ ) {
+		if ( !stage->buffers[ i ]->was_transferred ) {
+			uploads.push_back( { 0.f, stage->buffers[ i ]->size, i, false } );
+		}
+	}
 
-	// declare buffers
-	//
+	for ( uint32_t i = 0; i != stage->images.size(); i++ ) {
+		if ( !stage->images[ i ]->was_transferred && stage->images[ i ]->pixels ) {
+			uploads.push_back( { 0.f, stage->images[ i ]->info.byte_count, i, true } );
+		}
+	}
+
+	if ( uploads.empty() ) {
+		return;
+	}
+
+	// ----------| invariant: there is at least one resource which needs uploading
+
+	if ( stage->upload_budget_bytes == 0 ) {
+		// Unlimited budget: upload everything at once, order does not matter.
+		return;
+	}
+
+	stage_calculate_upload_distances( stage );
+
+	for ( auto& u : uploads ) {
+		u.distance = stage->upload_distances[ u.is_image ? stage->buffers.size() + u.index : u.index ];
+	}
+
+	std::stable_sort( uploads.begin(), uploads.end(), []( le_upload_item_o const& lhs, le_upload_item_o const& rhs ) {
+		return lhs.distance < rhs.distance;
+	} );
+
+	uint64_t budget_used = 0;
+	size_t   num_picked  = 0;
+
+	for ( ; num_picked != uploads.size(); num_picked++ ) {
+		if ( num_picked != 0 && budget_used + uploads[ num_picked ].num_bytes > stage->upload_budget_bytes ) {
+			break;
+		}
+		budget_used += uploads[ num_picked ].num_bytes;
+	}
+
+	uploads.resize( num_picked );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief returns whether all buffers and images which a primitive reads from have
+/// been uploaded, so that the primitive may be drawn.
+static bool primitive_is_resident( le_stage_o const* stage, le_primitive_o& primitive ) {
+
+	if ( primitive.is_resident ) {
+		return true;
+	}
+
+	auto buffer_is_resident = [ & ]( uint32_t accessor_idx ) -> bool {
+		return stage->buffers[ stage->buffer_views[ stage->accessors[ accessor_idx ].buffer_view_idx ].buffer_idx ]->was_transferred;
+	};
+
+	auto texture_is_resident = [ & ]( le_texture_view_o const* view ) -> bool {
+		if ( view == nullptr || view->texture_id >= stage->textures.size() ) {
+			return true;
+		}
+		stage_image_o const* img = stage->images[ stage->textures[ view->texture_id ].image_idx ];
+		return img->was_transferred || img->pixels == nullptr; // an image without pixels will never be uploaded
+	};
+
+	for ( auto const& attr : primitive.attributes ) {
+		if ( !buffer_is_resident( attr.accessor_idx ) ) {
+			return false;
+		}
+	}
+
+	if ( primitive.has_indices && !buffer_is_resident( primitive.indices_accessor_idx ) ) {
+		return false;
+	}
+
+	if ( primitive.is_deformed &&
+	     ( primitive.deform_source_buffer_idx >= stage->buffers.size() ||
+	       !stage->buffers[ primitive.deform_source_buffer_idx ]->was_transferred ) ) {
+		return false;
+	}
+
+	if ( primitive.has_material ) {
+		auto const& material = stage->materials[ primitive.material_idx ];
+		if ( !texture_is_resident( material.normal_texture ) ||
+		     !texture_is_resident( material.occlusion_texture ) ||
+		     !texture_is_resident( material.emissive_texture ) ) {
+			return false;
+		}
+		if ( material.metallic_roughness &&
+		     ( !texture_is_resident( material.metallic_roughness->base_color ) ||
+		       !texture_is_resident( material.metallic_roughness->metallic_roughness ) ) ) {
+			return false;
+		}
+	}
+
+	primitive.is_resident = true;
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief
+static bool pass_xfer_setup_resources( le_renderpass_o* pRp, void* user_data ) {
+	le::RenderPass rp{ pRp };
+	auto           stage = static_cast<le_stage_o*>( user_data );
+
+	stage_select_uploads( stage );
+
+	for ( auto const& u : stage->frame_uploads ) {
+		if ( u.is_image ) {
+			rp.useImageResource( stage->images[ u.index ]->handle, { le::ImageUsageFlags( le::ImageUsageFlagBits::eTransferDst ) } );
+		} else {
+			rp.useBufferResource( stage->buffers[ u.index ]->handle, { le::BufferUsageFlags( le::BufferUsageFlagBits::eTransferDst ) } );
+		}
+	}
+
+	return !stage->frame_uploads.empty(); // false means not to execute the execute callback.
+}
+
+// ----------------------------------------------------------------------
+
+static void pass_xfer_resources( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto stage   = static_cast<le_stage_o*>( user_data );
+	auto encoder = le::Encoder{ encoder_ };
+
+	for ( auto const& u : stage->frame_uploads ) {
+
+		if ( !u.is_image ) {
+
+			auto& b = stage->buffers[ u.index ];
+
+			// upload buffer
+			encoder.writeToBuffer( b->handle, 0, b->mem, b->size );
+
+			// we could possibly free mem once that's done.
+			buffer_release_mem( b );
+			b->was_transferred = true;
+
+		} else {
+
+			auto& img = stage->images[ u.index ];
+
+			using namespace le_pixels;
+			void* pix_data = le_pixels_i.get_data( img->pixels );
+
+			auto write_info = le::WriteToImageSettingsBuilder()
+			                      .setImageW( img->info.width )
+			                      .setImageH( img->info.height )
+			                      .setNumMiplevels( img->resource_info.image.mipLevels )
+			                      .build();
+
+			encoder.writeToImage( img->handle, write_info, pix_data, img->info.byte_count );
+
+			le_pixels_i.destroy( img->pixels );
+			img->pixels          = nullptr;
+			img->was_transferred = true;
+		}
+	}
+
+	stage->frame_uploads.clear();
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief add setup and execute callbacks to rendermodule so that rendermodule
+/// knows which resources are needed to render the stage.
+/// There are two resource types which potentially need uploading: buffers,
+/// and images.
+static void le_stage_update_render_module( le_stage_o* stage, le_rendergraph_o* module ) {
+
+	using namespace le_renderer;
+
+	auto rp = le::RenderPass( "Stage_Xfer", le::QueueFlagBits::eTransfer )
+	              .setSetupCallback( stage, pass_xfer_setup_resources )
+	              .setExecuteCallback( stage, pass_xfer_resources )
+	              .setIsRoot( true );
+
+	// declare buffers
+	//
 	for ( auto& b : stage->buffers ) {
 		rendergraph_i.declare_resource( module, b->handle, b->resource_info );
 	}
@@ -1559,6 +2187,14 @@ static void le_stage_update_render_module( le_stage_o* stage, le_rendergraph_o*
 		        le::RenderPass rp{ pRp };
 		        auto           stage = static_cast<le_stage_o*>( user_data );
 
+		        for ( auto& b : stage->buffers ) {
+			        if ( !b->was_transferred ) {
+				        // Uploads are spread over frames - acceleration structures read
+				        // from vertex and index buffers, so we wait until all are resident.
+				        return false;
+			        }
+		        }
+
 		        for ( auto& b : stage->buffers ) {
 			        rp.useBufferResource( b->handle, le::BufferUsageFlags( le::BufferUsageFlagBits::eTransferSrc ) );
 		        }
@@ -1647,10 +2283,10 @@ static void le_stage_update_render_module( le_stage_o* stage, le_rendergraph_o*
 						        le_rtx_geometry_instance_t instance{};
 						        instance.mask                                   = 0xff;
 						        instance.flags                                  = 0;
-						        instance.instanceShaderBindingTableRecordOffset = 0;                                     // TODO: set this to material-specific offset, based on array of hit shader groups in pipeline.
-						        instance.instanceCustomIndex                    = 0;                                     // TODO: set this to material?
-						        glm::mat4 transform                             = glm::transpose( n->global_transform ); // must transpose so that
-						        memcpy( &instance.transform, &transform, sizeof( instance.transform ) );                 // only copy 12 floats
+						        instance.instanceShaderBindingTableRecordOffset = 0;                                                       // TODO: set this to material-specific offset, based on array of hit shader groups in pipeline.
+						        instance.instanceCustomIndex                    = 0;                                                       // TODO: set this to material?
+						        glm::mat4 transform                             = glm::transpose( node_get_global_transform( stage, n ) ); // must transpose so that
+						        memcpy( &instance.transform, &transform, sizeof( instance.transform ) );                                   // only copy 12 floats
 						        for ( auto const& p : stage->meshes[ n->mesh_idx ].primitives ) {
 							        // TODO: set instanceCustomIndex based on material...
 							        blas_handles.push_back( p.rtx_blas_handle );
@@ -1692,7 +2328,7 @@ static le::IndexType index_type_from_num_type( le_num_type const& tp ) {
 /// calculates view matrix and projection matrix based on camera type and aspect ratio (w_over_h)
 /// if any of `camera_view_matrix` or `camera_projection_matrix` is nullptr, that value will
 /// not be calculated and updated.
-static bool stage_get_camera( le_stage_o const* stage, uint32_t scene_idx, uint32_t camera_idx, float w_over_h,
+static bool stage_get_camera( le_stage_o* stage, uint32_t scene_idx, uint32_t camera_idx, float w_over_h,
                               glm::mat4* camera_world_matrix,
                               glm::mat4* camera_view_matrix,
                               glm::mat4* camera_projection_matrix ) {
@@ -1732,13 +2368,13 @@ static bool stage_get_camera( le_stage_o const* stage, uint32_t scene_idx, uint3
 	le_camera_settings_o const& camera = stage->camera_settings[ found_camera_node->camera_idx ];
 
 	if ( camera_world_matrix ) {
-		*camera_world_matrix = found_camera_node->global_transform;
+		*camera_world_matrix = node_get_global_transform( stage, found_camera_node );
 	}
 
 	// Calculate: View Matrix is inverse global transform of the camera's node matrix.
 
 	if ( camera_view_matrix ) {
-		*camera_view_matrix = found_camera_node->inverse_global_transform;
+		*camera_view_matrix = node_get_inverse_global_transform( stage, found_camera_node );
 	}
 
 	// Calculate: Projection Matrix depends on type of camera.
@@ -1764,14 +2400,437 @@ static bool stage_get_camera( le_stage_o const* stage, uint32_t scene_idx, uint3
 
 // ----------------------------------------------------------------------
 
+/// \brief extracts frustum planes from a (projection * view) matrix.
+/// \details planes are given in world space, in Hessian normal form: xyz is the
+/// plane normal (pointing inwards), w is the distance to origin.
+/// Assumes Vulkan clip space, where depth ranges from 0 to 1.
+static void frustum_planes_from_view_projection( glm::mat4 const& view_projection, glm::vec4 planes[ 6 ] ) {
+
+	glm::mat4 const m = glm::transpose( view_projection ); // so that m[i] is row i of view_projection
+
+	planes[ 0 ] = m[ 3 ] + m[ 0 ]; // left
+	planes[ 1 ] = m[ 3 ] - m[ 0 ]; // right
+	planes[ 2 ] = m[ 3 ] + m[ 1 ]; // bottom
+	planes[ 3 ] = m[ 3 ] - m[ 1 ]; // top
+	planes[ 4 ] = m[ 2 ];          // near
+	planes[ 5 ] = m[ 3 ] - m[ 2 ]; // far
+
+	for ( size_t i = 0; i != 6; i++ ) {
+		planes[ i ] /= glm::length( glm::vec3( planes[ i ] ) );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief returns whether sphere (xyz: centre in world space, w: radius) touches frustum.
+/// \note test is conservative: a sphere outside the frustum, but close to one of its
+/// corners, may still pass.
+static bool sphere_in_frustum( glm::vec4 const planes[ 6 ], glm::vec4 const& sphere ) {
+	for ( size_t i = 0; i != 6; i++ ) {
+		if ( glm::dot( glm::vec3( planes[ i ] ), glm::vec3( sphere ) ) + planes[ i ].w < -sphere.w ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief sort order for draw items: scene, pipeline, material, mesh, primitive.
+/// Items which must not be instanced have a non-zero unique_key, and sort last.
+static bool draw_item_less( le_draw_item_o const& lhs, le_draw_item_o const& rhs ) {
+	return std::tie( lhs.scene_idx, lhs.pipeline_key, lhs.material_idx, lhs.mesh_idx, lhs.primitive_idx, lhs.unique_key ) <
+	       std::tie( rhs.scene_idx, rhs.pipeline_key, rhs.material_idx, rhs.mesh_idx, rhs.primitive_idx, rhs.unique_key );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief rebuilds the stage's draw list: all primitive draws sorted by state, with
+/// consecutive draws of the same primitive merged into instanced draw batches.
+/// \param frustum_planes: (optional) if given, nodes outside the frustum are culled.
+static void stage_build_draw_list( le_stage_o* stage, glm::vec4 const* frustum_planes ) {
+
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	auto& items = stage->draw_items;
+	items.clear();
+
+	for ( uint32_t scene_idx = 0; scene_idx != stage->scenes.size(); scene_idx++ ) {
+
+		le_scene_o const& s = stage->scenes[ scene_idx ];
+
+		for ( le_node_o const* n : stage->nodes ) {
+
+			if ( 0 == ( n->scene_bit_flags & ( 1 << s.scene_id ) ) || !n->has_mesh ) {
+				continue;
+			}
+
+			if ( frustum_planes && n->has_world_bounds &&
+			     !sphere_in_frustum( frustum_planes, n->world_bounding_sphere ) ) {
+				continue;
+			}
+
+			auto& mesh = stage->meshes[ n->mesh_idx ];
+
+			for ( uint32_t primitive_idx = 0; primitive_idx != mesh.primitives.size(); primitive_idx++ ) {
+
+				auto& primitive = mesh.primitives[ primitive_idx ];
+
+				if ( !primitive.pipeline_state_handle ) {
+					logger.error( "missing pipeline state object for primitive - did you call setup_pipelines on the stage after adding the mesh/primitive?" );
+					continue;
+				}
+
+				if ( !primitive_is_resident( stage, primitive ) ) {
+					// Still waiting for some of its data to be uploaded - skip for now.
+					continue;
+				}
+
+				// Deformed primitives read vertices which the deform pass wrote for
+				// this particular node - they can't be drawn instanced.
+				bool const needs_node_data = primitive.is_deformed;
+
+				if ( needs_node_data &&
+				     ( n->deform_job_idx == NO_DEFORM_JOB ||
+				       !stage->deform_jobs[ n->deform_job_idx + primitive.deform_slot ].is_active ) ) {
+					// Primitive became resident after deform jobs were built - we may draw it next frame.
+					continue;
+				}
+
+				le_draw_item_o item;
+				item.scene_idx     = scene_idx;
+				item.pipeline_key  = reinterpret_cast<uintptr_t>( primitive.pipeline_state_handle );
+				item.material_idx  = primitive.has_material ? primitive.material_idx : ~0u;
+				item.mesh_idx      = n->mesh_idx;
+				item.primitive_idx = primitive_idx;
+				item.unique_key    = needs_node_data ? reinterpret_cast<uintptr_t>( n ) : 0;
+				item.node          = n;
+
+				items.push_back( item );
+			}
+		}
+	}
+
+	std::sort( items.begin(), items.end(), draw_item_less );
+
+	stage->draw_batches.clear();
+	stage->draw_instances.clear();
+	stage->draw_instance_bounds.clear();
+
+	for ( size_t i = 0; i != items.size(); i++ ) {
+
+		le_draw_item_o const& item = items[ i ];
+
+		bool const starts_batch = ( i == 0 ) || item.unique_key || draw_item_less( items[ i - 1 ], item );
+
+		if ( starts_batch ) {
+			le_draw_batch_o batch;
+			batch.scene          = &stage->scenes[ item.scene_idx ];
+			batch.node           = item.node;
+			batch.primitive      = &stage->meshes[ item.mesh_idx ].primitives[ item.primitive_idx ];
+			batch.first_instance = uint32_t( stage->draw_instances.size() );
+			batch.instance_count = 0;
+			stage->draw_batches.push_back( batch );
+		}
+
+		le_draw_instance_o instance;
+		instance.model_matrix  = node_get_global_transform( stage, item.node );
+		instance.normal_matrix = glm::transpose( node_get_inverse_global_transform( stage, item.node ) ); // only calculated for nodes which we draw
+
+		stage->draw_instances.push_back( instance );
+		stage->draw_instance_bounds.push_back( item.node->has_world_bounds ? item.node->world_bounding_sphere : glm::vec4( 0, 0, 0, -1 ) );
+		stage->draw_batches.back().instance_count++;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief builds one deform job for every deformed primitive of every node which is
+/// part of a scene, and calculates joint matrices for all skinned nodes into a
+/// single joint palette.
+/// \details Jobs for the deformed primitives of a node are stored contiguously, in
+/// order of their deform slot, starting at the node's deform_job_idx.
+static void stage_build_deform_jobs( le_stage_o* stage ) {
+
+	stage->deform_jobs.clear();
+	stage->joint_palette.clear();
+	stage->deformed_vertex_count = 0;
+
+	for ( le_node_o* n : stage->nodes ) {
+
+		n->deform_job_idx = NO_DEFORM_JOB;
+
+		if ( !n->has_mesh || n->transform_idx == NO_TRANSFORM_IDX ) {
+			continue;
+		}
+
+		auto& mesh = stage->meshes[ n->mesh_idx ];
+
+		if ( 0 == mesh.deformed_primitive_count ) {
+			continue;
+		}
+
+		// ----------| invariant: node has at least one deformed primitive
+
+		uint32_t joint_offset = 0;
+
+		if ( n->skin ) {
+
+			// Calculate joint matrices for all joints of this node's skin, followed
+			// by their normal matrices.
+			//
+			// TODO: if skin has a skeleton, it should be possible to cache skin data -
+			// because it won't change based on what node it is associated to.
+			//
+			// Q: What does GLTF specify must happen if a skin does not specify its skeleton property
+			// A: This is not really well defined.
+			//
+			glm::mat4 const& rootInv =
+			    n->skin->skeleton
+			        ? node_get_inverse_global_transform( stage, n->skin->skeleton )
+			        : node_get_inverse_global_transform( stage, n );
+
+			joint_offset = uint32_t( stage->joint_palette.size() / 2 );
+
+			for ( size_t i = 0; i != n->skin->joints.size(); i++ ) {
+				glm::mat4 const joint_matrix =
+				    rootInv *
+				    node_get_global_transform( stage, n->skin->joints[ i ] ) *
+				    n->skin->inverse_bind_matrices[ i ];
+
+				stage->joint_palette.push_back( joint_matrix );
+				stage->joint_palette.push_back( glm::transpose( glm::inverse( joint_matrix ) ) );
+			}
+		}
+
+		n->deform_job_idx = uint32_t( stage->deform_jobs.size() );
+
+		for ( auto& primitive : mesh.primitives ) {
+
+			if ( !primitive.is_deformed ) {
+				continue;
+			}
+
+			le_deform_job_o job;
+			job.node         = n;
+			job.primitive    = &primitive;
+			job.joint_offset = joint_offset;
+			job.first_vertex = stage->deformed_vertex_count;
+			job.is_active    = primitive.pipeline_state_handle && primitive_is_resident( stage, primitive );
+
+			if ( job.is_active ) {
+				stage->deformed_vertex_count += primitive.vertex_count;
+			}
+
+			stage->deform_jobs.push_back( job );
+		}
+	}
+
+	if ( stage->joint_palette.empty() ) {
+		// The deform pass always binds the joint palette, even if no node is skinned.
+		stage->joint_palette.push_back( glm::identity<glm::mat4>() );
+		stage->joint_palette.push_back( glm::identity<glm::mat4>() );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief skins and morphs vertices of all deformed primitives, one dispatch per deform job,
+/// into DEFORMED_VERTICES_HANDLE - from where the draw pass reads them as vertex attributes.
+static void pass_deform( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto draw_params = static_cast<le_stage_api::draw_params_t*>( user_data );
+	auto stage       = draw_params->stage;
+	auto encoder     = le::ComputeEncoder{ encoder_ };
+
+	static auto pso_deform =
+	    LeComputePipelineBuilder( encoder.getPipelineManager() )
+	        .setShaderStage(
+	            LeShaderModuleBuilder( encoder.getPipelineManager() )
+	                .setShaderStage( le::ShaderStage::eCompute )
+	                .setSourceFilePath( "./resources/shaders/le_stage/deform.glsl" )
+	                .build() )
+	        .build();
+
+	// Must match its namesake in deform.glsl, and obey std140 packing rules.
+
+	struct DeformParams {
+		uint32_t  vertex_count;
+		uint32_t  first_vertex;       // index of first output vertex
+		uint32_t  joint_offset;       // index of first joint into joint palette
+		uint32_t  num_joint_sets;     // 0 if vertices are not skinned
+		uint32_t  morph_target_count; //
+		uint32_t  padding[ 3 ];       //
+		glm::vec4 morph_weights[ 3 ]; // one float per morph target, tightly packed
+	};
+
+	static_assert( sizeof( DeformParams::morph_weights ) == sizeof( le_node_o::morph_target_weights ), "morph weights must match node morph target weights" );
+
+	encoder
+	    .bindComputePipeline( pso_deform )
+	    .setArgumentData( LE_ARGUMENT_NAME( "JointPalette" ), stage->joint_palette.data(), sizeof( glm::mat4 ) * stage->joint_palette.size() )
+	    .bindArgumentBuffer( LE_ARGUMENT_NAME( "DeformedVertices" ), DEFORMED_VERTICES_HANDLE );
+
+	// Each job writes to its own range of deformed vertices - we therefore
+	// don't need any barriers in between dispatches.
+
+	for ( auto const& job : stage->deform_jobs ) {
+
+		if ( !job.is_active ) {
+			continue;
+		}
+
+		le_primitive_o const& primitive = *job.primitive;
+
+		DeformParams params{};
+		params.vertex_count       = primitive.vertex_count;
+		params.first_vertex       = job.first_vertex;
+		params.joint_offset       = job.joint_offset;
+		params.num_joint_sets     = job.node->skin ? std::min( primitive.num_joints_sets, 2u ) : 0;
+		params.morph_target_count = std::min<uint32_t>( primitive.morph_target_count, sizeof( params.morph_weights ) / sizeof( float ) );
+
+		memcpy( params.morph_weights, job.node->morph_target_weights, sizeof( params.morph_weights ) );
+
+		encoder
+		    .bindArgumentBuffer( LE_ARGUMENT_NAME( "DeformSource" ), stage->buffers[ primitive.deform_source_buffer_idx ]->handle )
+		    .setArgumentData( LE_ARGUMENT_NAME( "DeformParams" ), &params, sizeof( DeformParams ) )
+		    .dispatch( ( params.vertex_count + 63 ) / 64, 1, 1 );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief culls the stage's draw list against the camera frustum.
+/// \details writes one indirect draw command per draw batch into INDIRECT_DRAWS_HANDLE,
+/// and the transforms of all visible instances, compacted per batch, into
+/// INSTANCE_TRANSFORMS_HANDLE. Instance count of each command is the number of
+/// visible instances in its batch.
+static void pass_cull( le_command_buffer_encoder_o* encoder_, void* user_data ) {
+	auto draw_params = static_cast<le_stage_api::draw_params_t*>( user_data );
+	auto camera      = draw_params->camera;
+	auto stage       = draw_params->stage;
+	auto encoder     = le::ComputeEncoder{ encoder_ };
+
+	static auto pso_cull =
+	    LeComputePipelineBuilder( encoder.getPipelineManager() )
+	        .setShaderStage(
+	            LeShaderModuleBuilder( encoder.getPipelineManager() )
+	                .setShaderStage( le::ShaderStage::eCompute )
+	                .setSourceFilePath( "./resources/shaders/le_stage/frustum_cull.glsl" )
+	                .build() )
+	        .build();
+
+	// The following must match their namesakes in frustum_cull.glsl, and obey std430 packing rules.
+
+	struct CullBatch {
+		uint32_t count;          // index count for indexed draws, vertex count otherwise
+		uint32_t first_instance; // index of first instance of this batch into instance transforms
+		uint32_t padding[ 2 ];   //
+	};
+
+	struct CullInstance {
+		glm::vec4 bounding_sphere; // xyz: centre in world space, w: radius; negative radius means never to cull
+		uint32_t  batch_idx;
+		uint32_t  padding[ 3 ];
+	};
+
+	struct CullParams {
+		glm::vec4 frustum_planes[ 6 ];
+		uint32_t  batch_count;
+		uint32_t  instance_count;
+		uint32_t  stage; // 0: reset draw commands, 1: cull and compact instances
+	};
+
+	CullParams params{};
+
+	// Planes which no sphere may fail - we use these until the draw pass has
+	// run at least once, as only then do we know the aspect ratio of the frustum.
+	for ( auto& p : params.frustum_planes ) {
+		p = glm::vec4( 0, 0, 0, 1 );
+	}
+
+	if ( stage->cull_w_over_h > 0.f ) {
+
+		// Note that the culling pass runs before the draw pass - which means
+		// that we use the camera viewport of the previous frame.
+
+		glm::mat4 camera_projection_matrix = glm::ortho( -0.5f, 0.5f, -0.5f, 0.5f, -1000.f, 1000.f );
+		glm::mat4 camera_view_matrix       = glm::identity<glm::mat4>();
+
+		if ( camera ) {
+			using namespace le_camera;
+			le_camera_i.get_view_matrix( camera, ( float* )( &camera_view_matrix ) );
+			le_camera_i.get_projection_matrix( camera, ( float* )( &camera_projection_matrix ) );
+		} else {
+			stage_get_camera( stage, 0, 0, stage->cull_w_over_h,
+			                  nullptr,
+			                  &camera_view_matrix,
+			                  &camera_projection_matrix );
+		}
+
+		frustum_planes_from_view_projection( camera_projection_matrix * camera_view_matrix, params.frustum_planes );
+	}
+
+	params.batch_count    = uint32_t( stage->draw_batches.size() );
+	params.instance_count = uint32_t( stage->draw_instances.size() );
+
+	if ( params.batch_count == 0 ) {
+		return;
+	}
+
+	std::vector<CullBatch>    cull_batches( params.batch_count );
+	std::vector<CullInstance> cull_instances( params.instance_count );
+
+	for ( uint32_t i = 0; i != params.batch_count; i++ ) {
+		auto const& batch = stage->draw_batches[ i ];
+
+		cull_batches[ i ].count          = batch.primitive->has_indices ? batch.primitive->index_count : batch.primitive->vertex_count;
+		cull_batches[ i ].first_instance = batch.first_instance;
+
+		for ( uint32_t j = batch.first_instance; j != batch.first_instance + batch.instance_count; j++ ) {
+			cull_instances[ j ].bounding_sphere = stage->draw_instance_bounds[ j ];
+			cull_instances[ j ].batch_idx       = i;
+		}
+	}
+
+	encoder
+	    .bindComputePipeline( pso_cull )
+	    .setArgumentData( LE_ARGUMENT_NAME( "CullBatches" ), cull_batches.data(), sizeof( CullBatch ) * cull_batches.size() )
+	    .setArgumentData( LE_ARGUMENT_NAME( "CullInstances" ), cull_instances.data(), sizeof( CullInstance ) * cull_instances.size() )
+	    .setArgumentData( LE_ARGUMENT_NAME( "DrawInstances" ), stage->draw_instances.data(), sizeof( le_draw_instance_o ) * stage->draw_instances.size() )
+	    .bindArgumentBuffer( LE_ARGUMENT_NAME( "IndirectDraws" ), INDIRECT_DRAWS_HANDLE )
+	    .bindArgumentBuffer( LE_ARGUMENT_NAME( "InstanceSSBO" ), INSTANCE_TRANSFORMS_HANDLE );
+
+	// -- Reset draw commands, so that every batch starts out with zero instances
+
+	params.stage = 0;
+
+	encoder
+	    .setArgumentData( LE_ARGUMENT_NAME( "CullParams" ), &params, sizeof( CullParams ) )
+	    .dispatch( ( params.batch_count + 63 ) / 64, 1, 1 );
+
+	encoder.bufferMemoryBarrier(
+	    le::PipelineStageFlags2( le::PipelineStageFlagBits2::eComputeShader ),
+	    le::PipelineStageFlags2( le::PipelineStageFlagBits2::eComputeShader ),
+	    le::AccessFlagBits2::eShaderStorageRead | le::AccessFlagBits2::eShaderStorageWrite,
+	    INDIRECT_DRAWS_HANDLE );
+
+	// -- Cull instances, and append transforms of visible instances to their batch
+
+	params.stage = 1;
+
+	encoder
+	    .setArgumentData( LE_ARGUMENT_NAME( "CullParams" ), &params, sizeof( CullParams ) )
+	    .dispatch( ( params.instance_count + 63 ) / 64, 1, 1 );
+}
+
+// ----------------------------------------------------------------------
+
 static void pass_draw( le_command_buffer_encoder_o* encoder_, void* user_data ) {
 	auto draw_params = static_cast<le_stage_api::draw_params_t*>( user_data );
 	auto camera      = draw_params->camera;
 	auto stage       = draw_params->stage;
 	auto encoder     = le::Encoder{ encoder_ };
-
-	static auto logger  = LeLog( LOGGER_LABEL );
-	auto        extents = encoder.getRenderpassExtent();
+	auto extents     = encoder.getRenderpassExtent();
 
 	le::Viewport viewports[ 2 ] = {
 	    { 0.f, float( extents.height ), float( extents.width ), -float( extents.height ), -0.f, 1.f }, // negative viewport means to flip y axis in screen space
@@ -1806,17 +2865,31 @@ static void pass_draw( le_command_buffer_encoder_o* encoder_, void* user_data )
 	glm::vec4 camera_in_world_space = camera_world_matrix * glm::vec4{ 0, 0, 0, 1 };
 	camera_in_world_space /= camera_in_world_space.w;
 
+	// Model and normal matrices are given per instance, via InstanceSSBO.
 	struct UboMatrices {
 		glm::mat4 viewProjectionMatrix; // (projection * view) matrix
-		glm::mat4 normalMatrix;         // given in world-space, which means normalmatrix does not depend on camera, but is transpose(inverse(globalMatrix))
-		glm::mat4 modelMatrix;
-		glm::vec3 camera_position; // camera position in world space
+		glm::vec3 camera_position;      // camera position in world space
 	};
 
 	UboMatrices mvp_ubo;
 	mvp_ubo.viewProjectionMatrix = camera_projection_matrix * camera_view_matrix;
 	mvp_ubo.camera_position      = camera_in_world_space;
 
+	// Remember aspect ratio, so that the gpu culling pass can reconstruct the frustum.
+	stage->cull_w_over_h = float( extents.width ) / float( extents.height );
+
+	// Remember camera position, so that uploads for next frames can prioritise
+	// resources which are close to the camera.
+	stage->camera_position_hint = glm::vec3( camera_in_world_space );
+
+	if ( !stage->gpu_culling ) {
+		// If we cull on the gpu, the draw list was built in draw_into_module,
+		// as the culling pass, which runs before us, needs it, too.
+		glm::vec4 frustum_planes[ 6 ];
+		frustum_planes_from_view_projection( mvp_ubo.viewProjectionMatrix, frustum_planes );
+		stage_build_draw_list( stage, frustum_planes );
+	}
+
 	struct UboMaterialParams {
 		glm::vec4 base_color_factor{ 1, 1, 1, 1 }; // 4*4 = 16 byte alignment, which is largest alignment, and as such forms the struct's base alignment
 		float     metallic_factor{ 1 };            // 4 byte alignment, must be at mulitple of 4
@@ -1833,154 +2906,145 @@ static void pass_draw( le_command_buffer_encoder_o* encoder_, void* user_data )
 
 	UboPostProcessing post_processing_params{};
 
-	// We reserve pretty large amount of memory for joints data - so that we
-	// don't have to make allocations inside of the draw loop.
-	std::vector<glm::mat4> joints_data( 256 );
-	std::vector<glm::mat4> joints_normal_data( 256 );
+	// Draw batches are sorted by scene, pipeline, material, and primitive - we only
+	// update state when it changes from one batch to the next.
+	//
+	// Note that binding a different pipeline resets all arguments.
 
-	// if ( false )
-	for ( le_scene_o const& s : stage->scenes ) {
-		for ( le_node_o* n : stage->nodes ) {
+	le_scene_o const*     current_scene        = nullptr;
+	le_gpso_handle        current_pipeline     = nullptr;
+	uint32_t              current_material_idx = ~0u;
+	le_primitive_o const* current_primitive    = nullptr;
 
-			if ( ( n->scene_bit_flags & ( 1 << s.scene_id ) ) && n->has_mesh ) {
+	for ( uint32_t batch_idx = 0; batch_idx != stage->draw_batches.size(); batch_idx++ ) {
 
-				uint32_t joints_count = n->skin ? uint32_t( n->skin->joints.size() ) : 0;
+		le_draw_batch_o const& batch     = stage->draw_batches[ batch_idx ];
+		le_primitive_o const&  primitive = *batch.primitive;
+		le_node_o const*       n         = batch.node;
 
-				if ( joints_count ) {
-					// Calculate joints matrices for all given joints.
-					//
-					// TODO: if skin has a skeleton, it should be possible to cache skin data -
-					// because it won't change based on what node it is associated to.
-					// A skin ideally only needs to be calculated once, and should be re-used.
-					//
-					// Q: What does GLTF specify must happen if a skin does not specify its skeleton property
-					// A: This is not really well defined.
-					//
-					glm::mat4 const& rootInv =
-					    n->skin->skeleton
-					        ? n->skin->skeleton->inverse_global_transform
-					        : n->inverse_global_transform;
-
-					for ( size_t i = 0; i != n->skin->joints.size(); i++ ) {
-						joints_data[ i ] =
-						    rootInv *
-						    n->skin->joints[ i ]->global_transform *
-						    n->skin->inverse_bind_matrices[ i ];
-					}
+		if ( batch.scene != current_scene || primitive.pipeline_state_handle != current_pipeline ) {
 
-					// Calculate joints normals data - this is basically calculating the
-					// normal matrix for each of the world transform matrices in each joint.
-					for ( size_t i = 0; i != n->skin->joints.size(); i++ ) {
-						joints_normal_data[ i ] = transpose( inverse( joints_data[ i ] ) );
-					}
-				}
+			encoder
+			    .bindGraphicsPipeline( primitive.pipeline_state_handle )
+			    .setArgumentData( LE_ARGUMENT_NAME( "LightSSBO" ), batch.scene->lights.data(), sizeof( le_light_o ) * batch.scene->lights.size() )
+			    .setArgumentData( LE_ARGUMENT_NAME( "UboMatrices" ), &mvp_ubo, sizeof( UboMatrices ) )
+			    .setArgumentData( LE_ARGUMENT_NAME( "UboPostProcessing" ), &post_processing_params, sizeof( UboPostProcessing ) )
+			    .setViewports( 0, 1, &viewports[ 0 ] );
 
-				auto const& mesh = stage->meshes[ n->mesh_idx ];
-				for ( auto const& primitive : mesh.primitives ) {
+			if ( stage->gpu_culling ) {
+				// Culling pass wrote transforms of visible instances into this buffer,
+				// starting at each batch's first instance.
+				encoder.bindArgumentBuffer( LE_ARGUMENT_NAME( "InstanceSSBO" ), INSTANCE_TRANSFORMS_HANDLE );
+			}
 
-					if ( !primitive.pipeline_state_handle ) {
-						logger.error( "missing pipeline state object for primitive - did you call setup_pipelines on the stage after adding the mesh/primitive?" );
-						continue;
-					}
+			current_scene        = batch.scene;
+			current_pipeline     = primitive.pipeline_state_handle;
+			current_material_idx = ~0u;
+			current_primitive    = nullptr;
+		}
 
-					mvp_ubo.modelMatrix  = n->global_transform;
-					mvp_ubo.normalMatrix = glm::transpose( n->inverse_global_transform );
+		// The vertex shader reads instance transforms starting at `first_instance`.
+		// We can't pass this as the draw's firstInstance, since indirect draws may
+		// only use a non-zero firstInstance with drawIndirectFirstInstance enabled.
+		uint32_t first_instance = 0;
 
-					encoder
-					    .bindGraphicsPipeline( primitive.pipeline_state_handle )
-					    .setArgumentData( LE_ARGUMENT_NAME( "LightSSBO" ), s.lights.data(), sizeof( le_light_o ) * s.lights.size() )
-					    .setArgumentData( LE_ARGUMENT_NAME( "UboMatrices" ), &mvp_ubo, sizeof( UboMatrices ) )
-					    .setViewports( 0, 1, &viewports[ 0 ] );
+		if ( stage->gpu_culling ) {
+			first_instance = batch.first_instance;
+		} else {
+			encoder.setArgumentData( LE_ARGUMENT_NAME( "InstanceSSBO" ),
+			                         stage->draw_instances.data() + batch.first_instance,
+			                         sizeof( le_draw_instance_o ) * batch.instance_count );
+		}
 
-					if ( primitive.num_joints_sets && joints_count ) {
-						// we must apply joints matrices.
-						encoder.setArgumentData( LE_ARGUMENT_NAME( "UboJointMatrices" ), joints_data.data(), sizeof( glm::mat4 ) * joints_count );
-						encoder.setArgumentData( LE_ARGUMENT_NAME( "UboJointNormalMatrices" ), joints_normal_data.data(), sizeof( glm::mat4 ) * joints_count );
-					}
+		encoder.setPushConstantData( &first_instance, sizeof( first_instance ) );
 
-					if ( primitive.morph_target_count > 0 ) {
+		if ( primitive.has_material && primitive.material_idx != current_material_idx ) {
 
-						// This primitive has morph targets - we must upload the current weigths for the morph targets.
-						//
-						// NOTE: We upload the morph target weights tightly packed -
-						// this means the shader will receive them as vec4s, which
-						// every 4 floats (if available) grouped together into one vec4.
-						encoder.setArgumentData( LE_ARGUMENT_NAME( "UboMorphTargetWeights" ), n->morph_target_weights,
-						                         sizeof( glm::vec4 ) * ( ( primitive.morph_target_count + 3 ) / 4 ) );
-
-						if ( false ) {
-							std::ostringstream os;
-							os << "weights: " << std::dec;
-							for ( auto i = 0; i != primitive.morph_target_count; i++ ) {
-								os << std::setw( 8 ) << n->morph_target_weights[ i ] << ", ";
-							}
-							logger.info( os.str().c_str() );
-						}
-					}
+			auto const& material = stage->materials[ primitive.material_idx ];
 
-					if ( primitive.has_material ) {
+			{
+				// bind all textures
+				uint32_t tex_id = 0;
+				for ( auto const& tex : material.texture_handles ) {
+					encoder.setArgumentTexture( LE_ARGUMENT_NAME( "src_tex_unit" ), tex, tex_id++ );
+				}
+			}
 
-						auto const& material = stage->materials[ primitive.material_idx ];
+			if ( !material.cached_texture_params.empty() ) {
+				// has cached texture parameters
+				encoder.setArgumentData( LE_ARGUMENT_NAME( "UboTextureParams" ),
+				                         material.cached_texture_params.data(),
+				                         sizeof( le_material_o::UboTextureParamsSlice ) * material.cached_texture_params.size() );
+			}
 
-						{
-							// bind all textures
-							uint32_t tex_id = 0;
-							for ( auto const& tex : material.texture_handles ) {
-								encoder.setArgumentTexture( LE_ARGUMENT_NAME( "src_tex_unit" ), tex, tex_id++ );
-							}
-						}
+			if ( material.metallic_roughness ) {
+				auto&       mr         = material.metallic_roughness;
+				auto const& base_color = mr->base_color_factor;
 
-						if ( !material.cached_texture_params.empty() ) {
-							// has cached texture parameters
-							encoder.setArgumentData( LE_ARGUMENT_NAME( "UboTextureParams" ),
-							                         material.cached_texture_params.data(),
-							                         sizeof( le_material_o::UboTextureParamsSlice ) * material.cached_texture_params.size() );
-						}
+				material_params_ubo.base_color_factor =
+				    glm::vec4( base_color[ 0 ],
+				               base_color[ 1 ],
+				               base_color[ 2 ],
+				               base_color[ 3 ] );
 
-						if ( material.metallic_roughness ) {
-							auto&       mr         = material.metallic_roughness;
-							auto const& base_color = mr->base_color_factor;
+				material_params_ubo.metallic_factor  = mr->metallic_factor;
+				material_params_ubo.roughness_factor = mr->roughness_factor;
 
-							material_params_ubo.base_color_factor =
-							    glm::vec4( base_color[ 0 ],
-							               base_color[ 1 ],
-							               base_color[ 2 ],
-							               base_color[ 3 ] );
+				encoder.setArgumentData( LE_ARGUMENT_NAME( "UboMaterialParams" ),
+				                         &material_params_ubo, sizeof( UboMaterialParams ) );
+			}
 
-							material_params_ubo.metallic_factor  = mr->metallic_factor;
-							material_params_ubo.roughness_factor = mr->roughness_factor;
+			current_material_idx = primitive.material_idx;
+		}
 
-							encoder.setArgumentData( LE_ARGUMENT_NAME( "UboMaterialParams" ),
-							                         &material_params_ubo, sizeof( UboMaterialParams ) );
-						}
-					}
+		if ( &primitive != current_primitive ) {
 
-					encoder.setArgumentData( LE_ARGUMENT_NAME( "UboPostProcessing" ),
-					                         &post_processing_params, sizeof( UboPostProcessing ) );
+			// ---- invariant: primitive has pipeline, bindings.
 
-					// ---- invariant: primitive has pipeline, bindings.
+			encoder.bindVertexBuffers( 0, uint32_t( primitive.bindings_buffer_handles.size() ),
+			                           primitive.bindings_buffer_handles.data(),
+			                           primitive.bindings_buffer_offsets.data() );
 
-					encoder.bindVertexBuffers( 0, uint32_t( primitive.bindings_buffer_handles.size() ),
-					                           primitive.bindings_buffer_handles.data(),
-					                           primitive.bindings_buffer_offsets.data() );
+			if ( primitive.has_indices ) {
 
-					if ( primitive.has_indices ) {
+				auto& indices_accessor = stage->accessors[ primitive.indices_accessor_idx ];
+				auto& buffer_view      = stage->buffer_views[ indices_accessor.buffer_view_idx ];
+				auto& buffer           = stage->buffers[ buffer_view.buffer_idx ];
 
-						auto& indices_accessor = stage->accessors[ primitive.indices_accessor_idx ];
-						auto& buffer_view      = stage->buffer_views[ indices_accessor.buffer_view_idx ];
-						auto& buffer           = stage->buffers[ buffer_view.buffer_idx ];
+				encoder.bindIndexBuffer( buffer->handle,
+				                         buffer_view.byte_offset,
+				                         index_type_from_num_type( indices_accessor.component_type ) );
+			}
 
-						encoder.bindIndexBuffer( buffer->handle,
-						                         buffer_view.byte_offset,
-						                         index_type_from_num_type( indices_accessor.component_type ) );
+			current_primitive = &primitive;
+		}
 
-						encoder.drawIndexed( primitive.index_count );
-					} else {
+		if ( primitive.is_deformed ) {
+			// Deformed vertices replace binding 0 - batches of deformed primitives hold
+			// exactly one instance, so it's safe to use the deform job of the batch's node.
+			le_deform_job_o const& job    = stage->deform_jobs[ n->deform_job_idx + primitive.deform_slot ];
+			uint64_t const         offset = uint64_t( DEFORMED_VERTEX_STRIDE ) * job.first_vertex;
+			encoder.bindVertexBuffers( 0, 1, &DEFORMED_VERTICES_HANDLE, &offset );
+		}
 
-						encoder.draw( primitive.vertex_count );
-					}
+		if ( stage->gpu_culling ) {
+
+			// Culling pass writes one command per batch, using the layout of indexed
+			// draw commands, so that we may index commands the same way for both draw types.
+			uint64_t const indirect_draw_offset = sizeof( le::DrawIndexedIndirectCommand ) * batch_idx;
+
+			if ( primitive.has_indices ) {
+				encoder.drawIndexedIndirect( INDIRECT_DRAWS_HANDLE, indirect_draw_offset );
+			} else {
+				encoder.drawIndirect( INDIRECT_DRAWS_HANDLE, indirect_draw_offset, 1, sizeof( le::DrawIndexedIndirectCommand ) );
+			}
+
+		} else {
 
-				} // end for all mesh.primitives
+			if ( primitive.has_indices ) {
+				encoder.drawIndexed( primitive.index_count, batch.instance_count );
+			} else {
+				encoder.draw( primitive.vertex_count, batch.instance_count );
 			}
 		}
 	}
@@ -2132,48 +3196,302 @@ static void le_stage_draw_into_render_module( le_stage_api::draw_params_t* draw_
 				}
 			}
 
-			// -- Signal that we want to read from top-level acceleration structures.
+			// -- Signal that we want to read from top-level acceleration structures.
+
+			for ( auto const& s : draw_params->stage->scenes ) {
+				rtx_pass.useRtxTlasResource( s.rtx_tlas_handle );
+			}
+		}
+
+		rendergraph_i.add_renderpass( module, rtx_pass );
+	}
+
+#endif
+
+	auto stage_draw_pass =
+	    le::RenderPass( "Stage Draw", le::QueueFlagBits::eGraphics )
+	        .setExecuteCallback( draw_params, pass_draw )
+	        .addColorAttachment(
+	            color_attachment_image,
+	            le::ImageAttachmentInfoBuilder()
+	                .setColorClearValue( le::ClearValue( { 0.125f, 0.125f, 0.125f, 1.f } ) )
+	                .build() )
+	        .setSampleCount( le::SampleCountFlagBits::e4 );
+
+	if ( depth_stencil_attachment_image ) {
+		stage_draw_pass.addDepthStencilAttachment( depth_stencil_attachment_image );
+	}
+
+	{
+		auto stage = draw_params->stage;
+
+		// Skinned and morphed primitives are deformed once per frame, by a compute
+		// pass - every pass which draws them then reads the deformed vertices.
+		// Deform jobs must be built before the draw list, which refers to them.
+		stage_build_deform_jobs( stage );
+
+		if ( stage->deformed_vertex_count ) {
+
+			le_resource_info_t const deformed_vertices_info =
+			    le::BufferInfoBuilder()
+			        .setSize( DEFORMED_VERTEX_STRIDE * stage->deformed_vertex_count )
+			        .addUsageFlags( le::BufferUsageFlagBits::eStorageBuffer | le::BufferUsageFlagBits::eVertexBuffer )
+			        .build();
+
+			rendergraph_i.declare_resource( module, DEFORMED_VERTICES_HANDLE, deformed_vertices_info );
+
+			auto stage_deform_pass =
+			    le::RenderPass( "Stage Deform", le::QueueFlagBits::eCompute )
+			        .setExecuteCallback( draw_params, pass_deform )
+			        .useBufferResource( DEFORMED_VERTICES_HANDLE, le::AccessFlagBits2::eShaderStorageWrite );
+
+			for ( auto const& mesh : stage->meshes ) {
+				for ( auto const& primitive : mesh.primitives ) {
+					if ( primitive.is_deformed && primitive.is_resident ) {
+						stage_deform_pass.useBufferResource( stage->buffers[ primitive.deform_source_buffer_idx ]->handle, le::AccessFlagBits2::eShaderStorageRead );
+					}
+				}
+			}
+
+			rendergraph_i.add_renderpass( module, stage_deform_pass );
+
+			stage_draw_pass.useBufferResource( DEFORMED_VERTICES_HANDLE, le::AccessFlagBits2::eVertexAttributeRead );
+		}
+	}
+
+	if ( draw_params->stage->gpu_culling ) {
+
+		auto stage = draw_params->stage;
+
+		// The culling pass runs before the draw pass, and needs to know the draw
+		// list - we therefore must build the draw list here, without culling.
+		stage_build_draw_list( stage, nullptr );
+
+		if ( !stage->draw_batches.empty() ) {
+
+			le_resource_info_t const indirect_draws_info =
+			    le::BufferInfoBuilder()
+			        .setSize( uint32_t( sizeof( le::DrawIndexedIndirectCommand ) * stage->draw_batches.size() ) )
+			        .addUsageFlags( le::BufferUsageFlagBits::eStorageBuffer | le::BufferUsageFlagBits::eIndirectBuffer )
+			        .build();
+
+			le_resource_info_t const instance_transforms_info =
+			    le::BufferInfoBuilder()
+			        .setSize( uint32_t( sizeof( le_draw_instance_o ) * stage->draw_instances.size() ) )
+			        .addUsageFlags( le::BufferUsageFlagBits::eStorageBuffer )
+			        .build();
+
+			rendergraph_i.declare_resource( module, INDIRECT_DRAWS_HANDLE, indirect_draws_info );
+			rendergraph_i.declare_resource( module, INSTANCE_TRANSFORMS_HANDLE, instance_transforms_info );
+
+			auto stage_cull_pass =
+			    le::RenderPass( "Stage Cull", le::QueueFlagBits::eCompute )
+			        .setExecuteCallback( draw_params, pass_cull )
+			        .useBufferResource( INDIRECT_DRAWS_HANDLE, le::AccessFlagBits2::eShaderStorageRead, le::AccessFlagBits2::eShaderStorageWrite )
+			        .useBufferResource( INSTANCE_TRANSFORMS_HANDLE, le::AccessFlagBits2::eShaderStorageWrite );
+
+			rendergraph_i.add_renderpass( module, stage_cull_pass );
+
+			stage_draw_pass
+			    .useBufferResource( INDIRECT_DRAWS_HANDLE, le::AccessFlagBits2::eIndirectCommandRead )
+			    .useBufferResource( INSTANCE_TRANSFORMS_HANDLE, le::AccessFlagBits2::eShaderStorageRead );
+		}
+	}
+
+	for ( auto& b : draw_params->stage->buffers ) {
+		stage_draw_pass.useBufferResource( b->handle, le::BufferUsageFlagBits::eIndexBuffer | le::BufferUsageFlagBits::eVertexBuffer );
+	}
+
+	for ( auto& t : draw_params->stage->textures ) {
+		// We must create texture handles for this renderpass.
+		stage_draw_pass.sampleTexture(
+		    t.texture_handle, {
+		                          draw_params->stage->samplers[ t.sampler_idx ],             // samplerInfo
+		                          { draw_params->stage->images[ t.image_idx ]->handle, {} }, // imageViewInfo
+		                      } );
+	}
+
+	rendergraph_i.add_renderpass( module, stage_draw_pass );
+}
+
+/// \brief converts one accessor component to float - integer components are
+/// normalized if the accessor says so, otherwise converted as they are.
+template <typename T>
+static float accessor_component_to_float( char const* src, bool is_normalized ) {
+	T value;
+	memcpy( &value, src, sizeof( T ) );
+	if ( is_normalized && std::numeric_limits<T>::is_integer ) {
+		return std::max( float( value ) / float( std::numeric_limits<T>::max() ), -1.f );
+	}
+	return float( value );
+}
+
+/// \brief reads up to four components of element `idx` of an accessor into `out`.
+/// \return false if the accessor's buffer memory is not available anymore - which
+/// is the case once the buffer was uploaded.
+static bool accessor_read_element( le_stage_o const* stage, uint32_t accessor_idx, uint32_t idx, float out[ 4 ] ) {
+
+	le_accessor_o const&    accessor    = stage->accessors[ accessor_idx ];
+	le_buffer_view_o const& buffer_view = stage->buffer_views[ accessor.buffer_view_idx ];
+	le_buffer_o const*      buffer      = stage->buffers[ buffer_view.buffer_idx ];
+
+	if ( nullptr == buffer->mem ) {
+		return false;
+	}
+
+	uint32_t const component_size = size_of( accessor.component_type );
+	uint32_t const num_components = get_num_components( accessor.type );
+	uint32_t const stride         = buffer_view.byte_stride ? buffer_view.byte_stride : component_size * num_components;
+
+	char const* src = static_cast<char const*>( buffer->mem ) + buffer_view.byte_offset + accessor.byte_offset + size_t( stride ) * idx;
+
+	for ( uint32_t i = 0; i != std::min( num_components, 4u ); i++, src += component_size ) {
+		switch ( accessor.component_type ) {
+		case ( le_num_type::eF32 ): out[ i ] = accessor_component_to_float<float>( src, false ); break;
+		case ( le_num_type::eU8 ): out[ i ] = accessor_component_to_float<uint8_t>( src, accessor.is_normalized ); break;
+		case ( le_num_type::eI8 ): out[ i ] = accessor_component_to_float<int8_t>( src, accessor.is_normalized ); break;
+		case ( le_num_type::eU16 ): out[ i ] = accessor_component_to_float<uint16_t>( src, accessor.is_normalized ); break;
+		case ( le_num_type::eI16 ): out[ i ] = accessor_component_to_float<int16_t>( src, accessor.is_normalized ); break;
+		case ( le_num_type::eU32 ): out[ i ] = accessor_component_to_float<uint32_t>( src, accessor.is_normalized ); break;
+		default:
+			assert( false && "unsupported accessor component type" );
+		}
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief returns whether primitive has a (non-morph target) attribute of given type.
+static bool primitive_has_attribute( le_primitive_o const& primitive, le_primitive_attribute_info::Type type ) {
+	for ( auto const& attr : primitive.attributes ) {
+		if ( attr.type == type && !attr.morph.target.is_target ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief collects pointers to all attributes which the vertex shader reads directly from stage buffers.
+/// \details Vertex shaders for deformed primitives read positions, normals, and tangents from
+/// deformed vertices instead - and only the deform pass reads joints, weights, and morph targets.
+static void primitive_get_vertex_attributes( le_primitive_o const& primitive, std::vector<le_attribute_o const*>& attributes ) {
+
+	using Type = le_primitive_attribute_info::Type;
+
+	attributes.clear();
+
+	for ( auto const& attr : primitive.attributes ) {
+		if ( primitive.is_deformed &&
+		     ( attr.morph.target.is_target ||
+		       attr.type == Type::ePosition ||
+		       attr.type == Type::eNormal ||
+		       attr.type == Type::eTangent ||
+		       attr.type == Type::eJoints ||
+		       attr.type == Type::eJointWeights ) ) {
+			continue;
+		}
+		attributes.push_back( &attr );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief packs all vertex data which the deform pass reads for a skinned, or morphed
+/// primitive into a new stage buffer, and stores the index of this buffer with the primitive.
+/// \details Data is packed as vec4s - DEFORM_SOURCE_VEC4S per vertex, followed by
+/// DEFORM_TARGET_VEC4S per vertex for each morph target. Joint indices are stored as
+/// uints. This layout must match deform.glsl.
+/// \return false if vertex data could not be read, as it had been uploaded already.
+static bool primitive_pack_deform_source( le_stage_o* stage, le_primitive_o& primitive ) {
+
+	using Type = le_primitive_attribute_info::Type;
+
+	if ( primitive.attributes.empty() ) {
+		return false;
+	}
+
+	// Attributes are sorted by type - position attributes come first.
+	uint32_t const vertex_count = stage->accessors[ primitive.attributes.front().accessor_idx ].count;
+
+	std::vector<glm::vec4> data( size_t( vertex_count ) * ( DEFORM_SOURCE_VEC4S + DEFORM_TARGET_VEC4S * primitive.morph_target_count ), glm::vec4( 0 ) );
+
+	for ( auto const& attr : primitive.attributes ) {
+
+		size_t   first   = 0;                   // index of vec4 for first vertex
+		uint32_t stride  = DEFORM_SOURCE_VEC4S; // number of vec4s from one vertex to the next
+		bool     as_uint = false;               // whether to store components as uints
+
+		bool const is_joint_data = attr.type == Type::eJoints || attr.type == Type::eJointWeights;
+
+		if ( is_joint_data && ( attr.index > 1 || attr.morph.target.is_target ) ) {
+			continue; // we support at most two joints sets, which may not be morphed
+		}
+
+		if ( attr.morph.target.is_target ) {
+			first  = size_t( vertex_count ) * ( DEFORM_SOURCE_VEC4S + DEFORM_TARGET_VEC4S * attr.morph.target.idx );
+			stride = DEFORM_TARGET_VEC4S;
+		}
+
+		switch ( attr.type ) {
+		case ( Type::ePosition ):
+			break;
+		case ( Type::eNormal ):
+			first += 1;
+			break;
+		case ( Type::eTangent ):
+			first += 2;
+			break;
+		case ( Type::eJoints ):
+			first += 3 + attr.index;
+			as_uint = true;
+			break;
+		case ( Type::eJointWeights ):
+			first += 5 + attr.index;
+			break;
+		default:
+			continue; // all other attributes are read directly by the vertex shader
+		}
+
+		uint32_t const count = std::min( vertex_count, stage->accessors[ attr.accessor_idx ].count );
 
-			for ( auto const& s : draw_params->stage->scenes ) {
-				rtx_pass.useRtxTlasResource( s.rtx_tlas_handle );
-			}
-		}
+		for ( uint32_t v = 0; v != count; v++ ) {
 
-		rendergraph_i.add_renderpass( module, rtx_pass );
-	}
+			float element[ 4 ] = {};
 
-#endif
+			if ( !accessor_read_element( stage, attr.accessor_idx, v, element ) ) {
+				return false;
+			}
 
-	auto stage_draw_pass =
-	    le::RenderPass( "Stage Draw", le::QueueFlagBits::eGraphics )
-	        .setExecuteCallback( draw_params, pass_draw )
-	        .addColorAttachment(
-	            color_attachment_image,
-	            le::ImageAttachmentInfoBuilder()
-	                .setColorClearValue( le::ClearValue( { 0.125f, 0.125f, 0.125f, 1.f } ) )
-	                .build() )
-	        .setSampleCount( le::SampleCountFlagBits::e4 );
+			glm::vec4& dst = data[ first + size_t( stride ) * v ];
 
-	if ( depth_stencil_attachment_image ) {
-		stage_draw_pass.addDepthStencilAttachment( depth_stencil_attachment_image );
+			if ( as_uint ) {
+				for ( uint32_t i = 0; i != 4; i++ ) {
+					uint32_t joint_idx = uint32_t( element[ i ] );
+					memcpy( &dst[ i ], &joint_idx, sizeof( uint32_t ) );
+				}
+			} else {
+				dst = glm::vec4( element[ 0 ], element[ 1 ], element[ 2 ], element[ 3 ] );
+			}
+		}
 	}
 
-	for ( auto& b : draw_params->stage->buffers ) {
-		stage_draw_pass.useBufferResource( b->handle, le::BufferUsageFlagBits::eIndexBuffer | le::BufferUsageFlagBits::eVertexBuffer );
-	}
+	primitive.deform_source_buffer_idx = le_stage_create_buffer( stage, data.data(), uint32_t( sizeof( glm::vec4 ) * data.size() ), "deform_source" );
 
-	for ( auto& t : draw_params->stage->textures ) {
-		// We must create texture handles for this renderpass.
-		stage_draw_pass.sampleTexture(
-		    t.texture_handle, {
-		                          draw_params->stage->samplers[ t.sampler_idx ],             // samplerInfo
-		                          { draw_params->stage->images[ t.image_idx ]->handle, {} }, // imageViewInfo
-		                      } );
-	}
+	// The deform pass reads this buffer as a storage buffer.
+	le_buffer_o* buffer   = stage->buffers[ primitive.deform_source_buffer_idx ];
+	buffer->resource_info = le::BufferInfoBuilder( buffer->resource_info )
+	                            .addUsageFlags( le::BufferUsageFlags( le::BufferUsageFlagBits::eStorageBuffer ) )
+	                            .build();
 
-	rendergraph_i.add_renderpass( module, stage_draw_pass );
+	return true;
 }
 
+// ----------------------------------------------------------------------
+
 /// \brief initialises pipeline state objects associated with each primitive
 /// \details pipeline contains materials, vertex and index binding information on each primitive.
 /// this will also cache handles for vertex and index data with each primitive.
@@ -2289,26 +3607,47 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 		materials_defines_hash_to_defines_str.insert( { defines_hash, std::move( defines_str ) } );
 	}
 
+	// -- Pack vertex data for skinned, and morphed primitives, so that the deform pass
+	//    may read it. We must do this before buffers are uploaded, as we read from
+	//    buffer memory, which we release once a buffer was uploaded.
+
+	for ( auto& mesh : stage->meshes ) {
+		for ( auto& primitive : mesh.primitives ) {
+			if ( primitive.is_deformed && primitive.deform_source_buffer_idx == ~0u &&
+			     !primitive_pack_deform_source( stage, primitive ) ) {
+				logger.error( "could not read vertex data for skinned, or morphed primitive - call setup_pipelines before drawing the stage." );
+			}
+		}
+	}
+
 	// -- Then build a map of all vertex input defines per primitive
 
+	std::vector<le_attribute_o const*> vertex_attributes; // scratch: attributes which the vertex shader reads from stage buffers
+
 	for ( auto& mesh : stage->meshes ) {
 
 		for ( auto& primitive : mesh.primitives ) {
 
 			std::stringstream defines;
 
-			auto const attr_begin = primitive.attributes.data();
-			auto const attr_end   = attr_begin + primitive.attributes.size();
+			primitive_get_vertex_attributes( primitive, vertex_attributes );
 
-			{
-				// Find out if the primitive has morph targets - as this will
-				// inform the number of locations which each attribute occupies.
-				//
-				uint32_t morph_target_count = uint32_t( primitive.morph_target_count );
-				uint32_t location           = 0; // current location for attribute.
+			auto const attr_begin = vertex_attributes.data();
+			auto const attr_end   = attr_begin + vertex_attributes.size();
 
-				if ( morph_target_count ) {
-					defines << "MORPH_TARGET_COUNT=" << morph_target_count << ",";
+			{
+				uint32_t location = 0; // current location for attribute.
+
+				if ( primitive.is_deformed ) {
+					// Deformed positions, normals, and tangents come first, interleaved
+					// in the first binding - the deform pass writes them.
+					defines << "LOC_POSITIONS=" << location++ << ",NUM_POSITIONS=1,";
+					if ( primitive_has_attribute( primitive, le_primitive_attribute_info::Type::eNormal ) ) {
+						defines << "LOC_NORMALS=" << location++ << ",NUM_NORMALS=1,";
+					}
+					if ( primitive_has_attribute( primitive, le_primitive_attribute_info::Type::eTangent ) ) {
+						defines << "LOC_TANGENTS=" << location++ << ",NUM_TANGENTS=1,";
+					}
 				}
 
 				// TODO: check number of requested locations against device limits.
@@ -2322,30 +3661,21 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 					// (this gives us the array size per attribute)
 
 					uint32_t num_array_elements = 0;
-					for ( auto a = attr; a != attr_end && a->type == attr->type; a++, num_array_elements++ ) {
+					for ( auto a = attr; a != attr_end && ( *a )->type == ( *attr )->type; a++, num_array_elements++ ) {
 					}
 
-					switch ( attr->type ) {
+					switch ( ( *attr )->type ) {
 					case ( le_primitive_attribute_info::Type::ePosition ):
 						defines << "LOC_POSITIONS=" << location << ",";
 						defines << "NUM_POSITIONS=" << num_array_elements << ",";
-						if ( num_array_elements > 1 ) {
-							assert( num_array_elements == ( morph_target_count + 1 ) && "number of array elements must match 1 + morph_target_count" );
-						}
 						break;
 					case ( le_primitive_attribute_info::Type::eNormal ):
 						defines << "LOC_NORMALS=" << location << ",";
 						defines << "NUM_NORMALS=" << num_array_elements << ",";
-						if ( num_array_elements > 1 ) {
-							assert( num_array_elements == ( morph_target_count + 1 ) && "number of array elements must match 1 + morph_target_count" );
-						}
 						break;
 					case ( le_primitive_attribute_info::Type::eTangent ):
 						defines << "LOC_TANGENTS=" << location << ",";
 						defines << "NUM_TANGENTS=" << num_array_elements << ",";
-						if ( num_array_elements > 1 ) {
-							assert( num_array_elements == ( morph_target_count + 1 ) && "number of array elements must match 1 + morph_target_count" );
-						}
 						break;
 					case ( le_primitive_attribute_info::Type::eTexcoord ):
 						defines << "LOC_TEXCOORDS=" << location << ",";
@@ -2355,14 +3685,6 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 						defines << "LOC_COLORS=" << location << ",";
 						defines << "NUM_COLORS=" << num_array_elements << ",";
 						break;
-					case ( le_primitive_attribute_info::Type::eJoints ):
-						defines << "LOC_JOINT_SETS=" << location << ",";
-						defines << "NUM_JOINT_SETS=" << num_array_elements << ",";
-						break;
-					case ( le_primitive_attribute_info::Type::eJointWeights ):
-						defines << "LOC_JOINT_WEIGHTS_SET=" << location << ",";
-						defines << "NUM_JOINT_WEIGHTS_SET=" << num_array_elements << ",";
-						break;
 					default:
 						break;
 					}
@@ -2422,6 +3744,12 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 
 		for ( auto& primitive : mesh.primitives ) {
 
+			if ( primitive.is_deformed && primitive.deform_source_buffer_idx == ~0u ) {
+				// We could not pack vertex data for the deform pass, see above - there
+				// is no way for us to draw this primitive.
+				continue;
+			}
+
 			if ( !primitive.pipeline_state_handle ) {
 
 				// We must create a graphics pipeline state object (GPSO) for this primitive.
@@ -2490,10 +3818,35 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 				// A: yes, in that case multiple accessors may refer to the same bufferView, in which case each accessor
 				//    defines a byteOffset to specify where it starts within the bufferView.
 
+				if ( primitive.is_deformed ) {
+
+					// Deformed vertices go first - their buffer offset depends on the node
+					// which draws the primitive, we therefore only set it when drawing.
+
+					auto& binding = abs.addBinding( uint16_t( DEFORMED_VERTEX_STRIDE ) );
+
+					binding.addAttribute( 0, le_num_type::eF32, 3 ); // position
+
+					if ( primitive_has_attribute( primitive, le_primitive_attribute_info::Type::eNormal ) ) {
+						binding.addAttribute( 12, le_num_type::eF32, 3 );
+					}
+
+					if ( primitive_has_attribute( primitive, le_primitive_attribute_info::Type::eTangent ) ) {
+						binding.addAttribute( 24, le_num_type::eF32, 4 );
+					}
+
+					binding.end();
+
+					primitive.bindings_buffer_handles.push_back( DEFORMED_VERTICES_HANDLE );
+					primitive.bindings_buffer_offsets.push_back( 0 );
+				}
+
+				primitive_get_vertex_attributes( primitive, vertex_attributes );
+
 				// Note: iterator is increased in inner do-while loop
-				for ( auto it = primitive.attributes.begin(); it != primitive.attributes.end(); ) {
+				for ( auto it = vertex_attributes.begin(); it != vertex_attributes.end(); ) {
 
-					le_accessor_o const* accessor        = &stage->accessors[ it->accessor_idx ];
+					le_accessor_o const* accessor        = &stage->accessors[ ( *it )->accessor_idx ];
 					auto const&          buffer_view     = stage->buffer_views[ accessor->buffer_view_idx ];
 					uint32_t             buffer_view_idx = accessor->buffer_view_idx;
 
@@ -2528,11 +3881,11 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 						it++;
 
 						// prepare accessor for next iteration.
-						if ( it != primitive.attributes.end() ) {
-							accessor = &stage->accessors[ it->accessor_idx ];
+						if ( it != vertex_attributes.end() ) {
+							accessor = &stage->accessors[ ( *it )->accessor_idx ];
 						}
 
-					} while ( it != primitive.attributes.end() &&
+					} while ( it != vertex_attributes.end() &&
 					          buffer_view_idx == accessor->buffer_view_idx );
 
 					// Cache binding for primitive so that we can bind faster.
@@ -2619,46 +3972,78 @@ static void le_stage_setup_pipelines( le_stage_o* stage ) {
 
 // ----------------------------------------------------------------------
 
-template <typename T>
-void lerp_animation_target( T* target, T const& val_previous, T const& val_next, float norm_t ) {
-	T blend = glm::mix( val_previous, val_next, norm_t );
-	if ( target ) {
-		*target = blend;
+/// \brief returns index of first keyframe in channel which is at, or after ticks -
+/// this is the keyframe towards which we interpolate. Returns 0 if ticks lies
+/// beyond the last keyframe.
+/// \details Animations mostly play forward, we therefore first check whether the
+/// keyframe from the previous update, or the one after it still matches, and only
+/// fall back to a binary search if neither does.
+static uint32_t channel_find_next_key( le_animation_channel_o& channel, uint64_t ticks ) {
+
+	uint64_t const* key_ticks = channel.key_ticks.data();
+	uint32_t const  num_keys  = uint32_t( channel.key_ticks.size() );
+
+	if ( ticks > key_ticks[ num_keys - 1 ] ) {
+		return 0;
+	}
+
+	// ----------| invariant: there is a keyframe at, or after ticks
+
+	auto is_next_key = [ & ]( uint32_t k ) -> bool {
+		return k < num_keys && key_ticks[ k ] >= ticks && ( k == 1 || key_ticks[ k - 1 ] < ticks );
+	};
+
+	if ( is_next_key( channel.cursor ) ) {
+		return channel.cursor;
+	}
+
+	if ( is_next_key( channel.cursor + 1 ) ) {
+		return ++channel.cursor;
+	}
+
+	channel.cursor = uint32_t( std::lower_bound( key_ticks + 1, key_ticks + num_keys, ticks ) - key_ticks );
+
+	return channel.cursor;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief adds one lane to batch.
+static void animation_batch_push( le_animation_batch_o& batch, float* target, float const* a, float const* b, uint32_t num_components, float t ) {
+	batch.targets.push_back( target );
+	batch.t.push_back( t );
+	for ( uint32_t c = 0; c != num_components; c++ ) {
+		batch.a[ c ].push_back( a[ c ] );
+		batch.b[ c ].push_back( b[ c ] );
 	}
 }
 
-// Quaternions need to be slerped instead of mixed. They also must be normalised before application.
-template <>
-void lerp_animation_target<glm::quat>( glm::quat* target, glm::quat const& val_previous, glm::quat const& val_next, float norm_t ) {
-	glm::quat blend = glm::slerp( val_previous, val_next, norm_t );
-	blend           = glm::normalize( blend );
-	if ( target ) {
-		*target = blend;
+// ----------------------------------------------------------------------
+
+static void animation_batch_clear( le_animation_batch_o& batch ) {
+	batch.targets.clear();
+	batch.t.clear();
+	for ( uint32_t c = 0; c != 4; c++ ) {
+		batch.a[ c ].clear();
+		batch.b[ c ].clear();
 	}
 }
 
 // ----------------------------------------------------------------------
 
-static void apply_animation_channel( le_animation_channel_o const& channel, uint64_t ticks ) {
+/// \brief finds the keyframes which bracket ticks for channel, and adds their
+/// values to the batch which matches the channel's target type.
+static void gather_animation_channel( le_stage_o* stage, le_animation_channel_o& channel, uint64_t ticks ) {
 
-	if ( channel.sampler.size() < 2 ) {
+	if ( channel.key_ticks.size() < 2 ) {
 		return;
 	}
 
 	// -------- invariant: sampler has at least two elements.
 
-	le_keyframe_o const* sampler_begin = channel.sampler.data();
-	le_keyframe_o const* sampler_end   = sampler_begin + channel.sampler.size();
+	uint32_t const next_idx = channel_find_next_key( channel, ticks );
 
-	le_keyframe_o const* previous_key = sampler_begin;
-	le_keyframe_o const* next_key     = sampler_begin + 1;
-
-	while ( ( next_key->delta_ticks < ticks ) && ( next_key + 1 != sampler_end ) ) {
-		std::swap( previous_key, next_key );
-		next_key++;
-	}
-
-	if ( ticks > next_key->delta_ticks ) {
+	if ( next_idx == 0 ) {
 		// we're done here.
 
 		// TODO:
@@ -2669,52 +4054,44 @@ static void apply_animation_channel( le_animation_channel_o const& channel, uint
 		return;
 	}
 
-	float norm_t = 0.f; // normalised time in domain [previous_key..[next_key
+	le_keyframe_o const& previous_key = channel.sampler[ next_idx - 1 ];
+	le_keyframe_o const& next_key     = channel.sampler[ next_idx ];
 
-	// -- calculate normalised time.
+	// -- calculate normalised time in domain [previous_key..[next_key
 
-	norm_t = ( ticks - previous_key->delta_ticks ) /
-	         float( next_key->delta_ticks - previous_key->delta_ticks );
+	float norm_t = float( int64_t( ticks - previous_key.delta_ticks ) ) /
+	               float( next_key.delta_ticks - previous_key.delta_ticks );
 
 	norm_t = glm::clamp( norm_t, 0.f, 1.f );
 
-	// apply data to node pointed in channel, based on type.
+	assert( previous_key.array_size == next_key.array_size && "keys must have same array size" );
 
-	assert( previous_key->array_size == next_key->array_size && "keys must have same array size" );
+	float* target = static_cast<float*>( channel.target_node_element );
 
 	switch ( channel.target_compound_type ) {
 	case ( le_compound_num_type::eScalar ): {
-		for ( size_t i = 0; i != previous_key->array_size; i++ ) {
-			// If more than one scalar element, this most likely means that
-			// we're updating weights.
-			lerp_animation_target<float>( static_cast<float*>( channel.target_node_element ) + i,
-			                              previous_key->data.as_scalar[ i ], next_key->data.as_scalar[ i ], norm_t );
+		// If more than one scalar element, this most likely means that
+		// we're updating weights - each weight gets its own lane.
+		for ( uint32_t i = 0; i != previous_key.array_size; i++ ) {
+			animation_batch_push( stage->animation_batches[ ANIMATION_BATCH_SCALAR ], target + i,
+			                      &previous_key.data.as_scalar[ i ], &next_key.data.as_scalar[ i ], 1, norm_t );
 		}
 		break;
 	}
-	case ( le_compound_num_type::eVec2 ): {
-		lerp_animation_target<glm::vec2>( static_cast<glm::vec2*>( channel.target_node_element ),
-		                                  previous_key->data.as_vec2[ 0 ], next_key->data.as_vec2[ 0 ], norm_t );
-		break;
-	}
 	case ( le_compound_num_type::eVec3 ): {
-		lerp_animation_target<glm::vec3>( static_cast<glm::vec3*>( channel.target_node_element ),
-		                                  previous_key->data.as_vec3[ 0 ], next_key->data.as_vec3[ 0 ], norm_t );
-		break;
-	}
-	case ( le_compound_num_type::eVec4 ): {
-		lerp_animation_target<glm::vec4>( static_cast<glm::vec4*>( channel.target_node_element ),
-		                                  previous_key->data.as_vec4[ 0 ], next_key->data.as_vec4[ 0 ], norm_t );
+		animation_batch_push( stage->animation_batches[ ANIMATION_BATCH_VEC3 ], target,
+		                      &previous_key.data.as_vec3[ 0 ][ 0 ], &next_key.data.as_vec3[ 0 ][ 0 ], 3, norm_t );
 		break;
 	}
 	case ( le_compound_num_type::eQuat4 ): {
 		// note that we distinguish between quat and vec, because interpolation type is different
-		lerp_animation_target<glm::quat>( static_cast<glm::quat*>( channel.target_node_element ),
-		                                  previous_key->data.as_quat[ 0 ], next_key->data.as_quat[ 0 ], norm_t );
+		animation_batch_push( stage->animation_batches[ ANIMATION_BATCH_QUAT ], target,
+		                      &previous_key.data.as_quat[ 0 ][ 0 ], &next_key.data.as_quat[ 0 ][ 0 ], 4, norm_t );
 		break;
 	}
 	default:
-		break;
+		assert( false && "animation target type not supported" );
+		return;
 	}
 
 	channel.target_node->local_transform_cached = false;
@@ -2722,12 +4099,292 @@ static void apply_animation_channel( le_animation_channel_o const& channel, uint
 
 // ----------------------------------------------------------------------
 
-static void traverse_node( le_node_o* parent ) {
-	for ( le_node_o* c : parent->children ) {
-		c->global_transform         = parent->global_transform * c->local_transform;
-		c->inverse_global_transform = glm::inverse( c->global_transform );
-		traverse_node( c );
-		c->global_transform_chached = true;
+/// \brief linearly interpolates all lanes in batch, and writes results to lane targets.
+/// \details loops run over plain float arrays, so that the compiler may vectorise them.
+static void evaluate_lerp_batch( le_animation_batch_o& batch, uint32_t num_components ) {
+
+	size_t const num_lanes = batch.t.size();
+	float const* t         = batch.t.data();
+
+	for ( uint32_t c = 0; c != num_components; c++ ) {
+		float*       a = batch.a[ c ].data();
+		float const* b = batch.b[ c ].data();
+		for ( size_t i = 0; i != num_lanes; i++ ) {
+			a[ i ] = a[ i ] * ( 1.f - t[ i ] ) + b[ i ] * t[ i ]; // same as glm::mix
+		}
+	}
+
+	for ( size_t i = 0; i != num_lanes; i++ ) {
+		for ( uint32_t c = 0; c != num_components; c++ ) {
+			batch.targets[ i ][ c ] = batch.a[ c ][ i ];
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief spherically interpolates quaternion lanes, and normalises results - results are written to `a`.
+/// \details We approximate slerp by normalised linear interpolation with a corrected
+/// interpolation parameter, see: Arseny Kapoulkine, "Approximating slerp" (2015).
+/// Unlike exact slerp, this needs neither `acos` nor `sin`, nor any branches, so that
+/// the compiler may vectorise the loop. Maximum angular error against exact slerp is
+/// below 0.1 degrees, and shrinks as quaternions move closer together.
+///
+/// Parameters are `__restrict`, as otherwise the compiler would have to check all
+/// pairs of arrays for overlap, and would give up on vectorising. Note that `sqrtf`
+/// only vectorises if math functions are not required to set `errno` - which is
+/// why this module gets compiled with `-fno-math-errno`.
+static void slerp_lanes( size_t const num_lanes, float const* __restrict t,
+                         float* __restrict a0, float* __restrict a1, float* __restrict a2, float* __restrict a3,
+                         float const* __restrict b0, float const* __restrict b1, float const* __restrict b2, float const* __restrict b3 ) {
+
+	for ( size_t i = 0; i != num_lanes; i++ ) {
+
+		float const cos_theta = a0[ i ] * b0[ i ] + a1[ i ] * b1[ i ] + a2[ i ] * b2[ i ] + a3[ i ] * b3[ i ];
+		float const d         = fabsf( cos_theta );
+
+		// Correct t so that nlerp moves at (almost) constant angular velocity, like slerp.
+		float const k_a = 1.0904f + d * ( -3.2452f + d * ( 3.55645f - d * 1.43519f ) );
+		float const k_b = 0.848013f + d * ( -1.06021f + d * 0.215638f );
+		float const u   = t[ i ] - 0.5f;
+		float const k   = k_a * u * u + k_b;
+		float const t_c = t[ i ] + t[ i ] * u * ( t[ i ] - 1.f ) * k;
+
+		// If cos_theta < 0, interpolate towards -b, so that we take the shorter path.
+		float const w_a = 1.f - t_c;
+		float const w_b = copysignf( t_c, cos_theta );
+
+		float const r0 = w_a * a0[ i ] + w_b * b0[ i ];
+		float const r1 = w_a * a1[ i ] + w_b * b1[ i ];
+		float const r2 = w_a * a2[ i ] + w_b * b2[ i ];
+		float const r3 = w_a * a3[ i ] + w_b * b3[ i ];
+
+		float const inv_len = 1.f / sqrtf( r0 * r0 + r1 * r1 + r2 * r2 + r3 * r3 );
+
+		a0[ i ] = r0 * inv_len;
+		a1[ i ] = r1 * inv_len;
+		a2[ i ] = r2 * inv_len;
+		a3[ i ] = r3 * inv_len;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief spherically interpolates all quaternion lanes in batch, normalises results,
+/// and writes them to lane targets.
+static void evaluate_slerp_batch( le_animation_batch_o& batch ) {
+
+	size_t const num_lanes = batch.t.size();
+
+	float* a0 = batch.a[ 0 ].data();
+	float* a1 = batch.a[ 1 ].data();
+	float* a2 = batch.a[ 2 ].data();
+	float* a3 = batch.a[ 3 ].data();
+
+	slerp_lanes( num_lanes, batch.t.data(),
+	             a0, a1, a2, a3,
+	             batch.b[ 0 ].data(), batch.b[ 1 ].data(), batch.b[ 2 ].data(), batch.b[ 3 ].data() );
+
+	for ( size_t i = 0; i != num_lanes; i++ ) {
+		float* target = batch.targets[ i ];
+		target[ 0 ]   = a0[ i ];
+		target[ 1 ]   = a1[ i ];
+		target[ 2 ]   = a2[ i ];
+		target[ 3 ]   = a3[ i ];
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void transform_hierarchy_append_subtree( le_transform_hierarchy_o& t, le_node_o* node, uint32_t parent_idx ) {
+
+	// A node may only appear once in the hierarchy - even if it is the root
+	// node of more than one scene.
+	if ( node->transform_idx != NO_TRANSFORM_IDX ) {
+		return;
+	}
+
+	uint32_t const idx = uint32_t( t.nodes.size() );
+
+	node->transform_idx = idx;
+
+	t.nodes.push_back( node );
+	t.parent_idx.push_back( parent_idx );
+	t.subtree_end.push_back( 0 ); // patched once all children have been appended
+
+	for ( le_node_o* c : node->children ) {
+		transform_hierarchy_append_subtree( t, c, idx );
+	}
+
+	t.subtree_end[ idx ] = uint32_t( t.nodes.size() );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief (re-)builds transform hierarchy from scene root nodes.
+/// \details all nodes are marked dirty, so that all global transforms are
+/// re-calculated on the next update.
+static void transform_hierarchy_rebuild( le_stage_o* self ) {
+	auto& t = self->transforms;
+
+	for ( le_node_o* n : self->nodes ) {
+		n->transform_idx          = NO_TRANSFORM_IDX;
+		n->local_transform_cached = false;
+	}
+
+	t.nodes.clear();
+	t.parent_idx.clear();
+	t.subtree_end.clear();
+	t.roots.clear();
+
+	for ( le_scene_o const& s : self->scenes ) {
+		for ( le_node_o* n : s.root_nodes ) {
+			if ( n->transform_idx == NO_TRANSFORM_IDX ) {
+				t.roots.push_back( uint32_t( t.nodes.size() ) );
+				transform_hierarchy_append_subtree( t, n, NO_TRANSFORM_IDX );
+			}
+		}
+	}
+
+	size_t const num_nodes = t.nodes.size();
+
+	t.local.assign( num_nodes, glm::identity<glm::mat4>() );
+	t.global.assign( num_nodes, glm::identity<glm::mat4>() );
+	t.inverse_global.assign( num_nodes, glm::identity<glm::mat4>() );
+	t.local_dirty.assign( num_nodes, 1 );
+	t.global_dirty.assign( num_nodes, 0 );
+	t.inverse_valid.assign( num_nodes, 0 );
+	t.subtree_dirty.assign( num_nodes, 1 );
+
+	t.is_valid = true;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief updates global transform for node at `idx`.
+/// \details parent of node, if any, must have been updated first.
+static inline void transform_hierarchy_update_node( le_transform_hierarchy_o* t, uint32_t idx ) {
+
+	uint32_t const parent = t->parent_idx[ idx ];
+	bool const     dirty  = t->local_dirty[ idx ] || ( parent != NO_TRANSFORM_IDX && t->global_dirty[ parent ] );
+
+	t->global_dirty[ idx ]  = dirty;
+	t->local_dirty[ idx ]   = false;
+	t->subtree_dirty[ idx ] = false;
+
+	if ( dirty ) {
+		t->global[ idx ]        = parent == NO_TRANSFORM_IDX ? t->local[ idx ] : t->global[ parent ] * t->local[ idx ];
+		t->inverse_valid[ idx ] = false;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief updates global transforms for nodes in range [begin, end).
+/// \details range must consist of complete subtrees, the parents of which (if any)
+/// must have been updated first. Subtrees which contain no dirty nodes, and the
+/// parent of which did not change, are skipped.
+static void transform_hierarchy_update_range( le_transform_hierarchy_o* t, uint32_t begin, uint32_t end ) {
+	for ( uint32_t i = begin; i != end; ) {
+
+		uint32_t const parent = t->parent_idx[ i ];
+
+		if ( !t->subtree_dirty[ i ] && ( parent == NO_TRANSFORM_IDX || !t->global_dirty[ parent ] ) ) {
+			i = t->subtree_end[ i ]; // nothing in this subtree changed
+			continue;
+		}
+
+		transform_hierarchy_update_node( t, i );
+		i++;
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void transform_update_job( void* user_data ) {
+	auto params = static_cast<le_transform_update_range_t*>( user_data );
+	transform_hierarchy_update_range( params->hierarchy, params->begin, params->end );
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief splits subtree at `idx`, which must need updating, into update ranges.
+/// \details subtrees small enough for one job become (or get appended to) a range.
+/// Larger subtrees have their top node updated right away, and are split further
+/// at their children, so that even a scene with a single root is updated in parallel.
+static void transform_hierarchy_split_subtree( le_transform_hierarchy_o* t, uint32_t idx ) {
+
+	uint32_t const end = t->subtree_end[ idx ];
+
+	if ( end - idx <= TRANSFORM_JOB_MIN_NODES ) {
+
+		// Consecutive subtrees are adjacent, so that we can merge them into one range.
+
+		auto& ranges = t->update_ranges;
+
+		if ( ranges.empty() ||
+		     ranges.back().end != idx ||
+		     ranges.back().end - ranges.back().begin >= TRANSFORM_JOB_MIN_NODES ) {
+			ranges.push_back( { t, idx, end } );
+		} else {
+			ranges.back().end = end;
+		}
+
+		return;
+	}
+
+	// ----------| invariant: subtree is too large for one job
+
+	transform_hierarchy_update_node( t, idx );
+
+	bool const node_changed = t->global_dirty[ idx ];
+
+	for ( uint32_t c = idx + 1; c != end; c = t->subtree_end[ c ] ) {
+		if ( node_changed || t->subtree_dirty[ c ] ) {
+			transform_hierarchy_split_subtree( t, c );
+		}
+	}
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief updates global transforms of all subtrees which contain dirty nodes.
+/// \details subtrees are independent once their parent has been updated, and are
+/// therefore updated in parallel, if the job system is available.
+static void transform_hierarchy_update( le_transform_hierarchy_o* t ) {
+
+	// -- Group dirty subtrees into ranges of at least TRANSFORM_JOB_MIN_NODES nodes,
+	// so that each job has enough work to be worth its overhead.
+
+	auto& ranges = t->update_ranges;
+	ranges.clear();
+
+	for ( uint32_t root : t->roots ) {
+		if ( t->subtree_dirty[ root ] ) {
+			transform_hierarchy_split_subtree( t, root );
+		}
+	}
+
+#if ( LE_MT > 0 )
+	if ( ranges.size() > 1 ) {
+
+		auto& jobs = t->update_jobs;
+		jobs.clear();
+
+		for ( auto& r : ranges ) {
+			jobs.push_back( { transform_update_job, &r } );
+		}
+
+		le_jobs::counter_t* counter;
+		le_jobs::run_jobs( jobs.data(), uint32_t( jobs.size() ), &counter );
+		le_jobs::wait_for_counter_and_free( counter, 0 );
+
+		return;
+	}
+#endif
+
+	for ( auto& r : ranges ) {
+		transform_update_job( &r );
 	}
 }
 
@@ -2745,9 +4402,14 @@ static void le_stage_update( le_stage_o* self ) {
 		uint64_t current_ticks = le_timebase_i.get_current_ticks( self->timebase );
 
 		if ( !self->animations.empty() ) {
+
+			for ( auto& batch : self->animation_batches ) {
+				animation_batch_clear( batch );
+			}
+
 			// for each animation: find current keyframe
 
-			for ( auto const& a : self->animations ) {
+			for ( auto& a : self->animations ) {
 
 				uint64_t animation_time = current_ticks - a.ticks_offset;
 
@@ -2766,18 +4428,32 @@ static void le_stage_update( le_stage_o* self ) {
 					break;
 				}
 
-				for ( auto const& c : a.channels ) {
-					apply_animation_channel( c, animation_time );
+				for ( auto& c : a.channels ) {
+					gather_animation_channel( self, c, animation_time );
 				}
 			}
 
-			// apply keyframe value to node.
+			// apply keyframe values to nodes.
+
+			evaluate_lerp_batch( self->animation_batches[ ANIMATION_BATCH_SCALAR ], 1 );
+			evaluate_lerp_batch( self->animation_batches[ ANIMATION_BATCH_VEC3 ], 3 );
+			evaluate_slerp_batch( self->animation_batches[ ANIMATION_BATCH_QUAT ] );
 		}
 	}
 
+	if ( !self->transforms.is_valid ) {
+		transform_hierarchy_rebuild( self );
+	}
+
+	le_transform_hierarchy_o& t = self->transforms;
+
 	// -- Update node's local transform matrices from node's T,R,S properties.
+	// -- Mark nodes which changed, and all subtrees which contain them as dirty.
+
+	for ( uint32_t i = 0; i != uint32_t( t.nodes.size() ); i++ ) {
+
+		le_node_o* n = t.nodes[ i ];
 
-	for ( le_node_o* n : self->nodes ) {
 		if ( false == n->local_transform_cached ) {
 
 			glm::mat4 m =
@@ -2786,22 +4462,54 @@ static void le_stage_update( le_stage_o* self ) {
 			    glm::scale( glm::mat4( 1.f ), n->local_scale )             // scale
 			    ;
 
-			n->local_transform = m;
+			t.local[ i ]       = m;
+			t.local_dirty[ i ] = true;
+
+			// Walk up towards the root - we may stop at the first ancestor which
+			// is already marked, as all its ancestors must be marked, too.
+			for ( uint32_t p = i; p != NO_TRANSFORM_IDX && !t.subtree_dirty[ p ]; p = t.parent_idx[ p ] ) {
+				t.subtree_dirty[ p ] = true;
+			}
 
 			n->local_transform_cached = true;
 		}
 	}
 
-	// -- Update global transform matrices.
-	// -- while we are at it, we also calculate inverse global transforms.
-	// -- recurse over nodes, starting with root nodes of scene.
+	// -- Update global transform matrices, only for subtrees which contain dirty nodes.
+	// -- Inverse global transforms are calculated lazily, see node_get_inverse_global_transform.
 
-	for ( le_scene_o const& s : self->scenes ) {
-		for ( le_node_o* n : s.root_nodes ) {
-			n->global_transform         = n->local_transform;
-			n->inverse_global_transform = glm::inverse( n->global_transform );
-			traverse_node( n );
+	transform_hierarchy_update( &t );
+
+	// -- Update world-space bounding spheres for all nodes which have meshes,
+	// so that we may cull these nodes against the camera frustum when drawing.
+	//
+	// Skinned nodes are never culled: their vertices are placed by joints,
+	// and may therefore end up far outside the bounds of their mesh.
+
+	for ( le_node_o* n : self->nodes ) {
+
+		n->has_world_bounds = n->has_mesh && !n->skin && self->meshes[ n->mesh_idx ].has_bounds;
+
+		if ( !n->has_world_bounds ) {
+			continue;
 		}
+
+		// ----------| invariant: node has mesh, and mesh has bounds
+
+		le_mesh_o const& mesh = self->meshes[ n->mesh_idx ];
+
+		glm::vec3 centre      = ( mesh.bounds_min + mesh.bounds_max ) * 0.5f;
+		glm::vec3 half_extent = ( mesh.bounds_max - mesh.bounds_min ) * 0.5f;
+
+		// Radius must grow with the largest scale factor of the global transform.
+		glm::mat4 const& global_transform = node_get_global_transform( self, n );
+
+		float max_scale = glm::max( glm::length( glm::vec3( global_transform[ 0 ] ) ),
+		                            glm::max( glm::length( glm::vec3( global_transform[ 1 ] ) ),
+		                                      glm::length( glm::vec3( global_transform[ 2 ] ) ) ) );
+
+		n->world_bounding_sphere = glm::vec4( glm::vec3( global_transform * glm::vec4( centre, 1.f ) ),
+		                                      glm::length( half_extent ) * max_scale );
 	}
 
 	// -- Update all lights.
@@ -2826,8 +4534,8 @@ static void le_stage_update( le_stage_o* self ) {
 			glm::vec4 direction{ 0, 0, -1, 0 };
 			glm::vec4 position{ 0, 0, 0, 1 };
 
-			direction = n->global_transform * direction;
-			position  = n->global_transform * position;
+			direction = node_get_global_transform( self, n ) * direction;
+			position  = node_get_global_transform( self, n ) * position;
 
 			// clang-format off
 			switch(info.type) {
@@ -2871,10 +4579,43 @@ static void le_stage_update( le_stage_o* self ) {
 
 // ----------------------------------------------------------------------
 
+/// \brief enable or disable frustum culling via compute pass - if disabled (default),
+/// nodes are culled on the cpu, before their draws are encoded.
+static void le_stage_set_gpu_culling( le_stage_o* self, bool enabled ) {
+	self->gpu_culling = enabled;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief set maximum number of bytes which may be uploaded per frame - 0 means
+/// to upload everything at once. If a single resource is larger than the budget,
+/// it gets a frame of its own.
+static void le_stage_set_upload_budget( le_stage_o* self, uint64_t bytes_per_frame ) {
+	self->upload_budget_bytes = bytes_per_frame;
+}
+
+// ----------------------------------------------------------------------
+
+/// \brief returns true once all primitives of the given mesh may be drawn.
+static bool le_stage_is_mesh_resident( le_stage_o* self, uint32_t mesh_idx ) {
+	assert( mesh_idx < self->meshes.size() );
+
+	for ( auto& primitive : self->meshes[ mesh_idx ].primitives ) {
+		if ( !primitive_is_resident( self, primitive ) ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// ----------------------------------------------------------------------
+
 static le_stage_o* le_stage_create( le_renderer_o* renderer, le_timebase_o* timebase ) {
-	auto self      = new le_stage_o{};
-	self->renderer = renderer;
-	self->timebase = timebase;
+	auto self                 = new le_stage_o{};
+	self->renderer            = renderer;
+	self->timebase            = timebase;
+	self->upload_budget_bytes = DEFAULT_UPLOAD_BUDGET_BYTES;
 	return self;
 }
 
@@ -2891,8 +4632,8 @@ static void le_stage_destroy( le_stage_o* self ) {
 	}
 
 	for ( auto& b : self->buffers ) {
-		if ( b->owns_mem && b->mem && b->size ) {
-			free( b->mem );
+		if ( b->mem ) {
+			buffer_release_mem( b );
 		}
 		delete b;
 	}
@@ -2936,13 +4677,19 @@ LE_MODULE_REGISTER_IMPL( le_stage, api ) {
 	le_stage_i.draw_into_module    = le_stage_draw_into_render_module;
 
 	le_stage_i.setup_pipelines = le_stage_setup_pipelines;
+	le_stage_i.set_gpu_culling = le_stage_set_gpu_culling;
+
+	le_stage_i.set_upload_budget = le_stage_set_upload_budget;
+	le_stage_i.is_mesh_resident  = le_stage_is_mesh_resident;
 
 	le_stage_i.create_image_from_memory    = le_stage_create_image_from_memory;
 	le_stage_i.create_image_from_file_path = le_stage_create_image_from_file_path;
+	le_stage_i.create_images               = le_stage_create_images;
 
 	le_stage_i.create_texture         = le_stage_create_texture;
 	le_stage_i.create_sampler         = le_stage_create_sampler;
 	le_stage_i.create_buffer          = le_stage_create_buffer;
+	le_stage_i.create_buffer_borrowed = le_stage_create_buffer_borrowed;
 	le_stage_i.create_buffer_view     = le_stage_create_buffer_view;
 	le_stage_i.create_accessor        = le_stage_create_accessor;
 	le_stage_i.create_material        = le_stage_create_material;
@@ -21,12 +21,15 @@ struct le_texture_info;
 struct le_camera_settings_info;
 struct le_animation_info;
 struct le_skin_info;
+struct le_image_info;
 struct le_camera_o; // from module::le_camera
 
 LE_OPAQUE_HANDLE( le_img_resource_handle );
 
 struct le_sampler_info_t; // from le_renderer
 
+typedef void ( *le_borrowed_memory_release_fn )( void* user_data ); // see create_buffer_borrowed
+
 /* le_stage provides a scene graph, and playback capability for animations.
  *
  * Create elements inside the stage by calling the le_stage.create* methods.
@@ -45,6 +48,25 @@ struct le_sampler_info_t; // from le_renderer
  * Note that `draw_into_module()` requires a parameter object with the same
  * lifetime as the module used to draw.
  *
+ * Nodes are culled against the camera frustum before they are drawn, using
+ * world-space bounds which are updated in `update()`. Call `set_gpu_culling()`
+ * to cull in a compute pass instead - this pass writes an indirect draw buffer,
+ * which the draw pass then consumes. Skinned nodes, and nodes with morph targets
+ * are never culled.
+ *
+ * Draws are sorted by pipeline, material, and mesh; draws of the same primitive
+ * are merged into instanced draws.
+ *
+ * `create_buffer()` copies buffer memory; `create_buffer_borrowed()` does not -
+ * the stage instead reads from borrowed memory until the buffer has been
+ * uploaded, and then calls `release_fn`, after which it won't touch the memory
+ * again. `create_images()` decodes all given images in parallel.
+ *
+ * Buffers and images are uploaded incrementally, over as many frames as needed
+ * so that each frame uploads at most `set_upload_budget()` bytes. Resources
+ * closest to the camera are uploaded first. Primitives are not drawn until all
+ * of their data is resident - use `is_mesh_resident()` to query this.
+ *
  */
 
 // clang-format off
@@ -65,14 +87,19 @@ struct le_stage_api {
 		void            ( * draw_into_module )(draw_params_t* self, le_rendergraph_o* module, le_img_resource_handle color_attachment_image, le_img_resource_handle depth_stencil_attachment_image );
 
 		void     (* setup_pipelines)(le_stage_o* self);
+		void     (* set_gpu_culling)(le_stage_o* self, bool enabled); // must not change between draw_into_module, and rendering the frame
+		void     (* set_upload_budget)(le_stage_o* self, uint64_t bytes_per_frame); // 0 means unlimited
+		bool     (* is_mesh_resident)(le_stage_o* self, uint32_t mesh_idx); // true once all buffers, images used by mesh were uploaded
 
 		uint32_t (* create_image_from_memory)( le_stage_o* stage, unsigned char const * image_file_memory, uint32_t image_file_sz, char const * debug_name, uint32_t mip_levels);
 		uint32_t (* create_image_from_file_path)( le_stage_o* stage, char const * image_file_path, char const * debug_name, uint32_t mip_levels);
+		void     (* create_images)( le_stage_o* stage, le_image_info const * infos, uint32_t num_infos, uint32_t * out_image_indices ); // decodes images in parallel
 
 		uint32_t (* create_sampler)(le_stage_o* stage, le_sampler_info_t const * info);
 		uint32_t (* create_texture)(le_stage_o* stage, le_texture_info const * info);
 
 		uint32_t (* create_buffer      )( le_stage_o* self, void *mem, uint32_t sz, char const *debug_name );
+		uint32_t (* create_buffer_borrowed )( le_stage_o* self, void *mem, uint32_t sz, char const *debug_name, le_borrowed_memory_release_fn release_fn, void* release_fn_user_data );
 		uint32_t (* create_buffer_view )( le_stage_o* self, le_buffer_view_info const *info );
 		uint32_t (* create_accessor    )( le_stage_o* self, le_accessor_info const *info );
 		uint32_t (* create_material    )( le_stage_o* self, le_material_info const * info);
@@ -67,6 +67,14 @@ struct le_texture_info {
 	uint32_t sampler_idx;
 };
 
+struct le_image_info {
+	unsigned char const* file_memory;    // encoded image file data, or nullptr if file_path is given
+	uint32_t             file_memory_sz; // number of bytes in file_memory
+	char const*          file_path;      // only used if file_memory is nullptr
+	char const*          debug_name;     // optional
+	uint32_t             mip_levels;     // 0 means full mip chain
+};
+
 struct le_texture_transform_info {
 	float    offset[ 2 ];
 	float    rotation;
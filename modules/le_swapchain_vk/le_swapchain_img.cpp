@@ -9,6 +9,7 @@
 #include <cassert>
 #include "util/vk_mem_alloc/vk_mem_alloc.h"
 #include "le_log.h"
+#include "le_tracy.h"
 
 #include <cstring>
 #include <iostream>
@@ -16,38 +17,91 @@
 #include <fstream>
 #include <sstream>
 #include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifndef _MSC_VER
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
 
 static constexpr auto LOGGER_LABEL = "le_swapchain_img";
 
 struct TransferFrame {
-	VkImage           image            = nullptr; // Owned. Handle to image
-	VkBuffer          buffer           = nullptr; // Owned. Handle to buffer
-	VmaAllocation     imageAllocation  = nullptr; // Owned. Handle to image allocation
-	VmaAllocation     bufferAllocation = nullptr; // Owned. Handle to buffer allocation
+	VkImage           image           = nullptr;      // Owned. Handle to image
+	VmaAllocation     imageAllocation = nullptr;      // Owned. Handle to image allocation
 	VmaAllocationInfo imageAllocationInfo{};
-	VmaAllocationInfo bufferAllocationInfo{};
 	VkFence           frameFence;
-	VkCommandBuffer   cmdPresent; // copies from image to buffer
-	VkCommandBuffer   cmdAcquire; // transfers image back to correct layout
+	VkCommandBuffer   cmdPresent;                     // copies from image to readback buffer - re-recorded on each present
+	VkCommandBuffer   cmdAcquire;                     // transfers image back to correct layout
+	uint32_t          readback_slot = uint32_t( ~0 ); // readback slot targeted by most recent present of this image, ~0 if none
+	uint32_t          frame_number  = 0;              // total image count at the time this image was last acquired
+};
+
+// Host-visible buffer into which we read back image data.
+//
+// There are more readback slots than images, so that frames which were read back
+// may queue up for the writer thread while the gpu keeps rendering into images.
+struct ReadbackSlot {
+	VkBuffer          buffer     = nullptr; // Owned. Handle to buffer
+	VmaAllocation     allocation = nullptr; // Owned. Handle to buffer allocation
+	VmaAllocationInfo allocationInfo{};
+};
+
+// Writes read back frames to their destination (pipe, ring, or file) on a
+// dedicated thread, so that the render thread never blocks on i/o.
+struct ReadbackWriter {
+	struct Job {
+		uint32_t slot;
+		uint32_t frame_number;
+	};
+
+	std::thread             thread;
+	std::mutex              mtx;
+	std::condition_variable cv_job_added;    // signalled when a job was added, or when writer should stop
+	std::condition_variable cv_slot_written; // signalled when writer has finished with a slot
+	std::deque<Job>         jobs;            // protected by mtx
+	std::vector<uint8_t>    slot_is_queued;  // protected by mtx, per slot: 1 if slot waits to be written, or is being written
+	bool                    should_stop = false;
+};
+
+// Memory-mapped ring of frames, which an external process may read from.
+struct OutputRing {
+	int                             fd        = -1;      // Owned. must be closed if opened
+	void*                           mapping   = nullptr; // Owned. must be unmapped if mapped
+	size_t                          map_size  = 0;
+	le_swapchain_img_ring_header_t* header    = nullptr; // Points into mapping
+	uint64_t*                       slot_seq  = nullptr; // Points into mapping, one sequence number per slot
+	char*                           slot_data = nullptr; // Points into mapping
 };
 
 struct img_data_o {
 	le_swapchain_settings_t    mSettings;
-	uint32_t                   mImagecount;           // Number of images in swapchain
-	uint32_t                   totalImages;           // total number of produced images
-	uint32_t                   mImageIndex;           // current image index
-	uint32_t                   vk_queue_family_index; // queue family index for the queue which this swapchain will use
-	VkExtent3D                 mSwapchainExtent;      //
-	VkSurfaceFormatKHR         windowSurfaceFormat;   //
-	uint32_t                   reserved__;            // RESERVED for packing this struct
-	VkDevice                   device;                // Owned by backend
-	VkPhysicalDevice           physicalDevice;        // Owned by backend
-	VkCommandPool              vkCommandPool;         // Command pool from wich we allocate present and acquire command buffers
-	le_backend_o*              backend = nullptr;     // Not owned. Backend owns swapchain.
-	std::vector<TransferFrame> transferFrames;        //
-	FILE*                      pipe = nullptr;        // Pipe to ffmpeg. Owned. must be closed if opened
-	std::string                pipe_cmd;              // command line
-	BackendQueueInfo*          queue_info = nullptr;  // Non-owning. Present-enabled queue, initially null, set at create
+	uint32_t                   mImagecount;                // Number of images in swapchain
+	uint32_t                   totalImages;                // total number of produced images
+	uint32_t                   mImageIndex;                // current image index
+	uint32_t                   vk_queue_family_index;      // queue family index for the queue which this swapchain will use
+	VkExtent3D                 mSwapchainExtent;           //
+	VkSurfaceFormatKHR         windowSurfaceFormat;        //
+	uint32_t                   totalPresents;              // total number of presented images, selects readback slot
+	VkDevice                   device;                     // Owned by backend
+	VkPhysicalDevice           physicalDevice;             // Owned by backend
+	VkCommandPool              vkCommandPool;              // Command pool from wich we allocate present and acquire command buffers
+	le_backend_o*              backend = nullptr;          // Not owned. Backend owns swapchain.
+	std::vector<TransferFrame> transferFrames;             //
+	std::vector<ReadbackSlot>  readbackSlots;              // mImagecount + readback_queue_depth slots, reused round-robin
+	uint64_t                   frameSizeInBytes = 0;       // number of bytes of image data per frame
+	FILE*                      pipe             = nullptr; // Pipe to ffmpeg. Owned. must be closed if opened
+	std::string                pipe_cmd;                   // command line
+	bool                       discard_output = false;     // if set, read back frames are dropped instead of written out
+	OutputRing                 ring;                       // used instead of pipe if img_settings.ring_path was set
+	ReadbackWriter             writer;                     // writes read back frames to pipe, ring, or file
+	BackendQueueInfo*          queue_info = nullptr;       // Non-owning. Present-enabled queue, initially null, set at create
 };
 
 // ----------------------------------------------------------------------
@@ -71,13 +125,16 @@ static void swapchain_img_reset( le_swapchain_o* base, const le_swapchain_settin
 	VkResult imgAllocationResult = VK_ERROR_UNKNOWN;
 	VkResult bufAllocationResult = VK_ERROR_UNKNOWN;
 
-	uint32_t const numFrames = self->mImagecount;
+	uint32_t const numFrames        = self->mImagecount;
+	uint32_t const numReadbackSlots = numFrames + self->mSettings.img_settings.readback_queue_depth;
+
+	// We read back tightly packed rows of 4 bytes per pixel.
+	self->frameSizeInBytes = uint64_t( self->mSwapchainExtent.width ) * self->mSwapchainExtent.height * 4;
 
 	self->transferFrames.resize( numFrames, {} );
+	self->readbackSlots.resize( numReadbackSlots, {} );
 
 	for ( auto& frame : self->transferFrames ) {
-
-		uint64_t image_size_in_bytes = 0;
 		{
 			// Allocate space for an image which can hold a render surface
 
@@ -113,42 +170,6 @@ static void swapchain_img_reset( le_swapchain_o* base, const le_swapchain_settin
 			        &frame.imageAllocation,
 			        &frame.imageAllocationInfo ) );
 			assert( imgAllocationResult == VK_SUCCESS );
-			image_size_in_bytes = frame.imageAllocationInfo.size;
-		}
-
-		{
-			// Allocate space for a buffer in which to read back the image data.
-			//
-			// now we need a buffer which is host visible and coherent, which we can use to read out our data.
-			// there needs to be one buffer per image;
-			using namespace le_backend_vk;
-
-			VkBufferCreateInfo bufferCreateInfo{
-			    .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-			    .pNext                 = nullptr, // optional
-			    .flags                 = 0,       // optional
-			    .size                  = image_size_in_bytes,
-			    .usage                 = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			    .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
-			    .queueFamilyIndexCount = 1, // optional
-			    .pQueueFamilyIndices   = &self->vk_queue_family_index,
-			};
-
-			VmaAllocationCreateInfo allocationCreateInfo{};
-			allocationCreateInfo.flags          = VMA_ALLOCATION_CREATE_MAPPED_BIT;
-			allocationCreateInfo.usage          = VMA_MEMORY_USAGE_CPU_ONLY;
-			allocationCreateInfo.preferredFlags = 0;
-
-			bufAllocationResult = VkResult(
-			    private_backend_vk_i.allocate_buffer(
-			        self->backend,
-			        &bufferCreateInfo,
-			        &allocationCreateInfo,
-			        &frame.buffer,
-			        &frame.bufferAllocation,
-			        &frame.bufferAllocationInfo //
-			        ) );
-			assert( bufAllocationResult == VK_SUCCESS );
 		}
 
 		{
@@ -162,6 +183,47 @@ static void swapchain_img_reset( le_swapchain_o* base, const le_swapchain_settin
 		}
 	}
 
+	for ( auto& slot : self->readbackSlots ) {
+
+		// Allocate space for a buffer in which to read back the image data.
+		//
+		// now we need a buffer which is host visible and coherent, which we can use to read out our data.
+		// there needs to be one buffer per readback slot;
+		using namespace le_backend_vk;
+
+		VkBufferCreateInfo bufferCreateInfo{
+		    .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		    .pNext                 = nullptr, // optional
+		    .flags                 = 0,       // optional
+		    .size                  = self->frameSizeInBytes,
+		    .usage                 = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		    .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+		    .queueFamilyIndexCount = 1, // optional
+		    .pQueueFamilyIndices   = &self->vk_queue_family_index,
+		};
+
+		VmaAllocationCreateInfo allocationCreateInfo{};
+		allocationCreateInfo.flags          = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		allocationCreateInfo.usage          = VMA_MEMORY_USAGE_CPU_ONLY;
+		allocationCreateInfo.preferredFlags = 0;
+
+		bufAllocationResult = VkResult(
+		    private_backend_vk_i.allocate_buffer(
+		        self->backend,
+		        &bufferCreateInfo,
+		        &allocationCreateInfo,
+		        &slot.buffer,
+		        &slot.allocation,
+		        &slot.allocationInfo //
+		        ) );
+		assert( bufAllocationResult == VK_SUCCESS );
+	}
+
+	{
+		std::scoped_lock lock( self->writer.mtx );
+		self->writer.slot_is_queued.assign( numReadbackSlots, 0 );
+	}
+
 	// Allocate command buffers for each frame.
 	// Each frame needs one command buffer
 
@@ -188,80 +250,6 @@ static void swapchain_img_reset( le_swapchain_o* base, const le_swapchain_settin
 	// Add commands to command buffers for all frames.
 
 	for ( auto& frame : self->transferFrames ) {
-		{
-			// copy == transfer image to buffer memory
-			VkCommandBuffer& cmdPresent = frame.cmdPresent;
-			{
-				VkCommandBufferBeginInfo info = {
-				    .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-				    .pNext            = nullptr, // optional
-				    .flags            = 0,       // optional
-				    .pInheritanceInfo = 0,       // optional
-				};
-
-				vkBeginCommandBuffer( cmdPresent, &info );
-			}
-
-			{
-
-				VkImageMemoryBarrier2 img_barrier{
-				    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
-				    .pNext               = nullptr,                              // optional
-				    .srcStageMask        = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,  // wait for nothing
-				    .srcAccessMask       = 0,                                    // flush nothing
-				    .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, // block on any transfer stage
-				    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,        // make memory visible to transfer read (after layout transition)
-				    .oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,      // transition from present_src
-				    .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // to transfer_src optimal
-				    .srcQueueFamilyIndex = self->vk_queue_family_index,
-				    .dstQueueFamilyIndex = self->vk_queue_family_index,
-				    .image               = frame.image,
-				    .subresourceRange    = {
-				           .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-				           .baseMipLevel   = 0,
-				           .levelCount     = 1,
-				           .baseArrayLayer = 0,
-				           .layerCount     = 1,
-                    },
-				};
-
-				VkDependencyInfo info{
-				    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
-				    .pNext                    = nullptr, // optional
-				    .dependencyFlags          = 0,       // optional
-				    .memoryBarrierCount       = 0,       // optional
-				    .pMemoryBarriers          = 0,
-				    .bufferMemoryBarrierCount = 0, // optional
-				    .pBufferMemoryBarriers    = 0,
-				    .imageMemoryBarrierCount  = 1, // optional
-				    .pImageMemoryBarriers     = &img_barrier,
-				};
-
-				vkCmdPipelineBarrier2( cmdPresent, &info );
-			}
-
-			VkBufferImageCopy imgCopy{
-			    .bufferOffset      = 0,
-			    .bufferRowLength   = self->mSwapchainExtent.width,
-			    .bufferImageHeight = self->mSwapchainExtent.height,
-			    .imageSubresource  = {
-			         .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-			         .mipLevel       = 0,
-			         .baseArrayLayer = 0,
-			         .layerCount     = 1,
-                },
-			    .imageOffset = {},
-			    .imageExtent = self->mSwapchainExtent,
-			};
-			;
-
-			// TODO: here we must wait for the buffer read event to have been signalled - because that means that the buffer
-			// is available for writing again. Perhaps we should use a buffer which is not persistently mapped, if that's faster.
-
-			// Image must be transferred to a buffer - we can then read from this buffer.
-			vkCmdCopyImageToBuffer( cmdPresent, frame.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, frame.buffer, 1, &imgCopy );
-			vkEndCommandBuffer( cmdPresent );
-		}
 		{
 			// Move ownership of image back from transfer -> graphics
 			// Change image layout back to colorattachment
@@ -321,6 +309,272 @@ static void swapchain_img_reset( le_swapchain_o* base, const le_swapchain_settin
 	}
 }
 
+// ----------------------------------------------------------------------
+// Records commands which copy an image into a readback slot.
+//
+// We must re-record these commands for each present, since the readback slot
+// which an image gets copied into changes from present to present.
+//
+// The caller must make sure that `frame.cmdPresent` is not pending execution,
+// which is guaranteed once the frame's fence has been waited upon.
+static void swapchain_img_record_present_cmd( img_data_o* self, TransferFrame& frame, ReadbackSlot const& slot ) {
+
+	VkCommandBuffer& cmdPresent = frame.cmdPresent;
+	{
+		VkCommandBufferBeginInfo info = {
+		    .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		    .pNext            = nullptr,                                     // optional
+		    .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, // optional
+		    .pInheritanceInfo = 0,                                           // optional
+		};
+
+		vkBeginCommandBuffer( cmdPresent, &info );
+	}
+
+	{
+
+		VkImageMemoryBarrier2 img_barrier{
+		    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+		    .pNext               = nullptr,                              // optional
+		    .srcStageMask        = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,  // wait for nothing
+		    .srcAccessMask       = 0,                                    // flush nothing
+		    .dstStageMask        = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, // block on any transfer stage
+		    .dstAccessMask       = VK_ACCESS_2_TRANSFER_READ_BIT,        // make memory visible to transfer read (after layout transition)
+		    .oldLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,      // transition from present_src
+		    .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, // to transfer_src optimal
+		    .srcQueueFamilyIndex = self->vk_queue_family_index,
+		    .dstQueueFamilyIndex = self->vk_queue_family_index,
+		    .image               = frame.image,
+		    .subresourceRange    = {
+		           .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+		           .baseMipLevel   = 0,
+		           .levelCount     = 1,
+		           .baseArrayLayer = 0,
+		           .layerCount     = 1,
+            },
+		};
+
+		VkDependencyInfo info{
+		    .sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		    .pNext                    = nullptr, // optional
+		    .dependencyFlags          = 0,       // optional
+		    .memoryBarrierCount       = 0,       // optional
+		    .pMemoryBarriers          = 0,
+		    .bufferMemoryBarrierCount = 0, // optional
+		    .pBufferMemoryBarriers    = 0,
+		    .imageMemoryBarrierCount  = 1, // optional
+		    .pImageMemoryBarriers     = &img_barrier,
+		};
+
+		vkCmdPipelineBarrier2( cmdPresent, &info );
+	}
+
+	VkBufferImageCopy imgCopy{
+	    .bufferOffset      = 0,
+	    .bufferRowLength   = self->mSwapchainExtent.width,
+	    .bufferImageHeight = self->mSwapchainExtent.height,
+	    .imageSubresource  = {
+	         .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+	         .mipLevel       = 0,
+	         .baseArrayLayer = 0,
+	         .layerCount     = 1,
+        },
+	    .imageOffset = {},
+	    .imageExtent = self->mSwapchainExtent,
+	};
+
+	// Image must be transferred to a buffer - we can then read from this buffer.
+	vkCmdCopyImageToBuffer( cmdPresent, frame.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &imgCopy );
+	vkEndCommandBuffer( cmdPresent );
+}
+
+// ----------------------------------------------------------------------
+// Creates a memory-mapped file which holds a ring of frames, so that an external
+// process (an encoder, for example) may read frames without going through a pipe.
+//
+// If `path` points into a tmpfs, such as `/dev/shm`, the ring lives in shared memory.
+static bool swapchain_img_open_ring( img_data_o* self, char const* path, uint32_t slot_count ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+#ifdef _MSC_VER
+	// todo: implement windows-specific solution
+	logger.error( "Output ring is not implemented on this platform." );
+	return false;
+#else
+	OutputRing& ring = self->ring;
+
+	// Slots start at a page-aligned offset so that consumers may map individual slots.
+	uint64_t const page_size   = uint64_t( sysconf( _SC_PAGESIZE ) );
+	// Per-slot sequence numbers immediately follow the header.
+	uint64_t const sequence_offset = ( sizeof( le_swapchain_img_ring_header_t ) + alignof( uint64_t ) - 1 ) & ~uint64_t( alignof( uint64_t ) - 1 );
+	uint64_t const data_offset     = ( ( sequence_offset + sizeof( uint64_t ) * slot_count + page_size - 1 ) / page_size ) * page_size;
+	uint64_t const slot_stride = ( ( self->frameSizeInBytes + page_size - 1 ) / page_size ) * page_size;
+
+	ring.map_size = size_t( data_offset + slot_stride * slot_count );
+
+	ring.fd = open( path, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+
+	if ( ring.fd == -1 ) {
+		logger.error( "Could not open output ring file '%s': %s", path, strerror( errno ) );
+		return false;
+	}
+
+	if ( ftruncate( ring.fd, off_t( ring.map_size ) ) != 0 ) {
+		logger.error( "Could not resize output ring file '%s': %s", path, strerror( errno ) );
+		close( ring.fd );
+		ring.fd = -1;
+		return false;
+	}
+
+	ring.mapping = mmap( nullptr, ring.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring.fd, 0 );
+
+	if ( ring.mapping == MAP_FAILED ) {
+		logger.error( "Could not map output ring file '%s': %s", path, strerror( errno ) );
+		ring.mapping = nullptr;
+		close( ring.fd );
+		ring.fd = -1;
+		return false;
+	}
+
+	ring.header    = static_cast<le_swapchain_img_ring_header_t*>( ring.mapping );
+	ring.slot_seq  = reinterpret_cast<uint64_t*>( static_cast<char*>( ring.mapping ) + sequence_offset );
+	ring.slot_data = static_cast<char*>( ring.mapping ) + data_offset;
+
+	*ring.header = {
+	    .magic           = LE_SWAPCHAIN_IMG_RING_MAGIC,
+	    .version         = LE_SWAPCHAIN_IMG_RING_VERSION,
+	    .width           = self->mSwapchainExtent.width,
+	    .height          = self->mSwapchainExtent.height,
+	    .format          = uint32_t( self->windowSurfaceFormat.format ),
+	    .slot_count      = slot_count,
+	    .slot_stride     = slot_stride,
+	    .frame_size      = self->frameSizeInBytes,
+	    .data_offset     = data_offset,
+	    .sequence_offset = sequence_offset,
+	    .frames_written  = 0,
+	};
+
+	// ftruncate zero-fills the file, so all slot sequence numbers start out as 0 (no frame).
+
+	logger.info( "Image swapchain writing frames to output ring '%s' (%d slots)", path, slot_count );
+
+	return true;
+#endif // _MSC_VER
+}
+
+// ----------------------------------------------------------------------
+
+static void swapchain_img_close_ring( img_data_o* self ) {
+#ifndef _MSC_VER
+	OutputRing& ring = self->ring;
+	if ( ring.mapping ) {
+		munmap( ring.mapping, ring.map_size );
+	}
+	if ( ring.fd != -1 ) {
+		close( ring.fd );
+	}
+	ring = {};
+#endif
+}
+
+// ----------------------------------------------------------------------
+// Writes one frame to whichever destination this swapchain was set up for.
+// Called on the writer thread.
+static void swapchain_img_write_frame( img_data_o* self, ReadbackSlot const& slot, uint32_t frame_number ) {
+	static auto logger = LeLog( LOGGER_LABEL );
+
+	char const* frame_data = static_cast<char const*>( slot.allocationInfo.pMappedData );
+
+	if ( self->discard_output ) {
+
+		// Null output - frame was read back, but goes nowhere.
+
+	} else if ( self->ring.header ) {
+
+		// Copy frame into the next ring slot, then publish it by incrementing the
+		// number of frames written. The release store makes sure that frame data
+		// is visible to a reader before the updated counter is.
+		//
+		// Note that we never wait for readers - a reader which falls behind by more
+		// than `slot_count` frames will miss frames. The slot's sequence number is
+		// odd while we write, so that a reader can detect a torn copy (see
+		// le_swapchain_img_ring_header_t for the read protocol).
+
+		std::atomic_ref<uint64_t> frames_written( self->ring.header->frames_written );
+
+		uint64_t const n    = frames_written.load( std::memory_order_relaxed );
+		uint64_t const slot = n % self->ring.header->slot_count;
+
+		std::atomic_ref<uint64_t> slot_seq( self->ring.slot_seq[ slot ] );
+
+		slot_seq.store( 2 * n + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release ); // sequence number must be visible before any frame data
+		memcpy( self->ring.slot_data + slot * self->ring.header->slot_stride, frame_data, self->frameSizeInBytes );
+		slot_seq.store( 2 * n + 2, std::memory_order_release );
+
+		frames_written.store( n + 1, std::memory_order_release );
+
+	} else if ( self->pipe ) {
+
+		// Write out frame contents to ffmpeg via pipe - this may block if ffmpeg
+		// can't keep up, which is fine, since we're not on the render thread.
+		fwrite( frame_data, self->frameSizeInBytes, 1, self->pipe );
+
+	} else {
+		char file_name[ 1024 ];
+		snprintf( file_name, sizeof( file_name ), "isl_%08d.rgba", frame_number );
+		std::ofstream myfile( file_name, std::ios::out | std::ios::binary );
+		myfile.write( frame_data, std::streamsize( self->frameSizeInBytes ) );
+		myfile.close();
+		logger.info( "Wrote Image: %s", file_name );
+	}
+}
+
+// ----------------------------------------------------------------------
+
+static void swapchain_img_writer_thread( img_data_o* self ) {
+
+	ReadbackWriter& writer = self->writer;
+
+	for ( ;; ) {
+		ReadbackWriter::Job job;
+		{
+			std::unique_lock lock( writer.mtx );
+			writer.cv_job_added.wait( lock, [ &writer ]() { return writer.should_stop || !writer.jobs.empty(); } );
+
+			if ( writer.jobs.empty() ) {
+				// ----------| invariant: writer should stop, and all jobs have been drained
+				return;
+			}
+
+			job = writer.jobs.front();
+			writer.jobs.pop_front();
+		}
+
+		swapchain_img_write_frame( self, self->readbackSlots[ job.slot ], job.frame_number );
+
+		{
+			std::scoped_lock lock( writer.mtx );
+			writer.slot_is_queued[ job.slot ] = 0;
+		}
+		writer.cv_slot_written.notify_all();
+	}
+}
+
+// ----------------------------------------------------------------------
+// Stops writer thread once all queued frames have been written.
+static void swapchain_img_stop_writer( img_data_o* self ) {
+	if ( !self->writer.thread.joinable() ) {
+		return;
+	}
+	{
+		std::scoped_lock lock( self->writer.mtx );
+		self->writer.should_stop = true;
+	}
+	self->writer.cv_job_added.notify_all();
+	self->writer.thread.join();
+}
+
 // ----------------------------------------------------------------------
 
 static le_swapchain_o* swapchain_img_create( const le_swapchain_vk_api::swapchain_interface_t& interface, le_backend_o* backend, const le_swapchain_settings_t* settings ) {
@@ -334,6 +588,7 @@ static le_swapchain_o* swapchain_img_create( const le_swapchain_vk_api::swapchai
 	self->windowSurfaceFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
 	self->mImageIndex                    = uint32_t( ~0 );
 	self->pipe_cmd                       = std::string( settings->img_settings.pipe_cmd );
+	self->discard_output                 = settings->img_settings.discard_output != 0;
 	{
 
 		using namespace le_backend_vk;
@@ -357,7 +612,26 @@ static le_swapchain_o* swapchain_img_create( const le_swapchain_vk_api::swapchai
 
 	swapchain_img_reset( base, settings );
 
-	{
+	char const* ring_path = settings->img_settings.ring_path;
+
+	if ( self->discard_output ) {
+
+		logger.info( "Image swapchain discards output images." );
+
+	} else if ( ring_path && ring_path[ 0 ] != '\0' ) {
+
+		// Frames go into a memory-mapped ring instead of a pipe.
+
+		uint32_t slot_count = std::max<uint32_t>( 2, settings->img_settings.ring_slot_count );
+
+		if ( !swapchain_img_open_ring( self, ring_path, slot_count ) ) {
+			// We must not fall through to writing one file per frame instead -
+			// whoever asked for a ring would not expect these files.
+			logger.error( "Could not open output ring '%s' - image swapchain output is disabled.", ring_path );
+			self->discard_output = true;
+		}
+
+	} else {
 		// Generate a timestamp string so that we can generate unique filenames,
 		// making sure that output files generated by successive runs are not
 		// overwritten.
@@ -401,6 +675,11 @@ static le_swapchain_o* swapchain_img_create( const le_swapchain_vk_api::swapchai
 		assert( self->pipe != nullptr );
 #endif // _MSC_VER
 	}
+
+	// Frames which have been read back get written out on a dedicated thread, so that
+	// rendering only ever needs to wait for the writer if all readback slots are queued.
+	self->writer.thread = std::thread( swapchain_img_writer_thread, self );
+
 	return base;
 }
 
@@ -415,6 +694,11 @@ static void swapchain_img_destroy( le_swapchain_o* base ) {
 
 	auto self = static_cast<img_data_o* const>( base->data );
 
+	// Write out any frames which are still queued before we close the pipe.
+	swapchain_img_stop_writer( self );
+
+	swapchain_img_close_ring( self );
+
 	if ( self->pipe ) {
 #ifdef _MSC_VER
 
@@ -447,8 +731,6 @@ static void swapchain_img_destroy( le_swapchain_o* base ) {
 
 		// Destroy image allocation for this frame.
 		private_backend_vk_i.destroy_image( self->backend, f.image, f.imageAllocation );
-		// Destroy buffer allocation for this frame.
-		private_backend_vk_i.destroy_buffer( self->backend, f.buffer, f.bufferAllocation );
 
 		if ( f.frameFence ) {
 			vkDestroyFence( self->device, f.frameFence, nullptr );
@@ -460,6 +742,13 @@ static void swapchain_img_destroy( le_swapchain_o* base ) {
 
 	self->transferFrames.clear();
 
+	for ( auto& slot : self->readbackSlots ) {
+		// Destroy buffer allocation for this readback slot.
+		private_backend_vk_i.destroy_buffer( self->backend, slot.buffer, slot.allocation );
+	}
+
+	self->readbackSlots.clear();
+
 	if ( self->vkCommandPool ) {
 
 		// Destroying the command pool implicitly frees all command buffers
@@ -477,7 +766,6 @@ static void swapchain_img_destroy( le_swapchain_o* base ) {
 // ----------------------------------------------------------------------
 
 static bool swapchain_img_acquire_next_image( le_swapchain_o* base, VkSemaphore semaphorePresentComplete, uint32_t* imageIndex ) {
-	static auto logger = LeLog( LOGGER_LABEL );
 
 	auto self = static_cast<img_data_o* const>( base->data );
 	// This method will return the next avaliable vk image index for this swapchain, possibly
@@ -497,30 +785,23 @@ static bool swapchain_img_acquire_next_image( le_swapchain_o* base, VkSemaphore
 
 	self->mImageIndex = *imageIndex;
 
-	// We only want to write out images which have made the round-trip
-	// the first n images will be black...
-	if ( self->totalImages > self->mImagecount ) {
-		if ( self->pipe ) {
-			// TODO: we should be able to do the write on the back thread.
-			// the back thread must signal that it is complete with writing
-			// before the next present command is executed.
+	auto& frame = self->transferFrames[ *imageIndex ];
 
-			// Write out frame contents to ffmpeg via pipe.
-			auto const& frame = self->transferFrames[ *imageIndex ];
-			fwrite( frame.bufferAllocationInfo.pMappedData, self->mSwapchainExtent.width * self->mSwapchainExtent.height * 4, 1, self->pipe );
-
-		} else {
-			char file_name[ 1024 ];
-			sprintf( file_name, "isl_%08d.rgba", self->totalImages );
-			auto const&   frame = self->transferFrames[ *imageIndex ];
-			std::ofstream myfile( file_name, std::ios::out | std::ios::binary );
-			myfile.write( ( char* )frame.bufferAllocationInfo.pMappedData,
-			              self->mSwapchainExtent.width * self->mSwapchainExtent.height * 4 );
-			myfile.close();
-			logger.info( "Wrote Image: %s", file_name );
+	// If this image was presented before, its fence tells us that the copy into its
+	// readback slot has completed - we can hand the readback slot over to the writer
+	// thread. Images which have not made the round-trip yet have nothing to write.
+	if ( frame.readback_slot != uint32_t( ~0 ) ) {
+		{
+			std::scoped_lock lock( self->writer.mtx );
+			self->writer.jobs.push_back( { frame.readback_slot, frame.frame_number } );
+			self->writer.slot_is_queued[ frame.readback_slot ] = 1;
 		}
+		self->writer.cv_job_added.notify_one();
+		frame.readback_slot = uint32_t( ~0 );
 	}
 
+	frame.frame_number = self->totalImages;
+
 	++self->totalImages;
 
 	// The number of array elements must correspond to the number of wait semaphores, as each
@@ -564,6 +845,22 @@ static bool swapchain_img_present( le_swapchain_o* base, VkQueue queue, VkSemaph
 
 	auto self = static_cast<img_data_o* const>( base->data );
 
+	auto&    frame    = self->transferFrames[ *pImageIndex ];
+	uint32_t slot_idx = self->totalPresents % uint32_t( self->readbackSlots.size() );
+	self->totalPresents++;
+
+	{
+		// Readback slots are used round-robin. If the writer thread has not yet finished
+		// writing out the previous contents of this slot, we must wait for it - this is
+		// the only place where rendering may be slowed down by i/o.
+		ZoneScopedN( "Wait for readback slot" );
+		std::unique_lock lock( self->writer.mtx );
+		self->writer.cv_slot_written.wait( lock, [ self, slot_idx ]() { return self->writer.slot_is_queued[ slot_idx ] == 0; } );
+	}
+
+	swapchain_img_record_present_cmd( self, frame, self->readbackSlots[ slot_idx ] );
+	frame.readback_slot = slot_idx;
+
 	VkPipelineStageFlags wait_dst_stage_mask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 
 	VkSubmitInfo submitInfo{
@@ -573,12 +870,12 @@ static bool swapchain_img_present( le_swapchain_o* base, VkQueue queue, VkSemaph
 	    .pWaitSemaphores      = &renderCompleteSemaphore_, // tells us that the image has been written
 	    .pWaitDstStageMask    = &wait_dst_stage_mask,
 	    .commandBufferCount   = 1,
-	    .pCommandBuffers      = &self->transferFrames[ *pImageIndex ].cmdPresent, // copies image to buffer
-	    .signalSemaphoreCount = 0,                                                // optional
+	    .pCommandBuffers      = &frame.cmdPresent, // copies image to readback slot
+	    .signalSemaphoreCount = 0,                 // optional
 	    .pSignalSemaphores    = 0,
 	};
 
-	vkQueueSubmit( queue, 1, &submitInfo, self->transferFrames[ *pImageIndex ].frameFence );
+	vkQueueSubmit( queue, 1, &submitInfo, frame.frameFence );
 	return true;
 };
 
@@ -17,6 +17,42 @@ struct VkQueue_T;
 struct VkSurfaceFormatKHR;
 struct le_swapchain_settings_t;
 
+// Layout of the header at the start of an image swapchain output ring file.
+//
+// An image swapchain which was created with `img_settings.ring_path` writes frames
+// into a memory-mapped file instead of a pipe: the file starts with this header,
+// followed by `slot_count` frame slots starting at byte `data_offset`, each
+// `slot_stride` bytes apart. Frame `n` is stored in slot `n % slot_count`, as
+// tightly packed rows of 4 bytes per pixel.
+//
+// Each slot is guarded by a sequence number (an array of `slot_count` uint64_t
+// starting at byte `sequence_offset`). While frame `n` is being written into its
+// slot, the slot's sequence number is `2n+1`; once the frame is complete, it is
+// `2n+2`. The writer never waits for readers, so a slow reader may find its slot
+// overwritten, even while copying from it. To read frame `n`, a reader should:
+//
+//   1. load `frames_written` with acquire semantics; frame `n` is only ready if `n < frames_written`,
+//   2. load the slot's sequence number with acquire semantics; if it is not `2n+2`, the frame was lost,
+//   3. copy frame data out of the slot,
+//   4. issue an acquire fence, then load the sequence number again; if it changed, the copy is torn,
+//      and the frame was lost.
+#define LE_SWAPCHAIN_IMG_RING_MAGIC 0x5249454c // 'LEIR'
+#define LE_SWAPCHAIN_IMG_RING_VERSION 2
+
+struct le_swapchain_img_ring_header_t {
+	uint32_t magic;           // must be LE_SWAPCHAIN_IMG_RING_MAGIC
+	uint32_t version;         // must be LE_SWAPCHAIN_IMG_RING_VERSION
+	uint32_t width;           // frame width in pixels
+	uint32_t height;          // frame height in pixels
+	uint32_t format;          // VkFormat of frame data
+	uint32_t slot_count;      // number of frame slots
+	uint64_t slot_stride;     // number of bytes from the start of one slot to the next
+	uint64_t frame_size;      // number of bytes of frame data per slot
+	uint64_t data_offset;     // offset in bytes from the start of the file to the first slot
+	uint64_t sequence_offset; // offset in bytes from the start of the file to per-slot sequence numbers (uint64_t[slot_count])
+	uint64_t frames_written;  // total number of frames written - updated atomically by writer
+};
+
 struct le_swapchain_vk_api {
 
 	// clang-format off
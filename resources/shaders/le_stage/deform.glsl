@@ -0,0 +1,102 @@
+#version 450
+
+// Skins, and morphs the vertices of one primitive, as drawn by one node. One
+// invocation per vertex. Deformed vertices are written into DeformedVertices,
+// from where all passes which draw the primitive read them as vertex attributes.
+
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+struct Joint {
+	mat4 matrix;
+	mat4 normal_matrix; // transpose(inverse(matrix))
+};
+
+// Packed by le_stage_setup_pipelines. Seven vec4 per vertex: position, normal,
+// tangent, joints[2], weights[2] - where joint indices are stored as uints.
+// These are followed by three vec4 per vertex for each morph target: position,
+// normal, and tangent deltas.
+layout (std430, set = 0, binding = 0) readonly buffer DeformSource {
+	vec4 source[];
+};
+
+// Joints for all skinned nodes - each job starts at its joint_offset.
+layout (std430, set = 0, binding = 1) readonly buffer JointPalette {
+	Joint joints[];
+};
+
+// Ten floats per vertex: position.xyz, normal.xyz, tangent.xyzw
+layout (std430, set = 0, binding = 2) writeonly buffer DeformedVertices {
+	float deformed[];
+};
+
+layout (std140, set = 0, binding = 3) uniform DeformParams {
+	uint vertex_count;
+	uint first_vertex;       // index of first output vertex
+	uint joint_offset;       // index of first joint into joints
+	uint num_joint_sets;     // 0 if vertices are not skinned
+	uint morph_target_count;
+	vec4 morph_weights[3];   // one float per morph target, tightly packed
+};
+
+void main(){
+
+	uint v = gl_GlobalInvocationID.x;
+
+	if ( v >= vertex_count ) {
+		return;
+	}
+
+	uint base = v * 7;
+
+	vec3 pos     = source[ base + 0 ].xyz;
+	vec3 normal  = source[ base + 1 ].xyz;
+	vec4 tangent = source[ base + 2 ];
+
+	uint morph_base = vertex_count * 7;
+
+	for ( uint i = 0; i != morph_target_count; i++ ) {
+		float w = morph_weights[ i / 4 ][ i % 4 ];
+		uint  t = morph_base + ( i * vertex_count + v ) * 3;
+
+		pos         += w * source[ t + 0 ].xyz;
+		normal      += w * source[ t + 1 ].xyz;
+		tangent.xyz += w * source[ t + 2 ].xyz;
+	}
+
+	if ( num_joint_sets > 0 ) {
+		mat4 skin        = mat4( 0 );
+		mat4 skin_normal = mat4( 0 );
+
+		for ( uint s = 0; s != num_joint_sets; s++ ) {
+			uvec4 joint_idx = floatBitsToUint( source[ base + 3 + s ] );
+			vec4  weight    = source[ base + 5 + s ];
+
+			for ( int k = 0; k != 4; k++ ) {
+				skin        += weight[ k ] * joints[ joint_offset + joint_idx[ k ] ].matrix;
+				skin_normal += weight[ k ] * joints[ joint_offset + joint_idx[ k ] ].normal_matrix;
+			}
+		}
+
+		pos         = ( skin * vec4( pos, 1 ) ).xyz;
+		normal      = ( skin_normal * vec4( normal, 0 ) ).xyz;
+		tangent.xyz = ( skin * vec4( tangent.xyz, 0 ) ).xyz;
+	}
+
+	// Primitives without normals, or tangents leave these at zero - the
+	// vertex shader won't read them, but we must not write NaNs either.
+	normal      = normal * inversesqrt( max( dot( normal, normal ), 1e-20 ) );
+	tangent.xyz = tangent.xyz * inversesqrt( max( dot( tangent.xyz, tangent.xyz ), 1e-20 ) );
+
+	uint o = ( first_vertex + v ) * 10;
+
+	deformed[ o + 0 ] = pos.x;
+	deformed[ o + 1 ] = pos.y;
+	deformed[ o + 2 ] = pos.z;
+	deformed[ o + 3 ] = normal.x;
+	deformed[ o + 4 ] = normal.y;
+	deformed[ o + 5 ] = normal.z;
+	deformed[ o + 6 ] = tangent.x;
+	deformed[ o + 7 ] = tangent.y;
+	deformed[ o + 8 ] = tangent.z;
+	deformed[ o + 9 ] = tangent.w;
+}
@@ -0,0 +1,108 @@
+#version 450
+
+// Culls instances of draw batches against the camera frustum. Runs in two
+// dispatches:
+//
+// stage 0: one invocation per batch - writes the batch's indirect draw
+//          command, with an instance count of 0.
+// stage 1: one invocation per instance - if the instance is visible, appends
+//          its transforms to its batch, and increments the batch's instance count.
+
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+struct CullBatch {
+	uint count;          // index count for indexed draws, vertex count otherwise
+	uint first_instance; // index of first instance of this batch into instance transforms
+	uint padding[2];
+};
+
+struct CullInstance {
+	vec4 bounding_sphere; // xyz: centre in world space, w: radius; negative radius means never to cull
+	uint batch_idx;
+	uint padding[3];
+};
+
+struct InstanceTransform {
+	mat4 modelMatrix;
+	mat4 normalMatrix;
+};
+
+layout (std430, set = 0, binding = 0) readonly buffer CullBatches {
+	CullBatch batches[];
+};
+
+layout (std430, set = 0, binding = 1) readonly buffer CullInstances {
+	CullInstance cull_instances[];
+};
+
+layout (std430, set = 0, binding = 2) readonly buffer DrawInstances {
+	InstanceTransform draw_instances[];
+};
+
+// One command per batch, five uints each. Indexed draws use the layout of
+// VkDrawIndexedIndirectCommand, non-indexed draws the layout of
+// VkDrawIndirectCommand, followed by one unused uint.
+layout (std430, set = 0, binding = 3) buffer IndirectDraws {
+	uint commands[];
+};
+
+layout (std430, set = 0, binding = 4) writeonly buffer InstanceSSBO {
+	InstanceTransform instances[];
+};
+
+layout (std140, set = 0, binding = 5) uniform CullParams {
+	vec4 frustum_planes[6]; // world space, xyz: normal pointing inwards, w: distance to origin
+	uint batch_count;
+	uint instance_count;
+	uint stage;
+};
+
+void reset_command( uint batch_idx ){
+	CullBatch batch = batches[ batch_idx ];
+	uint      base  = batch_idx * 5;
+
+	commands[ base + 0 ] = batch.count; // index count | vertex count
+	commands[ base + 1 ] = 0;           // instance count
+	commands[ base + 2 ] = 0;           // first index | first vertex
+
+	// First instance must be 0, as indirect draws may only use a non-zero first
+	// instance if the drawIndirectFirstInstance feature is enabled. The draw pass
+	// instead tells the vertex shader where a batch's instances begin.
+	commands[ base + 3 ] = 0; // vertex offset | first instance
+	commands[ base + 4 ] = 0; // first instance | unused
+}
+
+void cull_instance( uint instance_idx ){
+	vec4 sphere  = cull_instances[ instance_idx ].bounding_sphere;
+	bool visible = true;
+
+	if ( sphere.w >= 0 ) {
+		for ( int i = 0; i != 6; i++ ) {
+			visible = visible && ( dot( frustum_planes[ i ].xyz, sphere.xyz ) + frustum_planes[ i ].w >= -sphere.w );
+		}
+	}
+
+	if ( !visible ) {
+		return;
+	}
+
+	uint batch_idx = cull_instances[ instance_idx ].batch_idx;
+	uint slot      = atomicAdd( commands[ batch_idx * 5 + 1 ], 1 );
+
+	instances[ batches[ batch_idx ].first_instance + slot ] = draw_instances[ instance_idx ];
+}
+
+void main(){
+
+	uint index = gl_GlobalInvocationID.x;
+
+	if ( stage == 0 ) {
+		if ( index < batch_count ) {
+			reset_command( index );
+		}
+	} else {
+		if ( index < instance_count ) {
+			cull_instance( index );
+		}
+	}
+}
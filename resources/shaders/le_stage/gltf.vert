@@ -18,54 +18,33 @@ layout (location = LOC_POSITIONS ) in vec3 a_pos[NUM_POSITIONS];
 	layout (location = LOC_TEXCOORDS) in vec2 a_tex_coord[NUM_TEXCOORDS];
 #endif
 
-#ifdef NUM_JOINT_SETS
-	layout(location = LOC_JOINT_SETS) in uvec4 a_Joint[NUM_JOINT_SETS];
-#endif
-
-#ifdef NUM_JOINT_WEIGHTS_SET
-	layout(location = LOC_JOINT_WEIGHTS_SET) in vec4 a_Weight[NUM_JOINT_WEIGHTS_SET];
-#endif
-
 // Uniform Arguments
 layout (std140, set = 0, binding = 0) uniform UboMatrices {
 	mat4 viewProjectionMatrix; // (projection * view) matrix
-	mat4 normalMatrix;
-	mat4 modelMatrix;
 	vec3 camera_position; // camera position in world space
 };
 
+// Per-instance transforms, indexed by first_instance + gl_InstanceIndex.
+struct InstanceTransform {
+	mat4 modelMatrix;
+	mat4 normalMatrix; // transpose(inverse(modelMatrix))
+};
+
+layout (std430, set = 0, binding = 5) readonly buffer InstanceSSBO {
+	InstanceTransform instances[];
+};
+
+// Index of the first instance of the current draw batch into InstanceSSBO.
+// We don't use the draw's firstInstance for this, as indirect draws may
+// only set firstInstance if drawIndirectFirstInstance is enabled.
+layout (push_constant) uniform DrawParams {
+	uint first_instance;
+};
+
 layout (std140, set = 0, binding = 1) uniform UboPostProcessing {
 	float exposure;
 } postProcessing;
 
-#ifdef MORPH_TARGET_COUNT
-	// we receive morph target weights as an array of vec4's because
-	// if we would use an array of floats this would waste 3 floats 
-	// per array element.
-	layout (std140, set = 0, binding = 2) uniform UboMorphTargetWeights{
-		vec4 morphTargetWeights[((MORPH_TARGET_COUNT+3)/4)+1];
-	};
-#	ifdef NUM_JOINT_SETS
-	layout (std140, set=0, binding = 3 ) readonly buffer UboJointMatrices {
-    	mat4 u_jointMatrix [];
-	};
-	layout (std140, set=0, binding = 4 ) readonly buffer UboJointNormalMatrices {
-    	mat4 u_jointNormalMatrix [];
-	};
-#	endif
-#else // !MORPH_TARGET_COUNT
-#	ifdef NUM_JOINT_SETS
-	layout (std140, set=0, binding = 2 ) readonly buffer UboJointMatrices {
-    	mat4 u_jointMatrix [];
-	};
-	layout (std140, set=0, binding = 3 ) readonly buffer UboJointNormalMatrices {
-    	mat4 u_jointNormalMatrix [];
-	};
-#	endif
-#endif
-
-#include "animation.glsl"
-
 #if defined(MATERIAL_SPECULARGLOSSINESS) || defined(MATERIAL_METALLICROUGHNESS)
 layout (std140, set = 1, binding = 0) uniform UboMaterialParams {
     vec4 base_color_factor;
@@ -97,55 +76,30 @@ out gl_PerVertex
     vec4 gl_Position;
 };
 
-vec4 getPosition(){
-	vec3 pos = a_pos[0];
+// Skinned, and morphed primitives are deformed by the deform pass (see deform.glsl)
+// before they are drawn - we read their deformed vertices as regular vertex attributes.
 
-#ifdef MORPH_TARGET_COUNT
-	getTargetPosition(pos);
-#endif
-
-#ifdef NUM_JOINT_SETS
-    pos = (getSkinningMatrix() * vec4(pos,1)).xyz;
-#endif
-
-	return vec4(pos, 1);
+vec4 getPosition(){
+	return vec4(a_pos[0], 1);
 }
 
 #ifdef LOC_NORMALS
 vec4 getNormal(){
-	vec3 normal = a_normal[0];
-
-#ifdef MORPH_TARGET_COUNT
-	getTargetNormal(normal);
-#endif
-
-#ifdef NUM_JOINT_SETS
-    normal = (getSkinningNormalMatrix() * vec4(normal,0)).xyz;
-#endif
-
-	return normalize(vec4(normal, 0));
+	return normalize(vec4(a_normal[0], 0));
 }
 #endif
 
 #ifdef LOC_TANGENTS
 vec4 getTangent(){
-
-	vec4 tangent = a_tangent[0];
-
-#ifdef MORPH_TARGET_COUNT
-    getTargetTangent(tangent);
-#endif
-
-#ifdef NUM_JOINT_SETS
-    tangent = getSkinningMatrix() * tangent;
-#endif
-
-	return normalize(tangent);
+	return normalize(a_tangent[0]);
 }
 #endif
 
 void main() {
 
+    mat4 modelMatrix  = instances[ first_instance + gl_InstanceIndex ].modelMatrix;
+    mat4 normalMatrix = instances[ first_instance + gl_InstanceIndex ].normalMatrix;
+
     vec4 pos = modelMatrix * getPosition(); 	// world position
     v_position = vec3(pos.xyz) / pos.w; 		// un-project 
 	
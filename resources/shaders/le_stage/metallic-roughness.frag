@@ -39,8 +39,6 @@ layout (location = 0) in VertexData {
 // Uniform Arguments
 layout (std140, set = 0, binding = 0) uniform UboMatrices {
     mat4 viewProjectionMatrix; // (projection * view) matrix
-    mat4 normalMatrix;
-    mat4 modelMatrix;
     vec3 camera_position; // camera position in world space
 };
 